@@ -48,7 +48,7 @@ typedef unsigned int GLenum;
 
 // Version number for shader translation API.
 // It is incremented every time the API changes.
-#define ANGLE_SH_VERSION 132
+#define ANGLE_SH_VERSION 147
 
 typedef enum {
   SH_GLES2_SPEC = 0x8B40,
@@ -172,6 +172,76 @@ typedef enum {
   // It is intended as a workaround for drivers that do not handle
   // struct scopes correctly, including all Mac drivers and Linux AMD.
   SH_REGENERATE_STRUCT_NAMES = 0x80000,
+
+  // This flag looks up the results of the compilation in the process-wide
+  // translation cache before compiling, and stores them there afterwards.
+  // A hit restores the object code, info log and variables of an earlier
+  // compilation of the same sources with the same options by a compiler
+  // with the same type, spec, output and resources, without parsing.
+  // See ShSetTranslationCacheMaxSize and ShSetTranslationCacheDirectory.
+  SH_CACHE_TRANSLATION = 0x100000,
+
+  // This flag enables an optimization pass that folds constant expressions,
+  // replaces variables that are never written after being initialized with
+  // a constant by that constant, and removes branches that are never taken,
+  // unreferenced variables and functions that are not called from main().
+  // Uniforms, attributes and varyings referenced only by the removed code
+  // are not reported as statically used when SH_VARIABLES is also set.
+  SH_PRUNE_DEAD_CODE = 0x200000,
+
+  // This flag makes the compiler record how long each phase of the
+  // compilation takes, along with the size of the AST, the number of
+  // declared symbols and the memory allocated from the pool.
+  // Can be queried by calling ShGetCompileStatistics().
+  SH_COMPILE_STATISTICS = 0x400000,
+
+  // This flag makes the HLSL output mark the loops it unrolls with
+  // [unroll]; the others keep the LOOP macro. A loop is unrolled if its
+  // number of iterations can be determined from the AST and the estimated
+  // size of all its iterations together, in operations, is at most
+  // MaxUnrolledLoopCost. Loops marked for unrolling by
+  // SH_UNROLL_FOR_LOOP_WITH_INTEGER_INDEX or
+  // SH_UNROLL_FOR_LOOP_WITH_SAMPLER_ARRAY_INDEX, and loops that compute
+  // gradients, are unrolled whenever their number of iterations is known.
+  SH_UNROLL_LOOPS_BY_COST = 0x800000,
+
+  // This flag enables an optimization pass that computes expressions that
+  // are repeated in a function, or that do not change from one iteration of
+  // a loop to the next, only once, in temporary variables. Only operations
+  // and built-in function calls without side effects are moved, and
+  // expressions evaluated only under a condition are never moved out of it.
+  // Runs after the pass enabled by SH_PRUNE_DEAD_CODE.
+  SH_ELIMINATE_COMMON_SUBEXPRESSIONS = 0x1000000,
+
+  // This flag makes the compiler keep a serialized form of the AST once it
+  // is validated, which ShCompileSerializedAST() translates later without
+  // preprocessing or parsing the shader again.
+  // Can be queried by calling ShGetSerializedAST().
+  SH_SERIALIZE_AST = 0x2000000,
+
+  // This flag limits the memory a compilation may use to
+  // MaxCompileMemory bytes, for the tree and the other data the compiler
+  // allocates from its pool, and separately for the tokens of macro
+  // expansions in progress. A compilation that needs more fails with an
+  // error in the info log. The limit is checked as the memory is taken
+  // into use, so a compilation may go over it by the memory that a single
+  // step of parsing or translation needs before it stops.
+  SH_LIMIT_COMPILE_MEMORY = 0x4000000,
+
+  // This flag replaces the uniforms of the default uniform block with a
+  // single array of vec4s, so that they can all be uploaded with one
+  // contiguous copy. The uniforms are placed in the array by the packing
+  // rules of the GLSL 1.017 spec, Appendix A, section 7, and each use of
+  // them reads the components they were placed in. Uniforms of float and
+  // bool types, of int types in ESSL 1.00 shaders, and arrays of them, are
+  // packed. Structures, samplers, non-square matrices and arrays that are
+  // used other than by indexing them are left as they are. Int and bool
+  // values are stored as floats.
+  // The array is named after the shader type, and
+  // ShGetPackedUniformArray() and ShGetPackedUniformPlacement() describe
+  // it. Compilation fails if the uniforms do not fit in
+  // MaxVertexUniformVectors or MaxFragmentUniformVectors rows.
+  SH_PACK_UNIFORMS = 0x8000000,
 } ShCompileOptions;
 
 // Defines alternate strategies for implementing array index clamping.
@@ -254,6 +324,14 @@ typedef struct
 
     // The maximum depth a call stack can be.
     int MaxCallStackDepth;
+
+    // The largest estimated size, in operations, of the unrolled code of a
+    // loop that SH_UNROLL_LOOPS_BY_COST unrolls.
+    int MaxUnrolledLoopCost;
+
+    // The most memory, in bytes, that a compilation with
+    // SH_LIMIT_COMPILE_MEMORY may use.
+    int MaxCompileMemory;
 } ShBuiltInResources;
 
 //
@@ -323,12 +401,309 @@ COMPILER_EXPORT void ShDestruct(ShHandle handle);
 // SH_VARIABLES: Extracts attributes, uniforms, and varyings.
 //               Can be queried by calling ShGetVariableInfo().
 //
+// After ShInitialize() has returned, ShCompile may be called concurrently
+// from several threads as long as each thread uses a different handle.
+// A handle must not be used by more than one thread at a time.
+//
 COMPILER_EXPORT bool ShCompile(
     const ShHandle handle,
     const char * const shaderStrings[],
     size_t numStrings,
     int compileOptions);
 
+//
+// A single compilation for ShCompileBatch. The first four members are the
+// arguments to ShCompile; result receives its return value.
+//
+typedef struct
+{
+    ShHandle handle;
+    const char * const *shaderStrings;
+    size_t numStrings;
+    int compileOptions;
+    bool result;
+} ShCompileJob;
+
+//
+// Compiles a batch of shaders in parallel on an internal pool of worker
+// threads, which is sized to the number of processors and lives until
+// ShFinalize(). Returns once every job has finished.
+// If all jobs succeed, the return value is true, else false.
+// Parameters:
+// jobs: Specifies an array of jobs. Each job must use a different handle.
+// numJobs: Specifies the number of elements in jobs array.
+//
+COMPILER_EXPORT bool ShCompileBatch(ShCompileJob *jobs, size_t numJobs);
+
+//
+// Compiles the given shader source for several targets, parsing and
+// validating it only once. Each handle is then translated from its own copy
+// of the validated AST, and gets its own results, which are queried as
+// after ShCompile. If the source fails to parse or validate, every handle
+// gets the info log of the failure.
+// The handles must have been constructed with the same shader type, spec
+// and built-in resources, and usually differ in their output. Handles that
+// do not match the first, and all handles when SH_CACHE_TRANSLATION is set,
+// are compiled separately instead.
+// With SH_COMPILE_STATISTICS, the phases of parsing and validation, and the
+// copying of the AST, are timed for the first handle only, and each handle
+// has the statistics of its own translation.
+// If the compilation succeeds for all handles, the return value is true,
+// else false.
+// Parameters:
+// handles: Specifies an array of compiler handles, each used at most once.
+// numHandles: Specifies the number of elements in handles array.
+// shaderStrings, numStrings, compileOptions: As for ShCompile.
+//
+COMPILER_EXPORT bool ShCompileMultipleTargets(
+    const ShHandle handles[],
+    size_t numHandles,
+    const char * const shaderStrings[],
+    size_t numStrings,
+    int compileOptions);
+
+//
+// Translates a shader from the serialized AST that a compilation with
+// SH_SERIALIZE_AST returned, without preprocessing or parsing it. The
+// results are the same as those of compiling the shader with ShCompile and
+// the given options, except that the options that affect preprocessing,
+// parsing and validation, such as SH_VALIDATE_LOOP_INDEXING or
+// SH_SOURCE_PATH, are those the AST was serialized with, and
+// SH_CACHE_TRANSLATION is ignored.
+// The compiler must have been constructed with the same shader type, spec
+// and built-in resources as the one that serialized the AST, but may have
+// another output. ShLinkVaryings can link the results as after ShCompile.
+// ASTs that were truncated or corrupted by accident are rejected, as are
+// trees the parser would not have created. The checksum does not protect
+// against deliberate changes, so ASTs from untrusted storage should be
+// authenticated by the caller.
+// If the AST is valid and the translation succeeds, the return value is
+// true, else false.
+// Parameters:
+// handle: Specifies the handle of compiler to be used.
+// serializedAST: Specifies the serialized AST.
+// length: Specifies the size of serializedAST in bytes.
+// compileOptions: As for ShCompile.
+//
+COMPILER_EXPORT bool ShCompileSerializedAST(
+    const ShHandle handle,
+    const char *serializedAST,
+    size_t length,
+    int compileOptions);
+
+//
+// A prologue of preprocessor directives, such as #define, #extension and
+// #pragma, that is shared by many shaders. It is preprocessed once, and
+// compilations start from the resulting preprocessor state instead of
+// preprocessing it again.
+//
+typedef void *ShPrologue;
+
+//
+// Preprocesses a prologue for the compilers with the same shader type, spec
+// and built-in resources as the given one.
+// Returns the prologue, or NULL if it contains anything but directives or
+// has errors, which are then written to the info log of the compiler.
+// Parameters:
+// handle: Specifies the compiler.
+// prologueStrings: Specifies an array of pointers to null-terminated strings
+//                  containing the prologue.
+// numStrings: Specifies the number of elements in prologueStrings array.
+//
+COMPILER_EXPORT ShPrologue ShCreatePrologue(
+    const ShHandle handle,
+    const char * const prologueStrings[],
+    size_t numStrings);
+COMPILER_EXPORT void ShDestructPrologue(ShPrologue prologue);
+
+//
+// Makes the later compilations of the compiler start from the given
+// prologue, as if it preceded their shader strings. The locations of
+// diagnostics in the shader strings are the same as without a prologue.
+// Passing NULL removes the prologue. The prologue must not be destructed
+// while a compiler uses it.
+// Returns false, and leaves the compiler unchanged, if the prologue was
+// created for a compiler with a different shader type, spec or built-in
+// resources.
+//
+COMPILER_EXPORT bool ShSetPrologue(const ShHandle handle, const ShPrologue prologue);
+
+//
+// Links the vertex shader last compiled by one compiler with the fragment
+// shader last compiled by another, both compiled with SH_VARIABLES. The
+// vertex shader is compiled again without the user-defined varyings that
+// the fragment shader does not statically use, which become globals of the
+// vertex shader, and with SH_PRUNE_DEAD_CODE, so that the computations of
+// their values are removed as well. The results of the vertex compiler,
+// including its object code and varyings, are replaced by those of this
+// compilation. Built-in outputs such as gl_Position are always kept.
+// The vertex compiler can be linked again, with the same or another
+// fragment shader, until it compiles another shader.
+// If both shaders compiled successfully with SH_VARIABLES and the vertex
+// shader links successfully, the return value is true, else false and the
+// results of the vertex compiler are left unchanged.
+// Parameters:
+// vertexHandle: Specifies the compiler of the vertex shader.
+// fragmentHandle: Specifies the compiler of the fragment shader.
+//
+COMPILER_EXPORT bool ShLinkVaryings(const ShHandle vertexHandle, const ShHandle fragmentHandle);
+
+//
+// Number of buckets in ShPoolAllocatorStats::allocationSizeHistogram.
+//
+#define SH_POOL_ALLOCATION_HISTOGRAM_SIZE 8
+
+//
+// Statistics of the memory pool that holds the intermediate data of a
+// compiler, such as its AST. See ShGetPoolAllocatorStats.
+//
+typedef struct
+{
+    // Size of the pages the pool obtains from the system.
+    size_t pageSize;
+    // Number of pages holding live data, and of free pages kept for reuse
+    // by later compilations.
+    size_t pagesInUse;
+    size_t pagesCached;
+    // The largest number of bytes held by the pool, in use or cached,
+    // since the compiler was constructed.
+    size_t peakBytes;
+    // Number of allocations from the pool and the total bytes requested.
+    size_t allocationCount;
+    size_t allocatedBytes;
+    // Bucket i counts allocations of at most 16 << i bytes that do not
+    // fall into a lower bucket; the last bucket counts all larger ones.
+    size_t allocationSizeHistogram[SH_POOL_ALLOCATION_HISTOGRAM_SIZE];
+} ShPoolAllocatorStats;
+
+//
+// Returns statistics of the memory pool of the given compiler.
+// If the function succeeds, the return value is true, else false.
+// Parameters:
+// handle: Specifies the compiler
+// stats: Returns the statistics.
+//
+COMPILER_EXPORT bool ShGetPoolAllocatorStats(const ShHandle handle,
+                                             ShPoolAllocatorStats *stats);
+
+//
+// Phases of a compilation timed with SH_COMPILE_STATISTICS. Phases that
+// are not enabled by the compile options take no time.
+//
+typedef enum {
+  SH_COMPILE_PHASE_PARSE,
+  SH_COMPILE_PHASE_POST_PROCESS,
+  SH_COMPILE_PHASE_LIMIT_EXPRESSION_COMPLEXITY,
+  SH_COMPILE_PHASE_DETECT_CALL_DEPTH,
+  SH_COMPILE_PHASE_VALIDATE_OUTPUTS,
+  SH_COMPILE_PHASE_VALIDATE_LIMITATIONS,
+  // Includes building and writing out the dependency graph.
+  SH_COMPILE_PHASE_TIMING_RESTRICTIONS,
+  SH_COMPILE_PHASE_REWRITE_CSS_SHADER,
+  // Copying of the validated AST for the other targets of
+  // ShCompileMultipleTargets.
+  SH_COMPILE_PHASE_COPY_TREE,
+  // Writing of the validated AST with SH_SERIALIZE_AST, and reading of it
+  // by ShCompileSerializedAST.
+  SH_COMPILE_PHASE_SERIALIZE_TREE,
+  SH_COMPILE_PHASE_DESERIALIZE_TREE,
+  SH_COMPILE_PHASE_PRUNE_DEAD_CODE,
+  SH_COMPILE_PHASE_ELIMINATE_COMMON_SUBEXPRESSIONS,
+  // Marking of for-loops to unroll.
+  SH_COMPILE_PHASE_UNROLL_MARKUP,
+  // Marking of built-in functions to emulate and of indirect array indexing
+  // to clamp.
+  SH_COMPILE_PHASE_EMULATION,
+  // Initialization of gl_Position and of varyings without static use.
+  SH_COMPILE_PHASE_INITIALIZE_VARIABLES,
+  SH_COMPILE_PHASE_UNFOLD_SHORT_CIRCUIT,
+  SH_COMPILE_PHASE_COLLECT_VARIABLES,
+  SH_COMPILE_PHASE_PACK_UNIFORMS,
+  SH_COMPILE_PHASE_SCALARIZE,
+  SH_COMPILE_PHASE_REGENERATE_STRUCT_NAMES,
+  SH_COMPILE_PHASE_TRANSLATE,
+  SH_COMPILE_PHASE_COUNT
+} ShCompilePhase;
+
+//
+// Statistics of the last compilation with SH_COMPILE_STATISTICS. See
+// ShGetCompileStatistics.
+//
+typedef struct
+{
+    // Time spent in each phase and in the whole of ShCompile, in
+    // milliseconds. A compilation served by the translation cache only has
+    // a total time.
+    double phaseTimes[SH_COMPILE_PHASE_COUNT];
+    double totalTime;
+    // Passes that only read the AST are run together in a single walk over
+    // it. These count the visits made to the passes of each phase in such
+    // walks; the time of a walk is split between its passes in proportion
+    // to them.
+    size_t phaseVisits[SH_COMPILE_PHASE_COUNT];
+    // Number of walks over the AST made by the validation, markup and
+    // transformation passes, not counting translation. A pass that walks
+    // the AST several times on its own counts once.
+    size_t treeWalks;
+    // Number of nodes in the AST after parsing.
+    size_t astNodeCount;
+    // Number of symbols declared by the shader, in any scope.
+    size_t symbolCount;
+    // Number of allocations and bytes requested from the memory pool.
+    size_t poolAllocationCount;
+    size_t poolAllocatedBytes;
+} ShCompileStatistics;
+
+//
+// Returns statistics of the last compilation of the given compiler. They
+// are zero unless it was compiled with SH_COMPILE_STATISTICS.
+// If the function succeeds, the return value is true, else false.
+// Parameters:
+// handle: Specifies the compiler
+// stats: Returns the statistics.
+//
+COMPILER_EXPORT bool ShGetCompileStatistics(const ShHandle handle,
+                                            ShCompileStatistics *stats);
+
+//
+// Returns a short name of the given phase, such as "parse". The names are
+// also used for the trace events that are recorded for each phase.
+//
+COMPILER_EXPORT const char *ShGetCompilePhaseName(ShCompilePhase phase);
+
+//
+// Limits the memory that the pool of the given compiler keeps for reuse
+// once a compilation has finished. Pages above the limit are returned to
+// the system. The default is 1MB. Lowering the limit trims the pool right
+// away.
+// Parameters:
+// handle: Specifies the compiler
+// maxBytes: The maximum number of bytes to keep.
+//
+COMPILER_EXPORT void ShSetPoolAllocatorMaxCachedBytes(const ShHandle handle,
+                                                     size_t maxBytes);
+
+//
+// Sets the maximum total size in bytes of the compilation results held in
+// memory by the translation cache used with SH_CACHE_TRANSLATION. Least
+// recently used results are evicted first. The default is 8MB.
+//
+COMPILER_EXPORT void ShSetTranslationCacheMaxSize(size_t maxSize);
+
+//
+// Makes the translation cache also store results as files in the given
+// directory, which must exist, so that they persist across runs. Files
+// written by a different ANGLE_SH_VERSION are ignored. Passing NULL stops
+// using a directory.
+//
+COMPILER_EXPORT void ShSetTranslationCacheDirectory(const char *directory);
+
+//
+// Drops all results held in memory by the translation cache. Files in the
+// cache directory are kept.
+//
+COMPILER_EXPORT void ShClearTranslationCache();
+
 // Return the version of the shader language.
 COMPILER_EXPORT int ShGetShaderVersion(const ShHandle handle);
 
@@ -346,6 +721,39 @@ COMPILER_EXPORT const std::string &ShGetInfoLog(const ShHandle handle);
 // handle: Specifies the compiler
 COMPILER_EXPORT const std::string &ShGetObjectCode(const ShHandle handle);
 
+// Returns the serialized AST of the last compilation with SH_SERIALIZE_AST,
+// which is empty if the shader failed to validate or its AST is nested too
+// deeply to be read back. It is binary data that
+// can be stored and passed to ShCompileSerializedAST, in any process using
+// the same version of the compiler.
+// Parameters:
+// handle: Specifies the compiler
+COMPILER_EXPORT const std::string &ShGetSerializedAST(const ShHandle handle);
+
+// Returns the length of the object code for a compiled shader, excluding the
+// null terminator.
+// Parameters:
+// handle: Specifies the compiler
+COMPILER_EXPORT size_t ShGetObjectCodeLength(const ShHandle handle);
+
+//
+// Receives one piece of the object code from ShGetObjectCodeChunks.
+// chunk is not null-terminated and is only valid during the call.
+//
+typedef void (*ShObjectCodeCallback)(const char *chunk, size_t length, void *userData);
+
+// Passes the object code for a compiled shader to callback in order, one
+// chunk at a time. Unlike ShGetObjectCode, this does not concatenate the
+// chunks the translator writes into, so large shaders are not copied into
+// one contiguous buffer.
+// Parameters:
+// handle: Specifies the compiler
+// callback: Called once for each chunk of object code.
+// userData: Passed unchanged to callback.
+COMPILER_EXPORT void ShGetObjectCodeChunks(const ShHandle handle,
+                                           ShObjectCodeCallback callback,
+                                           void *userData);
+
 // Returns a (original_name, hash) map containing all the user defined
 // names in the shader, including variable names, function names, struct
 // names, and struct field names.
@@ -385,6 +793,57 @@ COMPILER_EXPORT bool ShCheckVariablesWithinPackingLimits(
     ShVariableInfo *varInfoArray,
     size_t varInfoArraySize);
 
+// The place of a variable in rows of four components, as packed by the
+// rules of the GLSL 1.017 spec, Appendix A, section 7. Each row holds a
+// vector, or a column of a matrix.
+typedef struct
+{
+    // The first row of the variable.
+    int row;
+    // The first component of the variable in each of its rows, from 0 to 3.
+    int column;
+    // The number of rows of the variable, for all of its array elements.
+    int rows;
+} ShVariablePlacement;
+
+// Packs the passed in variables like ShCheckVariablesWithinPackingLimits,
+// and writes the placement of each variable to placementArray if they fit.
+// Parameters:
+// maxVectors: the available rows of registers.
+// varInfoArray: an array of variable info (types and sizes).
+// varInfoArraySize: the size of the variable array.
+// placementArray: an array of varInfoArraySize placements.
+COMPILER_EXPORT bool ShPackVariables(
+    int maxVectors,
+    ShVariableInfo *varInfoArray,
+    size_t varInfoArraySize,
+    ShVariablePlacement *placementArray);
+
+// Gives the name and the size, in vec4s, of the array that holds the
+// uniforms packed by the last compilation with SH_PACK_UNIFORMS.
+// Returns false if no uniforms were packed.
+// Parameters:
+// handle: Specifies the compiler
+// nameOut: output variable that stores the name of the array
+// mappedNameOut: output variable that stores the name of the array in the
+//                object code, which differs from nameOut if names are hashed
+// sizeOut: output variable that stores the size of the array
+COMPILER_EXPORT bool ShGetPackedUniformArray(const ShHandle handle,
+                                             std::string *nameOut,
+                                             std::string *mappedNameOut,
+                                             int *sizeOut);
+
+// Gives the placement of a uniform in the array returned by
+// ShGetPackedUniformArray.
+// Returns true if the uniform was packed, false otherwise.
+// Parameters:
+// handle: Specifies the compiler
+// uniformName: Specifies the uniform, by its name in ShGetUniforms
+// placementOut: output variable that stores the placement
+COMPILER_EXPORT bool ShGetPackedUniformPlacement(const ShHandle handle,
+                                                 const std::string &uniformName,
+                                                 ShVariablePlacement *placementOut);
+
 // Gives the compiler-assigned register for an interface block.
 // The method writes the value to the output variable "indexOut".
 // Returns true if it found a valid interface block, false otherwise.
@@ -29,6 +29,7 @@ static sh::GLenum FindShaderType(const char* fileName);
 static bool CompileFile(char* fileName, ShHandle compiler, int compileOptions);
 static void LogMsg(const char* msg, const char* name, const int num, const char* logName);
 static void PrintActiveVariables(ShHandle compiler, ShShaderInfo varType);
+static void PrintCompileStatistics(ShHandle compiler);
 
 // If NUM_SOURCE_STRINGS is set to a value > 1, the input file data is
 // broken into that many chunks.
@@ -87,6 +88,10 @@ int main(int argc, char* argv[])
             case 'e': compileOptions |= SH_EMULATE_BUILT_IN_FUNCTIONS; break;
             case 'd': compileOptions |= SH_DEPENDENCY_GRAPH; break;
             case 't': compileOptions |= SH_TIMING_RESTRICTIONS; break;
+            case 'p': compileOptions |= SH_PRUNE_DEAD_CODE; break;
+            case 'c': compileOptions |= SH_COMPILE_STATISTICS; break;
+            case 'r': compileOptions |= SH_UNROLL_LOOPS_BY_COST; break;
+            case 'z': compileOptions |= SH_ELIMINATE_COMMON_SUBEXPRESSIONS; break;
             case 's':
                 if (argv[0][2] == '=') {
                     switch (argv[0][3]) {
@@ -183,6 +188,12 @@ int main(int argc, char* argv[])
                   LogMsg("END", "COMPILER", numCompiles, "ACTIVE UNIFORMS");
                   printf("\n\n");
               }
+              if (compileOptions & SH_COMPILE_STATISTICS) {
+                  LogMsg("BEGIN", "COMPILER", numCompiles, "STATISTICS");
+                  PrintCompileStatistics(compiler);
+                  LogMsg("END", "COMPILER", numCompiles, "STATISTICS");
+                  printf("\n\n");
+              }
               if (!compiled)
                   failCode = EFailCompile;
               ++numCompiles;
@@ -213,7 +224,7 @@ int main(int argc, char* argv[])
 //
 void usage()
 {
-    printf("Usage: translate [-i -m -o -u -l -e -b=e -b=g -b=h -x=i -x=d] file1 file2 ...\n"
+    printf("Usage: translate [-i -m -o -u -l -e -p -c -r -z -b=e -b=g -b=h -x=i -x=d] file1 file2 ...\n"
         "Where: filename : filename ending in .frag or .vert\n"
         "       -i       : print intermediate tree\n"
         "       -m       : map long variable names\n"
@@ -223,6 +234,10 @@ void usage()
         "       -e       : emulate certain built-in functions (workaround for driver bugs)\n"
         "       -t       : enforce experimental timing restrictions\n"
         "       -d       : print dependency graph used to enforce timing restrictions\n"
+        "       -p       : fold constants and remove dead code\n"
+        "       -c       : print the time taken by each compile phase\n"
+        "       -r       : mark HLSL loops with [unroll] or [loop] by their estimated cost\n"
+        "       -z       : compute repeated and loop-invariant expressions once\n"
         "       -s=e     : use GLES2 spec (this is by default)\n"
         "       -s=w     : use WebGL spec\n"
         "       -s=c     : use CSS Shaders spec\n"
@@ -386,3 +401,19 @@ static void FreeShaderSource(ShaderSource& source) {
     source.clear();
 }
 
+void PrintCompileStatistics(ShHandle compiler)
+{
+    ShCompileStatistics stats;
+    if (!ShGetCompileStatistics(compiler, &stats))
+        return;
+
+    for (int phase = 0; phase < SH_COMPILE_PHASE_COUNT; ++phase) {
+        printf("%-28s %10.3f ms\n", ShGetCompilePhaseName(static_cast<ShCompilePhase>(phase)),
+               stats.phaseTimes[phase]);
+    }
+    printf("%-28s %10.3f ms\n", "total", stats.totalTime);
+    printf("%-28s %10u\n", "AST nodes", static_cast<unsigned int>(stats.astNodeCount));
+    printf("%-28s %10u\n", "symbols", static_cast<unsigned int>(stats.symbolCount));
+    printf("%-28s %10u\n", "pool allocations", static_cast<unsigned int>(stats.poolAllocationCount));
+    printf("%-28s %10u\n", "pool bytes", static_cast<unsigned int>(stats.poolAllocatedBytes));
+}
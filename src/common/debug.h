@@ -78,7 +78,7 @@ namespace gl
 #define ASSERT(expression) do { \
     if(!(expression)) \
         ERR("\t! Assert failed in %s(%d): "#expression"\n", __FUNCTION__, __LINE__); \
-        assert(expression); \
+    assert(expression); \
     } while(0)
 #define UNUSED_ASSERTION_VARIABLE(variable)
 #else
@@ -109,7 +109,7 @@ inline unsigned int unorm(float x)
 
 inline bool supportsSSE2()
 {
-#if ANGLE_PLATFORM_WINDOWS && !defined(_M_ARM)
+#if defined(ANGLE_PLATFORM_WINDOWS) && !defined(_M_ARM)
     static bool checked = false;
     static bool supports = false;
 
@@ -146,6 +146,13 @@ destType bitCast(const sourceType &source)
     return output;
 }
 
+// Rotates the bits of |value| left by |shift|, which must be in [1, 31].
+// Compilers turn this into a single rotate instruction.
+inline unsigned int rotl(unsigned int value, unsigned int shift)
+{
+    return (value << shift) | (value >> (32 - shift));
+}
+
 inline unsigned short float32ToFloat16(float fp32)
 {
     unsigned int fp32i = (unsigned int&)fp32;
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// mutex.cpp: Simple cross-platform interface for mutual exclusion and
+// condition variables.
+
+#include "common/mutex.h"
+
+#include <assert.h>
+
+Mutex::Mutex()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+#   if defined(ANGLE_ENABLE_WINDOWS_STORE)
+    InitializeCriticalSectionEx(&mCriticalSection, 0, 0);
+#   else
+    InitializeCriticalSection(&mCriticalSection);
+#   endif
+#elif defined(ANGLE_PLATFORM_POSIX)
+    int result = pthread_mutex_init(&mMutex, NULL);
+    assert(result == 0);
+    (void)result;
+#endif
+}
+
+Mutex::~Mutex()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    DeleteCriticalSection(&mCriticalSection);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_mutex_destroy(&mMutex);
+#endif
+}
+
+void Mutex::lock()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    EnterCriticalSection(&mCriticalSection);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_mutex_lock(&mMutex);
+#endif
+}
+
+bool Mutex::tryLock()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    return TryEnterCriticalSection(&mCriticalSection) != FALSE;
+#elif defined(ANGLE_PLATFORM_POSIX)
+    return pthread_mutex_trylock(&mMutex) == 0;
+#endif
+}
+
+void Mutex::unlock()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    LeaveCriticalSection(&mCriticalSection);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_mutex_unlock(&mMutex);
+#endif
+}
+
+ConditionVariable::ConditionVariable()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    InitializeConditionVariable(&mConditionVariable);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    int result = pthread_cond_init(&mConditionVariable, NULL);
+    assert(result == 0);
+    (void)result;
+#endif
+}
+
+ConditionVariable::~ConditionVariable()
+{
+#if defined(ANGLE_PLATFORM_POSIX)
+    pthread_cond_destroy(&mConditionVariable);
+#endif
+}
+
+void ConditionVariable::wait(Mutex *mutex)
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    SleepConditionVariableCS(&mConditionVariable, &mutex->mCriticalSection, INFINITE);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_cond_wait(&mConditionVariable, &mutex->mMutex);
+#endif
+}
+
+void ConditionVariable::signal()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    WakeConditionVariable(&mConditionVariable);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_cond_signal(&mConditionVariable);
+#endif
+}
+
+void ConditionVariable::broadcast()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    WakeAllConditionVariable(&mConditionVariable);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_cond_broadcast(&mConditionVariable);
+#endif
+}
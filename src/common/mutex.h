@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// mutex.h: Simple cross-platform interface for mutual exclusion and
+// condition variables.
+
+#ifndef COMMON_MUTEX_H_
+#define COMMON_MUTEX_H_
+
+#include "common/angleutils.h"
+#include "common/platform.h"
+
+#if defined(ANGLE_PLATFORM_POSIX)
+#   include <pthread.h>
+#endif
+
+class Mutex
+{
+  public:
+    Mutex();
+    ~Mutex();
+
+    void lock();
+    // Takes the mutex if no other thread holds it, without waiting.
+    bool tryLock();
+    void unlock();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(Mutex);
+    friend class ConditionVariable;
+
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    CRITICAL_SECTION mCriticalSection;
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_mutex_t mMutex;
+#else
+#   error Unsupported platform.
+#endif
+};
+
+// Holds a Mutex for the lifetime of the enclosing scope.
+class ScopedLock
+{
+  public:
+    explicit ScopedLock(Mutex *mutex)
+        : mMutex(mutex)
+    {
+        mMutex->lock();
+    }
+    ~ScopedLock()
+    {
+        mMutex->unlock();
+    }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(ScopedLock);
+
+    Mutex *mMutex;
+};
+
+class ConditionVariable
+{
+  public:
+    ConditionVariable();
+    ~ConditionVariable();
+
+    // Atomically releases |mutex|, which must be held by the caller, and
+    // waits until the variable is signalled. |mutex| is held again when
+    // this returns. Spurious wakeups are possible.
+    void wait(Mutex *mutex);
+    void signal();
+    void broadcast();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(ConditionVariable);
+
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    CONDITION_VARIABLE mConditionVariable;
+#elif defined(ANGLE_PLATFORM_POSIX)
+    pthread_cond_t mConditionVariable;
+#endif
+};
+
+#endif // COMMON_MUTEX_H_
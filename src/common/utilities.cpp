@@ -19,6 +19,10 @@
 #  include <windows.graphics.display.h>
 #endif
 
+#if defined(ANGLE_PLATFORM_POSIX)
+#  include <time.h>
+#endif
+
 namespace gl
 {
 
@@ -510,8 +514,13 @@ void PlatformSleep(unsigned long dwMilliseconds)
 
     // Emulate sleep by waiting with timeout on an event that is never signalled.
     WaitForSingleObjectEx(sleepEvent, dwMilliseconds, false);
-#else
+#elif defined(ANGLE_PLATFORM_WINDOWS)
     Sleep(dwMilliseconds);
+#else
+    timespec sleepTime;
+    sleepTime.tv_sec = dwMilliseconds / 1000;
+    sleepTime.tv_nsec = (dwMilliseconds % 1000) * 1000000;
+    nanosleep(&sleepTime, NULL);
 #endif
 }
 
@@ -51,6 +51,6 @@ std::string getTempPath();
 void writeFile(const char* path, const void* data, size_t size);
 #endif
 
-void PlatformSleep(_In_ unsigned long dwMilliseconds);
+void PlatformSleep(unsigned long dwMilliseconds);
 
 #endif  // LIBGLESV2_UTILITIES_H
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// workerpool.cpp: Simple cross-platform pool of worker threads that run
+// batches of independent tasks.
+
+#include "common/workerpool.h"
+
+#include <assert.h>
+
+#if defined(ANGLE_PLATFORM_POSIX)
+#   include <unistd.h>
+#endif
+
+WorkerPool::WorkerPool(size_t threadCount)
+    : mTasks(NULL),
+      mTaskCount(0),
+      mNextTask(0),
+      mPendingTasks(0),
+      mExiting(false)
+{
+#if defined(ANGLE_ENABLE_WINDOWS_STORE)
+    // Win32 threads are not available to Windows Store applications; all
+    // tasks run on the calling thread.
+    (void)threadCount;
+#else
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        ThreadHandle thread;
+#if defined(ANGLE_PLATFORM_WINDOWS)
+        thread = CreateThread(NULL, 0, ThreadMain, this, 0, NULL);
+        if (thread == NULL)
+        {
+            break;
+        }
+#elif defined(ANGLE_PLATFORM_POSIX)
+        if (pthread_create(&thread, NULL, ThreadMain, this) != 0)
+        {
+            break;
+        }
+#endif
+        mThreads.push_back(thread);
+    }
+#endif
+}
+
+WorkerPool::~WorkerPool()
+{
+    mMutex.lock();
+    mExiting = true;
+    mWorkAvailable.broadcast();
+    mMutex.unlock();
+
+    for (size_t i = 0; i < mThreads.size(); ++i)
+    {
+#if defined(ANGLE_PLATFORM_WINDOWS) && !defined(ANGLE_ENABLE_WINDOWS_STORE)
+        WaitForSingleObject(mThreads[i], INFINITE);
+        CloseHandle(mThreads[i]);
+#elif defined(ANGLE_PLATFORM_POSIX)
+        pthread_join(mThreads[i], NULL);
+#endif
+    }
+}
+
+void WorkerPool::runTasks(WorkerTask *const *tasks, size_t taskCount)
+{
+    ScopedLock runLock(&mRunMutex);
+    ScopedLock lock(&mMutex);
+
+    mTasks = tasks;
+    mTaskCount = taskCount;
+    mNextTask = 0;
+    mPendingTasks = taskCount;
+    if (taskCount > 1)
+    {
+        mWorkAvailable.broadcast();
+    }
+
+    runAvailableTasksLocked();
+
+    while (mPendingTasks > 0)
+    {
+        mWorkDone.wait(&mMutex);
+    }
+
+    mTasks = NULL;
+    mTaskCount = 0;
+    mNextTask = 0;
+}
+
+size_t WorkerPool::GetProcessorCount()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    SYSTEM_INFO info;
+    GetNativeSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#elif defined(ANGLE_PLATFORM_POSIX)
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<size_t>(count) : 1;
+#endif
+}
+
+#if defined(ANGLE_PLATFORM_WINDOWS)
+DWORD WINAPI WorkerPool::ThreadMain(LPVOID param)
+{
+    static_cast<WorkerPool*>(param)->workerLoop();
+    return 0;
+}
+#elif defined(ANGLE_PLATFORM_POSIX)
+void *WorkerPool::ThreadMain(void *param)
+{
+    static_cast<WorkerPool*>(param)->workerLoop();
+    return NULL;
+}
+#endif
+
+void WorkerPool::workerLoop()
+{
+    ScopedLock lock(&mMutex);
+
+    while (true)
+    {
+        while (!mExiting && mNextTask >= mTaskCount)
+        {
+            mWorkAvailable.wait(&mMutex);
+        }
+
+        if (mExiting)
+        {
+            break;
+        }
+
+        runAvailableTasksLocked();
+    }
+}
+
+void WorkerPool::runAvailableTasksLocked()
+{
+    while (mNextTask < mTaskCount)
+    {
+        WorkerTask *task = mTasks[mNextTask++];
+
+        mMutex.unlock();
+        task->run();
+        mMutex.lock();
+
+        assert(mPendingTasks > 0);
+        if (--mPendingTasks == 0)
+        {
+            mWorkDone.broadcast();
+        }
+    }
+}
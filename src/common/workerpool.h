@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// workerpool.h: Simple cross-platform pool of worker threads that run
+// batches of independent tasks.
+
+#ifndef COMMON_WORKERPOOL_H_
+#define COMMON_WORKERPOOL_H_
+
+#include "common/mutex.h"
+
+#include <stddef.h>
+#include <vector>
+
+class WorkerTask
+{
+  public:
+    virtual ~WorkerTask() {}
+    virtual void run() = 0;
+};
+
+class WorkerPool
+{
+  public:
+    // Starts |threadCount| worker threads. The thread calling runTasks()
+    // also runs tasks, so a pool with no threads runs everything serially.
+    explicit WorkerPool(size_t threadCount);
+    // Stops and joins all worker threads.
+    ~WorkerPool();
+
+    size_t getThreadCount() const { return mThreads.size(); }
+
+    // Runs every task in |tasks| and returns once all of them have
+    // completed. Tasks may run concurrently and in any order. Concurrent
+    // callers are serialized.
+    void runTasks(WorkerTask *const *tasks, size_t taskCount);
+
+    static size_t GetProcessorCount();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(WorkerPool);
+
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    typedef HANDLE ThreadHandle;
+    static DWORD WINAPI ThreadMain(LPVOID param);
+#elif defined(ANGLE_PLATFORM_POSIX)
+    typedef pthread_t ThreadHandle;
+    static void *ThreadMain(void *param);
+#endif
+
+    void workerLoop();
+    // Runs tasks until none are left to start. Called with mMutex held.
+    void runAvailableTasksLocked();
+
+    std::vector<ThreadHandle> mThreads;
+
+    Mutex mRunMutex;
+    Mutex mMutex;
+    ConditionVariable mWorkAvailable;
+    ConditionVariable mWorkDone;
+
+    WorkerTask *const *mTasks;
+    size_t mTaskCount;
+    size_t mNextTask;
+    size_t mPendingTasks;
+    bool mExiting;
+};
+
+#endif // COMMON_WORKERPOOL_H_
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "CharacterScan.h"
+
+// SSE2 is part of every x64 target. On 32-bit x86 it is only used when the
+// compiler may assume it, and other targets use the scalar loop.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PP_USE_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace pp
+{
+
+namespace
+{
+
+bool IsOneOf(char c, const char *set, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (c == set[i])
+            return true;
+    }
+    return false;
+}
+
+#if defined(PP_USE_SSE2)
+int LowestSetBit(int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, static_cast<unsigned long>(mask));
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(static_cast<unsigned int>(mask));
+#endif
+}
+#endif
+
+// Returns the first character in [begin, end) that is one of the |count|
+// characters of |set| if |matching| is true, or that is none of them if
+// |matching| is false. |set| holds at most five characters.
+inline const char *Find(const char *begin, const char *end,
+                        const char *set, int count, bool matching)
+{
+    const char *current = begin;
+
+#if defined(PP_USE_SSE2)
+    __m128i sets[5];
+    for (int i = 0; i < count; ++i)
+        sets[i] = _mm_set1_epi8(set[i]);
+
+    for (; end - current >= 16; current += 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+        __m128i found = _mm_cmpeq_epi8(chunk, sets[0]);
+        for (int i = 1; i < count; ++i)
+            found = _mm_or_si128(found, _mm_cmpeq_epi8(chunk, sets[i]));
+
+        int mask = _mm_movemask_epi8(found);
+        if (!matching)
+            mask ^= 0xFFFF;
+        if (mask != 0)
+            return current + LowestSetBit(mask);
+    }
+#endif
+
+    for (; current != end; ++current)
+    {
+        if (IsOneOf(*current, set, count) == matching)
+            return current;
+    }
+    return end;
+}
+
+}  // namespace anonymous
+
+const char *FindLineBreak(const char *begin, const char *end)
+{
+    static const char kSet[] = { '\r', '\n' };
+    return Find(begin, end, kSet, 2, true);
+}
+
+const char *FindCommentBreak(const char *begin, const char *end)
+{
+    static const char kSet[] = { '*', '\r', '\n' };
+    return Find(begin, end, kSet, 3, true);
+}
+
+const char *FindCommentOrBlank(const char *begin, const char *end)
+{
+    static const char kSet[] = { '/', ' ', '\t', '\v', '\f' };
+    return Find(begin, end, kSet, 5, true);
+}
+
+const char *SkipBlanks(const char *begin, const char *end)
+{
+    static const char kSet[] = { ' ', '\t', '\v', '\f' };
+    return Find(begin, end, kSet, 4, false);
+}
+
+}  // namespace pp
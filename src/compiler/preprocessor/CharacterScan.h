@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// CharacterScan.h: Searches for the characters that end comment and
+// whitespace runs, sixteen characters at a time where SSE2 is available.
+
+#ifndef COMPILER_PREPROCESSOR_CHARACTERSCAN_H_
+#define COMPILER_PREPROCESSOR_CHARACTERSCAN_H_
+
+namespace pp
+{
+
+// Each function returns a pointer to the first character in [begin, end)
+// it looks for, or end if there is none.
+
+// Finds '\r' or '\n'.
+const char *FindLineBreak(const char *begin, const char *end);
+
+// Finds '*', '\r' or '\n'.
+const char *FindCommentBreak(const char *begin, const char *end);
+
+// Finds '/', ' ', '\t', '\v' or '\f'.
+const char *FindCommentOrBlank(const char *begin, const char *end);
+
+// Finds the first character that is not ' ', '\t', '\v' or '\f'.
+const char *SkipBlanks(const char *begin, const char *end);
+
+}  // namespace pp
+#endif  // COMPILER_PREPROCESSOR_CHARACTERSCAN_H_
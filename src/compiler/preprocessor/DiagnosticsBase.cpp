@@ -78,6 +78,8 @@ std::string Diagnostics::message(ID id)
         return "Not enough arguments for macro";
       case PP_MACRO_TOO_MANY_ARGS:
         return "Too many arguments for macro";
+      case PP_MACRO_EXPANSION_TOO_LARGE:
+        return "macro expansion exceeds the memory budget";
       case PP_CONDITIONAL_ENDIF_WITHOUT_IF:
         return "unexpected #endif found without a matching #if";
       case PP_CONDITIONAL_ELSE_WITHOUT_IF:
@@ -109,6 +111,8 @@ std::string Diagnostics::message(ID id)
         return "invalid file number";
       case PP_INVALID_LINE_DIRECTIVE:
         return "invalid line directive";
+      case PP_PROLOGUE_UNEXPECTED_TOKEN:
+        return "only preprocessor directives are allowed in a prologue";
       // Errors end.
       // Warnings begin.
       case PP_EOF_IN_DIRECTIVE:
@@ -46,6 +46,7 @@ class Diagnostics
         PP_MACRO_UNTERMINATED_INVOCATION,
         PP_MACRO_TOO_FEW_ARGS,
         PP_MACRO_TOO_MANY_ARGS,
+        PP_MACRO_EXPANSION_TOO_LARGE,
         PP_CONDITIONAL_ENDIF_WITHOUT_IF,
         PP_CONDITIONAL_ELSE_WITHOUT_IF,
         PP_CONDITIONAL_ELSE_AFTER_ELSE,
@@ -61,6 +62,7 @@ class Diagnostics
         PP_INVALID_LINE_NUMBER,
         PP_INVALID_FILE_NUMBER,
         PP_INVALID_LINE_DIRECTIVE,
+        PP_PROLOGUE_UNEXPECTED_TOKEN,
         PP_ERROR_END,
 
         PP_WARNING_BEGIN,
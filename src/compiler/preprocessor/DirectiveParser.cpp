@@ -6,6 +6,7 @@
 
 #include "DirectiveParser.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <sstream>
@@ -243,7 +244,10 @@ void DirectiveParser::lex(Token *token)
     }
     while (skipping() || (token->type == '\n'));
 
-    mPastFirstStatement = true;
+    // Reaching the end of the input is not a statement, so that the state
+    // after a prologue of directives is the same as if the shader followed.
+    if (token->type != Token::LAST)
+        mPastFirstStatement = true;
 }
 
 void DirectiveParser::parseDirective(Token *token)
@@ -389,6 +393,23 @@ void DirectiveParser::parseDefine(Token *token)
         macro.replacements.push_back(*token);
         mTokenizer->lex(token);
     }
+    if (macro.type == Macro::kTypeFunc)
+    {
+        macro.parameterIndices.reserve(macro.replacements.size());
+        for (std::size_t i = 0; i < macro.replacements.size(); ++i)
+        {
+            const Token &repl = macro.replacements[i];
+            int index = -1;
+            if (repl.type == Token::IDENTIFIER)
+            {
+                Macro::Parameters::const_iterator param = std::find(
+                    macro.parameters.begin(), macro.parameters.end(), repl.text);
+                if (param != macro.parameters.end())
+                    index = static_cast<int>(param - macro.parameters.begin());
+            }
+            macro.parameterIndices.push_back(index);
+        }
+    }
     if (!macro.replacements.empty())
     {
         // Whitespace preceding the replacement list is not considered part of
@@ -29,6 +29,14 @@ class DirectiveParser : public Lexer
 
     virtual void lex(Token *token);
 
+    // Whether a #version directive would come too late. Saved and
+    // restored with the preprocessor state of a prologue.
+    bool isPastFirstStatement() const { return mPastFirstStatement; }
+    void setPastFirstStatement(bool pastFirstStatement)
+    {
+        mPastFirstStatement = pastFirstStatement;
+    }
+
   private:
     PP_DISALLOW_COPY_AND_ASSIGN(DirectiveParser);
 
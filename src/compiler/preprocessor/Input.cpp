@@ -6,6 +6,8 @@
 
 #include "Input.h"
 
+#include "CharacterScan.h"
+
 #include <algorithm>
 #include <cassert>
 #include <cstring>
@@ -13,13 +15,16 @@
 namespace pp
 {
 
-Input::Input() : mCount(0), mString(0)
+Input::Input() : mCount(0), mString(0), mScanState(SCAN_CODE), mKeepNextChar(false)
 {
 }
 
 Input::Input(size_t count, const char *const string[], const int length[]) :
     mCount(count),
-    mString(string)
+    mString(string),
+    mCompactLength(count, 0),
+    mScanState(SCAN_CODE),
+    mKeepNextChar(false)
 {
     mLength.reserve(mCount);
     for (size_t i = 0; i < mCount; ++i)
@@ -50,5 +55,125 @@ size_t Input::read(char *buf, size_t maxSize)
     return nRead;
 }
 
+size_t Input::readCompact(char *buf, size_t maxSize)
+{
+    size_t nRead = 0;
+    while ((nRead < maxSize) && (mReadLoc.sIndex < mCount))
+    {
+        const char *string = mString[mReadLoc.sIndex];
+        const char *begin = string + mReadLoc.cIndex;
+        const char *end = string + mLength[mReadLoc.sIndex];
+        if (begin == end)
+        {
+            ++mReadLoc.sIndex;
+            mReadLoc.cIndex = 0;
+            continue;
+        }
+
+        // Each step keeps the characters in [keep, keep + keepSize) and
+        // continues at |next|.
+        const char *keep = begin;
+        size_t keepSize = 0;
+        const char *next = begin;
+        switch (mScanState)
+        {
+          case SCAN_CODE:
+            {
+                const char *limit = begin + std::min<size_t>(end - begin, maxSize - nRead);
+                next = FindCommentOrBlank(begin, limit);
+                keepSize = next - begin;
+                if (next != limit)
+                {
+                    // Keep the '/' or the first blank too.
+                    char following = peekAfter(mReadLoc.sIndex, next);
+                    char c = *next++;
+                    ++keepSize;
+                    if (c != '/')
+                        mScanState = SCAN_BLANKS;
+                    else if (following == '/')
+                        mScanState = SCAN_LINE_COMMENT_OPEN;
+                    else if (following == '*')
+                        mScanState = SCAN_BLOCK_COMMENT_OPEN;
+                }
+            }
+            break;
+          case SCAN_BLANKS:
+            next = SkipBlanks(begin, end);
+            if (next != end)
+                mScanState = SCAN_CODE;
+            break;
+          case SCAN_LINE_COMMENT_OPEN:
+            keepSize = 1;
+            next = begin + 1;
+            mScanState = SCAN_LINE_COMMENT;
+            break;
+          case SCAN_LINE_COMMENT:
+            // The line break is not part of the comment.
+            next = FindLineBreak(begin, end);
+            if (next != end)
+                mScanState = SCAN_CODE;
+            break;
+          case SCAN_BLOCK_COMMENT_OPEN:
+            keepSize = 1;
+            next = begin + 1;
+            mScanState = SCAN_BLOCK_COMMENT;
+            break;
+          case SCAN_BLOCK_COMMENT:
+            keep = mKeepNextChar ? begin : FindCommentBreak(begin, end);
+            next = keep;
+            if (keep != end)
+            {
+                char c = *next++;
+                char following = peekAfter(mReadLoc.sIndex, keep);
+                if (c == '*' && following == '/')
+                {
+                    keepSize = 1;
+                    mScanState = SCAN_BLOCK_COMMENT_CLOSE;
+                }
+                else if (c == '\r' || c == '\n' || mKeepNextChar)
+                {
+                    keepSize = 1;
+                }
+                mKeepNextChar = (c == '\r' && following != '\n');
+            }
+            break;
+          case SCAN_BLOCK_COMMENT_CLOSE:
+            keepSize = 1;
+            next = begin + 1;
+            mScanState = SCAN_CODE;
+            break;
+          default:
+            assert(false);
+            break;
+        }
+
+        std::memcpy(buf + nRead, keep, keepSize);
+        nRead += keepSize;
+        mCompactLength[mReadLoc.sIndex] += keepSize;
+        mReadLoc.cIndex = next - string;
+
+        // Advance string if we reached the end of current string.
+        if (mReadLoc.cIndex == mLength[mReadLoc.sIndex])
+        {
+            ++mReadLoc.sIndex;
+            mReadLoc.cIndex = 0;
+        }
+    }
+    return nRead;
+}
+
+char Input::peekAfter(size_t sIndex, const char *c) const
+{
+    if (c + 1 != mString[sIndex] + mLength[sIndex])
+        return c[1];
+
+    for (++sIndex; sIndex < mCount; ++sIndex)
+    {
+        if (mLength[sIndex] > 0)
+            return mString[sIndex][0];
+    }
+    return 0;
+}
+
 }  // namespace pp
 
@@ -35,6 +35,18 @@ class Input
 
     size_t read(char *buf, size_t maxSize);
 
+    // Reads like read(), but leaves out the characters that do not change
+    // how the input is tokenized: the bodies of comments, except for their
+    // line breaks, and all but the first character of whitespace runs.
+    // The two cannot be mixed on one Input.
+    size_t readCompact(char *buf, size_t maxSize);
+    // The number of characters of string |index| returned by readCompact()
+    // so far.
+    size_t compactLength(size_t index) const
+    {
+        return mCompactLength[index];
+    }
+
     struct Location
     {
         size_t sIndex;  // String index;
@@ -49,12 +61,34 @@ class Input
     const Location &readLoc() const { return mReadLoc; }
 
   private:
+    enum ScanState
+    {
+        SCAN_CODE,
+        SCAN_BLANKS,
+        SCAN_LINE_COMMENT_OPEN,
+        SCAN_LINE_COMMENT,
+        SCAN_BLOCK_COMMENT_OPEN,
+        SCAN_BLOCK_COMMENT,
+        SCAN_BLOCK_COMMENT_CLOSE
+    };
+
+    // Returns the character that follows |c| in string |sIndex|, or in the
+    // strings after it, or 0 at the end of the input.
+    char peekAfter(size_t sIndex, const char *c) const;
+
     // Input.
     size_t mCount;
     const char * const *mString;
     std::vector<size_t> mLength;
 
     Location mReadLoc;
+
+    // State of readCompact().
+    std::vector<size_t> mCompactLength;
+    ScanState mScanState;
+    // Set after a '\r' in a block comment that is not followed by '\n'. The
+    // next character is kept so that the two do not become one line break.
+    bool mKeepNextChar;
 };
 
 }  // namespace pp
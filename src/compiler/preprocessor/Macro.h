@@ -25,6 +25,7 @@ struct Macro
     };
     typedef std::vector<std::string> Parameters;
     typedef std::vector<Token> Replacements;
+    typedef std::vector<int> ParameterIndices;
 
     Macro()
         : predefined(false),
@@ -41,6 +42,11 @@ struct Macro
     std::string name;
     Parameters parameters;
     Replacements replacements;
+    // For function-like macros, the index of the parameter referenced by
+    // each replacement token, or -1 if the token is not a parameter.
+    // Computed once when the macro is defined so that expansion does not
+    // need to search the parameter list.
+    ParameterIndices parameterIndices;
 };
 
 typedef std::map<std::string, Macro> MacroSet;
@@ -6,7 +6,6 @@
 
 #include "MacroExpander.h"
 
-#include <algorithm>
 #include <sstream>
 
 #include "DiagnosticsBase.h"
@@ -15,6 +14,17 @@
 namespace pp
 {
 
+namespace
+{
+
+// The memory a token takes in a buffer of tokens.
+std::size_t TokenBytes(const Token &token)
+{
+    return sizeof(Token) + token.text.size();
+}
+
+}  // namespace anonymous
+
 class TokenLexer : public Lexer
 {
  public:
@@ -51,22 +61,41 @@ MacroExpander::MacroExpander(Lexer *lexer,
                              Diagnostics *diagnostics)
     : mLexer(lexer),
       mMacroSet(macroSet),
-      mDiagnostics(diagnostics)
+      mDiagnostics(diagnostics),
+      mHasReserveToken(false),
+      mBudget(&mOwnBudget)
 {
+    mOwnBudget.maxBytes = 0;
+    mOwnBudget.usedBytes = 0;
+    mOwnBudget.exceeded = false;
 }
 
 MacroExpander::~MacroExpander()
 {
     for (std::size_t i = 0; i < mContextStack.size(); ++i)
     {
+        releaseBytes(mContextStack[i]->expansionBytes);
         delete mContextStack[i];
     }
 }
 
+void MacroExpander::setMemoryBudget(std::size_t maxBytes)
+{
+    mBudget->maxBytes = maxBytes;
+    mBudget->exceeded = false;
+}
+
 void MacroExpander::lex(Token *token)
 {
     while (true)
     {
+        if (mBudget->exceeded)
+        {
+            token->reset();
+            token->type = Token::LAST;
+            break;
+        }
+
         getToken(token);
 
         if (token->type != Token::IDENTIFIER)
@@ -99,10 +128,10 @@ void MacroExpander::lex(Token *token)
 
 void MacroExpander::getToken(Token *token)
 {
-    if (mReserveToken.get())
+    if (mHasReserveToken)
     {
-        *token = *mReserveToken;
-        mReserveToken.reset();
+        *token = mReserveToken;
+        mHasReserveToken = false;
         return;
     }
 
@@ -114,7 +143,7 @@ void MacroExpander::getToken(Token *token)
 
     if (!mContextStack.empty())
     {
-        *token = mContextStack.back()->get();
+        mContextStack.back()->get(token);
     }
     else
     {
@@ -128,12 +157,13 @@ void MacroExpander::ungetToken(const Token &token)
     {
         MacroContext *context = mContextStack.back();
         context->unget();
-        assert(context->replacements[context->index] == token);
+        assert((*context->replacements)[context->index].type == token.type);
     }
     else
     {
-        assert(!mReserveToken.get());
-        mReserveToken.reset(new Token(token));
+        assert(!mHasReserveToken);
+        mReserveToken = token;
+        mHasReserveToken = true;
     }
 }
 
@@ -155,16 +185,16 @@ bool MacroExpander::pushMacro(const Macro &macro, const Token &identifier)
     assert(identifier.type == Token::IDENTIFIER);
     assert(identifier.text == macro.name);
 
-    std::vector<Token> replacements;
-    if (!expandMacro(macro, identifier, &replacements))
+    MacroContext *context = new MacroContext;
+    if (!expandMacro(macro, identifier, context))
+    {
+        delete context;
         return false;
+    }
 
     // Macro is disabled for expansion until it is popped off the stack.
     macro.disabled = true;
 
-    MacroContext *context = new MacroContext;
-    context->macro = &macro;
-    context->replacements.swap(replacements);
     mContextStack.push_back(context);
     return true;
 }
@@ -179,38 +209,47 @@ void MacroExpander::popMacro()
     assert(context->empty());
     assert(context->macro->disabled);
     context->macro->disabled = false;
+    releaseBytes(context->expansionBytes);
     delete context;
 }
 
 bool MacroExpander::expandMacro(const Macro &macro,
                                 const Token &identifier,
-                                std::vector<Token> *replacements)
+                                MacroContext *context)
 {
-    replacements->clear();
+    context->macro = &macro;
+    context->location = identifier.location;
+    context->atStartOfLine = identifier.atStartOfLine();
+    context->hasLeadingSpace = identifier.hasLeadingSpace();
+
     if (macro.type == Macro::kTypeObj)
     {
-        replacements->assign(macro.replacements.begin(),
-                             macro.replacements.end());
+        if (!macro.predefined)
+        {
+            // The replacement list is used as is.
+            context->replacements = &macro.replacements;
+            return true;
+        }
+
+        const char kLine[] = "__LINE__";
+        const char kFile[] = "__FILE__";
 
-        if (macro.predefined)
+        context->expansion = macro.replacements;
+        context->replacements = &context->expansion;
+
+        assert(context->expansion.size() == 1);
+        Token& repl = context->expansion.front();
+        if (macro.name == kLine)
+        {
+            std::ostringstream stream;
+            stream << identifier.location.line;
+            repl.text = stream.str();
+        }
+        else if (macro.name == kFile)
         {
-            const char kLine[] = "__LINE__";
-            const char kFile[] = "__FILE__";
-
-            assert(replacements->size() == 1);
-            Token& repl = replacements->front();
-            if (macro.name == kLine)
-            {
-                std::ostringstream stream;
-                stream << identifier.location.line;
-                repl.text = stream.str();
-            }
-            else if (macro.name == kFile)
-            {
-                std::ostringstream stream;
-                stream << identifier.location.file;
-                repl.text = stream.str();
-            }
+            std::ostringstream stream;
+            stream << identifier.location.file;
+            repl.text = stream.str();
         }
     }
     else
@@ -218,30 +257,32 @@ bool MacroExpander::expandMacro(const Macro &macro,
         assert(macro.type == Macro::kTypeFunc);
         std::vector<MacroArg> args;
         args.reserve(macro.parameters.size());
-        if (!collectMacroArgs(macro, identifier, &args))
-            return false;
-
-        replaceMacroParams(macro, args, replacements);
-    }
-
-    for (std::size_t i = 0; i < replacements->size(); ++i)
-    {
-        Token& repl = replacements->at(i);
-        if (i == 0)
+        std::size_t argBytes = 0;
+        bool expanded = collectMacroArgs(macro, identifier, &args, &argBytes);
+        if (expanded)
         {
-            // The first token in the replacement list inherits the padding
-            // properties of the identifier token.
-            repl.setAtStartOfLine(identifier.atStartOfLine());
-            repl.setHasLeadingSpace(identifier.hasLeadingSpace());
+            replaceMacroParams(macro, args, &context->expansion);
+            context->replacements = &context->expansion;
+
+            std::size_t expansionBytes = 0;
+            for (std::size_t i = 0; i < context->expansion.size(); ++i)
+                expansionBytes += TokenBytes(context->expansion[i]);
+            expanded = reserveBytes(expansionBytes, identifier);
+            if (expanded)
+                context->expansionBytes = expansionBytes;
         }
-        repl.location = identifier.location;
+
+        // The arguments are freed on return.
+        releaseBytes(argBytes);
+        return expanded;
     }
     return true;
 }
 
 bool MacroExpander::collectMacroArgs(const Macro &macro,
                                      const Token &identifier,
-                                     std::vector<MacroArg> *args)
+                                     std::vector<MacroArg> *args,
+                                     std::size_t *argBytes)
 {
     Token token;
     getToken(&token);
@@ -286,6 +327,10 @@ bool MacroExpander::collectMacroArgs(const Macro &macro,
         }
         if (isArg)
         {
+            if (!reserveBytes(TokenBytes(token), identifier))
+                return false;
+            *argBytes += TokenBytes(token);
+
             MacroArg &arg = args->back();
             // Initial whitespace is not part of the argument.
             if (arg.empty())
@@ -316,45 +361,63 @@ bool MacroExpander::collectMacroArgs(const Macro &macro,
     for (std::size_t i = 0; i < args->size(); ++i)
     {
         MacroArg &arg = args->at(i);
+        if (!needsPreExpansion(arg))
+            continue;
+
         TokenLexer lexer(&arg);
         MacroExpander expander(&lexer, mMacroSet, mDiagnostics);
+        expander.mBudget = mBudget;
 
         arg.clear();
         expander.lex(&token);
         while (token.type != Token::LAST)
         {
+            if (!reserveBytes(TokenBytes(token), identifier))
+                return false;
+            *argBytes += TokenBytes(token);
+
             arg.push_back(token);
             expander.lex(&token);
         }
+        if (mBudget->exceeded)
+            return false;
     }
     return true;
 }
 
+bool MacroExpander::needsPreExpansion(const MacroArg &arg) const
+{
+    // Pre-expansion leaves an argument unchanged unless it contains an
+    // identifier that names a macro.
+    for (std::size_t i = 0; i < arg.size(); ++i)
+    {
+        const Token &token = arg[i];
+        if (token.type == Token::IDENTIFIER && !token.expansionDisabled() &&
+            mMacroSet->find(token.text) != mMacroSet->end())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void MacroExpander::replaceMacroParams(const Macro &macro,
                                        const std::vector<MacroArg> &args,
                                        std::vector<Token> *replacements)
 {
+    assert(macro.parameterIndices.size() == macro.replacements.size());
+    replacements->reserve(macro.replacements.size());
+
     for (std::size_t i = 0; i < macro.replacements.size(); ++i)
     {
         const Token &repl = macro.replacements[i];
-        if (repl.type != Token::IDENTIFIER)
-        {
-            replacements->push_back(repl);
-            continue;
-        }
-
-        // TODO(alokp): Optimize this.
-        // There is no need to search for macro params every time.
-        // The param index can be cached with the replacement token.
-        Macro::Parameters::const_iterator iter = std::find(
-            macro.parameters.begin(), macro.parameters.end(), repl.text);
-        if (iter == macro.parameters.end())
+        int iArg = macro.parameterIndices[i];
+        if (iArg < 0)
         {
             replacements->push_back(repl);
             continue;
         }
 
-        std::size_t iArg = std::distance(macro.parameters.begin(), iter);
         const MacroArg &arg = args[iArg];
         if (arg.empty())
         {
@@ -368,5 +431,26 @@ void MacroExpander::replaceMacroParams(const Macro &macro,
     }
 }
 
-}  // namespace pp
+bool MacroExpander::reserveBytes(std::size_t bytes, const Token &identifier)
+{
+    if (mBudget->exceeded)
+        return false;
+
+    if (mBudget->maxBytes != 0 && mBudget->usedBytes + bytes > mBudget->maxBytes)
+    {
+        mDiagnostics->report(Diagnostics::PP_MACRO_EXPANSION_TOO_LARGE,
+                             identifier.location, identifier.text);
+        mBudget->exceeded = true;
+        return false;
+    }
+    mBudget->usedBytes += bytes;
+    return true;
+}
 
+void MacroExpander::releaseBytes(std::size_t bytes)
+{
+    assert(mBudget->usedBytes >= bytes);
+    mBudget->usedBytes -= bytes;
+}
+
+}  // namespace pp
@@ -8,12 +8,12 @@
 #define COMPILER_PREPROCESSOR_MACRO_EXPANDER_H_
 
 #include <cassert>
-#include <memory>
 #include <vector>
 
 #include "Lexer.h"
 #include "Macro.h"
 #include "pp_utils.h"
+#include "Token.h"
 
 namespace pp
 {
@@ -28,6 +28,12 @@ class MacroExpander : public Lexer
 
     virtual void lex(Token *token);
 
+    // Limits the memory that the tokens of the expansions in progress may
+    // use to |maxBytes|, or removes the limit with 0. Exceeding it is
+    // reported as an error, after which lex() only returns Token::LAST.
+    void setMemoryBudget(std::size_t maxBytes);
+    bool memoryBudgetExceeded() const { return mBudget->exceeded; }
+
   private:
     PP_DISALLOW_COPY_AND_ASSIGN(MacroExpander);
 
@@ -35,39 +41,71 @@ class MacroExpander : public Lexer
     void ungetToken(const Token &token);
     bool isNextTokenLeftParen();
 
+    struct MacroContext;
     bool pushMacro(const Macro &macro, const Token &identifier);
     void popMacro();
 
     bool expandMacro(const Macro &macro,
                      const Token &identifier,
-                     std::vector<Token> *replacements);
+                     MacroContext *context);
 
     typedef std::vector<Token> MacroArg;
     bool collectMacroArgs(const Macro &macro,
                           const Token &identifier,
-                          std::vector<MacroArg> *args);
+                          std::vector<MacroArg> *args,
+                          std::size_t *argBytes);
+    bool needsPreExpansion(const MacroArg &arg) const;
     void replaceMacroParams(const Macro &macro,
                             const std::vector<MacroArg> &args,
                             std::vector<Token> *replacements);
 
+    // Adds |bytes| to the memory used by the expansions in progress.
+    // Returns false, after reporting the error at |identifier| the first
+    // time, if that exceeds the budget.
+    bool reserveBytes(std::size_t bytes, const Token &identifier);
+    void releaseBytes(std::size_t bytes);
+
     struct MacroContext
     {
         const Macro *macro;
         std::size_t index;
-        std::vector<Token> replacements;
+        // Points either at the replacement list of |macro|, which is shared
+        // by all expansions of a macro that needs no substitution, or at
+        // |expansion|.
+        const std::vector<Token> *replacements;
+        std::vector<Token> expansion;
+        // Memory reserved for |expansion|.
+        std::size_t expansionBytes;
+        // Properties the replaced tokens inherit from the macro identifier.
+        SourceLocation location;
+        bool atStartOfLine;
+        bool hasLeadingSpace;
 
         MacroContext()
             : macro(0),
-              index(0)
+              index(0),
+              replacements(0),
+              expansionBytes(0),
+              atStartOfLine(false),
+              hasLeadingSpace(false)
         {
         }
         bool empty() const
         {
-            return index == replacements.size();
+            return index == replacements->size();
         }
-        const Token &get()
+        void get(Token *token)
         {
-            return replacements[index++];
+            *token = (*replacements)[index];
+            if (index == 0)
+            {
+                // The first token in the replacement list inherits the
+                // padding properties of the identifier token.
+                token->setAtStartOfLine(atStartOfLine);
+                token->setHasLeadingSpace(hasLeadingSpace);
+            }
+            token->location = location;
+            ++index;
         }
         void unget()
         {
@@ -80,8 +118,22 @@ class MacroExpander : public Lexer
     MacroSet *mMacroSet;
     Diagnostics *mDiagnostics;
 
-    std::auto_ptr<Token> mReserveToken;
+    // Token pushed back by ungetToken() when no macro is being expanded.
+    Token mReserveToken;
+    bool mHasReserveToken;
     std::vector<MacroContext *> mContextStack;
+
+    // The memory used by the tokens of the expansions in progress. The
+    // expanders of macro arguments share the budget of the expander that
+    // creates them.
+    struct Budget
+    {
+        std::size_t maxBytes;
+        std::size_t usedBytes;
+        bool exceeded;
+    };
+    Budget mOwnBudget;
+    Budget *mBudget;
 };
 
 }  // namespace pp
@@ -8,8 +8,10 @@
 
 #include <cassert>
 #include <sstream>
+#include <vector>
 
 #include "DiagnosticsBase.h"
+#include "DirectiveHandlerBase.h"
 #include "DirectiveParser.h"
 #include "Macro.h"
 #include "MacroExpander.h"
@@ -19,11 +21,148 @@
 namespace pp
 {
 
+// A directive that is passed to the DirectiveHandler.
+struct RecordedDirective
+{
+    enum Type
+    {
+        kError,
+        kPragma,
+        kExtension,
+        kVersion
+    };
+
+    Type type;
+    SourceLocation location;
+    std::string name;
+    std::string value;
+    bool stdgl;
+    int version;
+};
+
+typedef std::vector<RecordedDirective> RecordedDirectives;
+
+struct SnapshotImpl
+{
+    MacroSet macroSet;
+    bool pastFirstStatement;
+    RecordedDirectives directives;
+};
+
+namespace
+{
+
+// Passes the directives on to the handler of the client, and records them
+// while a snapshot is being taken.
+class DirectiveRecorder : public DirectiveHandler
+{
+  public:
+    explicit DirectiveRecorder(DirectiveHandler *handler)
+        : mHandler(handler),
+          mDirectives(NULL)
+    {
+    }
+
+    void setRecording(RecordedDirectives *directives) { mDirectives = directives; }
+
+    virtual void handleError(const SourceLocation &loc, const std::string &msg)
+    {
+        RecordedDirective directive = create(RecordedDirective::kError, loc);
+        directive.value = msg;
+        record(directive);
+        mHandler->handleError(loc, msg);
+    }
+
+    virtual void handlePragma(const SourceLocation &loc,
+                              const std::string &name,
+                              const std::string &value,
+                              bool stdgl)
+    {
+        RecordedDirective directive = create(RecordedDirective::kPragma, loc);
+        directive.name = name;
+        directive.value = value;
+        directive.stdgl = stdgl;
+        record(directive);
+        mHandler->handlePragma(loc, name, value, stdgl);
+    }
+
+    virtual void handleExtension(const SourceLocation &loc,
+                                 const std::string &name,
+                                 const std::string &behavior)
+    {
+        RecordedDirective directive = create(RecordedDirective::kExtension, loc);
+        directive.name = name;
+        directive.value = behavior;
+        record(directive);
+        mHandler->handleExtension(loc, name, behavior);
+    }
+
+    virtual void handleVersion(const SourceLocation &loc, int version)
+    {
+        RecordedDirective directive = create(RecordedDirective::kVersion, loc);
+        directive.version = version;
+        record(directive);
+        mHandler->handleVersion(loc, version);
+    }
+
+    // Passes recorded directives to the handler of the client again.
+    void replay(const RecordedDirectives &directives)
+    {
+        for (size_t i = 0; i < directives.size(); ++i)
+        {
+            const RecordedDirective &directive = directives[i];
+            switch (directive.type)
+            {
+              case RecordedDirective::kError:
+                mHandler->handleError(directive.location, directive.value);
+                break;
+              case RecordedDirective::kPragma:
+                mHandler->handlePragma(directive.location, directive.name,
+                                       directive.value, directive.stdgl);
+                break;
+              case RecordedDirective::kExtension:
+                mHandler->handleExtension(directive.location, directive.name,
+                                          directive.value);
+                break;
+              case RecordedDirective::kVersion:
+                mHandler->handleVersion(directive.location, directive.version);
+                break;
+              default:
+                assert(false);
+                break;
+            }
+        }
+    }
+
+  private:
+    static RecordedDirective create(RecordedDirective::Type type, const SourceLocation &loc)
+    {
+        RecordedDirective directive;
+        directive.type = type;
+        directive.location = loc;
+        directive.stdgl = false;
+        directive.version = 0;
+        return directive;
+    }
+
+    void record(const RecordedDirective &directive)
+    {
+        if (mDirectives)
+            mDirectives->push_back(directive);
+    }
+
+    DirectiveHandler *mHandler;
+    RecordedDirectives *mDirectives;
+};
+
+}  // namespace anonymous
+
 struct PreprocessorImpl
 {
     Diagnostics *diagnostics;
     MacroSet macroSet;
     Tokenizer tokenizer;
+    DirectiveRecorder directiveRecorder;
     DirectiveParser directiveParser;
     MacroExpander macroExpander;
 
@@ -31,12 +170,23 @@ struct PreprocessorImpl
                      DirectiveHandler *directiveHandler)
         : diagnostics(diag),
           tokenizer(diag),
-          directiveParser(&tokenizer, &macroSet, diag, directiveHandler),
+          directiveRecorder(directiveHandler),
+          directiveParser(&tokenizer, &macroSet, diag, &directiveRecorder),
           macroExpander(&directiveParser, &macroSet, diag)
     {
     }
 };
 
+Snapshot::Snapshot(SnapshotImpl *impl)
+    : mImpl(impl)
+{
+}
+
+Snapshot::~Snapshot()
+{
+    delete mImpl;
+}
+
 Preprocessor::Preprocessor(Diagnostics *diagnostics,
                            DirectiveHandler *directiveHandler)
 {
@@ -63,6 +213,19 @@ bool Preprocessor::init(size_t count,
     return mImpl->tokenizer.init(count, string, length);
 }
 
+bool Preprocessor::init(const Snapshot &snapshot,
+                        size_t count,
+                        const char * const string[],
+                        const int length[])
+{
+    const SnapshotImpl *state = snapshot.mImpl;
+    mImpl->macroSet = state->macroSet;
+    mImpl->directiveParser.setPastFirstStatement(state->pastFirstStatement);
+    mImpl->directiveRecorder.replay(state->directives);
+
+    return mImpl->tokenizer.init(count, string, length);
+}
+
 void Preprocessor::predefineMacro(const char *name, int value)
 {
     std::ostringstream stream;
@@ -110,9 +273,48 @@ void Preprocessor::lex(Token *token)
     }
 }
 
+Snapshot *Preprocessor::takeSnapshot()
+{
+    SnapshotImpl *state = new SnapshotImpl;
+    mImpl->directiveRecorder.setRecording(&state->directives);
+
+    bool valid = true;
+    Token token;
+    for (lex(&token); token.type != Token::LAST; lex(&token))
+    {
+        if (valid)
+        {
+            mImpl->diagnostics->report(Diagnostics::PP_PROLOGUE_UNEXPECTED_TOKEN,
+                                       token.location, token.text);
+            valid = false;
+        }
+    }
+    mImpl->directiveRecorder.setRecording(NULL);
+
+    if (!valid)
+    {
+        delete state;
+        return NULL;
+    }
+
+    state->macroSet = mImpl->macroSet;
+    state->pastFirstStatement = mImpl->directiveParser.isPastFirstStatement();
+    return new Snapshot(state);
+}
+
 void Preprocessor::setMaxTokenSize(size_t maxTokenSize)
 {
     mImpl->tokenizer.setMaxTokenSize(maxTokenSize);
 }
 
+void Preprocessor::setMemoryBudget(size_t maxBytes)
+{
+    mImpl->macroExpander.setMemoryBudget(maxBytes);
+}
+
+bool Preprocessor::memoryBudgetExceeded() const
+{
+    return mImpl->macroExpander.memoryBudgetExceeded();
+}
+
 }  // namespace pp
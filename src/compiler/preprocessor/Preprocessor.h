@@ -17,8 +17,27 @@ namespace pp
 class Diagnostics;
 class DirectiveHandler;
 struct PreprocessorImpl;
+struct SnapshotImpl;
 struct Token;
 
+// The state of a preprocessor after it has processed a prologue: the
+// macros it defines and the directives it passes to the DirectiveHandler.
+// A snapshot is immutable, and may be used by several preprocessors at
+// once.
+class Snapshot
+{
+  public:
+    ~Snapshot();
+
+  private:
+    PP_DISALLOW_COPY_AND_ASSIGN(Snapshot);
+    friend class Preprocessor;
+
+    Snapshot(SnapshotImpl *impl);
+
+    SnapshotImpl *mImpl;
+};
+
 class Preprocessor
 {
   public:
@@ -35,14 +54,31 @@ class Preprocessor
     // corresponding string or a value less than 0 to indicate that the string
     // is null terminated.
     bool init(size_t count, const char * const string[], const int length[]);
+    // Same as above, but starts from the state saved in |snapshot| instead
+    // of the standard pre-defined macros. The directives of the prologue
+    // are passed to the DirectiveHandler again before the strings are
+    // preprocessed.
+    bool init(const Snapshot &snapshot,
+              size_t count, const char * const string[], const int length[]);
     // Adds a pre-defined macro.
     void predefineMacro(const char *name, int value);
 
     void lex(Token *token);
 
+    // Preprocesses all of the input, which must only contain directives,
+    // and returns the resulting state. Returns NULL if anything else is
+    // found in the input. The caller owns the snapshot.
+    Snapshot *takeSnapshot();
+
     // Set maximum preprocessor token size
     void setMaxTokenSize(size_t maxTokenSize);
 
+    // Limits the memory that the tokens of macro expansions in progress may
+    // use to |maxBytes|, or removes the limit with 0. Once a macro expansion
+    // exceeds it, an error is reported and lex() only returns Token::LAST.
+    void setMemoryBudget(size_t maxBytes);
+    bool memoryBudgetExceeded() const;
+
   private:
     PP_DISALLOW_COPY_AND_ASSIGN(Preprocessor);
 
@@ -563,24 +563,24 @@ typedef pp::SourceLocation YYLTYPE;
         yyextra->lineStart = true;     \
     } while(0);
 
-#define YY_USER_ACTION                                              \
-    do                                                              \
-    {                                                               \
-        pp::Input* input = &yyextra->input;                         \
-        pp::Input::Location* scanLoc = &yyextra->scanLoc;           \
-        while ((scanLoc->sIndex < input->count()) &&                \
-               (scanLoc->cIndex >= input->length(scanLoc->sIndex))) \
-        {                                                           \
-            scanLoc->cIndex -= input->length(scanLoc->sIndex++);    \
-            ++yyfileno; yylineno = 1;                               \
-        }                                                           \
-        yylloc->file = yyfileno;                                    \
-        yylloc->line = yylineno;                                    \
-        scanLoc->cIndex += yyleng;                                  \
+#define YY_USER_ACTION                                                     \
+    do                                                                     \
+    {                                                                      \
+        pp::Input* input = &yyextra->input;                                \
+        pp::Input::Location* scanLoc = &yyextra->scanLoc;                  \
+        while ((scanLoc->sIndex < input->count()) &&                       \
+               (scanLoc->cIndex >= input->compactLength(scanLoc->sIndex))) \
+        {                                                                  \
+            scanLoc->cIndex -= input->compactLength(scanLoc->sIndex++);    \
+            ++yyfileno; yylineno = 1;                                      \
+        }                                                                  \
+        yylloc->file = yyfileno;                                           \
+        yylloc->line = yylineno;                                           \
+        scanLoc->cIndex += yyleng;                                         \
     } while(0);
 
 #define YY_INPUT(buf, result, maxSize) \
-    result = yyextra->input.read(buf, maxSize);
+    result = yyextra->input.readCompact(buf, maxSize);
 
 #define INITIAL 0
 #define COMMENT 1
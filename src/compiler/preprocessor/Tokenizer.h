@@ -26,7 +26,9 @@ class Tokenizer : public Lexer
         Input input;
         // The location where yytext points to. Token location should track
         // scanLoc instead of Input::mReadLoc because they may not be the same
-        // if text is buffered up in the scanner input buffer.
+        // if text is buffered up in the scanner input buffer. The scanner
+        // reads with Input::readCompact(), so cIndex counts the characters it
+        // returned.
         Input::Location scanLoc;
 
         bool leadingSpace;
@@ -391,6 +391,11 @@ void BuiltInFunctionEmulator::MarkBuiltInFunctionsForEmulation(
     root->traverse(&marker);
 }
 
+TIntermTraverser* BuiltInFunctionEmulator::CreateEmulationMarker()
+{
+    return new BuiltInFunctionEmulationMarker(*this);
+}
+
 void BuiltInFunctionEmulator::Cleanup()
 {
     mFunctions.clear();
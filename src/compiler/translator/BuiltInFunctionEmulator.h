@@ -32,6 +32,10 @@ public:
     void OutputEmulatedFunctionDefinition(TInfoSinkBase& out, bool withPrecision) const;
 
     void MarkBuiltInFunctionsForEmulation(TIntermNode* root);
+    // Returns a traverser that does the marking of
+    // MarkBuiltInFunctionsForEmulation, to be run together with other
+    // passes. It is allocated from the current pool.
+    TIntermTraverser* CreateEmulationMarker();
 
     void Cleanup();
 
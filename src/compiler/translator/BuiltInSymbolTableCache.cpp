@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/BuiltInSymbolTableCache.h"
+
+#include <map>
+#include <sstream>
+
+#include "angle_gl.h"
+#include "common/mutex.h"
+#include "compiler/translator/Initialize.h"
+
+namespace
+{
+
+typedef std::map<std::string, TBuiltInSymbolTable *> BuiltInSymbolTableMap;
+
+Mutex gCacheMutex;
+BuiltInSymbolTableMap gCache;
+
+std::string GetCacheKey(sh::GLenum type, ShShaderSpec spec, const std::string &resourcesString)
+{
+    std::ostringstream key;
+    key << type << ":" << spec << resourcesString;
+    return key.str();
+}
+
+void InitializeBuiltIns(sh::GLenum type, ShShaderSpec spec,
+                        const ShBuiltInResources &resources,
+                        TSymbolTable &symbolTable)
+{
+    symbolTable.push();   // COMMON_BUILTINS
+    symbolTable.push();   // ESSL1_BUILTINS
+    symbolTable.push();   // ESSL3_BUILTINS
+
+    TPublicType integer;
+    integer.type = EbtInt;
+    integer.primarySize = 1;
+    integer.secondarySize = 1;
+    integer.array = false;
+
+    TPublicType floatingPoint;
+    floatingPoint.type = EbtFloat;
+    floatingPoint.primarySize = 1;
+    floatingPoint.secondarySize = 1;
+    floatingPoint.array = false;
+
+    TPublicType sampler;
+    sampler.primarySize = 1;
+    sampler.secondarySize = 1;
+    sampler.array = false;
+
+    switch(type)
+    {
+      case GL_FRAGMENT_SHADER:
+        symbolTable.setDefaultPrecision(integer, EbpMedium);
+        break;
+      case GL_VERTEX_SHADER:
+        symbolTable.setDefaultPrecision(integer, EbpHigh);
+        symbolTable.setDefaultPrecision(floatingPoint, EbpHigh);
+        break;
+      default:
+        assert(false && "Language not supported");
+    }
+    // We set defaults for all the sampler types, even those that are
+    // only available if an extension exists.
+    for (int samplerType = EbtGuardSamplerBegin + 1;
+         samplerType < EbtGuardSamplerEnd; ++samplerType)
+    {
+        sampler.type = static_cast<TBasicType>(samplerType);
+        symbolTable.setDefaultPrecision(sampler, EbpLow);
+    }
+
+    InsertBuiltInFunctions(type, spec, resources, symbolTable);
+
+    IdentifyBuiltIns(type, spec, resources, symbolTable);
+
+    // From here on the levels are only read, possibly from several threads.
+    symbolTable.precomputeBuiltInLazyData();
+}
+
+}  // namespace
+
+TBuiltInSymbolTable *AcquireBuiltInSymbolTable(sh::GLenum type,
+                                               ShShaderSpec spec,
+                                               const ShBuiltInResources &resources,
+                                               const std::string &resourcesString)
+{
+    ScopedLock lock(&gCacheMutex);
+
+    std::string key = GetCacheKey(type, spec, resourcesString);
+    BuiltInSymbolTableMap::iterator it = gCache.find(key);
+    if (it != gCache.end())
+    {
+        it->second->mRefCount++;
+        return it->second;
+    }
+
+    TBuiltInSymbolTable *builtIns = new TBuiltInSymbolTable();
+
+    // The built-ins live in the table's own pool rather than in the pool of
+    // the compiler that happens to create them.
+    TPoolAllocator *previousAllocator = GetGlobalPoolAllocator();
+    builtIns->mAllocator.push();
+    SetGlobalPoolAllocator(&builtIns->mAllocator);
+    InitializeBuiltIns(type, spec, resources, builtIns->mSymbolTable);
+    SetGlobalPoolAllocator(previousAllocator);
+
+    // One reference for the cache and one for the caller.
+    builtIns->mRefCount = 2;
+    gCache[key] = builtIns;
+    return builtIns;
+}
+
+void ReleaseBuiltInSymbolTable(TBuiltInSymbolTable *builtIns)
+{
+    ScopedLock lock(&gCacheMutex);
+    builtIns->releaseLocked();
+}
+
+void FreeBuiltInSymbolTableCache()
+{
+    ScopedLock lock(&gCacheMutex);
+    for (BuiltInSymbolTableMap::iterator it = gCache.begin(); it != gCache.end(); ++it)
+        it->second->releaseLocked();
+    gCache.clear();
+}
+
+size_t GetBuiltInSymbolTableCacheSize()
+{
+    ScopedLock lock(&gCacheMutex);
+    return gCache.size();
+}
@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#ifndef COMPILER_TRANSLATOR_BUILTINSYMBOLTABLECACHE_H_
+#define COMPILER_TRANSLATOR_BUILTINSYMBOLTABLECACHE_H_
+
+//
+// Process-wide cache of the built-in levels of the symbol table.
+//
+// The built-in levels only depend on the shader type, the spec and the
+// built-in resources, yet building them costs milliseconds and hundreds of
+// KB per compiler. Compilers created with the same combination share a
+// single frozen copy and only push their user levels on top of it.
+//
+
+#include <string>
+
+#include "compiler/translator/PoolAlloc.h"
+#include "compiler/translator/SymbolTable.h"
+
+class TBuiltInSymbolTable
+{
+  public:
+    const TSymbolTable &getSymbolTable() const { return mSymbolTable; }
+
+  private:
+    friend TBuiltInSymbolTable *AcquireBuiltInSymbolTable(
+        sh::GLenum, ShShaderSpec, const ShBuiltInResources &, const std::string &);
+    friend void ReleaseBuiltInSymbolTable(TBuiltInSymbolTable *);
+    friend void FreeBuiltInSymbolTableCache();
+
+    TBuiltInSymbolTable() : mRefCount(0) { }
+    DISALLOW_COPY_AND_ASSIGN(TBuiltInSymbolTable);
+
+    // Must be called with the cache lock held.
+    void releaseLocked()
+    {
+        ASSERT(mRefCount > 0);
+        if (--mRefCount == 0)
+            delete this;
+    }
+
+    // The allocator is declared first so it outlives the symbols it holds.
+    TPoolAllocator mAllocator;
+    TSymbolTable mSymbolTable;
+    int mRefCount;
+};
+
+// Returns the built-in symbol table for the given shader type, spec and
+// resources, building it on first use. |resourcesString| is the string
+// computed by TCompiler::setResourceString() for |resources|. Each call must
+// be balanced by a call to ReleaseBuiltInSymbolTable().
+TBuiltInSymbolTable *AcquireBuiltInSymbolTable(sh::GLenum type,
+                                               ShShaderSpec spec,
+                                               const ShBuiltInResources &resources,
+                                               const std::string &resourcesString);
+void ReleaseBuiltInSymbolTable(TBuiltInSymbolTable *builtIns);
+
+// Drops the references held by the cache. Tables still used by a compiler
+// are destroyed when that compiler releases them.
+void FreeBuiltInSymbolTableCache();
+
+// Returns the number of tables currently held by the cache.
+size_t GetBuiltInSymbolTableCacheSize();
+
+#endif  // COMPILER_TRANSLATOR_BUILTINSYMBOLTABLECACHE_H_
@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/CompileStatistics.h"
+
+#include "common/platform.h"
+#include "compiler/translator/IntermNode.h"
+#include "third_party/trace_event/trace_event.h"
+
+#if defined(ANGLE_PLATFORM_WINDOWS)
+#include <windows.h>
+#elif defined(ANGLE_PLATFORM_APPLE)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+namespace sh
+{
+
+namespace
+{
+
+const char *const kPhaseNames[SH_COMPILE_PHASE_COUNT] =
+{
+    "parse",
+    "postProcess",
+    "limitExpressionComplexity",
+    "detectCallDepth",
+    "validateOutputs",
+    "validateLimitations",
+    "enforceTimingRestrictions",
+    "rewriteCSSShader",
+    "copyTree",
+    "serializeTree",
+    "deserializeTree",
+    "pruneDeadCode",
+    "eliminateCommonSubexpressions",
+    "unrollMarkup",
+    "emulation",
+    "initializeVariables",
+    "unfoldShortCircuit",
+    "collectVariables",
+    "packUniforms",
+    "scalarize",
+    "regenerateStructNames",
+    "translate",
+};
+
+class CountNodesTraverser : public TIntermTraverser
+{
+  public:
+    CountNodesTraverser()
+        : TIntermTraverser(true, false, false),
+          mCount(0)
+    {
+    }
+
+    size_t getCount() const { return mCount; }
+
+    virtual void visitSymbol(TIntermSymbol *) { ++mCount; }
+    virtual void visitConstantUnion(TIntermConstantUnion *) { ++mCount; }
+    virtual void visitRaw(TIntermRaw *) { ++mCount; }
+    virtual bool visitBinary(Visit, TIntermBinary *) { ++mCount; return true; }
+    virtual bool visitUnary(Visit, TIntermUnary *) { ++mCount; return true; }
+    virtual bool visitSelection(Visit, TIntermSelection *) { ++mCount; return true; }
+    virtual bool visitAggregate(Visit, TIntermAggregate *) { ++mCount; return true; }
+    virtual bool visitLoop(Visit, TIntermLoop *) { ++mCount; return true; }
+    virtual bool visitBranch(Visit, TIntermBranch *) { ++mCount; return true; }
+
+  private:
+    size_t mCount;
+};
+
+}  // anonymous namespace
+
+double GetCurrentTimeMs()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return static_cast<double>(counter.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+#elif defined(ANGLE_PLATFORM_APPLE)
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    return static_cast<double>(mach_absolute_time()) * timebase.numer / timebase.denom / 1e6;
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<double>(now.tv_sec) * 1000.0 + static_cast<double>(now.tv_nsec) / 1e6;
+#endif
+}
+
+const char *GetCompilePhaseName(ShCompilePhase phase)
+{
+    if (phase < 0 || phase >= SH_COMPILE_PHASE_COUNT)
+        return "";
+    return kPhaseNames[phase];
+}
+
+size_t CountNodes(TIntermNode *root)
+{
+    CountNodesTraverser counter;
+    root->traverse(&counter);
+    return counter.getCount();
+}
+
+ScopedCompilePhase::ScopedCompilePhase(ShCompileStatistics *statistics, ShCompilePhase phase)
+    : mStatistics(statistics),
+      mPhase(phase),
+      mStartTime(0.0)
+{
+    TRACE_EVENT_BEGIN0("gpu.angle", kPhaseNames[mPhase]);
+    if (mStatistics)
+        mStartTime = GetCurrentTimeMs();
+}
+
+ScopedCompilePhase::~ScopedCompilePhase()
+{
+    if (mStatistics)
+        mStatistics->phaseTimes[mPhase] += GetCurrentTimeMs() - mStartTime;
+    TRACE_EVENT_END0("gpu.angle", kPhaseNames[mPhase]);
+}
+
+}
@@ -0,0 +1,48 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// CompileStatistics.h: Timing of the phases of a compilation and counting
+//   of AST nodes for SH_COMPILE_STATISTICS.
+//
+
+#ifndef COMPILER_COMPILE_STATISTICS_H_
+#define COMPILER_COMPILE_STATISTICS_H_
+
+#include "GLSLANG/ShaderLang.h"
+#include "common/angleutils.h"
+
+class TIntermNode;
+
+namespace sh
+{
+
+// Returns a monotonic time in milliseconds.
+double GetCurrentTimeMs();
+
+const char *GetCompilePhaseName(ShCompilePhase phase);
+
+// Returns the number of nodes in the tree below and including |root|.
+size_t CountNodes(TIntermNode *root);
+
+// Records begin and end trace events for a phase in the "gpu.angle"
+// category, and adds the time spent between construction and destruction
+// to |statistics| unless it is NULL.
+class ScopedCompilePhase
+{
+  public:
+    ScopedCompilePhase(ShCompileStatistics *statistics, ShCompilePhase phase);
+    ~ScopedCompilePhase();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(ScopedCompilePhase);
+
+    ShCompileStatistics *mStatistics;
+    ShCompilePhase mPhase;
+    double mStartTime;
+};
+
+}
+
+#endif // COMPILER_COMPILE_STATISTICS_H_
@@ -5,16 +5,27 @@
 //
 
 #include "compiler/translator/BuiltInFunctionEmulator.h"
+#include "compiler/translator/BuiltInSymbolTableCache.h"
+#include "compiler/translator/CompileStatistics.h"
 #include "compiler/translator/Compiler.h"
+#include "compiler/translator/CopyTree.h"
 #include "compiler/translator/DetectCallDepth.h"
+#include "compiler/translator/EliminateCommonSubexpressions.h"
 #include "compiler/translator/ForLoopUnroll.h"
 #include "compiler/translator/Initialize.h"
 #include "compiler/translator/InitializeParseContext.h"
 #include "compiler/translator/InitializeVariables.h"
 #include "compiler/translator/ParseContext.h"
+#include "compiler/translator/PassManager.h"
+#include "compiler/translator/Prologue.h"
+#include "compiler/translator/PruneDeadCode.h"
 #include "compiler/translator/RegenerateStructNames.h"
+#include "compiler/translator/RemoveVaryings.h"
 #include "compiler/translator/RenameFunction.h"
 #include "compiler/translator/ScalarizeVecAndMatConstructorArgs.h"
+#include "compiler/translator/SerializeTree.h"
+#include "compiler/translator/TranslationCache.h"
+#include "compiler/translator/TypeTable.h"
 #include "compiler/translator/UnfoldShortCircuitAST.h"
 #include "compiler/translator/ValidateLimitations.h"
 #include "compiler/translator/ValidateOutputs.h"
@@ -24,6 +35,7 @@
 #include "compiler/translator/timing/RestrictFragmentShaderTiming.h"
 #include "compiler/translator/timing/RestrictVertexShaderTiming.h"
 #include "third_party/compiler/ArrayBoundsClamper.h"
+#include "third_party/murmurhash/MurmurHash3.h"
 #include "angle_gl.h"
 #include "common/utilities.h"
 
@@ -68,6 +80,22 @@ class TScopedPoolAllocator
     TPoolAllocator* mAllocator;
 };
 
+class TScopedMemoryBudget
+{
+  public:
+    TScopedMemoryBudget(TPoolAllocator* allocator, size_t maxBytes) : mAllocator(allocator)
+    {
+        mAllocator->setBudget(maxBytes);
+    }
+    ~TScopedMemoryBudget()
+    {
+        mAllocator->setBudget(0);
+    }
+
+  private:
+    TPoolAllocator* mAllocator;
+};
+
 class TScopedSymbolTableLevel
 {
   public:
@@ -86,6 +114,19 @@ class TScopedSymbolTableLevel
     TSymbolTable* mTable;
 };
 
+// Version of the format written by TCompiler::serializeAST().
+const int kSerializedASTFormatVersion = 1;
+
+// Detects serialized ASTs that were corrupted by accident. It is not a
+// signature: anyone can compute it for a changed AST, which is why the tree
+// is checked again as it is read.
+int ChecksumSerializedAST(const std::string& contents)
+{
+    uint32_t checksum = 0;
+    MurmurHash3_x86_32(contents.data(), static_cast<int>(contents.size()), 0, &checksum);
+    return static_cast<int>(checksum);
+}
+
 int MapSpecToShaderVersion(ShShaderSpec spec)
 {
     switch (spec)
@@ -124,14 +165,22 @@ TCompiler::TCompiler(sh::GLenum type, ShShaderSpec spec, ShShaderOutput output)
       maxUniformVectors(0),
       maxExpressionComplexity(0),
       maxCallStackDepth(0),
+      builtInSymbolTable(NULL),
       fragmentPrecisionHigh(false),
       clampingStrategy(SH_CLAMP_WITH_CLAMP_INTRINSIC),
-      builtInFunctionEmulator(type)
+      builtInFunctionEmulator(type),
+      prologue(NULL),
+      linkCompileOptions(0),
+      linkCompileSucceeded(false),
+      linkFromSerializedAST(false),
+      linked(false)
 {
 }
 
 TCompiler::~TCompiler()
 {
+    if (builtInSymbolTable)
+        ReleaseBuiltInSymbolTable(builtInSymbolTable);
 }
 
 bool TCompiler::Init(const ShBuiltInResources& resources)
@@ -162,13 +211,271 @@ bool TCompiler::Init(const ShBuiltInResources& resources)
 bool TCompiler::compile(const char* const shaderStrings[],
                         size_t numStrings,
                         int compileOptions)
+{
+    memset(&compileStatistics, 0, sizeof(compileStatistics));
+    bool collectStatistics = (compileOptions & SH_COMPILE_STATISTICS) != 0;
+    double startTime = collectStatistics ? sh::GetCurrentTimeMs() : 0.0;
+
+    bool success = (compileOptions & SH_CACHE_TRANSLATION) ?
+        compileCached(shaderStrings, numStrings, compileOptions) :
+        compileUncached(shaderStrings, numStrings, compileOptions, NULL, 0);
+    setLinkSources(shaderStrings, numStrings, compileOptions, success);
+
+    if (collectStatistics)
+        compileStatistics.totalTime = sh::GetCurrentTimeMs() - startTime;
+    return success;
+}
+
+bool TCompiler::compileMultipleTargets(const char* const shaderStrings[],
+                                       size_t numStrings,
+                                       int compileOptions,
+                                       TCompiler* const otherTargets[],
+                                       size_t numOtherTargets)
+{
+    // Cached results are looked up per target, and targets that would
+    // parse the shader differently need a parse of their own.
+    std::vector<TCompiler*> sharingTargets;
+    bool success = true;
+    for (size_t i = 0; i < numOtherTargets; ++i)
+    {
+        if (!(compileOptions & SH_CACHE_TRANSLATION) && sharesParseWith(otherTargets[i]))
+            sharingTargets.push_back(otherTargets[i]);
+        else
+            success = otherTargets[i]->compile(shaderStrings, numStrings, compileOptions) && success;
+    }
+    if (sharingTargets.empty())
+        return compile(shaderStrings, numStrings, compileOptions) && success;
+
+    memset(&compileStatistics, 0, sizeof(compileStatistics));
+    for (size_t i = 0; i < sharingTargets.size(); ++i)
+        memset(&sharingTargets[i]->compileStatistics, 0, sizeof(compileStatistics));
+    bool collectStatistics = (compileOptions & SH_COMPILE_STATISTICS) != 0;
+    double startTime = collectStatistics ? sh::GetCurrentTimeMs() : 0.0;
+
+    bool sharedSuccess = compileUncached(shaderStrings, numStrings, compileOptions,
+                                         &sharingTargets[0], sharingTargets.size());
+    setLinkSources(shaderStrings, numStrings, compileOptions, sharedSuccess);
+    for (size_t i = 0; i < sharingTargets.size(); ++i)
+        sharingTargets[i]->setLinkSources(shaderStrings, numStrings, compileOptions, sharedSuccess);
+    success = sharedSuccess && success;
+
+    if (collectStatistics)
+    {
+        // The other targets have the time of their own translation.
+        compileStatistics.totalTime = sh::GetCurrentTimeMs() - startTime;
+        for (size_t i = 0; i < sharingTargets.size(); ++i)
+            compileStatistics.totalTime -= sharingTargets[i]->compileStatistics.totalTime;
+    }
+    return success;
+}
+
+bool TCompiler::compileSerializedAST(const char* data, size_t length, int compileOptions)
+{
+    memset(&compileStatistics, 0, sizeof(compileStatistics));
+    bool collectStatistics = (compileOptions & SH_COMPILE_STATISTICS) != 0;
+    double startTime = collectStatistics ? sh::GetCurrentTimeMs() : 0.0;
+
+    bool success = translateSerializedAST(data, length, compileOptions);
+    setLinkSerializedAST(data, length, compileOptions, success);
+
+    if (collectStatistics)
+        compileStatistics.totalTime = sh::GetCurrentTimeMs() - startTime;
+    return success;
+}
+
+bool TCompiler::sharesParseWith(const TCompiler* other) const
+{
+    return other != this &&
+           other->shaderType == shaderType &&
+           other->shaderSpec == shaderSpec &&
+           other->builtInResourcesString == builtInResourcesString &&
+           other->prologue == prologue;
+}
+
+bool TCompiler::setLinkState(int compileOptions, bool success)
+{
+    linked = !unreadVaryings.empty();
+    if (linked)
+        return false;
+
+    // Both sides of a link need the results of their last compilation.
+    linkCompileOptions = compileOptions;
+    linkCompileSucceeded = success;
+    if (shaderType != GL_VERTEX_SHADER)
+        return false;
+
+    unlinkedVaryings = varyings;
+    return true;
+}
+
+void TCompiler::setLinkSources(const char* const shaderStrings[],
+                               size_t numStrings,
+                               int compileOptions,
+                               bool success)
+{
+    if (setLinkState(compileOptions, success))
+    {
+        linkSources.assign(shaderStrings, shaderStrings + numStrings);
+        linkFromSerializedAST = false;
+    }
+}
+
+void TCompiler::setLinkSerializedAST(const char* data,
+                                     size_t length,
+                                     int compileOptions,
+                                     bool success)
+{
+    if (setLinkState(compileOptions, success))
+    {
+        linkSources.assign(1, std::string(data, length));
+        linkFromSerializedAST = true;
+    }
+}
+
+bool TCompiler::linkVaryings(const TCompiler* fragmentShader)
+{
+    if (shaderType != GL_VERTEX_SHADER || fragmentShader->shaderType != GL_FRAGMENT_SHADER ||
+        !linkCompileSucceeded || !(linkCompileOptions & SH_VARIABLES) ||
+        !fragmentShader->linkCompileSucceeded ||
+        !(fragmentShader->linkCompileOptions & SH_VARIABLES))
+    {
+        return false;
+    }
+
+    std::set<std::string> readVaryings;
+    const std::vector<sh::Varying> &fragmentVaryings = fragmentShader->getVaryings();
+    for (size_t i = 0; i < fragmentVaryings.size(); ++i)
+    {
+        if (fragmentVaryings[i].staticUse)
+            readVaryings.insert(fragmentVaryings[i].name);
+    }
+
+    std::set<std::string> unread;
+    for (size_t i = 0; i < unlinkedVaryings.size(); ++i)
+    {
+        const std::string &name = unlinkedVaryings[i].name;
+        if (name.compare(0, 3, "gl_") != 0 && readVaryings.count(name) == 0)
+            unread.insert(name);
+    }
+    // The results of the last compilation stay valid if it was not linked
+    // and nothing is removed.
+    if (unread.empty() && !linked)
+        return true;
+
+    // Compiling replaces the sources, so they are copied first.
+    std::vector<std::string> sources = linkSources;
+    std::vector<const char*> strings;
+    for (size_t i = 0; i < sources.size(); ++i)
+        strings.push_back(sources[i].c_str());
+
+    int compileOptions = linkCompileOptions;
+    if (!unread.empty())
+        compileOptions |= SH_PRUNE_DEAD_CODE;
+    unreadVaryings.swap(unread);
+    bool success = linkFromSerializedAST ?
+        compileSerializedAST(sources[0].data(), sources[0].size(), compileOptions) :
+        compile(strings.empty() ? NULL : &strings[0], strings.size(), compileOptions);
+    unreadVaryings.clear();
+    return success;
+}
+
+std::string TCompiler::getParseConfiguration() const
+{
+    std::ostringstream configuration;
+    configuration << shaderType << ":" << shaderSpec << builtInResourcesString;
+    return configuration.str();
+}
+
+TPrologue* TCompiler::createPrologue(const char* const prologueStrings[], size_t numStrings)
+{
+    TScopedPoolAllocator scopedAlloc(&allocator);
+    clearResults();
+
+    // The extensions enabled by the prologue are enabled again by each
+    // compilation that starts from it.
+    TExtensionBehavior prologueExtensionBehavior = extensionBehavior;
+    TIntermediate intermediate(infoSink);
+    TParseContext parseContext(symbolTable, prologueExtensionBehavior, intermediate,
+                               shaderType, shaderSpec, 0, true, NULL, infoSink);
+    parseContext.fragmentPrecisionHigh = fragmentPrecisionHigh;
+    SetGlobalParseContext(&parseContext);
+
+    pp::Snapshot* snapshot = PaPreprocessPrologue(numStrings, prologueStrings, &parseContext);
+    SetGlobalParseContext(NULL);
+    if (!snapshot)
+        return NULL;
+
+    BlobWriter source;
+    for (size_t i = 0; i < numStrings; ++i)
+        source.writeString(prologueStrings[i]);
+    return new TPrologue(snapshot, getParseConfiguration(), source.data());
+}
+
+bool TCompiler::setPrologue(const TPrologue* newPrologue)
+{
+    if (newPrologue && newPrologue->getConfiguration() != getParseConfiguration())
+        return false;
+
+    prologue = newPrologue;
+    return true;
+}
+
+bool TCompiler::compileCached(const char* const shaderStrings[],
+                              size_t numStrings,
+                              int compileOptions)
+{
+    TranslationCache *cache = GetTranslationCache();
+    std::string key = getTranslationCacheKey(shaderStrings, numStrings, compileOptions);
+    // Results produced with a user-provided name hashing function are
+    // only cached in memory, as the function cannot be identified across runs.
+    bool persistent = (hashFunction == NULL);
+
+    std::string results;
+    if (cache->lookup(key, persistent, &results))
+    {
+        clearResults();
+        BlobReader reader(results);
+        bool success = (reader.readInt() != 0);
+        deserializeResults(&reader);
+        if (!reader.error() && reader.endOfData())
+            return success;
+    }
+
+    bool success = compileUncached(shaderStrings, numStrings, compileOptions, NULL, 0);
+
+    BlobWriter writer;
+    writer.writeInt(success);
+    serializeResults(&writer);
+    cache->insert(key, persistent, writer.data());
+
+    return success;
+}
+
+bool TCompiler::compileUncached(const char* const shaderStrings[],
+                                size_t numStrings,
+                                int compileOptions,
+                                TCompiler* const otherTargets[],
+                                size_t numOtherTargets)
 {
     TScopedPoolAllocator scopedAlloc(&allocator);
+    TScopedMemoryBudget scopedBudget(&allocator, getMemoryBudget(compileOptions));
     clearResults();
+    for (size_t i = 0; i < numOtherTargets; ++i)
+        otherTargets[i]->clearResults();
 
     if (numStrings == 0)
         return true;
 
+    // Phases are always traced, but only timed when statistics are requested.
+    ShCompileStatistics *statistics = NULL;
+    ShPoolAllocatorStats poolStatsBefore;
+    size_t symbolCountBefore = symbolTable.getDeclaredSymbolCount();
+    if (compileOptions & SH_COMPILE_STATISTICS)
+    {
+        statistics = &compileStatistics;
+        allocator.getStats(&poolStatsBefore);
+    }
+
     // If compiling for WebGL, validate loop and indexing as well.
     if (IsWebGLBasedSpec(shaderSpec))
         compileOptions |= SH_VALIDATE_LOOP_INDEXING;
@@ -182,11 +489,19 @@ bool TCompiler::compile(const char* const shaderStrings[],
         ++firstSource;
     }
 
+    // The types of the nodes of the tree are shared for the duration of
+    // the compilation.
+    TTypeTable typeTable;
+    SetGlobalTypeTable(&typeTable);
+
     TIntermediate intermediate(infoSink);
     TParseContext parseContext(symbolTable, extensionBehavior, intermediate,
                                shaderType, shaderSpec, compileOptions, true,
                                sourcePath, infoSink);
     parseContext.fragmentPrecisionHigh = fragmentPrecisionHigh;
+    if (prologue)
+        parseContext.prologue = &prologue->getSnapshot();
+    parseContext.preprocessor.setMemoryBudget(getMemoryBudget(compileOptions));
     SetGlobalParseContext(&parseContext);
 
     // We preserve symbols at the built-in level from compile-to-compile.
@@ -194,9 +509,15 @@ bool TCompiler::compile(const char* const shaderStrings[],
     TScopedSymbolTableLevel scopedSymbolLevel(&symbolTable);
 
     // Parse shader.
-    bool success =
-        (PaParseStrings(numStrings - firstSource, &shaderStrings[firstSource], NULL, &parseContext) == 0) &&
-        (parseContext.treeRoot != NULL);
+    bool success = false;
+    {
+        sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_PARSE);
+        success =
+            (PaParseStrings(numStrings - firstSource, &shaderStrings[firstSource], NULL, &parseContext) == 0) &&
+            (parseContext.treeRoot != NULL);
+    }
+    // The parse ends early when the memory budget is used up.
+    success = checkMemoryBudget() && success;
 
     shaderVersion = parseContext.getShaderVersion();
     if (success && MapSpecToShaderVersion(shaderSpec) < shaderVersion)
@@ -206,6 +527,7 @@ bool TCompiler::compile(const char* const shaderStrings[],
         success = false;
     }
 
+    std::vector<TIntermNode*> otherRoots;
     if (success)
     {
         mPragma = parseContext.pragma();
@@ -215,157 +537,499 @@ bool TCompiler::compile(const char* const shaderStrings[],
         }
 
         TIntermNode* root = parseContext.treeRoot;
-        success = intermediate.postProcess(root);
+        {
+            sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_POST_PROCESS);
+            success = intermediate.postProcess(root);
+        }
 
-        // Disallow expressions deemed too complex.
-        if (success && (compileOptions & SH_LIMIT_EXPRESSION_COMPLEXITY))
-            success = limitExpressionComplexity(root);
+        if (statistics)
+            statistics->astNodeCount = sh::CountNodes(root);
+
+        // Passes that only read the tree are fused into as few walks as
+        // possible; each pass that modifies it ends a fused walk.
+        sh::PassManager passes(root, statistics);
+
+        // The validation passes run in one walk. Their errors are reported
+        // in the order below, up to the first pass that fails.
+        bool limitComplexity = (compileOptions & SH_LIMIT_EXPRESSION_COMPLEXITY) != 0;
+        TMaxDepthTraverser maxDepth(maxExpressionComplexity + 1);
+        DetectCallDepth detect(infoSink, (compileOptions & SH_LIMIT_CALL_STACK_DEPTH) != 0,
+                               maxCallStackDepth);
+        bool checkOutputs = (shaderVersion == 300 && shaderType == GL_FRAGMENT_SHADER);
+        TInfoSinkBase outputsLog;
+        ValidateOutputs validateOutputs(outputsLog, compileResources.MaxDrawBuffers);
+        bool checkLimitations = (compileOptions & SH_VALIDATE_LOOP_INDEXING) != 0;
+        TInfoSinkBase limitationsLog;
+        ValidateLimitations validateLimitations(shaderType, limitationsLog);
+        if (success)
+        {
+            // Disallow expressions deemed too complex.
+            if (limitComplexity)
+                passes.addReadOnlyPass(SH_COMPILE_PHASE_LIMIT_EXPRESSION_COMPLEXITY, &maxDepth);
+            passes.addReadOnlyPass(SH_COMPILE_PHASE_DETECT_CALL_DEPTH, &detect);
+            if (checkOutputs)
+                passes.addReadOnlyPass(SH_COMPILE_PHASE_VALIDATE_OUTPUTS, &validateOutputs);
+            if (checkLimitations)
+                passes.addReadOnlyPass(SH_COMPILE_PHASE_VALIDATE_LIMITATIONS, &validateLimitations);
+            passes.flush();
+        }
+
+        if (success && limitComplexity)
+        {
+            sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_LIMIT_EXPRESSION_COMPLEXITY);
+            success = limitExpressionComplexity(root, maxDepth);
+        }
 
         if (success)
-            success = detectCallDepth(root, infoSink, (compileOptions & SH_LIMIT_CALL_STACK_DEPTH) != 0);
+        {
+            sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_DETECT_CALL_DEPTH);
+            success = detectCallDepth(detect);
+        }
 
-        if (success && shaderVersion == 300 && shaderType == GL_FRAGMENT_SHADER)
-            success = validateOutputs(root);
+        if (success && checkOutputs)
+        {
+            infoSink.info.append(outputsLog);
+            success = (validateOutputs.numErrors() == 0);
+        }
 
-        if (success && (compileOptions & SH_VALIDATE_LOOP_INDEXING))
-            success = validateLimitations(root);
+        if (success && checkLimitations)
+        {
+            infoSink.info.append(limitationsLog);
+            success = (validateLimitations.numErrors() == 0);
+        }
 
         if (success && (compileOptions & SH_TIMING_RESTRICTIONS))
+        {
+            sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_TIMING_RESTRICTIONS);
             success = enforceTimingRestrictions(root, (compileOptions & SH_DEPENDENCY_GRAPH) != 0);
+        }
 
         if (success && shaderSpec == SH_CSS_SHADERS_SPEC)
-            rewriteCSSShader(root);
+            rewriteCSSShader(&passes);
+
+        if (success)
+            success = checkMemoryBudget();
 
-        // Unroll for-loop markup needs to happen after validateLimitations pass.
-        if (success && (compileOptions & SH_UNROLL_FOR_LOOP_WITH_INTEGER_INDEX))
+        if (success && (compileOptions & SH_SERIALIZE_AST))
         {
-            ForLoopUnrollMarker marker(ForLoopUnrollMarker::kIntegerIndex);
-            root->traverse(&marker);
+            sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_SERIALIZE_TREE);
+            serializeAST(root, sourcePath);
         }
-        if (success && (compileOptions & SH_UNROLL_FOR_LOOP_WITH_SAMPLER_ARRAY_INDEX))
+
+        // The other targets translate copies of the validated tree, taken
+        // before this compiler's passes modify it.
+        if (success && numOtherTargets > 0)
         {
-            ForLoopUnrollMarker marker(ForLoopUnrollMarker::kSamplerArrayIndex);
-            root->traverse(&marker);
-            if (marker.samplerArrayIndexIsFloatLoopIndex())
-            {
-                infoSink.info.prefix(EPrefixError);
-                infoSink.info << "sampler array index is float loop index";
-                success = false;
-            }
+            sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_COPY_TREE);
+            for (size_t i = 0; i < numOtherTargets; ++i)
+                otherRoots.push_back(sh::CopyTree(root));
         }
 
-        // Built-in function emulation needs to happen after validateLimitations pass.
-        if (success && (compileOptions & SH_EMULATE_BUILT_IN_FUNCTIONS))
-            builtInFunctionEmulator.MarkBuiltInFunctionsForEmulation(root);
+        if (success)
+            success = translateTree(root, compileOptions, symbolTable, statistics);
+    }
+
+    for (size_t i = 0; i < numOtherTargets; ++i)
+    {
+        TCompiler *target = otherTargets[i];
+        target->shaderVersion = shaderVersion;
+        target->serializedAST = serializedAST;
+        if (otherRoots.empty())
+        {
+            // Parsing or validation failed.
+            target->infoSink.info << infoSink.info.str();
+            continue;
+        }
+
+        target->mPragma = mPragma;
+        target->extensionBehavior = extensionBehavior;
+
+        ShCompileStatistics *targetStatistics =
+            statistics ? &target->compileStatistics : NULL;
+        double startTime = targetStatistics ? sh::GetCurrentTimeMs() : 0.0;
+        success = target->translateTree(otherRoots[i], compileOptions, symbolTable,
+                                        targetStatistics) && success;
+        if (targetStatistics)
+            targetStatistics->totalTime = sh::GetCurrentTimeMs() - startTime;
+    }
+
+    if (statistics)
+    {
+        ShPoolAllocatorStats poolStatsAfter;
+        allocator.getStats(&poolStatsAfter);
+        statistics->poolAllocationCount =
+            poolStatsAfter.allocationCount - poolStatsBefore.allocationCount;
+        statistics->poolAllocatedBytes =
+            poolStatsAfter.allocatedBytes - poolStatsBefore.allocatedBytes;
+        statistics->symbolCount = symbolTable.getDeclaredSymbolCount() - symbolCountBefore;
+    }
+
+    // Cleanup memory.
+    for (size_t i = 0; i < otherRoots.size(); ++i)
+        intermediate.remove(otherRoots[i]);
+    intermediate.remove(parseContext.treeRoot);
+    SetGlobalParseContext(NULL);
+    SetGlobalTypeTable(NULL);
+    return success;
+}
+
+bool TCompiler::translateTree(TIntermNode* root,
+                              int compileOptions,
+                              const TSymbolTable& parsedSymbols,
+                              ShCompileStatistics* statistics)
+{
+    sh::PassManager passes(root, statistics);
+    bool success = true;
+
+    // Pruning needs to happen after the validation passes so that errors
+    // in dead code are still reported, and before the passes below that
+    // mark or rewrite nodes.
+    if (!unreadVaryings.empty())
+    {
+        sh::RemoveVaryings removeVaryings(unreadVaryings);
+        passes.runMutatingPass(SH_COMPILE_PHASE_PRUNE_DEAD_CODE, &removeVaryings);
+    }
+    if (compileOptions & SH_PRUNE_DEAD_CODE)
+        passes.runMutatingPass(SH_COMPILE_PHASE_PRUNE_DEAD_CODE, sh::PruneDeadCode);
+    if (compileOptions & SH_ELIMINATE_COMMON_SUBEXPRESSIONS)
+        passes.runMutatingPass(SH_COMPILE_PHASE_ELIMINATE_COMMON_SUBEXPRESSIONS,
+                               sh::EliminateCommonSubexpressions);
+
+    // The markup passes only annotate nodes, and run in one walk together
+    // with the collection of variables unless the tree is modified in
+    // between. They need to happen after the validateLimitations pass.
+    bool initGLPosition = (shaderType == GL_VERTEX_SHADER && (compileOptions & SH_INIT_GL_POSITION));
+    bool unfoldShortCircuit = (compileOptions & SH_UNFOLD_SHORT_CIRCUIT) != 0;
+    bool collectVariables = (compileOptions & SH_VARIABLES) != 0;
+    bool fuseCollection = collectVariables && !initGLPosition && !unfoldShortCircuit;
+    ForLoopUnrollMarker integerIndexMarker(ForLoopUnrollMarker::kIntegerIndex);
+    ForLoopUnrollMarker samplerArrayIndexMarker(ForLoopUnrollMarker::kSamplerArrayIndex);
+    sh::CollectVariables collect(&attributes, &outputVariables, &uniforms, &varyings,
+                                 &interfaceBlocks, hashFunction, parsedSymbols);
+    if (compileOptions & SH_UNROLL_FOR_LOOP_WITH_INTEGER_INDEX)
+        passes.addReadOnlyPass(SH_COMPILE_PHASE_UNROLL_MARKUP, &integerIndexMarker);
+    if (compileOptions & SH_UNROLL_FOR_LOOP_WITH_SAMPLER_ARRAY_INDEX)
+        passes.addReadOnlyPass(SH_COMPILE_PHASE_UNROLL_MARKUP, &samplerArrayIndexMarker);
+    if (compileOptions & SH_EMULATE_BUILT_IN_FUNCTIONS)
+        passes.addReadOnlyPass(SH_COMPILE_PHASE_EMULATION,
+                               builtInFunctionEmulator.CreateEmulationMarker());
+    if (compileOptions & SH_CLAMP_INDIRECT_ARRAY_BOUNDS)
+        passes.addReadOnlyPass(SH_COMPILE_PHASE_EMULATION,
+                               arrayBoundsClamper.CreateClampingMarker());
+    if (fuseCollection)
+        passes.addReadOnlyPass(SH_COMPILE_PHASE_COLLECT_VARIABLES, &collect);
+    passes.flush();
+
+    if (samplerArrayIndexMarker.samplerArrayIndexIsFloatLoopIndex())
+    {
+        infoSink.info.prefix(EPrefixError);
+        infoSink.info << "sampler array index is float loop index";
+        success = false;
 
-        // Clamping uniform array bounds needs to happen after validateLimitations pass.
-        if (success && (compileOptions & SH_CLAMP_INDIRECT_ARRAY_BOUNDS))
-            arrayBoundsClamper.MarkIndirectArrayBoundsForClamping(root);
+        attributes.clear();
+        outputVariables.clear();
+        uniforms.clear();
+        varyings.clear();
+        interfaceBlocks.clear();
+    }
 
-        if (success && shaderType == GL_VERTEX_SHADER && (compileOptions & SH_INIT_GL_POSITION))
-            initializeGLPosition(root);
+    if (success && initGLPosition)
+        initializeGLPosition(&passes);
 
-        if (success && (compileOptions & SH_UNFOLD_SHORT_CIRCUIT))
+    if (success && unfoldShortCircuit)
+    {
+        UnfoldShortCircuitAST unfold;
+        passes.runMutatingPass(SH_COMPILE_PHASE_UNFOLD_SHORT_CIRCUIT, &unfold);
+        unfold.updateTree();
+    }
+
+    if (success && collectVariables)
+    {
+        if (!fuseCollection)
         {
-            UnfoldShortCircuitAST unfoldShortCircuit;
-            root->traverse(&unfoldShortCircuit);
-            unfoldShortCircuit.updateTree();
+            passes.addReadOnlyPass(SH_COMPILE_PHASE_COLLECT_VARIABLES, &collect);
+            passes.flush();
         }
 
-        if (success && (compileOptions & SH_VARIABLES))
         {
-            collectVariables(root);
-            if (compileOptions & SH_ENFORCE_PACKING_RESTRICTIONS)
+            sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_COLLECT_VARIABLES);
+            // This is for enforcePackingRestriction().
+            sh::ExpandUniforms(uniforms, &expandedUniforms);
+        }
+        if (compileOptions & SH_ENFORCE_PACKING_RESTRICTIONS)
+        {
+            success = enforcePackingRestrictions();
+            if (!success)
             {
-                success = enforcePackingRestrictions();
-                if (!success)
-                {
-                    infoSink.info.prefix(EPrefixError);
-                    infoSink.info << "too many uniforms";
-                }
+                infoSink.info.prefix(EPrefixError);
+                infoSink.info << "too many uniforms";
             }
-            if (success && shaderType == GL_VERTEX_SHADER &&
-                (compileOptions & SH_INIT_VARYINGS_WITHOUT_STATIC_USE))
-                initializeVaryingsWithoutStaticUse(root);
         }
+        if (success && shaderType == GL_VERTEX_SHADER &&
+            (compileOptions & SH_INIT_VARYINGS_WITHOUT_STATIC_USE))
+            initializeVaryingsWithoutStaticUse(&passes);
+    }
 
-        if (success && (compileOptions & SH_SCALARIZE_VEC_AND_MAT_CONSTRUCTOR_ARGS))
+    if (success && (compileOptions & SH_PACK_UNIFORMS))
+    {
+        TPrecision precision = EbpHigh;
+        if (shaderType == GL_FRAGMENT_SHADER && !fragmentPrecisionHigh)
+            precision = EbpMedium;
+        success = sh::PackUniforms(root, shaderType, shaderVersion, precision,
+                                   maxUniformVectors, &passes, &packedUniforms);
+        if (success)
         {
-            ScalarizeVecAndMatConstructorArgs scalarizer(
-                shaderType, fragmentPrecisionHigh);
-            root->traverse(&scalarizer);
+            packedUniforms.mappedArrayName =
+                TIntermTraverser::hash(packedUniforms.arrayName.c_str(), hashFunction).c_str();
         }
-
-        if (success && (compileOptions & SH_REGENERATE_STRUCT_NAMES))
+        else
         {
-            RegenerateStructNames gen(symbolTable, shaderVersion);
-            root->traverse(&gen);
+            infoSink.info.prefix(EPrefixError);
+            infoSink.info << "too many uniforms to pack";
         }
+    }
+
+    if (success && (compileOptions & SH_SCALARIZE_VEC_AND_MAT_CONSTRUCTOR_ARGS))
+    {
+        ScalarizeVecAndMatConstructorArgs scalarizer(
+            shaderType, fragmentPrecisionHigh);
+        passes.runMutatingPass(SH_COMPILE_PHASE_SCALARIZE, &scalarizer);
+    }
 
-        if (success && (compileOptions & SH_INTERMEDIATE_TREE))
-            intermediate.outputTree(root);
+    if (success && (compileOptions & SH_REGENERATE_STRUCT_NAMES))
+    {
+        RegenerateStructNames gen(parsedSymbols, shaderVersion);
+        passes.runMutatingPass(SH_COMPILE_PHASE_REGENERATE_STRUCT_NAMES, &gen);
+    }
 
-        if (success && (compileOptions & SH_OBJECT_CODE))
-            translate(root);
+    if (success && (compileOptions & SH_INTERMEDIATE_TREE))
+    {
+        TIntermediate intermediate(infoSink);
+        intermediate.outputTree(root);
     }
 
-    // Cleanup memory.
-    intermediate.remove(parseContext.treeRoot);
+    if (success)
+        success = checkMemoryBudget();
+
+    if (success && (compileOptions & SH_OBJECT_CODE))
+    {
+        sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_TRANSLATE);
+        translate(root);
+        success = checkMemoryBudget();
+        if (!success)
+            infoSink.obj.erase();
+    }
+
+    return success;
+}
+
+size_t TCompiler::getMemoryBudget(int compileOptions) const
+{
+    if (!(compileOptions & SH_LIMIT_COMPILE_MEMORY) || compileResources.MaxCompileMemory <= 0)
+        return 0;
+    return static_cast<size_t>(compileResources.MaxCompileMemory);
+}
+
+bool TCompiler::checkMemoryBudget()
+{
+    // The object code is not allocated from the pool, but grows with the
+    // loops that the output unrolls, so it counts against the budget too.
+    TPoolAllocator* pool = GetGlobalPoolAllocator();
+    size_t budget = pool->getBudget();
+    if (budget == 0 || (!pool->budgetExceeded() && static_cast<size_t>(infoSink.obj.size()) <= budget))
+        return true;
+
+    infoSink.info.prefix(EPrefixError);
+    infoSink.info << "compilation exceeds the memory budget of " << budget << " bytes";
+    return false;
+}
+
+bool TCompiler::translateSerializedAST(const char* data, size_t length, int compileOptions)
+{
+    TScopedPoolAllocator scopedAlloc(&allocator);
+    TScopedMemoryBudget scopedBudget(&allocator, getMemoryBudget(compileOptions));
+    clearResults();
+
+    ShCompileStatistics *statistics = NULL;
+    ShPoolAllocatorStats poolStatsBefore;
+    if (compileOptions & SH_COMPILE_STATISTICS)
+    {
+        statistics = &compileStatistics;
+        allocator.getStats(&poolStatsBefore);
+    }
+
+    TTypeTable typeTable;
+    SetGlobalTypeTable(&typeTable);
+
+    std::string sourcePath;
+    bool hasSourcePath = false;
+    TIntermNode* root = NULL;
+    {
+        sh::ScopedCompilePhase phase(statistics, SH_COMPILE_PHASE_DESERIALIZE_TREE);
+        root = deserializeAST(data, length, &sourcePath, &hasSourcePath);
+    }
+
+    // The HLSL output reads the options and the state of the compilation
+    // from the parse context.
+    TIntermediate intermediate(infoSink);
+    TParseContext parseContext(symbolTable, extensionBehavior, intermediate,
+                               shaderType, shaderSpec, compileOptions, true,
+                               hasSourcePath ? sourcePath.c_str() : NULL, infoSink);
+    parseContext.fragmentPrecisionHigh = fragmentPrecisionHigh;
+    parseContext.shaderVersion = shaderVersion;
+    SetGlobalParseContext(&parseContext);
+
+    bool success = (root != NULL);
+    if (success)
+    {
+        if (statistics)
+            statistics->astNodeCount = sh::CountNodes(root);
+        success = translateTree(root, compileOptions, symbolTable, statistics);
+    }
+
+    if (statistics)
+    {
+        ShPoolAllocatorStats poolStatsAfter;
+        allocator.getStats(&poolStatsAfter);
+        statistics->poolAllocationCount =
+            poolStatsAfter.allocationCount - poolStatsBefore.allocationCount;
+        statistics->poolAllocatedBytes =
+            poolStatsAfter.allocatedBytes - poolStatsBefore.allocatedBytes;
+    }
+
+    if (root)
+        intermediate.remove(root);
     SetGlobalParseContext(NULL);
+    SetGlobalTypeTable(NULL);
     return success;
 }
 
-bool TCompiler::InitBuiltInSymbolTable(const ShBuiltInResources &resources)
+void TCompiler::serializeAST(TIntermNode* root, const char* sourcePath)
 {
-    compileResources = resources;
-    setResourceString();
+    BlobWriter writer;
+    writer.writeInt(kSerializedASTFormatVersion);
+    writer.writeInt(ANGLE_SH_VERSION);
+    writer.writeString(getParseConfiguration());
+
+    BlobWriter contents;
+    contents.writeInt(shaderVersion);
+    contents.writeInt(sourcePath != NULL);
+    contents.writeString(sourcePath ? sourcePath : "");
+    contents.writeInt(mPragma.optimize);
+    contents.writeInt(mPragma.debug);
+    contents.writeInt(mPragma.stdgl.invariantAll);
+
+    // The invariance of varyings is restored from the invariant
+    // declarations in the tree.
+    contents.writeInt(static_cast<int>(extensionBehavior.size()));
+    for (TExtensionBehavior::const_iterator iter = extensionBehavior.begin();
+         iter != extensionBehavior.end(); ++iter)
+    {
+        contents.writeString(iter->first);
+        contents.writeInt(iter->second);
+    }
+    if (!sh::SerializeTree(root, &contents))
+        return;
 
-    assert(symbolTable.isEmpty());
-    symbolTable.push();   // COMMON_BUILTINS
-    symbolTable.push();   // ESSL1_BUILTINS
-    symbolTable.push();   // ESSL3_BUILTINS
-
-    TPublicType integer;
-    integer.type = EbtInt;
-    integer.primarySize = 1;
-    integer.secondarySize = 1;
-    integer.array = false;
-
-    TPublicType floatingPoint;
-    floatingPoint.type = EbtFloat;
-    floatingPoint.primarySize = 1;
-    floatingPoint.secondarySize = 1;
-    floatingPoint.array = false;
-
-    TPublicType sampler;
-    sampler.primarySize = 1;
-    sampler.secondarySize = 1;
-    sampler.array = false;
-
-    switch(shaderType)
-    {
-      case GL_FRAGMENT_SHADER:
-        symbolTable.setDefaultPrecision(integer, EbpMedium);
-        break;
-      case GL_VERTEX_SHADER:
-        symbolTable.setDefaultPrecision(integer, EbpHigh);
-        symbolTable.setDefaultPrecision(floatingPoint, EbpHigh);
-        break;
-      default:
-        assert(false && "Language not supported");
+    writer.writeInt(ChecksumSerializedAST(contents.data()));
+    writer.writeString(contents.data());
+    serializedAST = writer.data();
+}
+
+TIntermNode* TCompiler::deserializeAST(const char* data,
+                                       size_t length,
+                                       std::string* sourcePath,
+                                       bool* hasSourcePath)
+{
+    std::string blob(data, length);
+    BlobReader reader(blob);
+    std::string configuration;
+    bool sameVersion = (reader.readInt() == kSerializedASTFormatVersion &&
+                        reader.readInt() == ANGLE_SH_VERSION);
+    reader.readString(&configuration);
+    if (!reader.error() && (!sameVersion || configuration != getParseConfiguration()))
+    {
+        infoSink.info.prefix(EPrefixError);
+        infoSink.info << "serialized AST was created by another compiler version or configuration";
+        return NULL;
+    }
+
+    int checksum = reader.readInt();
+    std::string contents;
+    reader.readString(&contents);
+    if (reader.error() || !reader.endOfData() || checksum != ChecksumSerializedAST(contents))
+    {
+        infoSink.info.prefix(EPrefixError);
+        infoSink.info << "invalid serialized AST";
+        return NULL;
     }
-    // We set defaults for all the sampler types, even those that are
-    // only available if an extension exists.
-    for (int samplerType = EbtGuardSamplerBegin + 1;
-         samplerType < EbtGuardSamplerEnd; ++samplerType)
+
+    BlobReader contentsReader(contents);
+    int version = contentsReader.readInt();
+    *hasSourcePath = (contentsReader.readInt() != 0);
+    contentsReader.readString(sourcePath);
+    TPragma pragma;
+    pragma.optimize = (contentsReader.readInt() != 0);
+    pragma.debug = (contentsReader.readInt() != 0);
+    pragma.stdgl.invariantAll = (contentsReader.readInt() != 0);
+
+    TExtensionBehavior behavior = extensionBehavior;
+    bool validExtensions = true;
+    int extensionCount = contentsReader.readInt();
+    for (int i = 0; i < extensionCount && validExtensions && !contentsReader.error(); ++i)
     {
-        sampler.type = static_cast<TBasicType>(samplerType);
-        symbolTable.setDefaultPrecision(sampler, EbpLow);
+        std::string name;
+        contentsReader.readString(&name);
+        int value = contentsReader.readInt();
+        TExtensionBehavior::iterator iter = behavior.find(name);
+        validExtensions = (iter != behavior.end() && value >= EBhRequire && value <= EBhUndefined);
+        if (validExtensions)
+            iter->second = static_cast<TBehavior>(value);
     }
 
-    InsertBuiltInFunctions(shaderType, shaderSpec, resources, symbolTable);
+    TIntermNode* root = NULL;
+    if (validExtensions && !contentsReader.error())
+        root = sh::DeserializeTree(&contentsReader);
+    TIntermAggregate* globals = root ? root->getAsAggregate() : NULL;
+    if (globals == NULL || !contentsReader.endOfData())
+    {
+        infoSink.info.prefix(EPrefixError);
+        infoSink.info << "invalid serialized AST";
+        return NULL;
+    }
+
+    shaderVersion = version;
+    mPragma = pragma;
+    extensionBehavior = behavior;
+    if (mPragma.stdgl.invariantAll)
+        symbolTable.setGlobalInvariant();
+    TIntermSequence* declarations = globals->getSequence();
+    for (size_t i = 0; i < declarations->size(); ++i)
+    {
+        TIntermAggregate* declaration = (*declarations)[i]->getAsAggregate();
+        if (declaration && declaration->getOp() == EOpInvariantDeclaration)
+        {
+            TIntermSequence* symbols = declaration->getSequence();
+            for (size_t j = 0; j < symbols->size(); ++j)
+            {
+                TIntermSymbol* symbol = (*symbols)[j]->getAsSymbolNode();
+                if (symbol)
+                    symbolTable.addInvariantVarying(symbol->getSymbol());
+            }
+        }
+    }
+    return root;
+}
 
-    IdentifyBuiltIns(shaderType, shaderSpec, resources, symbolTable);
+bool TCompiler::InitBuiltInSymbolTable(const ShBuiltInResources &resources)
+{
+    compileResources = resources;
+    setResourceString();
+
+    assert(symbolTable.isEmpty());
+    builtInSymbolTable = AcquireBuiltInSymbolTable(shaderType, shaderSpec, resources,
+                                                   builtInResourcesString);
+    symbolTable.shareBuiltInLevels(builtInSymbolTable->getSymbolTable());
 
     return true;
 }
@@ -388,6 +1052,8 @@ void TCompiler::setResourceString()
               << ":FragmentPrecisionHigh:" << compileResources.FragmentPrecisionHigh
               << ":MaxExpressionComplexity:" << compileResources.MaxExpressionComplexity
               << ":MaxCallStackDepth:" << compileResources.MaxCallStackDepth
+              << ":MaxUnrolledLoopCost:" << compileResources.MaxUnrolledLoopCost
+              << ":MaxCompileMemory:" << compileResources.MaxCompileMemory
               << ":EXT_frag_depth:" << compileResources.EXT_frag_depth
               << ":EXT_shader_texture_lod:" << compileResources.EXT_shader_texture_lod
               << ":MaxVertexOutputVectors:" << compileResources.MaxVertexOutputVectors
@@ -399,12 +1065,117 @@ void TCompiler::setResourceString()
     builtInResourcesString = strstream.str();
 }
 
+std::string TCompiler::getTranslationCacheKey(const char* const shaderStrings[],
+                                              size_t numStrings,
+                                              int compileOptions) const
+{
+    std::ostringstream key;
+    key << shaderType << ":" << shaderSpec << ":" << outputType << ":" << compileOptions
+        << ":" << clampingStrategy << ":" << reinterpret_cast<size_t>(hashFunction)
+        << builtInResourcesString;
+
+    BlobWriter sources;
+    sources.writeInt(prologue != NULL);
+    if (prologue)
+        sources.writeString(prologue->getSource());
+    for (size_t i = 0; i < numStrings; ++i)
+        sources.writeString(shaderStrings[i]);
+    sources.writeInt(static_cast<int>(unreadVaryings.size()));
+    for (std::set<std::string>::const_iterator iter = unreadVaryings.begin();
+         iter != unreadVaryings.end(); ++iter)
+    {
+        sources.writeString(*iter);
+    }
+
+    return key.str() + sources.data();
+}
+
+void TCompiler::serializeResults(BlobWriter *writer) const
+{
+    writer->writeInt(shaderVersion);
+    writer->writeString(infoSink.info.str());
+    writer->writeString(infoSink.obj.str());
+    writer->writeString(infoSink.debug.str());
+    writer->writeString(serializedAST);
+
+    WriteVariableList(writer, attributes);
+    WriteVariableList(writer, outputVariables);
+    WriteVariableList(writer, uniforms);
+    WriteVariableList(writer, varyings);
+    WriteVariableList(writer, interfaceBlocks);
+
+    writer->writeString(packedUniforms.arrayName);
+    writer->writeString(packedUniforms.mappedArrayName);
+    writer->writeInt(packedUniforms.arraySize);
+    writer->writeInt(static_cast<int>(packedUniforms.placements.size()));
+    for (std::map<std::string, ShVariablePlacement>::const_iterator it = packedUniforms.placements.begin();
+         it != packedUniforms.placements.end(); ++it)
+    {
+        writer->writeString(it->first);
+        writer->writeInt(it->second.row);
+        writer->writeInt(it->second.column);
+        writer->writeInt(it->second.rows);
+    }
+
+    writer->writeInt(static_cast<int>(nameMap.size()));
+    for (NameMap::const_iterator it = nameMap.begin(); it != nameMap.end(); ++it)
+    {
+        writer->writeString(it->first);
+        writer->writeString(it->second);
+    }
+}
+
+void TCompiler::deserializeResults(BlobReader *reader)
+{
+    shaderVersion = reader->readInt();
+
+    std::string log;
+    reader->readString(&log);
+    infoSink.info << log;
+    reader->readString(&log);
+    infoSink.obj << log;
+    reader->readString(&log);
+    infoSink.debug << log;
+    reader->readString(&serializedAST);
+
+    ReadVariableList(reader, &attributes);
+    ReadVariableList(reader, &outputVariables);
+    ReadVariableList(reader, &uniforms);
+    ReadVariableList(reader, &varyings);
+    ReadVariableList(reader, &interfaceBlocks);
+
+    reader->readString(&packedUniforms.arrayName);
+    reader->readString(&packedUniforms.mappedArrayName);
+    packedUniforms.arraySize = reader->readInt();
+    int packedCount = reader->readInt();
+    for (int i = 0; i < packedCount && !reader->error(); ++i)
+    {
+        std::string name;
+        reader->readString(&name);
+        ShVariablePlacement &placement = packedUniforms.placements[name];
+        placement.row = reader->readInt();
+        placement.column = reader->readInt();
+        placement.rows = reader->readInt();
+    }
+
+    int nameCount = reader->readInt();
+    for (int i = 0; i < nameCount && !reader->error(); ++i)
+    {
+        std::string name;
+        std::string hashedName;
+        reader->readString(&name);
+        reader->readString(&hashedName);
+        nameMap[name] = hashedName;
+    }
+}
+
 void TCompiler::clearResults()
 {
     arrayBoundsClamper.Cleanup();
     infoSink.info.erase();
     infoSink.obj.erase();
     infoSink.debug.erase();
+    serializedAST.clear();
 
     attributes.clear();
     outputVariables.clear();
@@ -412,16 +1183,15 @@ void TCompiler::clearResults()
     expandedUniforms.clear();
     varyings.clear();
     interfaceBlocks.clear();
+    packedUniforms.clear();
 
     builtInFunctionEmulator.Cleanup();
 
     nameMap.clear();
 }
 
-bool TCompiler::detectCallDepth(TIntermNode* root, TInfoSink& infoSink, bool limitCallStackDepth)
+bool TCompiler::detectCallDepth(DetectCallDepth& detect)
 {
-    DetectCallDepth detect(infoSink, limitCallStackDepth, maxCallStackDepth);
-    root->traverse(&detect);
     switch (detect.detectCallDepth())
     {
       case DetectCallDepth::kErrorNone:
@@ -444,24 +1214,10 @@ bool TCompiler::detectCallDepth(TIntermNode* root, TInfoSink& infoSink, bool lim
     }
 }
 
-bool TCompiler::validateOutputs(TIntermNode* root)
-{
-    ValidateOutputs validateOutputs(infoSink.info, compileResources.MaxDrawBuffers);
-    root->traverse(&validateOutputs);
-    return (validateOutputs.numErrors() == 0);
-}
-
-void TCompiler::rewriteCSSShader(TIntermNode* root)
+void TCompiler::rewriteCSSShader(sh::PassManager* passes)
 {
     RenameFunction renamer("main(", "css_main(");
-    root->traverse(&renamer);
-}
-
-bool TCompiler::validateLimitations(TIntermNode* root)
-{
-    ValidateLimitations validate(shaderType, infoSink.info);
-    root->traverse(&validate);
-    return validate.numErrors() == 0;
+    passes->runMutatingPass(SH_COMPILE_PHASE_REWRITE_CSS_SHADER, &renamer);
 }
 
 bool TCompiler::enforceTimingRestrictions(TIntermNode* root, bool outputGraph)
@@ -494,11 +1250,8 @@ bool TCompiler::enforceTimingRestrictions(TIntermNode* root, bool outputGraph)
     }
 }
 
-bool TCompiler::limitExpressionComplexity(TIntermNode* root)
+bool TCompiler::limitExpressionComplexity(TIntermNode* root, const TMaxDepthTraverser& traverser)
 {
-    TMaxDepthTraverser traverser(maxExpressionComplexity+1);
-    root->traverse(&traverser);
-
     if (traverser.getMaxDepth() > maxExpressionComplexity)
     {
         infoSink.info << "Expression too complex.";
@@ -533,38 +1286,23 @@ bool TCompiler::enforceVertexShaderTimingRestrictions(TIntermNode* root)
     return restrictor.numErrors() == 0;
 }
 
-void TCompiler::collectVariables(TIntermNode* root)
-{
-    sh::CollectVariables collect(&attributes,
-                                 &outputVariables,
-                                 &uniforms,
-                                 &varyings,
-                                 &interfaceBlocks,
-                                 hashFunction,
-                                 symbolTable);
-    root->traverse(&collect);
-
-    // This is for enforcePackingRestriction().
-    sh::ExpandUniforms(uniforms, &expandedUniforms);
-}
-
 bool TCompiler::enforcePackingRestrictions()
 {
     VariablePacker packer;
     return packer.CheckVariablesWithinPackingLimits(maxUniformVectors, expandedUniforms);
 }
 
-void TCompiler::initializeGLPosition(TIntermNode* root)
+void TCompiler::initializeGLPosition(sh::PassManager* passes)
 {
     InitializeVariables::InitVariableInfoList variables;
     InitializeVariables::InitVariableInfo var(
         "gl_Position", TType(EbtFloat, EbpUndefined, EvqPosition, 4));
     variables.push_back(var);
     InitializeVariables initializer(variables);
-    root->traverse(&initializer);
+    passes->runMutatingPass(SH_COMPILE_PHASE_INITIALIZE_VARIABLES, &initializer);
 }
 
-void TCompiler::initializeVaryingsWithoutStaticUse(TIntermNode* root)
+void TCompiler::initializeVaryingsWithoutStaticUse(sh::PassManager* passes)
 {
     InitializeVariables::InitVariableInfoList variables;
     for (size_t ii = 0; ii < varyings.size(); ++ii)
@@ -586,7 +1324,7 @@ void TCompiler::initializeVaryingsWithoutStaticUse(TIntermNode* root)
         variables.push_back(var);
     }
     InitializeVariables initializer(variables);
-    root->traverse(&initializer);
+    passes->runMutatingPass(SH_COMPILE_PHASE_INITIALIZE_VARIABLES, &initializer);
 }
 
 const TExtensionBehavior& TCompiler::getExtensionBehavior() const
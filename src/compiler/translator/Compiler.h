@@ -18,15 +18,28 @@
 #include "compiler/translator/ExtensionBehavior.h"
 #include "compiler/translator/HashNames.h"
 #include "compiler/translator/InfoSink.h"
+#include "compiler/translator/PackUniforms.h"
 #include "compiler/translator/Pragma.h"
 #include "compiler/translator/SymbolTable.h"
 #include "compiler/translator/VariableInfo.h"
 #include "third_party/compiler/ArrayBoundsClamper.h"
 
+#include <set>
+
+class BlobReader;
+class BlobWriter;
+class DetectCallDepth;
+class TBuiltInSymbolTable;
 class TCompiler;
 class TDependencyGraph;
+class TPrologue;
 class TranslatorHLSL;
 
+namespace sh
+{
+class PassManager;
+}
+
 //
 // Helper function to identify specs that are based on the WebGL spec,
 // like the CSS Shaders spec.
@@ -43,6 +56,8 @@ public:
     virtual TCompiler* getAsCompiler() { return 0; }
     virtual TranslatorHLSL* getAsTranslatorHLSL() { return 0; }
 
+    TPoolAllocator& getPoolAllocator() { return allocator; }
+
 protected:
     // Memory allocator. Allocates and tracks memory required by the compiler.
     // Deallocates all memory when compiler is destructed.
@@ -64,16 +79,41 @@ class TCompiler : public TShHandleBase
     bool compile(const char* const shaderStrings[],
                  size_t numStrings,
                  int compileOptions);
+    // Compiles for this compiler and |otherTargets| at once, parsing and
+    // validating the shader only once. See ShCompileMultipleTargets.
+    bool compileMultipleTargets(const char* const shaderStrings[],
+                                size_t numStrings,
+                                int compileOptions,
+                                TCompiler* const otherTargets[],
+                                size_t numOtherTargets);
+    // Translates the shader from an AST serialized by a compilation with
+    // SH_SERIALIZE_AST. See ShCompileSerializedAST.
+    bool compileSerializedAST(const char* serializedAST, size_t length, int compileOptions);
+
+    // Preprocesses a prologue of directives for the compilations of this
+    // compiler and of those with the same configuration. Returns NULL and
+    // writes the errors to the info log if the prologue is invalid.
+    TPrologue* createPrologue(const char* const prologueStrings[], size_t numStrings);
+    // Makes later compilations start from |prologue|, which may be NULL.
+    // Returns false if the prologue was created for a different
+    // configuration.
+    bool setPrologue(const TPrologue* prologue);
+    // Compiles the last vertex shader of this compiler again without the
+    // varyings that |fragmentShader| does not read. See ShLinkVaryings.
+    bool linkVaryings(const TCompiler* fragmentShader);
 
     // Get results of the last compilation.
     int getShaderVersion() const { return shaderVersion; }
     TInfoSink& getInfoSink() { return infoSink; }
+    const std::string &getSerializedAST() const { return serializedAST; }
+    const ShCompileStatistics &getCompileStatistics() const { return compileStatistics; }
 
     const std::vector<sh::Attribute> &getAttributes() const { return attributes; }
     const std::vector<sh::Attribute> &getOutputVariables() const { return outputVariables; }
     const std::vector<sh::Uniform> &getUniforms() const { return uniforms; }
     const std::vector<sh::Varying> &getVaryings() const { return varyings; }
     const std::vector<sh::InterfaceBlock> &getInterfaceBlocks() const { return interfaceBlocks; }
+    const sh::PackedUniforms &getPackedUniforms() const { return packedUniforms; }
 
     ShHashFunction64 getHashFunction() const { return hashFunction; }
     NameMap& getNameMap() { return nameMap; }
@@ -93,17 +133,16 @@ class TCompiler : public TShHandleBase
     void setResourceString();
     // Clears the results from the previous compilation.
     void clearResults();
-    // Return true if function recursion is detected or call depth exceeded.
-    bool detectCallDepth(TIntermNode* root, TInfoSink& infoSink, bool limitCallStackDepth);
-    // Returns true if a program has no conflicting or missing fragment outputs
-    bool validateOutputs(TIntermNode* root);
+    // Write and read back the results of the last compilation for the
+    // translation cache. Subclasses with additional results extend these.
+    virtual void serializeResults(BlobWriter *writer) const;
+    virtual void deserializeResults(BlobReader *reader);
+    // Returns false and reports the error if |detect|, which has traversed
+    // the tree, found function recursion, a missing main() or a call stack
+    // deeper than allowed.
+    bool detectCallDepth(DetectCallDepth& detect);
     // Rewrites a shader's intermediate tree according to the CSS Shaders spec.
-    void rewriteCSSShader(TIntermNode* root);
-    // Returns true if the given shader does not exceed the minimum
-    // functionality mandated in GLSL 1.0 spec Appendix A.
-    bool validateLimitations(TIntermNode* root);
-    // Collect info for all attribs, uniforms, varyings.
-    void collectVariables(TIntermNode* root);
+    void rewriteCSSShader(sh::PassManager* passes);
     // Translate to object code.
     virtual void translate(TIntermNode* root) = 0;
     // Returns true if, after applying the packing rules in the GLSL 1.017 spec
@@ -113,12 +152,12 @@ class TCompiler : public TShHandleBase
     // of main(). It is to work around a Mac driver where such varyings in a vertex
     // shader may be optimized out incorrectly at compile time, causing a link failure.
     // This function should only be applied to vertex shaders.
-    void initializeVaryingsWithoutStaticUse(TIntermNode* root);
+    void initializeVaryingsWithoutStaticUse(sh::PassManager* passes);
     // Insert gl_Position = vec4(0,0,0,0) to the beginning of main().
     // It is to work around a Linux driver bug where missing this causes compile failure
     // while spec says it is allowed.
     // This function should only be applied to vertex shaders.
-    void initializeGLPosition(TIntermNode* root);
+    void initializeGLPosition(sh::PassManager* passes);
     // Returns true if the shader passes the restrictions that aim to prevent timing attacks.
     bool enforceTimingRestrictions(TIntermNode* root, bool outputGraph);
     // Returns true if the shader does not use samplers.
@@ -126,8 +165,9 @@ class TCompiler : public TShHandleBase
     // Returns true if the shader does not use sampler dependent values to affect control
     // flow or in operations whose time can depend on the input values.
     bool enforceFragmentShaderTimingRestrictions(const TDependencyGraph& graph);
-    // Return true if the maximum expression complexity is below the limit.
-    bool limitExpressionComplexity(TIntermNode* root);
+    // Return true if the maximum expression complexity found by |traverser|,
+    // which has traversed the tree, is below the limit.
+    bool limitExpressionComplexity(TIntermNode* root, const TMaxDepthTraverser& traverser);
     // Get built-in extensions with default behavior.
     const TExtensionBehavior& getExtensionBehavior() const;
     const TPragma& getPragma() const { return mPragma; }
@@ -143,8 +183,67 @@ class TCompiler : public TShHandleBase
     std::vector<sh::ShaderVariable> expandedUniforms;
     std::vector<sh::Varying> varyings;
     std::vector<sh::InterfaceBlock> interfaceBlocks;
+    sh::PackedUniforms packedUniforms;
 
   private:
+    bool compileCached(const char* const shaderStrings[],
+                       size_t numStrings,
+                       int compileOptions);
+    // Parses and validates the shader, and translates the validated tree
+    // for this compiler and for copies of it for |otherTargets|.
+    bool compileUncached(const char* const shaderStrings[],
+                         size_t numStrings,
+                         int compileOptions,
+                         TCompiler* const otherTargets[],
+                         size_t numOtherTargets);
+    // Runs the passes that follow validation, and the translation, over
+    // |root| for this compiler. |parsedSymbols| is the symbol table the
+    // shader was parsed with, and |statistics| may be NULL.
+    bool translateTree(TIntermNode* root,
+                       int compileOptions,
+                       const TSymbolTable& parsedSymbols,
+                       ShCompileStatistics* statistics);
+    // Returns the memory budget of a compilation with |compileOptions|, or
+    // 0 if it has none.
+    size_t getMemoryBudget(int compileOptions) const;
+    // Returns false and reports the error if the current compilation has
+    // used more memory than its budget.
+    bool checkMemoryBudget();
+    // Reads the tree serialized in |data| and translates it.
+    bool translateSerializedAST(const char* data, size_t length, int compileOptions);
+    // Writes the validated tree |root| to serializedAST, along with the
+    // state of the compilation that its translation depends on.
+    void serializeAST(TIntermNode* root, const char* sourcePath);
+    // Reads a tree written by serializeAST() and restores the state of the
+    // compilation. Returns NULL and reports the error if the data is not
+    // valid or was written by a compiler with another configuration.
+    TIntermNode* deserializeAST(const char* data,
+                                size_t length,
+                                std::string* sourcePath,
+                                bool* hasSourcePath);
+    // Returns true if |other| parses shaders exactly as this compiler.
+    bool sharesParseWith(const TCompiler* other) const;
+    // Keeps the sources of a vertex shader compilation for linkVaryings().
+    void setLinkSources(const char* const shaderStrings[],
+                        size_t numStrings,
+                        int compileOptions,
+                        bool success);
+    void setLinkSerializedAST(const char* serializedAST,
+                              size_t length,
+                              int compileOptions,
+                              bool success);
+    // Records the options and result of a compilation for linkVaryings().
+    // Returns true if its sources need to be kept.
+    bool setLinkState(int compileOptions, bool success);
+    // Identifies the compilers that parse shaders alike, and so can share
+    // a prologue or a serialized AST.
+    std::string getParseConfiguration() const;
+    // Returns a key covering the sources, options and all compiler state
+    // that the results of compiling them depend on.
+    std::string getTranslationCacheKey(const char* const shaderStrings[],
+                                       size_t numStrings,
+                                       int compileOptions) const;
+
     sh::GLenum shaderType;
     ShShaderSpec shaderSpec;
     ShShaderOutput outputType;
@@ -157,8 +256,10 @@ class TCompiler : public TShHandleBase
     std::string builtInResourcesString;
 
     // Built-in symbol table for the given language, spec, and resources.
-    // It is preserved from compile-to-compile.
+    // It is preserved from compile-to-compile. Its built-in levels are
+    // shared with other compilers through builtInSymbolTable.
     TSymbolTable symbolTable;
+    TBuiltInSymbolTable *builtInSymbolTable;
     // Built-in extensions with default behavior.
     TExtensionBehavior extensionBehavior;
     bool fragmentPrecisionHigh;
@@ -170,12 +271,32 @@ class TCompiler : public TShHandleBase
     // Results of compilation.
     int shaderVersion;
     TInfoSink infoSink;  // Output sink.
+    std::string serializedAST;
+    ShCompileStatistics compileStatistics;
 
     // name hashing.
     ShHashFunction64 hashFunction;
     NameMap nameMap;
 
     TPragma mPragma;
+
+    // Prologue the compilations start from, or NULL.
+    const TPrologue* prologue;
+
+    // The options and result of the last compilation other than by
+    // linkVaryings(), of a vertex or a fragment shader.
+    int linkCompileOptions;
+    bool linkCompileSucceeded;
+    // The last vertex shader compiled other than by linkVaryings(), with
+    // the varyings it was compiled with.
+    std::vector<std::string> linkSources;
+    // Whether linkSources holds a serialized AST instead of shader strings.
+    bool linkFromSerializedAST;
+    std::vector<sh::Varying> unlinkedVaryings;
+    // Output varyings that the compilation run by linkVaryings() removes.
+    std::set<std::string> unreadVaryings;
+    // Whether the results are those of linkVaryings().
+    bool linked;
 };
 
 //
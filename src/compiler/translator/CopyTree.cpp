@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/CopyTree.h"
+
+#include "compiler/translator/IntermNode.h"
+#include "compiler/translator/compilerdebug.h"
+
+namespace sh
+{
+
+namespace
+{
+
+TIntermNode *CopyNode(TIntermNode *node);
+
+TIntermTyped *CopyTyped(TIntermTyped *node)
+{
+    if (node == NULL)
+        return NULL;
+
+    TIntermNode *copy = CopyNode(node);
+    ASSERT(copy->getAsTyped() != NULL);
+    return copy->getAsTyped();
+}
+
+// |size| is the number of values of the constant.
+TIntermConstantUnion *CopyConstantUnion(TIntermConstantUnion *node, size_t size)
+{
+    ConstantUnion *values = node->getUnionArrayPointer();
+    if (values != NULL)
+    {
+        ConstantUnion *copiedValues = new ConstantUnion[size];
+        for (size_t i = 0; i < size; ++i)
+            copiedValues[i] = values[i];
+        values = copiedValues;
+    }
+
+    TIntermConstantUnion *copy = new TIntermConstantUnion(values, node->getType());
+    copy->setLine(node->getLine());
+    return copy;
+}
+
+TIntermAggregate *CopyAggregate(TIntermAggregate *node)
+{
+    // The copy constructor of aggregates is disallowed, so their fields
+    // are copied one by one.
+    TIntermAggregate *copy = new TIntermAggregate(node->getOp());
+    copy->setType(node->getType());
+    copy->setLine(node->getLine());
+    copy->setName(node->getName());
+    if (node->isUserDefined())
+        copy->setUserDefined();
+    copy->setOptimize(node->getOptimize());
+    copy->setDebug(node->getDebug());
+    if (node->getUseEmulatedFunction())
+        copy->setUseEmulatedFunction();
+
+    TIntermSequence *sequence = node->getSequence();
+    TIntermSequence *copiedSequence = copy->getSequence();
+    copiedSequence->reserve(sequence->size());
+    for (size_t i = 0; i < sequence->size(); ++i)
+        copiedSequence->push_back(CopyNode((*sequence)[i]));
+    return copy;
+}
+
+TIntermNode *CopyNode(TIntermNode *node)
+{
+    if (node == NULL)
+        return NULL;
+
+    if (TIntermSymbol *symbol = node->getAsSymbolNode())
+        return new TIntermSymbol(*symbol);
+
+    if (TIntermRaw *raw = node->getAsRawNode())
+        return new TIntermRaw(*raw);
+
+    if (TIntermConstantUnion *constant = node->getAsConstantUnion())
+        return CopyConstantUnion(constant, constant->getType().getObjectSize());
+
+    if (TIntermBinary *binary = node->getAsBinaryNode())
+    {
+        TIntermBinary *copy = new TIntermBinary(*binary);
+        copy->setLeft(CopyTyped(binary->getLeft()));
+
+        // The indices of fields have the type of the field, but a single
+        // value.
+        TIntermConstantUnion *fieldIndex = binary->getRight()->getAsConstantUnion();
+        if (fieldIndex && (binary->getOp() == EOpIndexDirectStruct ||
+                           binary->getOp() == EOpIndexDirectInterfaceBlock))
+            copy->setRight(CopyConstantUnion(fieldIndex, 1));
+        else
+            copy->setRight(CopyTyped(binary->getRight()));
+        return copy;
+    }
+
+    if (TIntermUnary *unary = node->getAsUnaryNode())
+    {
+        TIntermUnary *copy = new TIntermUnary(*unary);
+        copy->setOperand(CopyTyped(unary->getOperand()));
+        return copy;
+    }
+
+    if (TIntermAggregate *aggregate = node->getAsAggregate())
+        return CopyAggregate(aggregate);
+
+    if (TIntermSelection *selection = node->getAsSelectionNode())
+    {
+        TIntermSelection *copy = new TIntermSelection(
+            CopyTyped(selection->getCondition()->getAsTyped()),
+            CopyNode(selection->getTrueBlock()), CopyNode(selection->getFalseBlock()),
+            selection->getType());
+        copy->setLine(selection->getLine());
+        return copy;
+    }
+
+    if (TIntermLoop *loop = node->getAsLoopNode())
+    {
+        TIntermLoop *copy = new TIntermLoop(
+            loop->getType(), CopyNode(loop->getInit()), CopyTyped(loop->getCondition()),
+            CopyTyped(loop->getExpression()), CopyNode(loop->getBody()));
+        copy->setUnrollFlag(loop->getUnrollFlag());
+        copy->setLine(loop->getLine());
+        return copy;
+    }
+
+    if (TIntermBranch *branch = node->getAsBranchNode())
+    {
+        TIntermBranch *copy = new TIntermBranch(branch->getFlowOp(),
+                                                CopyTyped(branch->getExpression()));
+        copy->setLine(branch->getLine());
+        return copy;
+    }
+
+    UNREACHABLE();
+    return NULL;
+}
+
+}  // anonymous namespace
+
+TIntermNode *CopyTree(TIntermNode *root)
+{
+    return CopyNode(root);
+}
+
+}
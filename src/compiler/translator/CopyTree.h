@@ -0,0 +1,26 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// CopyTree.h: Deep copy of an intermediate tree.
+//
+
+#ifndef COMPILER_COPY_TREE_H_
+#define COMPILER_COPY_TREE_H_
+
+class TIntermNode;
+
+namespace sh
+{
+
+// Returns a copy of the tree under |root|, allocated from the current pool.
+// Every node is copied together with its line, its annotations and the
+// values of its constants, so that passes may modify the copy and the
+// original independently. The copies share the types of the original
+// nodes, which are never modified.
+TIntermNode *CopyTree(TIntermNode *root);
+
+}
+
+#endif // COMPILER_COPY_TREE_H_
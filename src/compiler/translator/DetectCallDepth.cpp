@@ -64,6 +64,14 @@ int DetectCallDepth::FunctionNode::detectCallDepth(DetectCallDepth* detectCallDe
     return maxDepth;
 }
 
+void DetectCallDepth::FunctionNode::addReachableFunctions(std::set<TString>* names) const
+{
+    if (!names->insert(name).second)
+        return;
+    for (size_t i = 0; i < callees.size(); ++i)
+        callees[i]->addReachableFunctions(names);
+}
+
 void DetectCallDepth::FunctionNode::reset()
 {
     visit = PreVisit;
@@ -173,6 +181,13 @@ DetectCallDepth::ErrorCode DetectCallDepth::detectCallDepth()
     return kErrorNone;
 }
 
+void DetectCallDepth::getFunctionsCalledFromMain(std::set<TString>* names)
+{
+    FunctionNode* main = findFunctionByName("main(");
+    if (main != NULL)
+        main->addReachableFunctions(names);
+}
+
 DetectCallDepth::FunctionNode* DetectCallDepth::findFunctionByName(
     const TString& name)
 {
@@ -8,6 +8,8 @@
 #define COMPILER_DETECT_RECURSION_H_
 
 #include <limits.h>
+#include <set>
+
 #include "compiler/translator/IntermNode.h"
 #include "compiler/translator/VariableInfo.h"
 
@@ -32,6 +34,10 @@ public:
 
     ErrorCode detectCallDepth();
 
+    // Collects the mangled names of main() and of all the functions it
+    // calls, directly or indirectly.
+    void getFunctionsCalledFromMain(std::set<TString>* names);
+
 private:
     class FunctionNode {
     public:
@@ -47,6 +53,9 @@ private:
         // Returns kInifinityCallDepth if recursive function calls are detected.
         int detectCallDepth(DetectCallDepth* detectCallDepth, int depth);
 
+        // Adds the name of this function and of its callees to names.
+        void addReachableFunctions(std::set<TString>* names) const;
+
         // Reset state.
         void reset();
 
@@ -0,0 +1,1111 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// EliminateCommonSubexpressions.cpp: Implementation for tree transform that
+//   computes repeated and loop-invariant expressions once.
+//
+
+#include "compiler/translator/EliminateCommonSubexpressions.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "compiler/translator/SymbolTable.h"
+#include "compiler/translator/compilerdebug.h"
+
+namespace sh
+{
+
+namespace
+{
+
+typedef std::map<TString, std::vector<TQualifier> > ParameterQualifierMap;
+
+// Returns the variable that an l-value expression such as "v.x" or
+// "a[i].f" writes to, or NULL if it is not a plain variable.
+TIntermSymbol *GetBaseSymbol(TIntermNode *node)
+{
+    while (TIntermBinary *binary = node->getAsBinaryNode())
+    {
+        switch (binary->getOp())
+        {
+          case EOpIndexDirect:
+          case EOpIndexIndirect:
+          case EOpIndexDirectStruct:
+          case EOpIndexDirectInterfaceBlock:
+          case EOpVectorSwizzle:
+            node = binary->getLeft();
+            break;
+          default:
+            return NULL;
+        }
+    }
+    return node->getAsSymbolNode();
+}
+
+// Returns true if a call of a user-defined function may write the variable,
+// other than through its arguments.
+bool IsWritableByCalls(TQualifier qualifier)
+{
+    switch (qualifier)
+    {
+      case EvqTemporary:
+      case EvqIn:
+      case EvqOut:
+      case EvqInOut:
+      case EvqConstReadOnly:
+      case EvqConst:
+      case EvqAttribute:
+      case EvqVaryingIn:
+      case EvqInvariantVaryingIn:
+      case EvqUniform:
+      case EvqVertexIn:
+      case EvqFragmentIn:
+      case EvqFragCoord:
+      case EvqFrontFacing:
+      case EvqPointCoord:
+      case EvqSmoothIn:
+      case EvqFlatIn:
+      case EvqCentroidIn:
+        return false;
+      default:
+        return true;
+    }
+}
+
+// Temporary variables are only made for the types that can be declared
+// without a precision qualifier being added.
+bool IsTemporaryType(const TType &type)
+{
+    if (type.isArray() || type.getStruct() != NULL)
+        return false;
+
+    switch (type.getBasicType())
+    {
+      case EbtBool:
+        return true;
+      case EbtFloat:
+      case EbtInt:
+      case EbtUInt:
+        return type.getPrecision() != EbpUndefined;
+      default:
+        return false;
+    }
+}
+
+// Writes the parts of a type that values are matched on.
+void WriteTypeKey(std::ostringstream &key, const TType &type)
+{
+    key << type.getBasicType() << "." << type.getNominalSize() << "." << type.getSecondarySize()
+        << "." << type.getPrecision() << "." << type.getStruct();
+    if (type.isArray())
+        key << "[" << type.getArraySize() << "]";
+}
+
+bool IsLeaf(TIntermNode *node)
+{
+    return node->getAsSymbolNode() != NULL || node->getAsConstantUnion() != NULL;
+}
+
+// Collects the variables that a subtree may write, and whether it calls
+// user-defined functions. The target of |ignored|, the assignment of a
+// statement that is done after all its reads, is not collected.
+class WriteTraverser : public TIntermTraverser
+{
+  public:
+    WriteTraverser(const ParameterQualifierMap &parameters, std::set<int> *written,
+                   TIntermNode *ignored)
+        : mParameters(parameters),
+          mWritten(written),
+          mIgnored(ignored),
+          mCallsUserFunctions(false)
+    {
+    }
+
+    bool callsUserFunctions() const { return mCallsUserFunctions; }
+
+  protected:
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        if ((node->isAssignment() || node->getOp() == EOpInitialize) && node != mIgnored)
+            record(node->getLeft());
+        return true;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        if (node->isAssignment())
+            record(node->getOperand());
+        return true;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        TIntermSequence *sequence = node->getSequence();
+        if (node->getOp() == EOpDeclaration)
+        {
+            // Declarations without an initializer start a new value.
+            for (size_t i = 0; i < sequence->size(); ++i)
+            {
+                if ((*sequence)[i]->getAsSymbolNode())
+                    record((*sequence)[i]);
+            }
+        }
+        else if (node->getOp() == EOpFunctionCall && node->isUserDefined())
+        {
+            mCallsUserFunctions = true;
+            ParameterQualifierMap::const_iterator parameters = mParameters.find(node->getName());
+            for (size_t i = 0; i < sequence->size(); ++i)
+            {
+                if (parameters == mParameters.end() || i >= parameters->second.size() ||
+                    parameters->second[i] == EvqOut || parameters->second[i] == EvqInOut)
+                {
+                    record((*sequence)[i]);
+                }
+            }
+        }
+        return true;
+    }
+
+  private:
+    void record(TIntermNode *node)
+    {
+        TIntermSymbol *symbol = GetBaseSymbol(node);
+        if (symbol != NULL)
+            mWritten->insert(symbol->getId());
+    }
+
+    const ParameterQualifierMap &mParameters;
+    std::set<int> *mWritten;
+    TIntermNode *mIgnored;
+    bool mCallsUserFunctions;
+
+    DISALLOW_COPY_AND_ASSIGN(WriteTraverser);
+};
+
+// Collects the names used in the shader, which the temporary variables must
+// not hide.
+class NameTraverser : public TIntermTraverser
+{
+  public:
+    NameTraverser(std::set<TString> *names)
+        : mNames(names)
+    {
+    }
+
+  protected:
+    virtual void visitSymbol(TIntermSymbol *node)
+    {
+        mNames->insert(node->getSymbol());
+        if (node->getType().getStruct() != NULL)
+            mNames->insert(node->getType().getStruct()->name());
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        if (!node->getName().empty())
+            mNames->insert(TFunction::unmangleName(node->getName()));
+        return true;
+    }
+
+  private:
+    std::set<TString> *mNames;
+
+    DISALLOW_COPY_AND_ASSIGN(NameTraverser);
+};
+
+// Finds the uses of the temporary variables made by ExpressionOptimizer.
+class TemporaryUseTraverser : public TIntermTraverser
+{
+  public:
+    struct Use
+    {
+        TIntermSymbol *symbol;
+        TIntermNode *parent;
+    };
+    typedef std::map<TString, std::vector<Use> > UseMap;
+
+    TemporaryUseTraverser(const std::set<TString> &temporaries)
+        : mTemporaries(temporaries)
+    {
+    }
+
+    const UseMap &getUses() const { return mUses; }
+
+  protected:
+    virtual void visitSymbol(TIntermSymbol *node)
+    {
+        if (mTemporaries.count(node->getSymbol()) == 0)
+            return;
+
+        TIntermBinary *initialize = getParentNode()->getAsBinaryNode();
+        if (initialize && initialize->getOp() == EOpInitialize && initialize->getLeft() == node)
+            return;
+
+        Use use;
+        use.symbol = node;
+        use.parent = getParentNode();
+        mUses[node->getSymbol()].push_back(use);
+    }
+
+  private:
+    const std::set<TString> &mTemporaries;
+    UseMap mUses;
+
+    DISALLOW_COPY_AND_ASSIGN(TemporaryUseTraverser);
+};
+
+class ExpressionOptimizer
+{
+  public:
+    ExpressionOptimizer(const ParameterQualifierMap &parameters, const std::set<TString> &names)
+        : mParameters(parameters),
+          mShaderNames(names),
+          mNames(names),
+          mNextVersion(0),
+          mBlock(NULL),
+          mStatement(NULL),
+          mUnstableCalls(false),
+          mConditional(false),
+          mFrozen(false),
+          mChainStart(0)
+    {
+    }
+
+    void optimizeFunction(TIntermAggregate *body)
+    {
+        mChainStart = 0;
+        processBlock(body);
+        ASSERT(mScopes.empty() && mLoops.empty() && mPending.empty());
+    }
+
+    // Puts back the temporaries that end up with a single use at the place
+    // of the expression they replaced, removes the unused ones, and numbers
+    // the others in the order they were made.
+    void removeRedundantTemporaries(TIntermNode *root);
+
+  private:
+    // The number of the value of an expression, or -1 if the expression
+    // cannot be matched, and the innermost loop that writes a variable
+    // it reads, or -1.
+    struct Value
+    {
+        Value(int number, int loop)
+            : number(number),
+              loop(loop),
+              hoistable(false)
+        {
+        }
+
+        int number;
+        int loop;
+        // The expression is invariant in a loop, and is moved out of it
+        // unless its parent can be moved with it.
+        bool hoistable;
+    };
+
+    struct Hoistable
+    {
+        TIntermTyped *node;
+        Value value;
+    };
+    typedef std::vector<Hoistable> HoistableList;
+
+    struct Temporary
+    {
+        TString name;
+        TType type;
+        TIntermAggregate *declaration;
+        TIntermAggregate *block;
+        TIntermSymbol *firstUse;
+        int loop;
+        bool hoisted;
+    };
+
+    // The first evaluation of a value that is available at the current
+    // position, and the temporary that holds it once it is used again.
+    struct Entry
+    {
+        TIntermTyped *node;
+        TIntermNode *parent;
+        TIntermAggregate *block;
+        TIntermNode *statement;
+        int loop;
+        int temporary;
+    };
+
+    struct Loop
+    {
+        TIntermLoop *node;
+        // The block that the loop is a statement of, or NULL.
+        TIntermAggregate *block;
+        size_t scope;
+        std::set<int> written;
+        bool callsUserFunctions;
+    };
+
+    enum Position
+    {
+        kUnconditional,
+        kConditional,
+        kFrozen
+    };
+
+    void processBlock(TIntermAggregate *block);
+    void processStatement(TIntermAggregate *block, TIntermNode *statement);
+    void processSubStatement(TIntermNode *statement);
+    void processSimpleStatement(TIntermNode *statement);
+    void processSelection(TIntermSelection *selection);
+    void processLoop(TIntermLoop *loop);
+
+    Value processExpression(TIntermTyped *node, TIntermNode *parent);
+    Value processOperand(TIntermTyped *node, TIntermNode *parent, Position position,
+                         HoistableList *hoistables);
+    Value symbolValue(TIntermSymbol *node);
+    Value finishValue(TIntermTyped *node, TIntermNode *parent, const std::string &key,
+                      int loop, bool candidate, HoistableList *hoistables);
+
+    int getNumber(const std::string &key);
+    int hoistTarget(int loop) const;
+    void hoist(TIntermTyped *node, TIntermNode *parent, const Value &value);
+    void hoistAll(const HoistableList &hoistables, TIntermNode *parent);
+    Value useEntry(int number, TIntermTyped *node, TIntermNode *parent);
+    int createTemporary(TIntermTyped *expression, TIntermAggregate *block,
+                        TIntermNode *statement, int loop, bool hoisted);
+    TIntermSymbol *createUse(int temporary, const TSourceLoc &line);
+    void startStatement(TIntermNode *statement, TIntermNode *ignored);
+    void writeVariables(TIntermNode *node);
+    void bumpVersions(const std::set<int> &written, bool callsUserFunctions);
+
+    const ParameterQualifierMap &mParameters;
+    const std::set<TString> &mShaderNames;
+    // The shader names and the names given to temporaries so far.
+    std::set<TString> mNames;
+
+    std::map<std::string, int> mNumbers;
+    std::map<int, int> mVersions;
+    std::set<int> mWritableByCalls;
+    int mNextVersion;
+
+    std::map<int, Entry> mEntries;
+    std::vector<std::vector<int> > mScopes;
+    std::vector<Loop> mLoops;
+    std::vector<Temporary> mTemporaries;
+    // Declarations of temporaries to insert before statements, once the
+    // block of the statement is processed.
+    std::map<TIntermNode *, TIntermSequence> mPending;
+
+    // The statement being processed, and the block it is in, or NULL if
+    // new declarations cannot be inserted before it.
+    TIntermAggregate *mBlock;
+    TIntermNode *mStatement;
+    // Variables that the current statement writes before its last read.
+    std::set<int> mUnstable;
+    bool mUnstableCalls;
+    bool mConditional;
+    bool mFrozen;
+    // The outermost loop that evaluates the current position in all its
+    // iterations.
+    size_t mChainStart;
+
+    DISALLOW_COPY_AND_ASSIGN(ExpressionOptimizer);
+};
+
+void ExpressionOptimizer::processBlock(TIntermAggregate *block)
+{
+    mScopes.push_back(std::vector<int>());
+
+    TIntermSequence *sequence = block->getSequence();
+    for (size_t i = 0; i < sequence->size(); ++i)
+        processStatement(block, (*sequence)[i]);
+
+    const std::vector<int> &scope = mScopes.back();
+    for (size_t i = 0; i < scope.size(); ++i)
+        mEntries.erase(scope[i]);
+    mScopes.pop_back();
+
+    if (mPending.empty())
+        return;
+    TIntermSequence statements;
+    statements.reserve(sequence->size());
+    for (size_t i = 0; i < sequence->size(); ++i)
+    {
+        std::map<TIntermNode *, TIntermSequence>::iterator pending = mPending.find((*sequence)[i]);
+        if (pending != mPending.end())
+        {
+            statements.insert(statements.end(), pending->second.begin(), pending->second.end());
+            mPending.erase(pending);
+        }
+        statements.push_back((*sequence)[i]);
+    }
+    sequence->swap(statements);
+}
+
+void ExpressionOptimizer::processStatement(TIntermAggregate *block, TIntermNode *statement)
+{
+    mBlock = block;
+    mStatement = statement;
+
+    TIntermAggregate *aggregate = statement->getAsAggregate();
+    TIntermSelection *selection = statement->getAsSelectionNode();
+    if (aggregate && aggregate->getOp() == EOpSequence)
+        processBlock(aggregate);
+    else if (TIntermLoop *loop = statement->getAsLoopNode())
+        processLoop(loop);
+    else if (selection && !selection->usesTernaryOperator())
+        processSelection(selection);
+    else
+        processSimpleStatement(statement);
+}
+
+// Processes a statement that is not in a block, such as the body of an
+// if-statement without braces, in a scope of its own.
+void ExpressionOptimizer::processSubStatement(TIntermNode *statement)
+{
+    if (statement == NULL)
+        return;
+
+    TIntermAggregate *block = statement->getAsAggregate();
+    if (block && block->getOp() == EOpSequence)
+    {
+        processBlock(block);
+    }
+    else
+    {
+        mScopes.push_back(std::vector<int>());
+        processStatement(NULL, statement);
+        const std::vector<int> &scope = mScopes.back();
+        for (size_t i = 0; i < scope.size(); ++i)
+            mEntries.erase(scope[i]);
+        mScopes.pop_back();
+    }
+}
+
+void ExpressionOptimizer::processSimpleStatement(TIntermNode *statement)
+{
+    // The target of an assignment or an initialization that makes up the
+    // whole statement is written after the reads of the statement.
+    TIntermNode *ignored = NULL;
+    TIntermBinary *binary = statement->getAsBinaryNode();
+    TIntermAggregate *aggregate = statement->getAsAggregate();
+    if (binary && binary->isAssignment())
+        ignored = binary;
+    else if (aggregate && aggregate->getOp() == EOpDeclaration &&
+             aggregate->getSequence()->size() == 1)
+        ignored = (*aggregate->getSequence())[0];
+    startStatement(statement, ignored);
+
+    if (aggregate && aggregate->getOp() == EOpDeclaration)
+    {
+        TIntermSequence *declarators = aggregate->getSequence();
+        for (size_t i = 0; i < declarators->size(); ++i)
+        {
+            TIntermBinary *initialize = (*declarators)[i]->getAsBinaryNode();
+            if (initialize == NULL)
+                continue;
+            Value value = processExpression(initialize->getRight(), initialize);
+            if (value.hoistable)
+                hoist(initialize->getRight(), initialize, value);
+        }
+    }
+    else if (TIntermBranch *branch = statement->getAsBranchNode())
+    {
+        if (branch->getExpression())
+        {
+            Value value = processExpression(branch->getExpression(), branch);
+            if (value.hoistable)
+                hoist(branch->getExpression(), branch, value);
+        }
+    }
+    else if (TIntermTyped *expression = statement->getAsTyped())
+    {
+        // The statement itself is never replaced, as declarations are
+        // inserted before it.
+        processExpression(expression, mBlock);
+    }
+
+    writeVariables(statement);
+}
+
+void ExpressionOptimizer::processSelection(TIntermSelection *selection)
+{
+    TIntermTyped *condition = selection->getCondition()->getAsTyped();
+    startStatement(condition, NULL);
+    Value value = processExpression(condition, selection);
+    if (value.hoistable)
+        hoist(condition, selection, value);
+    writeVariables(selection->getCondition());
+
+    // Only a part of the iterations of the loops around the selection
+    // execute its branches.
+    size_t chainStart = mChainStart;
+    mChainStart = mLoops.size();
+    processSubStatement(selection->getTrueBlock());
+    processSubStatement(selection->getFalseBlock());
+    mChainStart = chainStart;
+
+    writeVariables(selection);
+}
+
+void ExpressionOptimizer::processLoop(TIntermLoop *loop)
+{
+    Loop frame;
+    frame.node = loop;
+    frame.block = mBlock;
+    frame.scope = mScopes.size() - 1;
+    WriteTraverser writes(mParameters, &frame.written, NULL);
+    loop->traverse(&writes);
+    frame.callsUserFunctions = writes.callsUserFunctions();
+
+    // The values that the loop writes differ in each iteration. The header
+    // of the loop is left as it is.
+    bumpVersions(frame.written, frame.callsUserFunctions);
+    mLoops.push_back(frame);
+    processSubStatement(loop->getBody());
+    mLoops.pop_back();
+    bumpVersions(frame.written, frame.callsUserFunctions);
+}
+
+ExpressionOptimizer::Value ExpressionOptimizer::processOperand(
+    TIntermTyped *node, TIntermNode *parent, Position position, HoistableList *hoistables)
+{
+    if (node == NULL)
+        return Value(-1, -1);
+
+    bool conditional = mConditional;
+    bool frozen = mFrozen;
+    mConditional = mConditional || position == kConditional;
+    mFrozen = mFrozen || position == kFrozen;
+    Value value = processExpression(node, parent);
+    mConditional = conditional;
+    mFrozen = frozen;
+
+    if (value.hoistable)
+    {
+        Hoistable hoistable = { node, value };
+        hoistables->push_back(hoistable);
+    }
+    return value;
+}
+
+ExpressionOptimizer::Value ExpressionOptimizer::processExpression(TIntermTyped *node,
+                                                                   TIntermNode *parent)
+{
+    std::ostringstream key;
+    HoistableList hoistables;
+
+    if (TIntermSymbol *symbol = node->getAsSymbolNode())
+        return symbolValue(symbol);
+
+    if (TIntermConstantUnion *constant = node->getAsConstantUnion())
+    {
+        const ConstantUnion *values = constant->getUnionArrayPointer();
+        if (values == NULL)
+            return Value(-1, -1);
+        // The indices of fields have the type of the field, but a single
+        // value.
+        size_t size = node->getType().getObjectSize();
+        TIntermBinary *parentBinary = parent ? parent->getAsBinaryNode() : NULL;
+        if (parentBinary && parentBinary->getRight() == node &&
+            (parentBinary->getOp() == EOpIndexDirectStruct ||
+             parentBinary->getOp() == EOpIndexDirectInterfaceBlock))
+        {
+            size = 1;
+        }
+        key << "c";
+        WriteTypeKey(key, node->getType());
+        for (size_t i = 0; i < size; ++i)
+        {
+            switch (values[i].getType())
+            {
+              case EbtFloat:
+                {
+                    float f = values[i].getFConst();
+                    unsigned int bits = 0;
+                    memcpy(&bits, &f, sizeof(bits));
+                    key << "," << bits;
+                }
+                break;
+              case EbtInt:
+                key << "," << values[i].getIConst();
+                break;
+              case EbtUInt:
+                key << "," << values[i].getUConst();
+                break;
+              case EbtBool:
+                key << "," << values[i].getBConst();
+                break;
+              default:
+                return Value(-1, -1);
+            }
+        }
+        return Value(getNumber(key.str()), -1);
+    }
+
+    WriteTypeKey(key, node->getType());
+
+    if (TIntermBinary *binary = node->getAsBinaryNode())
+    {
+        TOperator op = binary->getOp();
+        Position rightPosition = kUnconditional;
+        bool candidate = true;
+        bool opaque = binary->isAssignment() || op == EOpComma;
+        switch (op)
+        {
+          case EOpLogicalAnd:
+          case EOpLogicalOr:
+            rightPosition = kConditional;
+            opaque = true;
+            break;
+          case EOpIndexIndirect:
+            // The index keeps its form, which may be restricted.
+            rightPosition = kFrozen;
+            candidate = false;
+            break;
+          case EOpIndexDirect:
+          case EOpIndexDirectStruct:
+          case EOpIndexDirectInterfaceBlock:
+          case EOpVectorSwizzle:
+            candidate = false;
+            break;
+          default:
+            break;
+        }
+
+        Value left = processOperand(binary->getLeft(), binary, kUnconditional, &hoistables);
+        Value right = processOperand(binary->getRight(), binary, rightPosition, &hoistables);
+        if (opaque || left.number < 0 || right.number < 0)
+        {
+            hoistAll(hoistables, binary);
+            return Value(-1, -1);
+        }
+        key << "b" << op << ":" << left.number << "," << right.number;
+        return finishValue(node, parent, key.str(), std::max(left.loop, right.loop),
+                           candidate, &hoistables);
+    }
+
+    if (TIntermUnary *unary = node->getAsUnaryNode())
+    {
+        Value operand = processOperand(unary->getOperand(), unary, kUnconditional, &hoistables);
+        if (unary->isAssignment() || operand.number < 0)
+        {
+            hoistAll(hoistables, unary);
+            return Value(-1, -1);
+        }
+        // Built-in functions of one argument are unary operators too. The
+        // other operators are only worth a temporary for a computed operand.
+        bool candidate = unary->getOp() >= EOpRadians || !IsLeaf(unary->getOperand());
+        key << "u" << unary->getOp() << ":" << operand.number;
+        return finishValue(node, parent, key.str(), operand.loop, candidate, &hoistables);
+    }
+
+    if (TIntermAggregate *aggregate = node->getAsAggregate())
+    {
+        TOperator op = aggregate->getOp();
+        bool opaque = false;
+        bool candidate = false;
+        if (op == EOpFunctionCall)
+        {
+            opaque = aggregate->isUserDefined();
+            candidate = true;
+        }
+        else if (op >= EOpRadians && op <= EOpAll)
+        {
+            candidate = true;
+        }
+        else if (op != EOpSequence && !(op >= EOpConstructInt && op <= EOpConstructStruct))
+        {
+            opaque = true;
+        }
+
+        key << "a" << op << aggregate->getName() << ":";
+        int loop = -1;
+        TIntermSequence *sequence = aggregate->getSequence();
+        for (size_t i = 0; i < sequence->size(); ++i)
+        {
+            TIntermTyped *argument = (*sequence)[i]->getAsTyped();
+            Value value = processOperand(argument, aggregate, kUnconditional, &hoistables);
+            if (value.number < 0)
+                opaque = true;
+            key << value.number << ",";
+            loop = std::max(loop, value.loop);
+        }
+        if (opaque)
+        {
+            hoistAll(hoistables, aggregate);
+            return Value(-1, -1);
+        }
+        return finishValue(node, parent, key.str(), loop, candidate, &hoistables);
+    }
+
+    if (TIntermSelection *selection = node->getAsSelectionNode())
+    {
+        processOperand(selection->getCondition()->getAsTyped(), selection, kUnconditional, &hoistables);
+        processOperand(selection->getTrueBlock()->getAsTyped(), selection, kConditional,
+                       &hoistables);
+        processOperand(selection->getFalseBlock()->getAsTyped(), selection, kConditional,
+                       &hoistables);
+        hoistAll(hoistables, selection);
+        return Value(-1, -1);
+    }
+
+    return Value(-1, -1);
+}
+
+ExpressionOptimizer::Value ExpressionOptimizer::symbolValue(TIntermSymbol *node)
+{
+    int id = node->getId();
+    TQualifier qualifier = node->getQualifier();
+    bool writableByCalls = IsWritableByCalls(qualifier);
+    if (id <= 0 || mUnstable.count(id) > 0 || (mUnstableCalls && writableByCalls))
+        return Value(-1, -1);
+    if (writableByCalls)
+        mWritableByCalls.insert(id);
+
+    int loop = -1;
+    for (int i = static_cast<int>(mLoops.size()) - 1; i >= 0 && loop < 0; --i)
+    {
+        if (mLoops[i].written.count(id) > 0 ||
+            (mLoops[i].callsUserFunctions && writableByCalls))
+        {
+            loop = i;
+        }
+    }
+
+    std::ostringstream key;
+    key << "s" << id << ":" << mVersions[id];
+    return Value(getNumber(key.str()), loop);
+}
+
+ExpressionOptimizer::Value ExpressionOptimizer::finishValue(
+    TIntermTyped *node, TIntermNode *parent, const std::string &key, int loop,
+    bool candidate, HoistableList *hoistables)
+{
+    Value value(getNumber(key), loop);
+    if (!candidate || mFrozen || node == mStatement || !IsTemporaryType(node->getType()))
+    {
+        hoistAll(*hoistables, node);
+        return value;
+    }
+
+    std::map<int, Entry>::iterator entry = mEntries.find(value.number);
+    if (entry != mEntries.end())
+        return useEntry(value.number, node, parent);
+
+    if (mConditional)
+    {
+        hoistAll(*hoistables, node);
+        return value;
+    }
+
+    // An invariant expression is moved out of the loop together with the
+    // invariant parts of it.
+    int target = hoistTarget(loop);
+    if (target >= 0)
+    {
+        HoistableList deeper;
+        for (size_t i = 0; i < hoistables->size(); ++i)
+        {
+            if (hoistTarget((*hoistables)[i].value.loop) != target)
+                deeper.push_back((*hoistables)[i]);
+        }
+        hoistAll(deeper, node);
+        value.hoistable = true;
+        return value;
+    }
+
+    hoistAll(*hoistables, node);
+    if (mBlock != NULL)
+    {
+        Entry newEntry;
+        newEntry.node = node;
+        newEntry.parent = parent;
+        newEntry.block = mBlock;
+        newEntry.statement = mStatement;
+        newEntry.loop = static_cast<int>(mLoops.size()) - 1;
+        newEntry.temporary = -1;
+        mEntries[value.number] = newEntry;
+        mScopes.back().push_back(value.number);
+    }
+    return value;
+}
+
+int ExpressionOptimizer::getNumber(const std::string &key)
+{
+    std::map<std::string, int>::iterator number = mNumbers.find(key);
+    if (number != mNumbers.end())
+        return number->second;
+
+    int newNumber = static_cast<int>(mNumbers.size());
+    mNumbers[key] = newNumber;
+    return newNumber;
+}
+
+// Returns the outermost loop that an expression whose innermost writing
+// loop is |loop| can be moved out of, or -1.
+int ExpressionOptimizer::hoistTarget(int loop) const
+{
+    for (size_t i = std::max(static_cast<size_t>(loop + 1), mChainStart); i < mLoops.size(); ++i)
+    {
+        if (mLoops[i].block != NULL)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void ExpressionOptimizer::hoist(TIntermTyped *node, TIntermNode *parent, const Value &value)
+{
+    std::map<int, Entry>::iterator entry = mEntries.find(value.number);
+    if (entry != mEntries.end())
+    {
+        useEntry(value.number, node, parent);
+        return;
+    }
+
+    int target = hoistTarget(value.loop);
+    ASSERT(target >= 0);
+    const Loop &loop = mLoops[target];
+
+    Entry newEntry;
+    newEntry.node = NULL;
+    newEntry.parent = NULL;
+    newEntry.block = loop.block;
+    newEntry.statement = loop.node;
+    newEntry.loop = target - 1;
+    newEntry.temporary = createTemporary(node, loop.block, loop.node, target - 1, true);
+    mEntries[value.number] = newEntry;
+    mScopes[loop.scope].push_back(value.number);
+
+    TIntermSymbol *use = createUse(newEntry.temporary, node->getLine());
+    mTemporaries[newEntry.temporary].firstUse = use;
+    parent->replaceChildNode(node, use);
+}
+
+void ExpressionOptimizer::hoistAll(const HoistableList &hoistables, TIntermNode *parent)
+{
+    for (size_t i = 0; i < hoistables.size(); ++i)
+        hoist(hoistables[i].node, parent, hoistables[i].value);
+}
+
+ExpressionOptimizer::Value ExpressionOptimizer::useEntry(int number, TIntermTyped *node,
+                                                         TIntermNode *parent)
+{
+    Entry *entry = &mEntries[number];
+    if (entry->temporary < 0)
+    {
+        entry->temporary = createTemporary(entry->node, entry->block, entry->statement,
+                                           entry->loop, false);
+        TIntermSymbol *firstUse = createUse(entry->temporary, entry->node->getLine());
+        mTemporaries[entry->temporary].firstUse = firstUse;
+        entry->parent->replaceChildNode(entry->node, firstUse);
+    }
+
+    parent->replaceChildNode(node, createUse(entry->temporary, node->getLine()));
+    return Value(number, mTemporaries[entry->temporary].loop);
+}
+
+int ExpressionOptimizer::createTemporary(TIntermTyped *expression, TIntermAggregate *block,
+                                         TIntermNode *statement, int loop, bool hoisted)
+{
+    Temporary temporary;
+    for (int index = static_cast<int>(mTemporaries.size()); ; ++index)
+    {
+        std::ostringstream name;
+        name << "_cse" << index;
+        temporary.name = name.str().c_str();
+        if (mNames.count(temporary.name) == 0)
+            break;
+    }
+    mNames.insert(temporary.name);
+
+    temporary.type = expression->getType();
+    temporary.type.setQualifier(EvqTemporary);
+
+    TIntermBinary *initialize = new TIntermBinary(EOpInitialize);
+    TIntermSymbol *symbol = new TIntermSymbol(-1, temporary.name, temporary.type);
+    symbol->setLine(expression->getLine());
+    initialize->setLeft(symbol);
+    initialize->setRight(expression);
+    initialize->setType(temporary.type);
+    initialize->setLine(expression->getLine());
+
+    temporary.declaration = new TIntermAggregate(EOpDeclaration);
+    temporary.declaration->getSequence()->push_back(initialize);
+    temporary.declaration->setLine(expression->getLine());
+    temporary.block = block;
+    temporary.firstUse = NULL;
+    temporary.loop = loop;
+    temporary.hoisted = hoisted;
+    mPending[statement].push_back(temporary.declaration);
+
+    mTemporaries.push_back(temporary);
+    return static_cast<int>(mTemporaries.size()) - 1;
+}
+
+TIntermSymbol *ExpressionOptimizer::createUse(int temporary, const TSourceLoc &line)
+{
+    TIntermSymbol *symbol = new TIntermSymbol(-1, mTemporaries[temporary].name,
+                                              mTemporaries[temporary].type);
+    symbol->setLine(line);
+    return symbol;
+}
+
+// Marks the variables that the statement writes after one of its reads as
+// unstable, so that the expressions reading them are not matched.
+void ExpressionOptimizer::startStatement(TIntermNode *statement, TIntermNode *ignored)
+{
+    mUnstable.clear();
+    WriteTraverser writes(mParameters, &mUnstable, ignored);
+    statement->traverse(&writes);
+    mUnstableCalls = writes.callsUserFunctions();
+}
+
+void ExpressionOptimizer::writeVariables(TIntermNode *node)
+{
+    mUnstable.clear();
+    mUnstableCalls = false;
+
+    std::set<int> written;
+    WriteTraverser writes(mParameters, &written, NULL);
+    node->traverse(&writes);
+    bumpVersions(written, writes.callsUserFunctions());
+}
+
+void ExpressionOptimizer::bumpVersions(const std::set<int> &written, bool callsUserFunctions)
+{
+    for (std::set<int>::const_iterator iter = written.begin(); iter != written.end(); ++iter)
+        mVersions[*iter] = ++mNextVersion;
+    if (callsUserFunctions)
+    {
+        for (std::set<int>::const_iterator iter = mWritableByCalls.begin();
+             iter != mWritableByCalls.end(); ++iter)
+        {
+            mVersions[*iter] = ++mNextVersion;
+        }
+    }
+}
+
+void ExpressionOptimizer::removeRedundantTemporaries(TIntermNode *root)
+{
+    std::set<TString> names;
+    for (size_t i = 0; i < mTemporaries.size(); ++i)
+        names.insert(mTemporaries[i].name);
+    std::vector<bool> removed(mTemporaries.size(), false);
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        TemporaryUseTraverser uses(names);
+        root->traverse(&uses);
+
+        for (size_t i = 0; i < mTemporaries.size(); ++i)
+        {
+            const Temporary &temporary = mTemporaries[i];
+            if (removed[i])
+                continue;
+
+            TemporaryUseTraverser::UseMap::const_iterator found =
+                uses.getUses().find(temporary.name);
+            if (found != uses.getUses().end())
+            {
+                // Temporaries that only replace their first evaluation
+                // are put back, unless they move it out of a loop.
+                const std::vector<TemporaryUseTraverser::Use> &use = found->second;
+                if (use.size() > 1 || use[0].symbol != temporary.firstUse || temporary.hoisted)
+                    continue;
+                TIntermBinary *initialize =
+                    (*temporary.declaration->getSequence())[0]->getAsBinaryNode();
+                use[0].parent->replaceChildNode(use[0].symbol, initialize->getRight());
+            }
+
+            TIntermSequence *sequence = temporary.block->getSequence();
+            sequence->erase(std::find(sequence->begin(), sequence->end(),
+                                      temporary.declaration));
+            removed[i] = true;
+            names.erase(temporary.name);
+            changed = true;
+        }
+    }
+
+    TemporaryUseTraverser uses(names);
+    root->traverse(&uses);
+    int index = 0;
+    for (size_t i = 0; i < mTemporaries.size(); ++i)
+    {
+        if (removed[i])
+            continue;
+
+        Temporary &temporary = mTemporaries[i];
+        TemporaryUseTraverser::UseMap::const_iterator found = uses.getUses().find(temporary.name);
+        for (;; ++index)
+        {
+            std::ostringstream name;
+            name << "_cse" << index;
+            temporary.name = name.str().c_str();
+            if (mShaderNames.count(temporary.name) == 0)
+                break;
+        }
+        ++index;
+
+        TIntermBinary *initialize = (*temporary.declaration->getSequence())[0]->getAsBinaryNode();
+        initialize->setLeft(createUse(static_cast<int>(i), initialize->getLine()));
+        const std::vector<TemporaryUseTraverser::Use> &use = found->second;
+        for (size_t j = 0; j < use.size(); ++j)
+        {
+            use[j].parent->replaceChildNode(use[j].symbol,
+                                            createUse(static_cast<int>(i), use[j].symbol->getLine()));
+        }
+    }
+}
+
+}  // anonymous namespace
+
+void EliminateCommonSubexpressions(TIntermNode *root)
+{
+    TIntermAggregate *globals = root->getAsAggregate();
+    if (globals == NULL || globals->getOp() != EOpSequence)
+        return;
+
+    ParameterQualifierMap parameters;
+    std::vector<TIntermAggregate *> bodies;
+    TIntermSequence *declarations = globals->getSequence();
+    for (size_t i = 0; i < declarations->size(); ++i)
+    {
+        TIntermAggregate *function = (*declarations)[i]->getAsAggregate();
+        if (function == NULL || function->getOp() != EOpFunction)
+            continue;
+
+        TIntermSequence *sequence = function->getSequence();
+        std::vector<TQualifier> &qualifiers = parameters[function->getName()];
+        TIntermAggregate *parameterList = sequence->empty() ? NULL : (*sequence)[0]->getAsAggregate();
+        if (parameterList != NULL && parameterList->getOp() == EOpParameters)
+        {
+            TIntermSequence *symbols = parameterList->getSequence();
+            for (size_t j = 0; j < symbols->size(); ++j)
+                qualifiers.push_back((*symbols)[j]->getAsTyped()->getQualifier());
+        }
+
+        TIntermAggregate *body = sequence->size() > 1 ? (*sequence)[1]->getAsAggregate() : NULL;
+        if (body != NULL && body->getOp() == EOpSequence)
+            bodies.push_back(body);
+    }
+
+    std::set<TString> names;
+    NameTraverser nameTraverser(&names);
+    root->traverse(&nameTraverser);
+
+    ExpressionOptimizer optimizer(parameters, names);
+    for (size_t i = 0; i < bodies.size(); ++i)
+        optimizer.optimizeFunction(bodies[i]);
+    optimizer.removeRedundantTemporaries(root);
+}
+
+}
@@ -0,0 +1,42 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// EliminateCommonSubexpressions.h: Tree transform that computes repeated
+//   and loop-invariant expressions once, in temporary variables.
+//
+
+#ifndef COMPILER_ELIMINATE_COMMON_SUBEXPRESSIONS_H_
+#define COMPILER_ELIMINATE_COMMON_SUBEXPRESSIONS_H_
+
+#include "compiler/translator/IntermNode.h"
+
+namespace sh
+{
+
+// Walks the statements of each function in order and numbers the values of
+// the expressions in them, so that expressions that compute the same value
+// get the same number:
+// - Operations and built-in function calls that compute a value computed
+//   before in the same block, or in a block that encloses it, are replaced
+//   by a temporary variable that is initialized with the first of them.
+//   Values are matched on their operations, types, precisions and the
+//   variables they read, and writes to these variables, including writes
+//   by user-defined functions, start new values.
+// - Operations and built-in function calls in the body of a loop that only
+//   read variables that the loop does not write are moved to a temporary
+//   variable declared before the loop. Expressions are only moved out of
+//   loops that are statements of a block, and if every iteration evaluates
+//   them, that is, not out of selections, ternary operators or the right
+//   operands of && and ||.
+// Expressions in conditional positions are replaced by values computed
+// before them, but never move. Expressions that index arrays, and the
+// headers of for-loops, are left as they are so that they keep the form
+// that the ESSL limitations require. Calls of user-defined functions,
+// assignments and constructors are never moved.
+void EliminateCommonSubexpressions(TIntermNode *root);
+
+}
+
+#endif // COMPILER_ELIMINATE_COMMON_SUBEXPRESSIONS_H_
@@ -6,27 +6,31 @@
 
 #include "compiler/translator/InfoSink.h"
 
+#include <algorithm>
+
+const size_t TInfoSinkBase::kChunkSize;
+
 void TInfoSinkBase::prefix(TPrefixType p) {
     switch(p) {
         case EPrefixNone:
             break;
         case EPrefixWarning:
-            sink.append("WARNING: ");
+            *this << "WARNING: ";
             break;
         case EPrefixError:
-            sink.append("ERROR: ");
+            *this << "ERROR: ";
             break;
         case EPrefixInternalError:
-            sink.append("INTERNAL ERROR: ");
+            *this << "INTERNAL ERROR: ";
             break;
         case EPrefixUnimplemented:
-            sink.append("UNIMPLEMENTED: ");
+            *this << "UNIMPLEMENTED: ";
             break;
         case EPrefixNote:
-            sink.append("NOTE: ");
+            *this << "NOTE: ";
             break;
         default:
-            sink.append("UNKOWN ERROR: ");
+            *this << "UNKOWN ERROR: ";
             break;
     }
 }
@@ -39,7 +43,7 @@ void TInfoSinkBase::location(int file, int line) {
         stream << file << ":? ";
     stream << ": ";
 
-    sink.append(stream.str());
+    append(stream.str());
 }
 
 void TInfoSinkBase::location(const TSourceLoc& loc) {
@@ -49,6 +53,42 @@ void TInfoSinkBase::location(const TSourceLoc& loc) {
 void TInfoSinkBase::message(TPrefixType p, const TSourceLoc& loc, const char* m) {
     prefix(p);
     location(loc);
-    sink.append(m);
-    sink.append("\n");
+    *this << m << "\n";
+}
+
+void TInfoSinkBase::append(const TInfoSinkBase& other) {
+    for (size_t i = 0; i < other.chunks.size(); ++i)
+        append(other.chunks[i]);
+}
+
+const TPersistString& TInfoSinkBase::str() const {
+    if (chunks.size() == 1)
+        return chunks.front();
+
+    // Chunks are only ever appended, so a concatenation of the right length
+    // is up to date.
+    if (flattened.size() != totalSize) {
+        flattened.clear();
+        flattened.reserve(totalSize);
+        for (size_t i = 0; i < chunks.size(); ++i)
+            flattened.append(chunks[i]);
+    }
+    return flattened;
+}
+
+void TInfoSinkBase::appendToNewChunks(const char* str, size_t length) {
+    totalSize += length;
+    while (length > 0) {
+        if (chunks.empty() || chunks.back().size() >= kChunkSize) {
+            chunks.push_back(TPersistString());
+            // The first chunk grows on demand so that small sinks stay small.
+            if (chunks.size() > 1)
+                chunks.back().reserve(kChunkSize);
+        }
+        TPersistString& chunk = chunks.back();
+        size_t count = std::min(length, kChunkSize - chunk.size());
+        chunk.append(str, count);
+        str += count;
+        length -= count;
+    }
 }
@@ -9,6 +9,8 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+#include <deque>
 #include "compiler/translator/Common.h"
 
 // Returns the fractional part of the given floating-point number.
@@ -36,33 +38,41 @@ enum TPrefixType {
 // The methods are a general set of tools for getting a variety of
 // messages and types inserted into the log.
 //
+// The text is stored as a list of chunks of at most kChunkSize characters,
+// so that large outputs such as generated HLSL grow without reallocating
+// and copying everything written so far. Callers that can consume the text
+// piecewise should use chunkCount() and chunk(); str() and c_str()
+// concatenate the chunks on first use.
+//
 class TInfoSinkBase {
 public:
-    TInfoSinkBase() {}
+    static const size_t kChunkSize = 16 * 1024;
+
+    TInfoSinkBase() : totalSize(0) {}
 
     template <typename T>
     TInfoSinkBase& operator<<(const T& t) {
         TPersistStringStream stream;
         stream << t;
-        sink.append(stream.str());
+        append(stream.str());
         return *this;
     }
     // Override << operator for specific types. It is faster to append strings
     // and characters directly to the sink.
     TInfoSinkBase& operator<<(char c) {
-        sink.append(1, c);
+        append(&c, 1);
         return *this;
     }
     TInfoSinkBase& operator<<(const char* str) {
-        sink.append(str);
+        append(str, strlen(str));
         return *this;
     }
     TInfoSinkBase& operator<<(const TPersistString& str) {
-        sink.append(str);
+        append(str);
         return *this;
     }
     TInfoSinkBase& operator<<(const TString& str) {
-        sink.append(str.c_str());
+        append(str.c_str(), str.size());
         return *this;
     }
     // Make sure floats are written with correct precision.
@@ -81,21 +91,31 @@ public:
             stream.precision(8);
             stream << f;
         }
-        sink.append(stream.str());
+        append(stream.str());
         return *this;
     }
     // Write boolean values as their names instead of integral value.
     TInfoSinkBase& operator<<(bool b) {
         const char* str = b ? "true" : "false";
-        sink.append(str);
+        append(str, strlen(str));
         return *this;
     }
 
-    void erase() { sink.clear(); }
-    int size() { return static_cast<int>(sink.size()); }
+    // Appends the contents of another sink chunk by chunk.
+    void append(const TInfoSinkBase& other);
+
+    void erase() {
+        chunks.clear();
+        flattened.clear();
+        totalSize = 0;
+    }
+    int size() const { return static_cast<int>(totalSize); }
+
+    size_t chunkCount() const { return chunks.size(); }
+    const TPersistString& chunk(size_t index) const { return chunks[index]; }
 
-    const TPersistString& str() const { return sink; }
-    const char* c_str() const { return sink.c_str(); }
+    const TPersistString& str() const;
+    const char* c_str() const { return str().c_str(); }
 
     void prefix(TPrefixType p);
     void location(int file, int line);
@@ -103,7 +123,22 @@ public:
     void message(TPrefixType p, const TSourceLoc& loc, const char* m);
 
 private:
-    TPersistString sink;
+    void append(const TPersistString& str) { append(str.c_str(), str.size()); }
+    void append(const char* str, size_t length) {
+        if (!chunks.empty() && chunks.back().size() + length <= kChunkSize) {
+            chunks.back().append(str, length);
+            totalSize += length;
+        } else {
+            appendToNewChunks(str, length);
+        }
+    }
+    void appendToNewChunks(const char* str, size_t length);
+
+    // A deque never moves its elements when it grows.
+    std::deque<TPersistString> chunks;
+    size_t totalSize;
+    // Concatenation of all chunks, built by str() when there is more than one.
+    mutable TPersistString flattened;
 };
 
 class TInfoSink {
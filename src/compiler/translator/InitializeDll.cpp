@@ -5,8 +5,11 @@
 //
 
 #include "compiler/translator/InitializeDll.h"
+#include "compiler/translator/BuiltInSymbolTableCache.h"
 #include "compiler/translator/InitializeGlobals.h"
 #include "compiler/translator/InitializeParseContext.h"
+#include "compiler/translator/TranslationCache.h"
+#include "compiler/translator/TypeTable.h"
 
 #include "common/platform.h"
 
@@ -24,11 +27,19 @@ bool InitProcess()
         return false;
     }
 
+    if (!InitializeTypeTableIndex()) {
+        assert(0 && "InitProcess(): Failed to initalize type table");
+        return false;
+    }
+
     return true;
 }
 
 void DetachProcess()
 {
+    FreeBuiltInSymbolTableCache();
+    GetTranslationCache()->clear();
+    FreeTypeTableIndex();
     FreeParseContextIndex();
     FreePoolIndex();
 }
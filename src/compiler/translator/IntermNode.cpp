@@ -136,9 +136,28 @@ bool CompareStructure(const TType &leftNodeType,
 void TIntermTyped::setTypePreservePrecision(const TType &t)
 {
     TPrecision precision = getPrecision();
-    mType = t;
-    ASSERT(mType.getBasicType() != EbtBool || precision == EbpUndefined);
-    mType.setPrecision(precision);
+    ASSERT(t.getBasicType() != EbtBool || precision == EbpUndefined);
+    TType type(t);
+    type.setPrecision(precision);
+    mType = InternType(type);
+}
+
+void TIntermTyped::setPrecision(TPrecision precision)
+{
+    if (mType->getPrecision() == precision)
+        return;
+    TType type(*mType);
+    type.setPrecision(precision);
+    mType = InternType(type);
+}
+
+void TIntermTyped::setQualifier(TQualifier qualifier)
+{
+    if (mType->getQualifier() == qualifier)
+        return;
+    TType type(*mType);
+    type.setQualifier(qualifier);
+    mType = InternType(type);
 }
 
 #define REPLACE_IF_IS(node, type, original, replacement) \
@@ -249,7 +268,7 @@ void TIntermAggregate::setPrecisionFromChildren()
 {
     if (getBasicType() == EbtBool)
     {
-        mType.setPrecision(EbpUndefined);
+        setPrecision(EbpUndefined);
         return;
     }
 
@@ -262,7 +281,7 @@ void TIntermAggregate::setPrecisionFromChildren()
             precision = GetHigherPrecision(typed->getPrecision(), precision);
         ++childIter;
     }
-    mType.setPrecision(precision);
+    setPrecision(precision);
 }
 
 void TIntermAggregate::setBuiltInFunctionPrecision()
@@ -286,9 +305,9 @@ void TIntermAggregate::setBuiltInFunctionPrecision()
     // ESSL 3.0 spec section 8: textureSize always gets highp precision.
     // All other functions that take a sampler are assumed to be texture functions.
     if (mName.find("textureSize") == 0)
-        mType.setPrecision(EbpHigh);
+        setPrecision(EbpHigh);
     else
-        mType.setPrecision(precision);
+        setPrecision(precision);
 }
 
 bool TIntermSelection::replaceChildNode(
@@ -411,7 +430,7 @@ bool TIntermUnary::promote(TInfoSink &)
     }
 
     setType(mOperand->getType());
-    mType.setQualifier(EvqTemporary);
+    setQualifier(EvqTemporary);
 
     return true;
 }
@@ -448,13 +467,13 @@ bool TIntermBinary::promote(TInfoSink &infoSink)
     // The result gets promoted to the highest precision.
     TPrecision higherPrecision = GetHigherPrecision(
         mLeft->getPrecision(), mRight->getPrecision());
-    getTypePointer()->setPrecision(higherPrecision);
+    setPrecision(higherPrecision);
 
     // Binary operations results in temporary variables unless both
     // operands are const.
     if (mLeft->getQualifier() != EvqConst || mRight->getQualifier() != EvqConst)
     {
-        getTypePointer()->setQualifier(EvqTemporary);
+        setQualifier(EvqTemporary);
     }
 
     const int nominalSize =
@@ -23,6 +23,7 @@
 
 #include "compiler/translator/Common.h"
 #include "compiler/translator/Types.h"
+#include "compiler/translator/TypeTable.h"
 #include "compiler/translator/ConstantUnion.h"
 
 //
@@ -199,6 +200,7 @@ class TIntermSelection;
 class TIntermTyped;
 class TIntermSymbol;
 class TIntermLoop;
+class TIntermBranch;
 class TInfoSink;
 class TIntermRaw;
 
@@ -230,6 +232,7 @@ class TIntermNode
     virtual TIntermSelection *getAsSelectionNode() { return 0; }
     virtual TIntermSymbol *getAsSymbolNode() { return 0; }
     virtual TIntermLoop *getAsLoopNode() { return 0; }
+    virtual TIntermBranch *getAsBranchNode() { return 0; }
     virtual TIntermRaw *getAsRawNode() { return 0; }
 
     // Replace a child node. Return true if |original| is a child
@@ -260,38 +263,41 @@ struct TIntermNodePair
 class TIntermTyped : public TIntermNode
 {
   public:
-    TIntermTyped(const TType &t) : mType(t)  { }
+    TIntermTyped(const TType &t) : mType(InternType(t))  { }
     virtual TIntermTyped *getAsTyped() { return this; }
 
     virtual bool hasSideEffects() const = 0;
 
-    void setType(const TType &t) { mType = t; }
+    // Types are shared between nodes and never modified. Changing the type
+    // of a node replaces it with the shared copy of the new type.
+    void setType(const TType &t) { mType = InternType(t); }
     void setTypePreservePrecision(const TType &t);
-    const TType &getType() const { return mType; }
-    TType *getTypePointer() { return &mType; }
-
-    TBasicType getBasicType() const { return mType.getBasicType(); }
-    TQualifier getQualifier() const { return mType.getQualifier(); }
-    TPrecision getPrecision() const { return mType.getPrecision(); }
-    int getCols() const { return mType.getCols(); }
-    int getRows() const { return mType.getRows(); }
-    int getNominalSize() const { return mType.getNominalSize(); }
-    int getSecondarySize() const { return mType.getSecondarySize(); }
-
-    bool isInterfaceBlock() const { return mType.isInterfaceBlock(); }
-    bool isMatrix() const { return mType.isMatrix(); }
-    bool isArray()  const { return mType.isArray(); }
-    bool isVector() const { return mType.isVector(); }
-    bool isScalar() const { return mType.isScalar(); }
-    bool isScalarInt() const { return mType.isScalarInt(); }
-    const char *getBasicString() const { return mType.getBasicString(); }
-    const char *getQualifierString() const { return mType.getQualifierString(); }
-    TString getCompleteString() const { return mType.getCompleteString(); }
-
-    int getArraySize() const { return mType.getArraySize(); }
+    void setPrecision(TPrecision precision);
+    void setQualifier(TQualifier qualifier);
+    const TType &getType() const { return *mType; }
+
+    TBasicType getBasicType() const { return mType->getBasicType(); }
+    TQualifier getQualifier() const { return mType->getQualifier(); }
+    TPrecision getPrecision() const { return mType->getPrecision(); }
+    int getCols() const { return mType->getCols(); }
+    int getRows() const { return mType->getRows(); }
+    int getNominalSize() const { return mType->getNominalSize(); }
+    int getSecondarySize() const { return mType->getSecondarySize(); }
+
+    bool isInterfaceBlock() const { return mType->isInterfaceBlock(); }
+    bool isMatrix() const { return mType->isMatrix(); }
+    bool isArray()  const { return mType->isArray(); }
+    bool isVector() const { return mType->isVector(); }
+    bool isScalar() const { return mType->isScalar(); }
+    bool isScalarInt() const { return mType->isScalarInt(); }
+    const char *getBasicString() const { return mType->getBasicString(); }
+    const char *getQualifierString() const { return mType->getQualifierString(); }
+    TString getCompleteString() const { return mType->getCompleteString(); }
+
+    int getArraySize() const { return mType->getArraySize(); }
 
   protected:
-    TType mType;
+    const TType *mType;
 };
 
 //
@@ -353,6 +359,7 @@ class TIntermBranch : public TIntermNode
         : mFlowOp(op),
           mExpression(e) { }
 
+    virtual TIntermBranch *getAsBranchNode() { return this; }
     virtual void traverse(TIntermTraverser *);
     virtual bool replaceChildNode(
         TIntermNode *original, TIntermNode *replacement);
@@ -583,9 +590,14 @@ class TIntermAggregate : public TIntermOperator
     TIntermAggregate()
         : TIntermOperator(EOpNull),
           mUserDefined(false),
+          mOptimize(false),
+          mDebug(false),
           mUseEmulatedFunction(false) { }
     TIntermAggregate(TOperator op)
         : TIntermOperator(op),
+          mUserDefined(false),
+          mOptimize(false),
+          mDebug(false),
           mUseEmulatedFunction(false) { }
     ~TIntermAggregate() { }
 
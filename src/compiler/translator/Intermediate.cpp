@@ -376,7 +376,7 @@ TIntermTyped *TIntermediate::addComma(
         TIntermTyped *commaAggregate = growAggregate(left, right, line);
         commaAggregate->getAsAggregate()->setOp(EOpComma);
         commaAggregate->setType(right->getType());
-        commaAggregate->getTypePointer()->setQualifier(EvqTemporary);
+        commaAggregate->setQualifier(EvqTemporary);
         return commaAggregate;
     }
 }
@@ -417,7 +417,7 @@ TIntermTyped *TIntermediate::addSelection(
     //
     TIntermSelection *node = new TIntermSelection(
         cond, trueBlock, falseBlock, trueBlock->getType());
-    node->getTypePointer()->setQualifier(EvqTemporary);
+    node->setQualifier(EvqTemporary);
     node->setLine(line);
 
     return node;
@@ -0,0 +1,441 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/LoopCost.h"
+
+#include "angle_gl.h"
+#include "compiler/translator/SymbolTable.h"
+
+#include <limits.h>
+
+namespace sh
+{
+
+namespace
+{
+
+// Built-in functions called through EOpFunctionCall are the texture
+// lookups.
+const int kTextureLookupCost = 4;
+// The test and branch of each iteration of a loop that is not unrolled.
+const int kLoopOverheadCost = 2;
+
+// Adds up to INT_MAX.
+int AddCost(int a, int b)
+{
+    return (a > INT_MAX - b) ? INT_MAX : a + b;
+}
+
+int MultiplyCost(int cost, int count)
+{
+    return (count > 0 && cost > INT_MAX / count) ? INT_MAX : cost * count;
+}
+
+// Texture lookups whose level of detail comes from derivatives of their
+// coordinates, when called from a fragment shader.
+bool IsGradientLookup(const TString &name)
+{
+    return name == "texture2D" || name == "texture2DProj" || name == "textureCube" ||
+           name == "texture" || name == "textureProj" ||
+           name == "textureOffset" || name == "textureProjOffset";
+}
+
+class CostTraverser : public TIntermTraverser
+{
+  public:
+    CostTraverser(LoopCostModel *model)
+        : mModel(model),
+          mCost(0),
+          mUsesGradients(false)
+    {
+    }
+
+    int getCost() const { return mCost; }
+    bool usesGradients() const { return mUsesGradients; }
+
+  protected:
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        switch (node->getOp())
+        {
+          case EOpIndexDirect:
+          case EOpIndexDirectStruct:
+          case EOpIndexDirectInterfaceBlock:
+          case EOpVectorSwizzle:
+            // Free register selects.
+            break;
+          default:
+            add(1);
+            break;
+        }
+        return true;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        switch (node->getOp())
+        {
+          case EOpDFdx:
+          case EOpDFdy:
+          case EOpFwidth:
+            mUsesGradients = true;
+            break;
+          default:
+            break;
+        }
+        add(1);
+        return true;
+    }
+
+    virtual bool visitSelection(Visit visit, TIntermSelection *node)
+    {
+        add(1);
+        return true;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        switch (node->getOp())
+        {
+          case EOpSequence:
+          case EOpDeclaration:
+          case EOpInvariantDeclaration:
+          case EOpParameters:
+          case EOpFunction:
+          case EOpPrototype:
+            break;
+          case EOpFunctionCall:
+            if (node->isUserDefined())
+            {
+                add(AddCost(1, mModel->getFunctionCost(node->getName())));
+                if (mModel->functionUsesGradients(node->getName()))
+                    mUsesGradients = true;
+            }
+            else
+            {
+                add(kTextureLookupCost);
+                if (mModel->isFragmentShader() &&
+                    IsGradientLookup(TFunction::unmangleName(node->getName())))
+                {
+                    mUsesGradients = true;
+                }
+            }
+            break;
+          default:
+            add(1);
+            break;
+        }
+        return true;
+    }
+
+    virtual bool visitLoop(Visit visit, TIntermLoop *node)
+    {
+        int iterationCost = mModel->getIterationCost(node);
+        int tripCount = LoopCostModel::GetTripCount(node);
+        if (mModel->shouldUnroll(node, tripCount))
+            add(MultiplyCost(iterationCost, tripCount));
+        else
+            add(AddCost(iterationCost, kLoopOverheadCost));
+        if (mModel->usesGradients(node))
+            mUsesGradients = true;
+        return false;
+    }
+
+    virtual bool visitBranch(Visit visit, TIntermBranch *node)
+    {
+        add(1);
+        return true;
+    }
+
+  private:
+    void add(int cost) { mCost = AddCost(mCost, cost); }
+
+    LoopCostModel *mModel;
+    int mCost;
+    bool mUsesGradients;
+
+    DISALLOW_COPY_AND_ASSIGN(CostTraverser);
+};
+
+// Finds whether a variable is written, conservatively assuming that it is
+// written when passed to a user-defined function.
+class WriteTraverser : public TIntermTraverser
+{
+  public:
+    WriteTraverser(int id)
+        : mId(id),
+          mWritten(false)
+    {
+    }
+
+    bool isWritten() const { return mWritten; }
+
+  protected:
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        if (node->isAssignment())
+            check(node->getLeft());
+        return !mWritten;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        if (node->isAssignment())
+            check(node->getOperand());
+        return !mWritten;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        if (node->getOp() == EOpFunctionCall && node->isUserDefined())
+        {
+            TIntermSequence *arguments = node->getSequence();
+            for (size_t i = 0; i < arguments->size(); ++i)
+                check((*arguments)[i]);
+        }
+        return !mWritten;
+    }
+
+  private:
+    void check(TIntermNode *node)
+    {
+        TIntermSymbol *symbol = node->getAsSymbolNode();
+        mWritten = mWritten || (symbol && symbol->getId() == mId);
+    }
+
+    int mId;
+    bool mWritten;
+
+    DISALLOW_COPY_AND_ASSIGN(WriteTraverser);
+};
+
+bool GetIntConstant(TIntermNode *node, int *value)
+{
+    TIntermConstantUnion *constant = node ? node->getAsConstantUnion() : NULL;
+    if (constant == NULL || constant->getBasicType() != EbtInt || !constant->isScalar())
+        return false;
+    *value = constant->getIConst(0);
+    return true;
+}
+
+// Returns the number of iterations, or -1, of "i = initial; i op limit;
+// i += increment".
+int CountIterations(int initial, TOperator op, int limit, int increment)
+{
+    switch (op)
+    {
+      case EOpLessThanEqual:
+        if (limit == INT_MAX)
+            return -1;
+        return CountIterations(initial, EOpLessThan, limit + 1, increment);
+      case EOpGreaterThanEqual:
+        if (limit == INT_MIN)
+            return -1;
+        return CountIterations(initial, EOpGreaterThan, limit - 1, increment);
+      case EOpLessThan:
+        if (initial >= limit)
+            return 0;
+        if (increment <= 0)
+            return -1;
+        return static_cast<int>((static_cast<long long>(limit) - initial + increment - 1) /
+                                increment);
+      case EOpGreaterThan:
+        if (initial <= limit)
+            return 0;
+        if (increment >= 0)
+            return -1;
+        return static_cast<int>((static_cast<long long>(initial) - limit - increment - 1) /
+                                -increment);
+      case EOpNotEqual:
+        {
+            long long distance = static_cast<long long>(limit) - initial;
+            if (distance % increment != 0 || distance / increment < 0)
+                return -1;
+            return static_cast<int>(distance / increment);
+        }
+      default:
+        return -1;
+    }
+}
+
+}  // anonymous namespace
+
+LoopCostModel::LoopCostModel(TIntermNode *root, GLenum shaderType, int maxUnrolledCost)
+    : mFragmentShader(shaderType == GL_FRAGMENT_SHADER),
+      mMaxUnrolledCost(maxUnrolledCost)
+{
+    TIntermAggregate *globals = root->getAsAggregate();
+    if (globals == NULL || globals->getOp() != EOpSequence)
+        return;
+
+    TIntermSequence *declarations = globals->getSequence();
+    for (size_t i = 0; i < declarations->size(); ++i)
+    {
+        TIntermAggregate *function = (*declarations)[i]->getAsAggregate();
+        if (function && function->getOp() == EOpFunction)
+            mFunctions[function->getName()] = function;
+    }
+}
+
+int LoopCostModel::GetTripCount(TIntermLoop *loop)
+{
+    if (loop->getType() != ELoopFor || loop->getInit() == NULL ||
+        loop->getCondition() == NULL || loop->getExpression() == NULL)
+    {
+        return -1;
+    }
+
+    // int i = initial
+    TIntermAggregate *init = loop->getInit()->getAsAggregate();
+    if (init == NULL || init->getOp() != EOpDeclaration || init->getSequence()->size() != 1)
+        return -1;
+    TIntermBinary *initialize = init->getSequence()->front()->getAsBinaryNode();
+    if (initialize == NULL || initialize->getOp() != EOpInitialize)
+        return -1;
+    TIntermSymbol *index = initialize->getLeft()->getAsSymbolNode();
+    int initial = 0;
+    if (index == NULL || !GetIntConstant(initialize->getRight(), &initial))
+        return -1;
+
+    // i op limit
+    TIntermBinary *test = loop->getCondition()->getAsBinaryNode();
+    int limit = 0;
+    if (test == NULL || test->getLeft()->getAsSymbolNode() == NULL ||
+        test->getLeft()->getAsSymbolNode()->getId() != index->getId() ||
+        !GetIntConstant(test->getRight(), &limit))
+    {
+        return -1;
+    }
+
+    // i += increment, i -= increment, ++i, i++, --i or i--
+    int increment = 0;
+    TIntermNode *expression = loop->getExpression();
+    TIntermNode *incremented = NULL;
+    if (TIntermBinary *binary = expression->getAsBinaryNode())
+    {
+        if (!GetIntConstant(binary->getRight(), &increment) || increment == INT_MIN)
+            return -1;
+        if (binary->getOp() == EOpSubAssign)
+            increment = -increment;
+        else if (binary->getOp() != EOpAddAssign)
+            return -1;
+        incremented = binary->getLeft();
+    }
+    else if (TIntermUnary *unary = expression->getAsUnaryNode())
+    {
+        switch (unary->getOp())
+        {
+          case EOpPostIncrement:
+          case EOpPreIncrement:
+            increment = 1;
+            break;
+          case EOpPostDecrement:
+          case EOpPreDecrement:
+            increment = -1;
+            break;
+          default:
+            return -1;
+        }
+        incremented = unary->getOperand();
+    }
+    if (increment == 0 || incremented == NULL || incremented->getAsSymbolNode() == NULL ||
+        incremented->getAsSymbolNode()->getId() != index->getId())
+    {
+        return -1;
+    }
+
+    if (loop->getBody())
+    {
+        WriteTraverser write(index->getId());
+        loop->getBody()->traverse(&write);
+        if (write.isWritten())
+            return -1;
+    }
+
+    return CountIterations(initial, test->getOp(), limit, increment);
+}
+
+bool LoopCostModel::shouldUnroll(TIntermLoop *loop, int tripCount)
+{
+    if (tripCount < 0)
+        return false;
+    if (loop->getUnrollFlag() || usesGradients(loop))
+        return true;
+    return MultiplyCost(getIterationCost(loop), tripCount) <= mMaxUnrolledCost;
+}
+
+int LoopCostModel::getIterationCost(TIntermLoop *loop)
+{
+    std::map<TIntermLoop *, int>::const_iterator iter = mIterationCosts.find(loop);
+    if (iter != mIterationCosts.end())
+        return iter->second;
+
+    int cost = 0;
+    bool gradients = false;
+    TIntermNode *parts[] = { loop->getBody(), loop->getCondition(), loop->getExpression() };
+    for (size_t i = 0; i < ArraySize(parts); ++i)
+    {
+        if (parts[i])
+        {
+            bool partGradients = false;
+            cost = AddCost(cost, measure(parts[i], &partGradients));
+            gradients = gradients || partGradients;
+        }
+    }
+
+    mIterationCosts[loop] = cost;
+    mIterationGradients[loop] = gradients;
+    return cost;
+}
+
+bool LoopCostModel::usesGradients(TIntermLoop *loop)
+{
+    getIterationCost(loop);
+    return mIterationGradients[loop];
+}
+
+int LoopCostModel::getCost(TIntermNode *node)
+{
+    bool usesGradients = false;
+    return measure(node, &usesGradients);
+}
+
+int LoopCostModel::measure(TIntermNode *node, bool *usesGradients)
+{
+    CostTraverser traverser(this);
+    node->traverse(&traverser);
+    *usesGradients = traverser.usesGradients();
+    return traverser.getCost();
+}
+
+int LoopCostModel::getFunctionCost(const TString &mangledName)
+{
+    std::map<TString, int>::const_iterator iter = mFunctionCosts.find(mangledName);
+    if (iter != mFunctionCosts.end())
+        return iter->second;
+
+    // Functions cannot be recursive. The cost is set before the function
+    // is traversed all the same, so that recursion is not endless.
+    mFunctionCosts[mangledName] = 0;
+    mFunctionGradients[mangledName] = false;
+    std::map<TString, TIntermAggregate *>::const_iterator function =
+        mFunctions.find(mangledName);
+    int cost = 0;
+    bool gradients = false;
+    if (function != mFunctions.end())
+        cost = measure(function->second, &gradients);
+    mFunctionCosts[mangledName] = cost;
+    mFunctionGradients[mangledName] = gradients;
+    return cost;
+}
+
+bool LoopCostModel::functionUsesGradients(const TString &mangledName)
+{
+    getFunctionCost(mangledName);
+    return mFunctionGradients[mangledName];
+}
+
+}
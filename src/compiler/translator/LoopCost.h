@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// LoopCost.h: Estimates the size of loops when unrolled, to decide which
+//   loops the HLSL output asks the HLSL compiler to unroll.
+//
+
+#ifndef COMPILER_LOOP_COST_H_
+#define COMPILER_LOOP_COST_H_
+
+#include "common/angleutils.h"
+#include "compiler/translator/IntermNode.h"
+
+#include <map>
+
+namespace sh
+{
+
+// Costs are rough counts of the operations the code of a node compiles to.
+// Texture lookups count as several operations, and calls of user-defined
+// functions as the cost of the function, which the HLSL compiler inlines.
+//
+// Gradient operations are derivatives, and in fragment shaders the texture
+// lookups that take their level of detail from derivatives. The HLSL
+// compiler has to unroll loops that contain them, so those loops are never
+// kept rolled.
+class LoopCostModel
+{
+  public:
+    // |root| holds the definitions of the functions the loops may call.
+    // Loops are unrolled if the cost of all their iterations is at most
+    // |maxUnrolledCost|.
+    LoopCostModel(TIntermNode *root, GLenum shaderType, int maxUnrolledCost);
+
+    // Returns the number of iterations of a for-loop of the form
+    // "for (int i = a; i < b; i += c)", with any comparison and increment
+    // of a constant, if its index is not written in its body. Returns -1
+    // for other loops.
+    static int GetTripCount(TIntermLoop *loop);
+
+    // Returns true if a loop of |tripCount| iterations, or of an unknown
+    // number if -1, should be unrolled. Loops marked by ForLoopUnrollMarker,
+    // and loops with gradient operations, are unrolled whenever their trip
+    // count is known.
+    bool shouldUnroll(TIntermLoop *loop, int tripCount);
+
+    // Returns the cost of one iteration of a loop, including its condition
+    // and expression.
+    int getIterationCost(TIntermLoop *loop);
+
+    // Returns true if the body, condition or expression of |loop|, or a
+    // function they call, contains a gradient operation.
+    bool usesGradients(TIntermLoop *loop);
+
+    // Returns the cost of |node| as emitted, with the loops in it unrolled
+    // as decided by shouldUnroll().
+    int getCost(TIntermNode *node);
+
+    int getFunctionCost(const TString &mangledName);
+    bool functionUsesGradients(const TString &mangledName);
+
+    bool isFragmentShader() const { return mFragmentShader; }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(LoopCostModel);
+
+    // Measures |node| as getCost() does, and finds whether it contains a
+    // gradient operation.
+    int measure(TIntermNode *node, bool *usesGradients);
+
+    bool mFragmentShader;
+    int mMaxUnrolledCost;
+    std::map<TString, TIntermAggregate *> mFunctions;
+    std::map<TString, int> mFunctionCosts;
+    std::map<TString, bool> mFunctionGradients;
+    std::map<TIntermLoop *, int> mIterationCosts;
+    std::map<TIntermLoop *, bool> mIterationGradients;
+};
+
+}
+
+#endif // COMPILER_LOOP_COST_H_
@@ -11,6 +11,7 @@
 #include "common/blocklayout.h"
 #include "compiler/translator/compilerdebug.h"
 #include "compiler/translator/InfoSink.h"
+#include "compiler/translator/LoopCost.h"
 #include "compiler/translator/DetectDiscontinuity.h"
 #include "compiler/translator/SearchSymbol.h"
 #include "compiler/translator/UnfoldShortCircuit.h"
@@ -141,6 +142,9 @@ OutputHLSL::OutputHLSL(TParseContext &context, TranslatorHLSL *parentTranslator)
 
     mExcessiveLoopIndex = NULL;
 
+    mMaxUnrolledLoopCost = resources.MaxUnrolledLoopCost;
+    mLoopCostModel = NULL;
+
     mStructureHLSL = new StructureHLSL;
     mUniformHLSL = new UniformHLSL(mStructureHLSL, parentTranslator);
 
@@ -165,28 +169,35 @@ OutputHLSL::OutputHLSL(TParseContext &context, TranslatorHLSL *parentTranslator)
 OutputHLSL::~OutputHLSL()
 {
     SafeDelete(mUnfoldShortCircuit);
+    SafeDelete(mLoopCostModel);
     SafeDelete(mStructureHLSL);
     SafeDelete(mUniformHLSL);
 }
 
-void OutputHLSL::output()
+void OutputHLSL::output(TIntermNode *treeRoot, TInfoSinkBase &objSink)
 {
-    mContainsLoopDiscontinuity = mContext.shaderType == GL_FRAGMENT_SHADER && containsLoopDiscontinuity(mContext.treeRoot);
-    const std::vector<TIntermTyped*> &flaggedStructs = FlagStd140ValueStructs(mContext.treeRoot);
+    mContainsLoopDiscontinuity = mContext.shaderType == GL_FRAGMENT_SHADER && containsLoopDiscontinuity(treeRoot);
+    const std::vector<TIntermTyped*> &flaggedStructs = FlagStd140ValueStructs(treeRoot);
     makeFlaggedStructMaps(flaggedStructs);
 
     // Work around D3D9 bug that would manifest in vertex shaders with selection blocks which
     // use a vertex attribute as a condition, and some related computation in the else block.
     if (mOutputType == SH_HLSL9_OUTPUT && mContext.shaderType == GL_VERTEX_SHADER)
     {
-        RewriteElseBlocks(mContext.treeRoot);
+        RewriteElseBlocks(treeRoot);
     }
 
-    mContext.treeRoot->traverse(this);   // Output the body first to determine what has to go in the header
+    if (mContext.compileOptions & SH_UNROLL_LOOPS_BY_COST)
+    {
+        SafeDelete(mLoopCostModel);
+        mLoopCostModel = new LoopCostModel(treeRoot, mContext.shaderType, mMaxUnrolledLoopCost);
+    }
+
+    treeRoot->traverse(this);   // Output the body first to determine what has to go in the header
     header();
 
-    mContext.infoSink().obj << mHeader.c_str();
-    mContext.infoSink().obj << mBody.c_str();
+    objSink.append(mHeader);
+    objSink.append(mBody);
 }
 
 void OutputHLSL::makeFlaggedStructMaps(const std::vector<TIntermTyped *> &flaggedStructs)
@@ -2394,16 +2405,17 @@ bool OutputHLSL::visitLoop(Visit visit, TIntermLoop *node)
 
     TInfoSinkBase &out = mBody;
 
+    const char *attribute = loopAttribute(node, LoopCostModel::GetTripCount(node));
     if (node->getType() == ELoopDoWhile)
     {
-        out << "{LOOP do\n";
+        out << "{" << attribute << " do\n";
 
         outputLineDirective(node->getLine().first_line);
         out << "{\n";
     }
     else
     {
-        out << "{LOOP for(";
+        out << "{" << attribute << " for(";
 
         if (node->getInit())
         {
@@ -2710,7 +2722,8 @@ bool OutputHLSL::handleExcessiveLoop(TIntermLoop *node)
 
                 // for(int index = initial; index < clampedLimit; index += increment)
 
-                out << "LOOP for(";
+                int fragmentIterations = std::min(MAX_LOOP_ITERATIONS, iterations);
+                out << loopAttribute(node, fragmentIterations) << " for(";
                 index->traverse(this);
                 out << " = ";
                 out << initial;
@@ -2760,6 +2773,18 @@ bool OutputHLSL::handleExcessiveLoop(TIntermLoop *node)
     return false;   // Not handled as an excessive loop
 }
 
+const char *OutputHLSL::loopAttribute(TIntermLoop *node, int tripCount)
+{
+    if (mLoopCostModel == NULL)
+    {
+        return "LOOP";
+    }
+
+    // Loops kept rolled use the macro, so that the HLSL compiler can still
+    // unroll them when it has to and ANGLE retries without [loop].
+    return mLoopCostModel->shouldUnroll(node, tripCount) ? "[unroll]" : "LOOP";
+}
+
 void OutputHLSL::outputTriplet(Visit visit, const TString &preString, const TString &inString, const TString &postString)
 {
     TInfoSinkBase &out = mBody;
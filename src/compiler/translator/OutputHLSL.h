@@ -18,6 +18,7 @@
 
 namespace sh
 {
+class LoopCostModel;
 class UnfoldShortCircuit;
 class StructureHLSL;
 class UniformHLSL;
@@ -30,7 +31,8 @@ class OutputHLSL : public TIntermTraverser
     OutputHLSL(TParseContext &context, TranslatorHLSL *parentTranslator);
     ~OutputHLSL();
 
-    void output();
+    // Writes the translation of |treeRoot| to |objSink|.
+    void output(TIntermNode *treeRoot, TInfoSinkBase &objSink);
 
     TInfoSinkBase &getBodyStream();
 
@@ -56,6 +58,9 @@ class OutputHLSL : public TIntermTraverser
     void traverseStatements(TIntermNode *node);
     bool isSingleStatement(TIntermNode *node);
     bool handleExcessiveLoop(TIntermLoop *node);
+    // Returns the attribute of a loop that runs |tripCount| times, or an
+    // unknown number of times if -1.
+    const char *loopAttribute(TIntermLoop *node, int tripCount);
     void outputTriplet(Visit visit, const TString &preString, const TString &inString, const TString &postString);
     void outputLineDirective(int line);
     TString argumentString(const TIntermSymbol *symbol);
@@ -150,6 +155,10 @@ class OutputHLSL : public TIntermTraverser
 
     TIntermSymbol *mExcessiveLoopIndex;
 
+    // Decides which loops are unrolled with SH_UNROLL_LOOPS_BY_COST.
+    int mMaxUnrolledLoopCost;
+    LoopCostModel *mLoopCostModel;
+
     TString structInitializerString(int indent, const TStructure &structure, const TString &rhsStructName);
 
     std::map<TIntermTyped*, TString> mFlaggedStructMappedNames;
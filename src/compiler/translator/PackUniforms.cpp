@@ -0,0 +1,601 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/PackUniforms.h"
+
+#include "angle_gl.h"
+#include "compiler/translator/PassManager.h"
+#include "compiler/translator/SymbolTable.h"
+#include "compiler/translator/VariablePacker.h"
+#include "compiler/translator/util.h"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace sh
+{
+
+namespace
+{
+
+bool IsIndex(TIntermNode *node)
+{
+    TIntermBinary *binary = node ? node->getAsBinaryNode() : NULL;
+    return binary && (binary->getOp() == EOpIndexDirect || binary->getOp() == EOpIndexIndirect);
+}
+
+// Returns the symbol that |node| indexes, if it is an index.
+TIntermSymbol *IndexedSymbol(TIntermNode *node)
+{
+    return IsIndex(node) ? node->getAsBinaryNode()->getLeft()->getAsSymbolNode() : NULL;
+}
+
+bool IsPackableType(const TType &type, int shaderVersion)
+{
+    if (type.getStruct() || type.getInterfaceBlock())
+        return false;
+    if (type.isMatrix() && type.getCols() != type.getRows())
+        return false;
+
+    switch (type.getBasicType())
+    {
+      case EbtFloat:
+      case EbtBool:
+        return true;
+      case EbtInt:
+        // Ints of ESSL 3.00 have more bits than a float can hold.
+        return shaderVersion == 100;
+      default:
+        return false;
+    }
+}
+
+TOperator GetConstructorOp(TBasicType basicType, int size)
+{
+    switch (basicType)
+    {
+      case EbtInt:
+        switch (size)
+        {
+          case 1: return EOpConstructInt;
+          case 2: return EOpConstructIVec2;
+          case 3: return EOpConstructIVec3;
+          default: return EOpConstructIVec4;
+        }
+      case EbtBool:
+        switch (size)
+        {
+          case 1: return EOpConstructBool;
+          case 2: return EOpConstructBVec2;
+          case 3: return EOpConstructBVec3;
+          default: return EOpConstructBVec4;
+        }
+      default:
+        switch (size)
+        {
+          case 1: return EOpConstructFloat;
+          case 2: return EOpConstructVec2;
+          case 3: return EOpConstructVec3;
+          default: return EOpConstructVec4;
+        }
+    }
+}
+
+TOperator GetMatrixConstructorOp(int size)
+{
+    switch (size)
+    {
+      case 2: return EOpConstructMat2;
+      case 3: return EOpConstructMat3;
+      default: return EOpConstructMat4;
+    }
+}
+
+TIntermConstantUnion *CreateIntConstant(int value, const TSourceLoc &line)
+{
+    ConstantUnion *u = new ConstantUnion[1];
+    u[0].setIConst(value);
+    TIntermConstantUnion *node = new TIntermConstantUnion(u, TType(EbtInt, EbpUndefined, EvqConst));
+    node->setLine(line);
+    return node;
+}
+
+TIntermConstantUnion *CreateFloatConstant(float value, const TSourceLoc &line)
+{
+    ConstantUnion *u = new ConstantUnion[1];
+    u[0].setFConst(value);
+    TIntermConstantUnion *node = new TIntermConstantUnion(u, TType(EbtFloat, EbpUndefined, EvqConst));
+    node->setLine(line);
+    return node;
+}
+
+TIntermBinary *CreateIntBinary(TOperator op, TIntermTyped *left, TIntermTyped *right)
+{
+    TIntermBinary *binary = new TIntermBinary(op);
+    binary->setLeft(left);
+    binary->setRight(right);
+    binary->setType(TType(EbtInt, EbpHigh, EvqTemporary));
+    binary->setLine(left->getLine());
+    return binary;
+}
+
+TIntermAggregate *CreateConstructor(TOperator op, const TType &type, const TSourceLoc &line)
+{
+    TIntermAggregate *constructor = new TIntermAggregate(op);
+    constructor->setType(type);
+    constructor->setLine(line);
+    return constructor;
+}
+
+// Returns int(clamp(float(index), 0.0, float(count - 1))), which is valid
+// in every shader version.
+TIntermTyped *CreateClampedIndex(TIntermTyped *index, int count)
+{
+    const TSourceLoc &line = index->getLine();
+    TIntermAggregate *toFloat = CreateConstructor(EOpConstructFloat,
+                                                  TType(EbtFloat, EbpHigh, EvqTemporary), line);
+    toFloat->getSequence()->push_back(index);
+
+    TIntermAggregate *clamp = new TIntermAggregate(EOpClamp);
+    clamp->getSequence()->push_back(toFloat);
+    clamp->getSequence()->push_back(CreateFloatConstant(0.0f, line));
+    clamp->getSequence()->push_back(CreateFloatConstant(static_cast<float>(count - 1), line));
+    clamp->setType(TType(EbtFloat, EbpHigh, EvqTemporary));
+    clamp->setLine(line);
+
+    TIntermAggregate *toInt = CreateConstructor(EOpConstructInt,
+                                                TType(EbtInt, EbpHigh, EvqTemporary), line);
+    toInt->getSequence()->push_back(clamp);
+    return toInt;
+}
+
+// Builds the expression of a row of the packed array, as a constant offset
+// plus the indices of the uniform times their strides. Constant indices are
+// folded into the offset.
+class RowIndex
+{
+  public:
+    RowIndex(int offset, const TSourceLoc &line)
+        : mOffset(offset),
+          mDynamic(NULL),
+          mLine(line)
+    {
+    }
+
+    // Adds index * stride, where the index selects one of |count| elements.
+    void addIndex(TIntermBinary *indexNode, int stride, int count)
+    {
+        TIntermTyped *index = indexNode->getRight();
+        if (TIntermConstantUnion *constant = index->getAsConstantUnion())
+        {
+            mOffset += constant->getIConst(0) * stride;
+            return;
+        }
+
+        TIntermTyped *term = index;
+        if (indexNode->getAddIndexClamp())
+            term = CreateClampedIndex(term, count);
+        if (stride != 1)
+            term = CreateIntBinary(EOpMul, term, CreateIntConstant(stride, mLine));
+        mDynamic = mDynamic ? CreateIntBinary(EOpAdd, mDynamic, term) : term;
+    }
+
+    void addOffset(int offset) { mOffset += offset; }
+
+    bool isConstant() const { return mDynamic == NULL; }
+
+    TIntermTyped *create() const
+    {
+        if (mDynamic == NULL)
+            return CreateIntConstant(mOffset, mLine);
+        if (mOffset == 0)
+            return mDynamic;
+        return CreateIntBinary(EOpAdd, mDynamic, CreateIntConstant(mOffset, mLine));
+    }
+
+  private:
+    int mOffset;
+    TIntermTyped *mDynamic;
+    TSourceLoc mLine;
+};
+
+struct PackableUniform
+{
+    TType type;
+    ShVariablePlacement placement;
+    bool excluded;
+};
+
+typedef std::map<TString, PackableUniform> PackableUniformMap;
+
+// Finds the uniforms that can be packed, and the names that are in use.
+class PackableUniformCollector : public TIntermTraverser
+{
+  public:
+    PackableUniformCollector(int shaderVersion)
+        : TIntermTraverser(true, false, false),
+          mShaderVersion(shaderVersion)
+    {
+    }
+
+    virtual void visitSymbol(TIntermSymbol *node);
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node);
+
+    // The names of the packable uniforms, in the order of their declarations.
+    std::vector<TString> declarationOrder;
+    PackableUniformMap uniforms;
+    std::set<TString> names;
+
+  private:
+    int mShaderVersion;
+};
+
+void PackableUniformCollector::visitSymbol(TIntermSymbol *node)
+{
+    names.insert(node->getSymbol());
+
+    PackableUniformMap::iterator uniform = uniforms.find(node->getSymbol());
+    if (node->getQualifier() != EvqUniform || uniform == uniforms.end() ||
+        !node->isArray())
+    {
+        return;
+    }
+
+    // Arrays are only packed if each of their uses reads an element.
+    TIntermNode *parent = getParentNode();
+    TIntermAggregate *declaration = parent->getAsAggregate();
+    if (declaration && declaration->getOp() == EOpDeclaration)
+        return;
+
+    if (IndexedSymbol(parent) != node)
+    {
+        uniform->second.excluded = true;
+        return;
+    }
+
+    // A whole matrix is read column by column, which would evaluate a
+    // dynamic index more than once.
+    TIntermBinary *index = parent->getAsBinaryNode();
+    if (node->isMatrix() && !index->getRight()->getAsConstantUnion())
+    {
+        TIntermNode *grandParent = mPath.size() >= 2 ? mPath[mPath.size() - 2] : NULL;
+        if (!IsIndex(grandParent) || grandParent->getAsBinaryNode()->getLeft() != parent)
+            uniform->second.excluded = true;
+    }
+}
+
+bool PackableUniformCollector::visitAggregate(Visit, TIntermAggregate *node)
+{
+    switch (node->getOp())
+    {
+      case EOpDeclaration:
+        for (size_t i = 0; i < node->getSequence()->size(); ++i)
+        {
+            TIntermSymbol *symbol = (*node->getSequence())[i]->getAsSymbolNode();
+            if (symbol && symbol->getQualifier() == EvqUniform &&
+                IsPackableType(symbol->getType(), mShaderVersion))
+            {
+                PackableUniform uniform;
+                uniform.type = symbol->getType();
+                uniform.excluded = false;
+                uniforms[symbol->getSymbol()] = uniform;
+                declarationOrder.push_back(symbol->getSymbol());
+            }
+        }
+        break;
+      case EOpFunction:
+      case EOpPrototype:
+      case EOpFunctionCall:
+        names.insert(TFunction::unmangleName(node->getName()));
+        break;
+      default:
+        break;
+    }
+    return true;
+}
+
+// Replaces the uses of the packed uniforms with reads of the packed array.
+class PackedUniformReplacer : public TIntermTraverser
+{
+  public:
+    PackedUniformReplacer(const PackableUniformMap &uniforms, const TType &arrayType,
+                          const TString &arrayName)
+        : TIntermTraverser(false, false, true),
+          mUniforms(uniforms),
+          mArrayType(arrayType),
+          mArrayName(arrayName)
+    {
+    }
+
+    virtual void visitSymbol(TIntermSymbol *node);
+    virtual bool visitBinary(Visit visit, TIntermBinary *node);
+
+  private:
+    const PackableUniform *findPacked(TIntermSymbol *node) const;
+
+    // Reads |size| components of a row, converted to |basicType|.
+    TIntermTyped *createRead(const RowIndex &row, int column, int size,
+                             TBasicType basicType, TPrecision precision,
+                             const TSourceLoc &line) const;
+    // Constructs a matrix from the rows that follow |row|.
+    TIntermTyped *createMatrixRead(const RowIndex &row, const TType &type,
+                                   const TSourceLoc &line) const;
+
+    void replace(TIntermNode *node, TIntermTyped *replacement)
+    {
+        getParentNode()->replaceChildNode(node, replacement);
+    }
+
+    const PackableUniformMap &mUniforms;
+    TType mArrayType;
+    TString mArrayName;
+};
+
+const PackableUniform *PackedUniformReplacer::findPacked(TIntermSymbol *node) const
+{
+    if (node == NULL || node->getQualifier() != EvqUniform)
+        return NULL;
+    PackableUniformMap::const_iterator uniform = mUniforms.find(node->getSymbol());
+    if (uniform == mUniforms.end() || uniform->second.excluded)
+        return NULL;
+    return &uniform->second;
+}
+
+TIntermTyped *PackedUniformReplacer::createRead(const RowIndex &row, int column, int size,
+                                                TBasicType basicType, TPrecision precision,
+                                                const TSourceLoc &line) const
+{
+    TIntermSymbol *array = new TIntermSymbol(-1, mArrayName, mArrayType);
+    array->setLine(line);
+
+    TIntermBinary *index = new TIntermBinary(row.isConstant() ? EOpIndexDirect : EOpIndexIndirect);
+    index->setLeft(array);
+    index->setRight(row.create());
+    index->setType(TType(EbtFloat, mArrayType.getPrecision(), EvqTemporary, 4));
+    index->setLine(line);
+
+    TIntermTyped *read = index;
+    if (size != 4)
+    {
+        TIntermAggregate *fields = new TIntermAggregate(EOpSequence);
+        fields->setLine(line);
+        for (int i = 0; i < size; ++i)
+            fields->getSequence()->push_back(CreateIntConstant(column + i, line));
+
+        TIntermBinary *swizzle = new TIntermBinary(EOpVectorSwizzle);
+        swizzle->setLeft(index);
+        swizzle->setRight(fields);
+        swizzle->setType(TType(EbtFloat, mArrayType.getPrecision(), EvqTemporary, size));
+        swizzle->setLine(line);
+        read = swizzle;
+    }
+
+    if (basicType == EbtFloat)
+        return read;
+
+    TIntermAggregate *conversion = CreateConstructor(GetConstructorOp(basicType, size),
+                                                     TType(basicType, precision, EvqTemporary, size),
+                                                     line);
+    conversion->getSequence()->push_back(read);
+    return conversion;
+}
+
+TIntermTyped *PackedUniformReplacer::createMatrixRead(const RowIndex &row, const TType &type,
+                                                      const TSourceLoc &line) const
+{
+    // Dynamic indices of whole matrices are not packed, so that no index is
+    // evaluated more than once.
+    ASSERT(row.isConstant());
+    int size = type.getCols();
+    TType matrixType(EbtFloat, type.getPrecision(), EvqTemporary, size, size);
+    TIntermAggregate *matrix = CreateConstructor(GetMatrixConstructorOp(size), matrixType, line);
+    for (int column = 0; column < size; ++column)
+    {
+        RowIndex columnRow(row);
+        columnRow.addOffset(column);
+        matrix->getSequence()->push_back(
+            createRead(columnRow, 0, size, EbtFloat, type.getPrecision(), line));
+    }
+    return matrix;
+}
+
+void PackedUniformReplacer::visitSymbol(TIntermSymbol *node)
+{
+    const PackableUniform *uniform = findPacked(node);
+    if (uniform == NULL)
+        return;
+
+    // Declarations are removed once all uses are replaced, and arrays and
+    // indexed matrices are replaced together with their indices.
+    TIntermNode *parent = getParentNode();
+    TIntermAggregate *declaration = parent->getAsAggregate();
+    if (declaration && declaration->getOp() == EOpDeclaration)
+        return;
+    if (node->isArray() || (node->isMatrix() && IndexedSymbol(parent) == node))
+        return;
+
+    const TType &type = node->getType();
+    RowIndex row(uniform->placement.row, node->getLine());
+    if (type.isMatrix())
+        replace(node, createMatrixRead(row, type, node->getLine()));
+    else
+        replace(node, createRead(row, uniform->placement.column, type.getNominalSize(),
+                                 type.getBasicType(), type.getPrecision(), node->getLine()));
+}
+
+bool PackedUniformReplacer::visitBinary(Visit, TIntermBinary *node)
+{
+    if (!IsIndex(node))
+        return true;
+
+    // An index of a matrix array element is read as a single column.
+    TIntermSymbol *symbol = IndexedSymbol(node);
+    TIntermBinary *elementIndex = NULL;
+    if (symbol == NULL && IsIndex(node->getLeft()))
+    {
+        elementIndex = node->getLeft()->getAsBinaryNode();
+        symbol = IndexedSymbol(elementIndex);
+        if (symbol == NULL || !symbol->isArray() || !symbol->isMatrix())
+            return true;
+    }
+
+    const PackableUniform *uniform = findPacked(symbol);
+    if (uniform == NULL)
+        return true;
+
+    const TType &type = symbol->getType();
+    const TSourceLoc &line = node->getLine();
+    RowIndex row(uniform->placement.row, line);
+    if (elementIndex)
+    {
+        int size = type.getCols();
+        row.addIndex(elementIndex, size, type.getArraySize());
+        row.addIndex(node, 1, size);
+        replace(node, createRead(row, 0, size, EbtFloat, type.getPrecision(), line));
+    }
+    else if (type.isArray() && type.isMatrix())
+    {
+        // Read as a whole matrix, unless the parent reads one of its columns.
+        if (IsIndex(getParentNode()) && getParentNode()->getAsBinaryNode()->getLeft() == node)
+            return true;
+        int size = type.getCols();
+        row.addIndex(node, size, type.getArraySize());
+        replace(node, createMatrixRead(row, type, line));
+    }
+    else if (type.isArray())
+    {
+        row.addIndex(node, 1, type.getArraySize());
+        replace(node, createRead(row, uniform->placement.column, type.getNominalSize(),
+                                 type.getBasicType(), type.getPrecision(), line));
+    }
+    else if (type.isMatrix())
+    {
+        int size = type.getCols();
+        row.addIndex(node, 1, size);
+        replace(node, createRead(row, 0, size, EbtFloat, type.getPrecision(), line));
+    }
+    return true;
+}
+
+// Removes the declarations of the packed uniforms from the global scope, and
+// declares the packed array in place of the first of them.
+void ReplaceDeclarations(TIntermAggregate *root, const PackableUniformMap &uniforms,
+                         TIntermSymbol *arraySymbol)
+{
+    TIntermSequence *globals = root->getSequence();
+    TIntermSequence::iterator insertPosition = globals->end();
+    for (TIntermSequence::iterator global = globals->begin(); global != globals->end(); )
+    {
+        TIntermAggregate *declaration = (*global)->getAsAggregate();
+        if (declaration == NULL || declaration->getOp() != EOpDeclaration)
+        {
+            ++global;
+            continue;
+        }
+
+        TIntermSequence *symbols = declaration->getSequence();
+        size_t kept = 0;
+        for (size_t i = 0; i < symbols->size(); ++i)
+        {
+            TIntermSymbol *symbol = (*symbols)[i]->getAsSymbolNode();
+            PackableUniformMap::const_iterator uniform =
+                symbol ? uniforms.find(symbol->getSymbol()) : uniforms.end();
+            if (symbol == NULL || symbol->getQualifier() != EvqUniform ||
+                uniform == uniforms.end() || uniform->second.excluded)
+            {
+                (*symbols)[kept++] = (*symbols)[i];
+            }
+        }
+
+        if (kept == symbols->size())
+        {
+            ++global;
+            continue;
+        }
+
+        if (insertPosition == globals->end())
+        {
+            TIntermAggregate *arrayDeclaration = new TIntermAggregate(EOpDeclaration);
+            arrayDeclaration->getSequence()->push_back(arraySymbol);
+            arrayDeclaration->setLine(declaration->getLine());
+            arraySymbol->setLine(declaration->getLine());
+            global = globals->insert(global, arrayDeclaration);
+            insertPosition = global;
+            ++global;
+        }
+
+        symbols->resize(kept);
+        if (kept == 0)
+            global = globals->erase(global);
+        else
+            ++global;
+    }
+}
+
+}  // namespace anonymous
+
+bool PackUniforms(TIntermNode *root, GLenum shaderType, int shaderVersion,
+                  TPrecision precision, int maxVectors, PassManager *passes,
+                  PackedUniforms *packedUniforms)
+{
+    packedUniforms->clear();
+
+    PackableUniformCollector collector(shaderVersion);
+    passes->addReadOnlyPass(SH_COMPILE_PHASE_PACK_UNIFORMS, &collector);
+    passes->flush();
+
+    std::vector<TString> packed;
+    std::vector<ShaderVariable> variables;
+    for (size_t i = 0; i < collector.declarationOrder.size(); ++i)
+    {
+        const PackableUniform &uniform = collector.uniforms[collector.declarationOrder[i]];
+        if (uniform.excluded)
+            continue;
+        packed.push_back(collector.declarationOrder[i]);
+        variables.push_back(ShaderVariable(GLVariableType(uniform.type),
+                                           uniform.type.getArraySize()));
+    }
+    if (packed.empty())
+        return true;
+
+    std::vector<ShVariablePlacement> placements;
+    VariablePacker packer;
+    if (maxVectors <= 0 || !packer.PackVariables(maxVectors, variables, &placements))
+        return false;
+
+    int arraySize = 0;
+    for (size_t i = 0; i < packed.size(); ++i)
+    {
+        collector.uniforms[packed[i]].placement = placements[i];
+        arraySize = std::max(arraySize, placements[i].row + placements[i].rows);
+        packedUniforms->placements[packed[i].c_str()] = placements[i];
+    }
+
+    TString arrayName = shaderType == GL_VERTEX_SHADER ? "webgl_VertexUniforms"
+                                                       : "webgl_FragmentUniforms";
+    for (int suffix = 1; collector.names.count(arrayName) > 0; ++suffix)
+    {
+        std::ostringstream name;
+        name << (shaderType == GL_VERTEX_SHADER ? "webgl_VertexUniforms" : "webgl_FragmentUniforms")
+             << suffix;
+        arrayName = name.str().c_str();
+    }
+    packedUniforms->arrayName = arrayName.c_str();
+    packedUniforms->arraySize = arraySize;
+
+    TType arrayType(EbtFloat, precision, EvqUniform, 4, 1, true);
+    arrayType.setArraySize(arraySize);
+
+    PackedUniformReplacer replacer(collector.uniforms, arrayType, arrayName);
+    passes->runMutatingPass(SH_COMPILE_PHASE_PACK_UNIFORMS, &replacer);
+    ASSERT(root->getAsAggregate());
+    ReplaceDeclarations(root->getAsAggregate(), collector.uniforms,
+                        new TIntermSymbol(-1, arrayName, arrayType));
+    return true;
+}
+
+}
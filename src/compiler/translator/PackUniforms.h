@@ -0,0 +1,62 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PackUniforms.h: Replaces the uniforms of the default uniform block with a
+//   single array of vec4s, for SH_PACK_UNIFORMS.
+//
+
+#ifndef COMPILER_PACK_UNIFORMS_H_
+#define COMPILER_PACK_UNIFORMS_H_
+
+#include "GLSLANG/ShaderLang.h"
+#include "compiler/translator/IntermNode.h"
+
+#include <map>
+#include <string>
+
+namespace sh
+{
+
+class PassManager;
+
+// The uniforms that PackUniforms replaced.
+struct PackedUniforms
+{
+    PackedUniforms()
+        : arraySize(0)
+    {
+    }
+
+    void clear()
+    {
+        arrayName.clear();
+        mappedArrayName.clear();
+        arraySize = 0;
+        placements.clear();
+    }
+
+    // The name and the size of the vec4 array. The size is 0 if no
+    // uniforms were packed. The mapped name is set by the compiler.
+    std::string arrayName;
+    std::string mappedArrayName;
+    int arraySize;
+    // The placement of each packed uniform in the array, by name.
+    std::map<std::string, ShVariablePlacement> placements;
+};
+
+// Packs the uniforms that SH_PACK_UNIFORMS describes into |maxVectors| rows
+// with VariablePacker, and replaces their declarations with a declaration
+// of an array of that many rows. Each use of a packed uniform reads the
+// components it was placed in, converted back to its type; a matrix is
+// constructed from its columns unless a single column is indexed. Indices
+// that were marked for clamping are clamped to the uniform they index.
+// Returns false, without changing the tree, if the uniforms do not fit.
+bool PackUniforms(TIntermNode *root, GLenum shaderType, int shaderVersion,
+                  TPrecision precision, int maxVectors, PassManager *passes,
+                  PackedUniforms *packedUniforms);
+
+}
+
+#endif // COMPILER_PACK_UNIFORMS_H_
@@ -202,6 +202,11 @@ void TParseContext::trace(const char* str)
     diagnostics.writeDebug(str);
 }
 
+bool TParseContext::memoryBudgetExceeded() const
+{
+    return GetGlobalPoolAllocator()->budgetExceeded() || preprocessor.memoryBudgetExceeded();
+}
+
 //
 // Same error message for all places assignments don't work.
 //
@@ -2137,7 +2142,7 @@ TIntermTyped* TParseContext::addIndexExpression(TIntermTyped *baseExpression, co
 
         if (baseExpression->getType().getQualifier() == EvqConst)
         {
-            indexedExpression->getTypePointer()->setQualifier(EvqConst);
+            indexedExpression->setQualifier(EvqConst);
         }
     }
     else if (baseExpression->isMatrix())
@@ -2267,7 +2272,7 @@ TIntermTyped* TParseContext::addFieldSelectionExpression(TIntermTyped *baseExpre
                         indexedExpression->setType(*fields[i]->type());
                         // change the qualifier of the return type, not of the structure field
                         // as the structure definition is shared between various structures.
-                        indexedExpression->getTypePointer()->setQualifier(EvqConst);
+                        indexedExpression->setQualifier(EvqConst);
                     }
                 }
                 else
@@ -2582,5 +2587,26 @@ int PaParseStrings(size_t count, const char* const string[], const int length[],
     return (error == 0) && (context->numErrors() == 0) ? 0 : 1;
 }
 
+pp::Snapshot* PaPreprocessPrologue(size_t count, const char* const string[],
+                                   TParseContext* context) {
+    if ((count == 0) || (string == NULL))
+        return NULL;
+
+    if (glslang_initialize(context))
+        return NULL;
+
+    pp::Snapshot* snapshot = NULL;
+    if (glslang_scan(count, string, NULL, context) == 0)
+        snapshot = context->preprocessor.takeSnapshot();
+
+    glslang_finalize(context);
+
+    if (context->numErrors() > 0) {
+        delete snapshot;
+        return NULL;
+    }
+    return snapshot;
+}
+
 
 
@@ -44,6 +44,7 @@ struct TParseContext {
             shaderVersion(100),
             directiveHandler(ext, diagnostics, shaderVersion),
             preprocessor(&diagnostics, &directiveHandler),
+            prologue(NULL),
             scanner(NULL) {  }
     TIntermediate& intermediate; // to hold and build a parse tree
     TSymbolTable& symbolTable;   // symbol table that goes with the language currently being parsed
@@ -65,6 +66,7 @@ struct TParseContext {
     TDiagnostics diagnostics;
     TDirectiveHandler directiveHandler;
     pp::Preprocessor preprocessor;
+    const pp::Snapshot* prologue;  // Preprocessor state to start from, or NULL.
     void* scanner;
 
     int getShaderVersion() const { return shaderVersion; }
@@ -77,6 +79,10 @@ struct TParseContext {
     void trace(const char* str);
     void recover();
 
+    // True once the compilation has used up its memory budget, after
+    // which the scanner stops reading tokens.
+    bool memoryBudgetExceeded() const;
+
     // This method is guaranteed to succeed, even if no variable with 'name' exists.
     const TVariable *getNamedVariable(const TSourceLoc &location, const TString *name, const TSymbol *symbol);
 
@@ -168,5 +174,9 @@ struct TParseContext {
 
 int PaParseStrings(size_t count, const char* const string[], const int length[],
                    TParseContext* context);
+// Preprocesses a prologue made of directives only, and returns the state of
+// the preprocessor after it, or NULL if there are errors.
+pp::Snapshot* PaPreprocessPrologue(size_t count, const char* const string[],
+                                   TParseContext* context);
 
 #endif // _PARSER_HELPER_INCLUDED_
@@ -0,0 +1,300 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/PassManager.h"
+
+#include "compiler/translator/CompileStatistics.h"
+#include "compiler/translator/IntermNode.h"
+#include "compiler/translator/compilerdebug.h"
+#include "third_party/trace_event/trace_event.h"
+
+namespace sh
+{
+
+namespace
+{
+
+// Forwards every visit of a single walk to a set of traversers, and keeps
+// track of the nodes each of them has stopped visiting. The depth and path
+// of the traversers are updated as they would be by their own traversal.
+class FusedTraverser : public TIntermTraverser
+{
+  public:
+    FusedTraverser()
+        : TIntermTraverser(true, true, true, false)
+    {
+    }
+
+    void addTraverser(TIntermTraverser *traverser)
+    {
+        ASSERT(!traverser->rightToLeft);
+        Member member;
+        member.traverser = traverser;
+        member.visitCount = 0;
+        member.skippedNode = NULL;
+        member.skippedAfterDescent = false;
+        mMembers.push_back(member);
+    }
+
+    size_t getVisitCount(size_t index) const { return mMembers[index].visitCount; }
+
+    virtual void visitSymbol(TIntermSymbol *node)
+    {
+        for (size_t i = 0; i < mMembers.size(); ++i)
+        {
+            if (mMembers[i].skippedNode == NULL)
+            {
+                ++mMembers[i].visitCount;
+                mMembers[i].traverser->visitSymbol(node);
+            }
+        }
+    }
+
+    virtual void visitRaw(TIntermRaw *node)
+    {
+        for (size_t i = 0; i < mMembers.size(); ++i)
+        {
+            if (mMembers[i].skippedNode == NULL)
+            {
+                ++mMembers[i].visitCount;
+                mMembers[i].traverser->visitRaw(node);
+            }
+        }
+    }
+
+    virtual void visitConstantUnion(TIntermConstantUnion *node)
+    {
+        for (size_t i = 0; i < mMembers.size(); ++i)
+        {
+            if (mMembers[i].skippedNode == NULL)
+            {
+                ++mMembers[i].visitCount;
+                mMembers[i].traverser->visitConstantUnion(node);
+            }
+        }
+    }
+
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        // A false in-visit skips the right operand.
+        visitNode(visit, node, &TIntermTraverser::visitBinary, true, kInVisitSkipsRest);
+        return true;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        visitNode(visit, node, &TIntermTraverser::visitUnary, true, kInVisitSkipsRest);
+        return true;
+    }
+
+    virtual bool visitSelection(Visit visit, TIntermSelection *node)
+    {
+        visitNode(visit, node, &TIntermTraverser::visitSelection, true, kInVisitSkipsRest);
+        return true;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        // A false in-visit only suppresses the remaining in-visits and the
+        // post-visit; the remaining children are still traversed.
+        visitNode(visit, node, &TIntermTraverser::visitAggregate, true, kInVisitSkipsVisits);
+        return true;
+    }
+
+    virtual bool visitLoop(Visit visit, TIntermLoop *node)
+    {
+        visitNode(visit, node, &TIntermTraverser::visitLoop, true, kInVisitSkipsRest);
+        return true;
+    }
+
+    virtual bool visitBranch(Visit visit, TIntermBranch *node)
+    {
+        // Branches without an expression are not descended into.
+        visitNode(visit, node, &TIntermTraverser::visitBranch,
+                  node->getExpression() != NULL, kInVisitSkipsRest);
+        return true;
+    }
+
+  private:
+    enum InVisitBehavior
+    {
+        kInVisitSkipsRest,
+        kInVisitSkipsVisits
+    };
+
+    struct Member
+    {
+        TIntermTraverser *traverser;
+        size_t visitCount;
+        // While set, the traverser gets no visits until the post-visit of
+        // this node, which it does not get either.
+        TIntermNode *skippedNode;
+        bool skippedAfterDescent;
+        // Aggregates whose remaining in-visits and post-visit are skipped.
+        std::vector<TIntermNode *> suppressedAggregates;
+    };
+
+    template <typename NodeType>
+    void visitNode(Visit visit, NodeType *node,
+                   bool (TIntermTraverser::*visitFunction)(Visit, NodeType *),
+                   bool descends, InVisitBehavior inVisitBehavior)
+    {
+        for (size_t i = 0; i < mMembers.size(); ++i)
+        {
+            Member &member = mMembers[i];
+            TIntermTraverser *traverser = member.traverser;
+
+            if (member.skippedNode != NULL)
+            {
+                if (visit == PostVisit && member.skippedNode == node)
+                {
+                    if (member.skippedAfterDescent)
+                        traverser->decrementDepth();
+                    member.skippedNode = NULL;
+                }
+                continue;
+            }
+
+            switch (visit)
+            {
+              case PreVisit:
+                if (traverser->preVisit)
+                {
+                    ++member.visitCount;
+                    if (!(traverser->*visitFunction)(PreVisit, node))
+                    {
+                        member.skippedNode = node;
+                        member.skippedAfterDescent = false;
+                        break;
+                    }
+                }
+                if (descends)
+                    traverser->incrementDepth(node);
+                break;
+
+              case InVisit:
+                if (!traverser->inVisit)
+                    break;
+                if (!member.suppressedAggregates.empty() &&
+                    member.suppressedAggregates.back() == node)
+                    break;
+                ++member.visitCount;
+                if (!(traverser->*visitFunction)(InVisit, node))
+                {
+                    if (inVisitBehavior == kInVisitSkipsRest)
+                    {
+                        member.skippedNode = node;
+                        member.skippedAfterDescent = true;
+                    }
+                    else
+                    {
+                        member.suppressedAggregates.push_back(node);
+                    }
+                }
+                break;
+
+              case PostVisit:
+                if (descends)
+                    traverser->decrementDepth();
+                if (!member.suppressedAggregates.empty() &&
+                    member.suppressedAggregates.back() == node)
+                {
+                    member.suppressedAggregates.pop_back();
+                    break;
+                }
+                if (traverser->postVisit)
+                {
+                    ++member.visitCount;
+                    (traverser->*visitFunction)(PostVisit, node);
+                }
+                break;
+
+              default:
+                UNREACHABLE();
+                break;
+            }
+        }
+    }
+
+    std::vector<Member> mMembers;
+};
+
+}  // anonymous namespace
+
+PassManager::PassManager(TIntermNode *root, ShCompileStatistics *statistics)
+    : mRoot(root),
+      mStatistics(statistics)
+{
+}
+
+PassManager::~PassManager()
+{
+}
+
+void PassManager::addReadOnlyPass(ShCompilePhase phase, TIntermTraverser *traverser)
+{
+    ReadOnlyPass pass;
+    pass.phase = phase;
+    pass.traverser = traverser;
+    mQueue.push_back(pass);
+}
+
+void PassManager::flush()
+{
+    if (mQueue.empty())
+        return;
+
+    TRACE_EVENT0("gpu.angle", "fusedPasses");
+    double startTime = mStatistics ? GetCurrentTimeMs() : 0.0;
+
+    FusedTraverser fused;
+    for (size_t i = 0; i < mQueue.size(); ++i)
+        fused.addTraverser(mQueue[i].traverser);
+    mRoot->traverse(&fused);
+
+    if (mStatistics)
+    {
+        double walkTime = GetCurrentTimeMs() - startTime;
+        size_t totalVisitCount = 0;
+        for (size_t i = 0; i < mQueue.size(); ++i)
+            totalVisitCount += fused.getVisitCount(i);
+
+        for (size_t i = 0; i < mQueue.size(); ++i)
+        {
+            size_t visitCount = fused.getVisitCount(i);
+            double share = (totalVisitCount > 0) ?
+                static_cast<double>(visitCount) / totalVisitCount :
+                1.0 / mQueue.size();
+            mStatistics->phaseTimes[mQueue[i].phase] += walkTime * share;
+            mStatistics->phaseVisits[mQueue[i].phase] += visitCount;
+        }
+        ++mStatistics->treeWalks;
+    }
+
+    mQueue.clear();
+}
+
+void PassManager::runMutatingPass(ShCompilePhase phase, TIntermTraverser *traverser)
+{
+    flush();
+
+    ScopedCompilePhase scopedPhase(mStatistics, phase);
+    mRoot->traverse(traverser);
+    if (mStatistics)
+        ++mStatistics->treeWalks;
+}
+
+void PassManager::runMutatingPass(ShCompilePhase phase, void (*pass)(TIntermNode *root))
+{
+    flush();
+
+    ScopedCompilePhase scopedPhase(mStatistics, phase);
+    pass(mRoot);
+    if (mStatistics)
+        ++mStatistics->treeWalks;
+}
+
+}
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PassManager.h: Runs the traversers of a compilation over the AST, fusing
+//   passes that only read the tree into a single walk.
+//
+
+#ifndef COMPILER_PASS_MANAGER_H_
+#define COMPILER_PASS_MANAGER_H_
+
+#include "GLSLANG/ShaderLang.h"
+#include "common/angleutils.h"
+
+#include <vector>
+
+class TIntermNode;
+class TIntermTraverser;
+
+namespace sh
+{
+
+// Read-only passes are queued with addReadOnlyPass() and run together by
+// flush(), in one walk over the tree. Each of them sees the same sequence
+// of visits as if it had traversed the tree alone: returning false from a
+// visit skips the rest of the node for that pass only. Passes that modify
+// the tree are run alone with runMutatingPass(), which first flushes the
+// queued read-only passes, so the order in which passes are added is the
+// order in which they observe the tree.
+//
+// Read-only passes may not traverse from right to left, and must not
+// depend on the results of another pass of the same walk. They may
+// annotate nodes, as long as no other pass of the walk reads the
+// annotation.
+//
+// The time of each pass is added to the phase it is run for. The time of
+// a fused walk is split between its passes in proportion to the number of
+// visits each of them gets. Passes that are still queued when the manager
+// is destroyed are not run.
+class PassManager
+{
+  public:
+    // |statistics| may be NULL, in which case the passes are only traced.
+    PassManager(TIntermNode *root, ShCompileStatistics *statistics);
+    ~PassManager();
+
+    void addReadOnlyPass(ShCompilePhase phase, TIntermTraverser *traverser);
+    // Runs the queued read-only passes.
+    void flush();
+
+    void runMutatingPass(ShCompilePhase phase, TIntermTraverser *traverser);
+    void runMutatingPass(ShCompilePhase phase, void (*pass)(TIntermNode *root));
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(PassManager);
+
+    struct ReadOnlyPass
+    {
+        ShCompilePhase phase;
+        TIntermTraverser *traverser;
+    };
+
+    TIntermNode *mRoot;
+    ShCompileStatistics *mStatistics;
+    std::vector<ReadOnlyPass> mQueue;
+};
+
+}
+
+#endif // COMPILER_PASS_MANAGER_H_
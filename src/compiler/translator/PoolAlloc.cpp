@@ -55,9 +55,19 @@ TPoolAllocator::TPoolAllocator(int growthIncrement, int allocationAlignment) :
     alignment(allocationAlignment),
     freeList(0),
     inUseList(0),
+    maxCachedPages(kDefaultMaxCachedPages),
+    numCachedPages(0),
+    numPagesInUse(0),
+    peakPages(0),
+    budgetBytes(0),
+    budgetPages(0),
+    budgetBasePages(0),
+    budgetIsExceeded(false),
     numCalls(0),
     totalBytes(0)
 {
+    memset(sizeHistogram, 0, sizeof(sizeHistogram));
+
     //
     // Don't allow page sizes we know are smaller than all common
     // OS page sizes.
@@ -182,16 +192,20 @@ void TPoolAllocator::pop()
         inUseList->~tHeader();
         
         tHeader* nextInUse = inUseList->nextPage;
+        numPagesInUse -= inUseList->pageCount;
         if (inUseList->pageCount > 1)
             delete [] reinterpret_cast<char*>(inUseList);
         else {
             inUseList->nextPage = freeList;
             freeList = inUseList;
+            ++numCachedPages;
         }
         inUseList = nextInUse;
     }
 
     stack.pop_back();
+
+    trimFreeList();
 }
 
 //
@@ -204,13 +218,52 @@ void TPoolAllocator::popAll()
         pop();
 }
 
+void TPoolAllocator::setMaxCachedPages(size_t maxPages)
+{
+    maxCachedPages = maxPages;
+    trimFreeList();
+}
+
+void TPoolAllocator::trimFreeList()
+{
+    while (numCachedPages > maxCachedPages) {
+        tHeader* next = freeList->nextPage;
+        delete [] reinterpret_cast<char*>(freeList);
+        freeList = next;
+        --numCachedPages;
+    }
+}
+
+void TPoolAllocator::setBudget(size_t maxBytes)
+{
+    budgetBytes = maxBytes;
+    budgetPages = (maxBytes + pageSize - 1) / pageSize;
+    budgetBasePages = numPagesInUse;
+    budgetIsExceeded = false;
+}
+
+void TPoolAllocator::getStats(ShPoolAllocatorStats* stats) const
+{
+    stats->pageSize = pageSize;
+    stats->pagesInUse = numPagesInUse;
+    stats->pagesCached = numCachedPages;
+    stats->peakBytes = peakPages * pageSize;
+    stats->allocationCount = numCalls;
+    stats->allocatedBytes = totalBytes;
+    memcpy(stats->allocationSizeHistogram, sizeHistogram, sizeof(sizeHistogram));
+}
+
 void* TPoolAllocator::allocate(size_t numBytes)
 {
     //
-    // Just keep some interesting statistics.
+    // Keep statistics for getStats().
     //
     ++numCalls;
     totalBytes += numBytes;
+    size_t bucket = 0;
+    while (bucket < SH_POOL_ALLOCATION_HISTOGRAM_SIZE - 1 && numBytes > (size_t(16) << bucket))
+        ++bucket;
+    ++sizeHistogram[bucket];
 
     // If we are using guard blocks, all allocations are bracketed by
     // them: [guardblock][allocation][guardblock].  numBytes is how
@@ -254,6 +307,8 @@ void* TPoolAllocator::allocate(size_t numBytes)
         // Use placement-new to initialize header
         new(memory) tHeader(inUseList, (numBytesToAlloc + pageSize - 1) / pageSize);
         inUseList = memory;
+        numPagesInUse += memory->pageCount;
+        updatePeak();
 
         currentPageOffset = pageSize;  // make next allocation come from a new page
 
@@ -268,6 +323,7 @@ void* TPoolAllocator::allocate(size_t numBytes)
     if (freeList) {
         memory = freeList;
         freeList = freeList->nextPage;
+        --numCachedPages;
     } else {
         memory = reinterpret_cast<tHeader*>(::new char[pageSize]);
         if (memory == 0)
@@ -277,7 +333,9 @@ void* TPoolAllocator::allocate(size_t numBytes)
     // Use placement-new to initialize header
     new(memory) tHeader(inUseList, 1);
     inUseList = memory;
-    
+    ++numPagesInUse;
+    updatePeak();
+
     unsigned char* ret = reinterpret_cast<unsigned char *>(inUseList) + headerSkip;
     currentPageOffset = (headerSkip + allocationSize + alignmentMask) & ~alignmentMask;
 
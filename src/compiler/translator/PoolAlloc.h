@@ -35,6 +35,8 @@
 #include <string.h>
 #include <vector>
 
+#include "GLSLANG/ShaderLang.h"
+
 // If we are using guard blocks, we must track each indivual
 // allocation.  If we aren't using guard blocks, these
 // never get instantiated, so won't have any impact.
@@ -107,7 +109,8 @@ private:
 // Page stacks are linked together with a simple header at the beginning
 // of each allocation obtained from the underlying OS.  Multi-page allocations
 // are returned to the OS.  Individual page allocations are kept for future
-// re-use.
+// re-use, up to a limit set by setMaxCachedPages(); pages above it are
+// returned to the OS by pop().
 //
 // The "page size" used is not, nor must it match, the underlying OS
 // page size.  But, having it be about that size or equal to a set of 
@@ -145,6 +148,34 @@ public:
     //
     void* allocate(size_t numBytes);
 
+    //
+    // Call setMaxCachedPages() to limit the number of free single pages
+    // kept for re-use after pop().  Pages above the limit are returned to
+    // the OS, immediately and on subsequent pops.
+    //
+    void setMaxCachedPages(size_t maxPages);
+    size_t getMaxCachedPages() const { return maxCachedPages; }
+    size_t getPageSize() const { return pageSize; }
+
+    //
+    // Call getStats() to read page and allocation statistics.
+    //
+    void getStats(ShPoolAllocatorStats* stats) const;
+
+    //
+    // Call setBudget() to limit the memory of the pages taken into use
+    // after the call to maxBytes, or to remove the limit with 0.  Since
+    // callers do not expect allocate() to fail, allocations above the
+    // limit still succeed, but budgetExceeded() returns true from then on
+    // until the next call to setBudget(), so that callers can stop their
+    // work.
+    //
+    void setBudget(size_t maxBytes);
+    size_t getBudget() const { return budgetBytes; }
+    bool budgetExceeded() const { return budgetIsExceeded; }
+
+    static const size_t kDefaultMaxCachedPages = 128;
+
     //
     // There is no deallocate.  The point of this class is that
     // deallocation can be skipped by the user of it, as the model
@@ -206,8 +237,28 @@ protected:
     tHeader* inUseList;     // list of all memory currently being used
     tAllocStack stack;      // stack of where to allocate from, to partition pool
 
-    int numCalls;           // just an interesting statistic
-    size_t totalBytes;      // just an interesting statistic
+    // Frees cached pages above maxCachedPages.
+    void trimFreeList();
+    void updatePeak() {
+        if (numPagesInUse + numCachedPages > peakPages)
+            peakPages = numPagesInUse + numCachedPages;
+        if (budgetPages != 0 && numPagesInUse > budgetBasePages + budgetPages)
+            budgetIsExceeded = true;
+    }
+
+    size_t maxCachedPages;  // limit on the length of freeList
+    size_t numCachedPages;  // length of freeList
+    size_t numPagesInUse;   // pages in inUseList, counting multi-page allocations fully
+    size_t peakPages;       // highest numCachedPages + numPagesInUse
+
+    size_t budgetBytes;     // limit set by setBudget(), or 0
+    size_t budgetPages;     // budgetBytes in pages, rounded up
+    size_t budgetBasePages; // numPagesInUse when the budget was set
+    bool budgetIsExceeded;
+
+    size_t numCalls;        // number of calls to allocate()
+    size_t totalBytes;      // bytes requested from allocate()
+    size_t sizeHistogram[SH_POOL_ALLOCATION_HISTOGRAM_SIZE];
 private:
     TPoolAllocator& operator=(const TPoolAllocator&);  // dont allow assignment operator
     TPoolAllocator(const TPoolAllocator&);  // dont allow default copy constructor
@@ -260,6 +311,15 @@ public:
     template<class Other>
     pool_allocator(const pool_allocator<Other>& p) : allocator(&p.getAllocator()) { }
 
+    // Copies of pooled containers allocate from the pool that is current at
+    // the time of the copy, not from the pool of the original. Otherwise
+    // copying a string out of a longer-lived pool, such as the one holding
+    // the shared built-in symbols, would keep growing that pool.
+    pool_allocator<T> select_on_container_copy_construction() const {
+        TPoolAllocator* current = GetGlobalPoolAllocator();
+        return current ? pool_allocator<T>(*current) : *this;
+    }
+
 #if defined(__SUNPRO_CC) && !defined(_RWSTD_ALLOCATOR)
     // libCStd on some platforms have a different allocate/deallocate interface.
     // Caller pre-bakes sizeof(T) into 'n' which is the number of bytes to be
@@ -0,0 +1,22 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/Prologue.h"
+
+#include "compiler/preprocessor/Preprocessor.h"
+
+TPrologue::TPrologue(pp::Snapshot *snapshot, const std::string &configuration,
+                     const std::string &source)
+    : mSnapshot(snapshot),
+      mConfiguration(configuration),
+      mSource(source)
+{
+}
+
+TPrologue::~TPrologue()
+{
+    delete mSnapshot;
+}
@@ -0,0 +1,43 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Prologue.h: A prologue of directives, preprocessed once and shared by the
+//   compilations of all compilers with the same configuration.
+//
+
+#ifndef COMPILER_TRANSLATOR_PROLOGUE_H_
+#define COMPILER_TRANSLATOR_PROLOGUE_H_
+
+#include "common/angleutils.h"
+
+#include <string>
+
+namespace pp
+{
+class Snapshot;
+}
+
+class TPrologue
+{
+  public:
+    // Takes ownership of |snapshot|. |configuration| identifies the
+    // compilers the prologue may be used with, and |source| is the text of
+    // the prologue, which the results of their compilations depend on.
+    TPrologue(pp::Snapshot *snapshot, const std::string &configuration, const std::string &source);
+    ~TPrologue();
+
+    const pp::Snapshot &getSnapshot() const { return *mSnapshot; }
+    const std::string &getConfiguration() const { return mConfiguration; }
+    const std::string &getSource() const { return mSource; }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(TPrologue);
+
+    pp::Snapshot *mSnapshot;
+    std::string mConfiguration;
+    std::string mSource;
+};
+
+#endif // COMPILER_TRANSLATOR_PROLOGUE_H_
@@ -0,0 +1,880 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PruneDeadCode.cpp: Implementation for tree transform that folds constant
+//   expressions and removes code that cannot affect the output.
+//
+
+#include "compiler/translator/PruneDeadCode.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "compiler/translator/DetectCallDepth.h"
+#include "compiler/translator/InfoSink.h"
+#include "compiler/translator/SymbolTable.h"
+
+namespace sh
+{
+
+namespace
+{
+
+// Returns the variable that an l-value expression such as "v.x" or
+// "a[i].f" writes to, or NULL if it is not a plain variable.
+TIntermSymbol *GetBaseSymbol(TIntermNode *node)
+{
+    while (TIntermBinary *binary = node->getAsBinaryNode())
+    {
+        switch (binary->getOp())
+        {
+          case EOpIndexDirect:
+          case EOpIndexIndirect:
+          case EOpIndexDirectStruct:
+          case EOpIndexDirectInterfaceBlock:
+          case EOpVectorSwizzle:
+            node = binary->getLeft();
+            break;
+          default:
+            return NULL;
+        }
+    }
+    return node->getAsSymbolNode();
+}
+
+// Local and global variables that only exist in the shader source. Struct
+// variables are excluded as their declaration may also define the struct.
+bool IsRemovableVariable(const TType &type)
+{
+    return (type.getQualifier() == EvqTemporary || type.getQualifier() == EvqGlobal) &&
+           type.getBasicType() != EbtStruct;
+}
+
+bool IsPropagatableType(const TType &type)
+{
+    switch (type.getBasicType())
+    {
+      case EbtFloat:
+      case EbtInt:
+      case EbtUInt:
+      case EbtBool:
+        return !type.isArray();
+      default:
+        return false;
+    }
+}
+
+bool IsIncrementOrDecrement(TOperator op)
+{
+    switch (op)
+    {
+      case EOpPostIncrement:
+      case EOpPostDecrement:
+      case EOpPreIncrement:
+      case EOpPreDecrement:
+        return true;
+      default:
+        return false;
+    }
+}
+
+typedef std::set<TString> FunctionSet;
+
+// Finds assignments, calls of user-defined functions that are not pure and
+// statements in an expression. Unlike TIntermTyped::hasSideEffects(), which
+// assumes that every aggregate may have side effects, it looks into
+// constructors, built-in functions and pure functions.
+class SideEffectsTraverser : public TIntermTraverser
+{
+  public:
+    SideEffectsTraverser(const FunctionSet &pureFunctions)
+        : mPureFunctions(pureFunctions),
+          mFound(false)
+    {
+    }
+
+    bool found() const { return mFound; }
+
+  protected:
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        mFound = mFound || node->isAssignment();
+        if (!mFound && node->getOp() == EOpVectorSwizzle)
+        {
+            // The component list of a swizzle is a sequence.
+            node->getLeft()->traverse(this);
+            return false;
+        }
+        return !mFound;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        mFound = mFound || node->isAssignment();
+        return !mFound;
+    }
+
+    virtual void visitRaw(TIntermRaw *node)
+    {
+        mFound = true;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        if (node->getOp() == EOpFunctionCall)
+        {
+            // Built-in functions have no out parameters.
+            mFound = mFound ||
+                     (node->isUserDefined() && mPureFunctions.count(node->getName()) == 0);
+        }
+        else
+        {
+            // The other operators up to EOpPrototype are statements, and
+            // the ones after are constructors and built-in operations.
+            mFound = mFound || node->getOp() <= EOpPrototype;
+        }
+        return !mFound;
+    }
+
+    virtual bool visitSelection(Visit visit, TIntermSelection *node)
+    {
+        mFound = mFound || !node->usesTernaryOperator();
+        return !mFound;
+    }
+
+    virtual bool visitLoop(Visit visit, TIntermLoop *node)
+    {
+        mFound = true;
+        return false;
+    }
+
+    virtual bool visitBranch(Visit visit, TIntermBranch *node)
+    {
+        mFound = true;
+        return false;
+    }
+
+  private:
+    const FunctionSet &mPureFunctions;
+    bool mFound;
+
+    DISALLOW_COPY_AND_ASSIGN(SideEffectsTraverser);
+};
+
+bool ExpressionHasSideEffects(TIntermTyped *expression, const FunctionSet &pureFunctions)
+{
+    SideEffectsTraverser sideEffects(pureFunctions);
+    expression->traverse(&sideEffects);
+    return sideEffects.found();
+}
+
+// Checks whether a function definition can be called without side
+// effects, given the functions known to be pure: it has no out or inout
+// parameters, does not discard, only assigns to its parameters and local
+// variables, and only calls pure functions.
+class PureFunctionTraverser : public TIntermTraverser
+{
+  public:
+    PureFunctionTraverser(const FunctionSet &pureFunctions)
+        : mPureFunctions(pureFunctions),
+          mPure(true)
+    {
+    }
+
+    bool isPure() const { return mPure; }
+
+  protected:
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        if (node->isAssignment())
+            checkAssigned(node->getLeft());
+        return mPure;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        if (IsIncrementOrDecrement(node->getOp()))
+            checkAssigned(node->getOperand());
+        return mPure;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        switch (node->getOp())
+        {
+          case EOpParameters:
+          case EOpDeclaration:
+            {
+                TIntermSequence *declarators = node->getSequence();
+                for (size_t i = 0; i < declarators->size(); ++i)
+                {
+                    TIntermNode *declarator = (*declarators)[i];
+                    TIntermBinary *initialize = declarator->getAsBinaryNode();
+                    TIntermSymbol *symbol = initialize ? initialize->getLeft()->getAsSymbolNode()
+                                                       : declarator->getAsSymbolNode();
+                    if (symbol == NULL)
+                        continue;
+                    TQualifier qualifier = symbol->getQualifier();
+                    if (qualifier == EvqOut || qualifier == EvqInOut)
+                        mPure = false;
+                    mLocals.insert(symbol->getId());
+                    if (initialize)
+                        initialize->getRight()->traverse(this);
+                }
+            }
+            return false;
+          case EOpFunctionCall:
+            if (node->isUserDefined() && mPureFunctions.count(node->getName()) == 0)
+                mPure = false;
+            break;
+          default:
+            break;
+        }
+        return mPure;
+    }
+
+    virtual bool visitBranch(Visit visit, TIntermBranch *node)
+    {
+        if (node->getFlowOp() == EOpKill)
+            mPure = false;
+        return mPure;
+    }
+
+  private:
+    void checkAssigned(TIntermNode *node)
+    {
+        TIntermSymbol *symbol = GetBaseSymbol(node);
+        if (symbol == NULL || mLocals.count(symbol->getId()) == 0)
+            mPure = false;
+    }
+
+    const FunctionSet &mPureFunctions;
+    std::set<int> mLocals;
+    bool mPure;
+
+    DISALLOW_COPY_AND_ASSIGN(PureFunctionTraverser);
+};
+
+// Finds the functions defined in the shader whose calls have no side
+// effects. Functions cannot be recursive, so removing the functions found
+// not to be pure until no more are found leaves the pure ones.
+void FindPureFunctions(TIntermNode *root, FunctionSet *pureFunctions)
+{
+    TIntermAggregate *globals = root->getAsAggregate();
+    if (globals == NULL || globals->getOp() != EOpSequence)
+        return;
+
+    std::vector<TIntermAggregate *> functions;
+    TIntermSequence *declarations = globals->getSequence();
+    for (size_t i = 0; i < declarations->size(); ++i)
+    {
+        TIntermAggregate *function = (*declarations)[i]->getAsAggregate();
+        if (function && function->getOp() == EOpFunction)
+        {
+            functions.push_back(function);
+            pureFunctions->insert(function->getName());
+        }
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0; i < functions.size(); ++i)
+        {
+            if (pureFunctions->count(functions[i]->getName()) == 0)
+                continue;
+
+            PureFunctionTraverser pure(*pureFunctions);
+            functions[i]->traverse(&pure);
+            if (!pure.isPure())
+            {
+                pureFunctions->erase(functions[i]->getName());
+                changed = true;
+            }
+        }
+    }
+}
+
+// Conservatively checks whether executing a statement may have side
+// effects.
+bool HasSideEffects(TIntermNode *statement, const FunctionSet &pureFunctions)
+{
+    TIntermAggregate *declaration = statement->getAsAggregate();
+    if (declaration && declaration->getOp() == EOpDeclaration)
+    {
+        TIntermSequence *declarators = declaration->getSequence();
+        for (size_t i = 0; i < declarators->size(); ++i)
+        {
+            TIntermBinary *initialize = (*declarators)[i]->getAsBinaryNode();
+            if (initialize && ExpressionHasSideEffects(initialize->getRight(), pureFunctions))
+                return true;
+        }
+        return false;
+    }
+
+    TIntermTyped *expression = statement->getAsTyped();
+    return !expression || ExpressionHasSideEffects(expression, pureFunctions);
+}
+
+bool IsEmptyBlock(TIntermNode *statement)
+{
+    TIntermAggregate *block = statement->getAsAggregate();
+    return block && block->getOp() == EOpSequence && block->getSequence()->empty();
+}
+
+// Expression statements such as "x;" or "1.0 + y;" have no effect.
+bool IsUnusedExpression(TIntermNode *statement, const FunctionSet &pureFunctions)
+{
+    TIntermTyped *expression = statement->getAsTyped();
+    return expression && !ExpressionHasSideEffects(expression, pureFunctions);
+}
+
+// Checks whether a statement always ends with a return, break, continue
+// or discard.
+bool EndsWithBranch(TIntermNode *statement)
+{
+    if (statement->getAsBranchNode())
+        return true;
+
+    TIntermAggregate *block = statement->getAsAggregate();
+    return block && block->getOp() == EOpSequence && !block->getSequence()->empty() &&
+           EndsWithBranch(block->getSequence()->back());
+}
+
+// Returns a statement that executes |node|, which may be NULL, in a scope
+// of its own.
+TIntermAggregate *MakeBlock(TIntermNode *node)
+{
+    TIntermAggregate *block = node ? node->getAsAggregate() : NULL;
+    if (block && block->getOp() == EOpSequence)
+        return block;
+
+    block = new TIntermAggregate(EOpSequence);
+    if (node)
+    {
+        block->getSequence()->push_back(node);
+        block->setLine(node->getLine());
+    }
+    return block;
+}
+
+// Folds an operation on constant operands. Returns NULL if the operation
+// cannot be folded without an error, for example a division by zero, so
+// that the error is left to the driver at run time as before.
+TIntermTyped *Fold(TOperator op, TIntermConstantUnion *operand, TIntermConstantUnion *right,
+                   const TSourceLoc &line)
+{
+    TInfoSink infoSink;
+    TIntermTyped *folded = operand->fold(op, right, infoSink);
+    if (folded == NULL || infoSink.info.size() > 0)
+        return NULL;
+    folded->setLine(line);
+    return folded;
+}
+
+struct VariableUsage
+{
+    VariableUsage()
+        : removable(false),
+          constant(false),
+          references(0),
+          writes(0),
+          assignments(0),
+          initializer(NULL)
+    {
+    }
+
+    // Declared by a statement that can be removed.
+    bool removable;
+    // Initialized with a constant that can replace the variable.
+    bool constant;
+    // Reads and writes, not counting the declaration.
+    int references;
+    int writes;
+    // Writes by assignments and increments, unlike writes by the out
+    // and inout arguments of function calls, which may also be reads.
+    int assignments;
+    TIntermTyped *initializer;
+};
+
+typedef std::map<int, VariableUsage> VariableUsageMap;
+
+// Counts the references to every variable and records how local and
+// global variables are initialized.
+class VariableUsageTraverser : public TIntermTraverser
+{
+  public:
+    VariableUsageTraverser() { }
+
+    const VariableUsageMap &getUsage() const { return mUsage; }
+
+  protected:
+    virtual void visitSymbol(TIntermSymbol *node)
+    {
+        ++mUsage[node->getId()].references;
+    }
+
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        if (node->isAssignment())
+            markAssigned(node->getLeft());
+        return true;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        if (IsIncrementOrDecrement(node->getOp()))
+            markAssigned(node->getOperand());
+        return true;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        switch (node->getOp())
+        {
+          case EOpDeclaration:
+            visitDeclaration(node);
+            return false;
+          case EOpFunctionCall:
+            {
+                // Arguments for out and inout parameters are written.
+                TIntermSequence *arguments = node->getSequence();
+                for (size_t i = 0; i < arguments->size(); ++i)
+                    markWritten((*arguments)[i]);
+            }
+            break;
+          default:
+            break;
+        }
+        return true;
+    }
+
+  private:
+    void visitDeclaration(TIntermAggregate *node)
+    {
+        // Variables declared in a loop header are left alone, as removing
+        // them would change the structure of the loop.
+        TIntermNode *parent = getParentNode();
+        bool inLoopHeader = parent && parent->getAsLoopNode();
+
+        TIntermSequence *declarators = node->getSequence();
+        for (size_t i = 0; i < declarators->size(); ++i)
+        {
+            TIntermNode *declarator = (*declarators)[i];
+            TIntermSymbol *symbol = declarator->getAsSymbolNode();
+            TIntermTyped *initializer = NULL;
+            TIntermBinary *initialize = declarator->getAsBinaryNode();
+            if (initialize && initialize->getOp() == EOpInitialize)
+            {
+                symbol = initialize->getLeft()->getAsSymbolNode();
+                initializer = initialize->getRight();
+            }
+            if (symbol == NULL)
+            {
+                declarator->traverse(this);
+                continue;
+            }
+
+            VariableUsage &usage = mUsage[symbol->getId()];
+            usage.removable = !inLoopHeader && IsRemovableVariable(symbol->getType());
+            usage.constant = usage.removable && initializer &&
+                             initializer->getAsConstantUnion() &&
+                             IsPropagatableType(symbol->getType());
+            usage.initializer = initializer;
+
+            // The declared symbol itself is not a reference.
+            if (initializer)
+                initializer->traverse(this);
+        }
+    }
+
+    void markWritten(TIntermNode *node)
+    {
+        TIntermSymbol *symbol = GetBaseSymbol(node);
+        if (symbol)
+            ++mUsage[symbol->getId()].writes;
+    }
+
+    void markAssigned(TIntermNode *node)
+    {
+        markWritten(node);
+        TIntermSymbol *symbol = GetBaseSymbol(node);
+        if (symbol)
+            ++mUsage[symbol->getId()].assignments;
+    }
+
+    VariableUsageMap mUsage;
+
+    DISALLOW_COPY_AND_ASSIGN(VariableUsageTraverser);
+};
+
+// Replaces variables that always hold their constant initializer by the
+// constant, removes the assignments to variables that are never read, and
+// removes the declarations of variables that are no longer referenced.
+class RemoveVariablesTraverser : public TIntermTraverser
+{
+  public:
+    RemoveVariablesTraverser(const VariableUsageMap &usage, const FunctionSet &pureFunctions)
+        : mUsage(usage),
+          mPureFunctions(pureFunctions),
+          mChanged(false)
+    {
+    }
+
+    bool changed() const { return mChanged; }
+
+  protected:
+    virtual void visitSymbol(TIntermSymbol *node)
+    {
+        const VariableUsage *usage = findUsage(node->getId());
+        if (usage == NULL || !isPropagated(*usage))
+            return;
+
+        TType type = node->getType();
+        type.setQualifier(EvqConst);
+        TIntermConstantUnion *constant = new TIntermConstantUnion(
+            usage->initializer->getAsConstantUnion()->getUnionArrayPointer(), type);
+        constant->setLine(node->getLine());
+
+        bool replaced = getParentNode()->replaceChildNode(node, constant);
+        ASSERT(replaced);
+        mChanged = true;
+    }
+
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        if (!node->isAssignment() || !isWriteOnly(node->getLeft()))
+            return true;
+
+        // The value of an assignment is the value assigned, which is only
+        // that of the right operand for a plain assignment. The removed
+        // assignments are traversed again by the next iteration.
+        if (node->getOp() != EOpAssign && !isStatement())
+            return true;
+        replace(node, node->getRight());
+        return false;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        if (!IsIncrementOrDecrement(node->getOp()) || !isWriteOnly(node->getOperand()) ||
+            !isStatement())
+        {
+            return true;
+        }
+        // The empty block is removed by PruneTreeTraverser.
+        replace(node, new TIntermAggregate(EOpSequence));
+        return false;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        if (node->getOp() != EOpDeclaration)
+            return true;
+
+        TIntermSequence *declarators = node->getSequence();
+        TIntermSequence remaining;
+        for (size_t i = 0; i < declarators->size(); ++i)
+        {
+            TIntermNode *declarator = (*declarators)[i];
+            TIntermBinary *initialize = declarator->getAsBinaryNode();
+            TIntermSymbol *symbol = initialize ? initialize->getLeft()->getAsSymbolNode()
+                                               : declarator->getAsSymbolNode();
+            const VariableUsage *usage = symbol ? findUsage(symbol->getId()) : NULL;
+            if (usage == NULL || !isDead(*usage))
+                remaining.push_back(declarator);
+        }
+        if (remaining.size() == declarators->size())
+            return true;
+
+        mChanged = true;
+        if (remaining.empty())
+        {
+            // The empty block is removed by PruneTreeTraverser.
+            bool replaced = getParentNode()->replaceChildNode(
+                node, new TIntermAggregate(EOpSequence));
+            ASSERT(replaced);
+            return false;
+        }
+        *declarators = remaining;
+        return true;
+    }
+
+  private:
+    const VariableUsage *findUsage(int id) const
+    {
+        VariableUsageMap::const_iterator iter = mUsage.find(id);
+        return iter != mUsage.end() ? &iter->second : NULL;
+    }
+
+    // Checks whether the l-value |node| writes to a variable that is only
+    // ever assigned to, without side effects in its indices.
+    bool isWriteOnly(TIntermTyped *node) const
+    {
+        TIntermSymbol *symbol = GetBaseSymbol(node);
+        const VariableUsage *usage = symbol ? findUsage(symbol->getId()) : NULL;
+        return usage && usage->removable && usage->references == usage->assignments &&
+               !ExpressionHasSideEffects(node, mPureFunctions);
+    }
+
+    // Checks whether the node being visited is an expression statement.
+    bool isStatement()
+    {
+        TIntermAggregate *parent = getParentNode()->getAsAggregate();
+        return parent && parent->getOp() == EOpSequence;
+    }
+
+    void replace(TIntermNode *original, TIntermNode *replacement)
+    {
+        bool replaced = getParentNode()->replaceChildNode(original, replacement);
+        ASSERT(replaced);
+        mChanged = true;
+    }
+
+    static bool isPropagated(const VariableUsage &usage)
+    {
+        return usage.constant && usage.writes == 0;
+    }
+
+    bool isDead(const VariableUsage &usage) const
+    {
+        return usage.removable &&
+               (usage.references == 0 || isPropagated(usage)) &&
+               (usage.initializer == NULL ||
+                !ExpressionHasSideEffects(usage.initializer, mPureFunctions));
+    }
+
+    const VariableUsageMap &mUsage;
+    const FunctionSet &mPureFunctions;
+    bool mChanged;
+
+    DISALLOW_COPY_AND_ASSIGN(RemoveVariablesTraverser);
+};
+
+// Folds constant expressions and removes branches that are never taken,
+// working bottom-up so that folded operands are seen by their parents.
+class PruneTreeTraverser : public TIntermTraverser
+{
+  public:
+    PruneTreeTraverser(const FunctionSet &pureFunctions)
+        : TIntermTraverser(false, false, true),
+          mPureFunctions(pureFunctions),
+          mChanged(false)
+    {
+    }
+
+    bool changed() const { return mChanged; }
+
+  protected:
+    virtual bool visitBinary(Visit visit, TIntermBinary *node)
+    {
+        TIntermConstantUnion *left = node->getLeft()->getAsConstantUnion();
+        TIntermConstantUnion *right = node->getRight()->getAsConstantUnion();
+
+        if (node->getOp() == EOpLogicalAnd || node->getOp() == EOpLogicalOr)
+        {
+            // The operand value that decides the result on its own.
+            bool decidingValue = (node->getOp() == EOpLogicalOr);
+            if (left)
+            {
+                replace(node, left->getBConst(0) == decidingValue ? left : node->getRight());
+            }
+            else if (right && !node->getLeft()->hasSideEffects())
+            {
+                replace(node, right->getBConst(0) == decidingValue ? right : node->getLeft());
+            }
+            return true;
+        }
+
+        if (left && right && !node->isAssignment())
+        {
+            TIntermTyped *folded = Fold(node->getOp(), left, right, node->getLine());
+            if (folded)
+                replace(node, folded);
+        }
+        return true;
+    }
+
+    virtual bool visitUnary(Visit visit, TIntermUnary *node)
+    {
+        TIntermConstantUnion *operand = node->getOperand()->getAsConstantUnion();
+        if (operand && !IsIncrementOrDecrement(node->getOp()))
+        {
+            TIntermTyped *folded = Fold(node->getOp(), operand, NULL, node->getLine());
+            if (folded)
+                replace(node, folded);
+        }
+        return true;
+    }
+
+    virtual bool visitSelection(Visit visit, TIntermSelection *node)
+    {
+        TIntermConstantUnion *condition = node->getCondition()->getAsConstantUnion();
+        if (condition == NULL)
+        {
+            if (node->usesTernaryOperator())
+                return true;
+
+            if (node->getFalseBlock() && IsEmptyBlock(node->getFalseBlock()))
+            {
+                node->replaceChildNode(node->getFalseBlock(), NULL);
+                mChanged = true;
+            }
+            if (node->getFalseBlock() == NULL &&
+                (node->getTrueBlock() == NULL || IsEmptyBlock(node->getTrueBlock())) &&
+                !node->getCondition()->getAsTyped()->hasSideEffects())
+            {
+                replace(node, new TIntermAggregate(EOpSequence));
+            }
+            return true;
+        }
+
+        TIntermNode *taken = condition->getBConst(0) ? node->getTrueBlock()
+                                                     : node->getFalseBlock();
+        if (node->usesTernaryOperator())
+            replace(node, taken);
+        else
+            replace(node, MakeBlock(taken));
+        return true;
+    }
+
+    virtual bool visitLoop(Visit visit, TIntermLoop *node)
+    {
+        // The body of a do-while loop is executed at least once.
+        if (node->getType() == ELoopDoWhile)
+            return true;
+
+        TIntermConstantUnion *condition =
+            node->getCondition() ? node->getCondition()->getAsConstantUnion() : NULL;
+        if (condition == NULL || condition->getBConst(0))
+            return true;
+        if (node->getInit() && HasSideEffects(node->getInit(), mPureFunctions))
+            return true;
+
+        replace(node, new TIntermAggregate(EOpSequence));
+        return true;
+    }
+
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node)
+    {
+        // Sequences are also used for the component indices of swizzles,
+        // which are not statements.
+        TIntermNode *parent = getParentNode();
+        if (node->getOp() != EOpSequence || (parent && parent->getAsBinaryNode()))
+            return true;
+
+        TIntermSequence *statements = node->getSequence();
+        TIntermSequence remaining;
+        for (size_t i = 0; i < statements->size(); ++i)
+        {
+            TIntermNode *statement = (*statements)[i];
+            if (IsEmptyBlock(statement) || IsUnusedExpression(statement, mPureFunctions))
+                continue;
+
+            remaining.push_back(statement);
+
+            // Statements after a return, break, continue or discard are
+            // never executed.
+            if (EndsWithBranch(statement))
+                break;
+        }
+        if (remaining.size() != statements->size())
+        {
+            *statements = remaining;
+            mChanged = true;
+        }
+        return true;
+    }
+
+  private:
+    void replace(TIntermNode *original, TIntermNode *replacement)
+    {
+        bool replaced = getParentNode()->replaceChildNode(original, replacement);
+        ASSERT(replaced);
+        mChanged = true;
+    }
+
+    const FunctionSet &mPureFunctions;
+    bool mChanged;
+
+    DISALLOW_COPY_AND_ASSIGN(PruneTreeTraverser);
+};
+
+// Removes the definitions and prototypes of functions that cannot be
+// reached from main().
+bool RemoveUncalledFunctions(TIntermNode *root)
+{
+    TIntermAggregate *globals = root->getAsAggregate();
+    if (globals == NULL || globals->getOp() != EOpSequence)
+        return false;
+
+    TInfoSink infoSink;
+    DetectCallDepth callGraph(infoSink, false, 0);
+    root->traverse(&callGraph);
+
+    std::set<TString> calledFunctions;
+    callGraph.getFunctionsCalledFromMain(&calledFunctions);
+    if (calledFunctions.empty())
+        return false;
+
+    // Prototypes are named without their parameter types.
+    std::set<TString> calledNames;
+    for (std::set<TString>::const_iterator iter = calledFunctions.begin();
+         iter != calledFunctions.end(); ++iter)
+    {
+        calledNames.insert(TFunction::unmangleName(*iter));
+    }
+
+    TIntermSequence *declarations = globals->getSequence();
+    TIntermSequence remaining;
+    for (size_t i = 0; i < declarations->size(); ++i)
+    {
+        TIntermAggregate *function = (*declarations)[i]->getAsAggregate();
+        if (function && function->getOp() == EOpFunction &&
+            calledFunctions.count(function->getName()) == 0)
+        {
+            continue;
+        }
+        if (function && function->getOp() == EOpPrototype &&
+            calledNames.count(function->getName()) == 0)
+        {
+            continue;
+        }
+        remaining.push_back((*declarations)[i]);
+    }
+    if (remaining.size() == declarations->size())
+        return false;
+
+    *declarations = remaining;
+    return true;
+}
+
+}  // anonymous namespace
+
+void PruneDeadCode(TIntermNode *root)
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = RemoveUncalledFunctions(root);
+
+        FunctionSet pureFunctions;
+        FindPureFunctions(root, &pureFunctions);
+
+        VariableUsageTraverser usage;
+        root->traverse(&usage);
+        RemoveVariablesTraverser removeVariables(usage.getUsage(), pureFunctions);
+        root->traverse(&removeVariables);
+        changed = removeVariables.changed() || changed;
+
+        PruneTreeTraverser pruneTree(pureFunctions);
+        root->traverse(&pruneTree);
+        changed = pruneTree.changed() || changed;
+    }
+}
+
+}
@@ -0,0 +1,37 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PruneDeadCode.h: Tree transform that folds constant expressions and
+//   removes code that cannot affect the output of the shader.
+//
+
+#ifndef COMPILER_PRUNE_DEAD_CODE_H_
+#define COMPILER_PRUNE_DEAD_CODE_H_
+
+#include "compiler/translator/IntermNode.h"
+
+namespace sh
+{
+
+// Repeats the following steps until the tree no longer changes:
+// - Functions that are not called from main() are removed, together with
+//   their prototypes. The call graph is the one built by DetectCallDepth.
+// - Variables that are initialized with a constant and never written
+//   afterwards are replaced by that constant. Assignments to variables that
+//   are never read are replaced by their right operand. Unreferenced
+//   variables whose initializers have no side effects are removed.
+// - Unary and binary operations on constants are folded, and selections,
+//   ternary operators and short-circuiting operators with a constant
+//   condition are replaced by the branch that is taken.
+// - Loops whose condition is constant false, statements that follow a
+//   branch, and expression statements without side effects are removed.
+//   Calls of functions that only write to their parameters and local
+//   variables, and do not discard, have no side effects.
+// Declarations of uniforms, attributes, varyings and structs are kept.
+void PruneDeadCode(TIntermNode *root);
+
+}
+
+#endif // COMPILER_PRUNE_DEAD_CODE_H_
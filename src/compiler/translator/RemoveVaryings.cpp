@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/RemoveVaryings.h"
+
+#include "compiler/translator/util.h"
+
+namespace sh
+{
+
+void RemoveVaryings::visitSymbol(TIntermSymbol *node)
+{
+    if (isRemoved(node))
+        node->setQualifier(EvqGlobal);
+}
+
+bool RemoveVaryings::visitAggregate(Visit visit, TIntermAggregate *node)
+{
+    // Varyings are declared at global scope.
+    if (node->getOp() != EOpSequence || getParentNode() != NULL)
+        return true;
+
+    TIntermSequence *globals = node->getSequence();
+    TIntermSequence remaining;
+    for (size_t i = 0; i < globals->size(); ++i)
+    {
+        TIntermAggregate *declaration = (*globals)[i]->getAsAggregate();
+        if (declaration && declaration->getOp() == EOpInvariantDeclaration &&
+            isRemoved(declaration->getSequence()->front()))
+        {
+            continue;
+        }
+        remaining.push_back((*globals)[i]);
+        if (declaration == NULL || declaration->getOp() != EOpDeclaration)
+            continue;
+
+        // A declaration has a single qualifier, so the removed varyings
+        // of a declaration that also declares kept ones are moved to a
+        // declaration of their own.
+        TIntermSequence *declarators = declaration->getSequence();
+        TIntermSequence kept;
+        TIntermAggregate *removed = new TIntermAggregate(EOpDeclaration);
+        removed->setLine(declaration->getLine());
+        for (size_t j = 0; j < declarators->size(); ++j)
+        {
+            TIntermNode *declarator = (*declarators)[j];
+            if (isRemoved(declarator))
+                removed->getSequence()->push_back(declarator);
+            else
+                kept.push_back(declarator);
+        }
+        if (!removed->getSequence()->empty() && !kept.empty())
+        {
+            *declarators = kept;
+            remaining.push_back(removed);
+        }
+    }
+    *globals = remaining;
+    return true;
+}
+
+bool RemoveVaryings::isRemoved(TIntermNode *node) const
+{
+    TIntermSymbol *symbol = node->getAsSymbolNode();
+    return symbol && IsVaryingOut(symbol->getQualifier()) &&
+           mNames.count(symbol->getSymbol().c_str()) > 0;
+}
+
+}
@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// RemoveVaryings.h: Turns the output varyings of a vertex shader that the
+//   fragment shader it is linked with does not read into global variables.
+//
+
+#ifndef COMPILER_REMOVE_VARYINGS_H_
+#define COMPILER_REMOVE_VARYINGS_H_
+
+#include "compiler/translator/IntermNode.h"
+
+#include <set>
+#include <string>
+
+namespace sh
+{
+
+// The varyings named in |names| keep their writes and reads in the vertex
+// shader, but are no longer outputs of it: they are declared as globals
+// and their invariant declarations are removed. PruneDeadCode then removes
+// them together with the computations of the values written to them.
+class RemoveVaryings : public TIntermTraverser
+{
+  public:
+    RemoveVaryings(const std::set<std::string> &names)
+        : mNames(names)
+    {
+    }
+
+  protected:
+    virtual void visitSymbol(TIntermSymbol *node);
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node);
+
+  private:
+    bool isRemoved(TIntermNode *node) const;
+
+    const std::set<std::string> &mNames;
+
+    DISALLOW_COPY_AND_ASSIGN(RemoveVaryings);
+};
+
+}
+
+#endif // COMPILER_REMOVE_VARYINGS_H_
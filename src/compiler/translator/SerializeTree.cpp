@@ -0,0 +1,1136 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/SerializeTree.h"
+
+#include "compiler/translator/IntermNode.h"
+#include "compiler/translator/SymbolTable.h"
+#include "compiler/translator/TranslationCache.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace sh
+{
+
+namespace
+{
+
+enum NodeKind
+{
+    kNullNode,
+    kSymbolNode,
+    kRawNode,
+    kConstantUnionNode,
+    kBinaryNode,
+    kUnaryNode,
+    kAggregateNode,
+    kSelectionNode,
+    kLoopNode,
+    kBranchNode
+};
+
+// Types, structures and interface blocks share one table, in which each
+// entry only refers to the entries before it.
+enum TableEntryKind
+{
+    kTypeEntry,
+    kStructureEntry,
+    kInterfaceBlockEntry
+};
+
+// Values that the interface block of the type of a field can have.
+enum FieldBlock
+{
+    kNoBlock,
+    kOwnerBlock
+};
+
+// Counts the nesting of the nodes being written or read, the same way for
+// both, so that every tree that is written can be read.
+class ScopedDepth
+{
+  public:
+    ScopedDepth(int *depth, int *maxDepth)
+        : mDepth(depth)
+    {
+        ++*mDepth;
+        *maxDepth = std::max(*maxDepth, *mDepth);
+    }
+    ~ScopedDepth() { --*mDepth; }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(ScopedDepth);
+
+    int *mDepth;
+};
+
+bool IsUnaryOp(TOperator op)
+{
+    return (op >= EOpNegative && op <= EOpPreDecrement) ||
+           (op >= EOpRadians && op <= EOpAll && op != EOpMatrixTimesMatrix);
+}
+
+bool IsBinaryOp(TOperator op)
+{
+    return (op >= EOpAdd && op <= EOpVectorSwizzle) || op == EOpMatrixTimesMatrix ||
+           (op >= EOpAssign && op <= EOpDivAssign);
+}
+
+// Built-in functions of more than one argument, and the operators of the
+// aggregates of the parser.
+bool IsAggregateOp(TOperator op)
+{
+    return (op >= EOpNull && op <= EOpPrototype) ||
+           (op >= EOpRadians && op <= EOpAll && op != EOpMatrixTimesMatrix) ||
+           (op >= EOpConstructInt && op <= EOpConstructStruct);
+}
+
+// Types that operators other than assignments, comparisons and indexing
+// can take.
+bool IsArithmeticType(const TType &type)
+{
+    switch (type.getBasicType())
+    {
+      case EbtFloat:
+      case EbtInt:
+      case EbtUInt:
+      case EbtBool:
+        return !type.isArray();
+      default:
+        return false;
+    }
+}
+
+// Returns the number of the elements, columns or fields of |type| that
+// EOpIndexDirect or |op| can select, or 0 if it cannot index it.
+int GetIndexableSize(const TType &type, TOperator op)
+{
+    switch (op)
+    {
+      case EOpIndexDirectStruct:
+        return (type.getStruct() && !type.isArray()) ?
+            static_cast<int>(type.getStruct()->fields().size()) : 0;
+      case EOpIndexDirectInterfaceBlock:
+        return (type.getInterfaceBlock() && !type.isArray()) ?
+            static_cast<int>(type.getInterfaceBlock()->fields().size()) : 0;
+      default:
+        if (type.isArray())
+            return type.getArraySize();
+        if (type.getBasicType() == EbtStruct || IsSampler(type.getBasicType()))
+            return 0;
+        return (type.isMatrix() || type.isVector()) ? type.getNominalSize() : 0;
+    }
+}
+
+// Returns true if |node| is a constant integer between 0 and |size| - 1.
+// The indices of fields have the type of the field, and a single integer
+// value, which the reader has checked.
+bool IsConstantIndex(TIntermTyped *node, int size, bool fieldIndex)
+{
+    TIntermConstantUnion *constant = node->getAsConstantUnion();
+    if (constant == NULL || constant->getUnionArrayPointer() == NULL ||
+        (!fieldIndex && !constant->getType().isScalarInt()))
+    {
+        return false;
+    }
+    const ConstantUnion &value = constant->getUnionArrayPointer()[0];
+    int index = value.getType() == EbtUInt ? static_cast<int>(value.getUConst()) :
+                                             value.getIConst();
+    return index >= 0 && index < size;
+}
+
+bool IsBoolCondition(TIntermTyped *condition)
+{
+    return condition->getBasicType() == EbtBool && condition->isScalar() &&
+           !condition->isArray();
+}
+
+// The checks below cover what the outputs take for granted of the trees
+// the parser creates: that the operands of an operator have types it
+// applies to, that indices select an element that exists, and that the
+// children the outputs read as expressions are typed.
+
+bool IsValidBinary(TIntermBinary *node)
+{
+    TOperator op = node->getOp();
+    TIntermTyped *left = node->getLeft();
+    TIntermTyped *right = node->getRight();
+    switch (op)
+    {
+      case EOpIndexDirect:
+        return IsConstantIndex(right, GetIndexableSize(left->getType(), op), false);
+      case EOpIndexDirectStruct:
+      case EOpIndexDirectInterfaceBlock:
+        return IsConstantIndex(right, GetIndexableSize(left->getType(), op), true);
+      case EOpIndexIndirect:
+        return GetIndexableSize(left->getType(), op) > 0 && right->isScalarInt() &&
+               !right->isArray();
+      case EOpVectorSwizzle:
+        {
+            TIntermAggregate *offsets = right->getAsAggregate();
+            if (offsets == NULL || left->isArray() || left->isMatrix() ||
+                !IsArithmeticType(left->getType()))
+            {
+                return false;
+            }
+            TIntermSequence *sequence = offsets->getSequence();
+            if (sequence->empty() || sequence->size() > 4)
+                return false;
+            for (size_t i = 0; i < sequence->size(); ++i)
+            {
+                TIntermTyped *offset = (*sequence)[i]->getAsTyped();
+                if (offset == NULL || !IsConstantIndex(offset, left->getNominalSize(), false))
+                    return false;
+            }
+            return true;
+        }
+      case EOpComma:
+        return true;
+      case EOpAssign:
+      case EOpInitialize:
+      case EOpEqual:
+      case EOpNotEqual:
+        return left->getBasicType() != EbtVoid && !IsSampler(left->getBasicType()) &&
+               right->getBasicType() != EbtVoid && !IsSampler(right->getBasicType());
+      default:
+        return IsArithmeticType(left->getType()) && IsArithmeticType(right->getType());
+    }
+}
+
+bool IsValidAggregate(TIntermAggregate *node)
+{
+    TOperator op = node->getOp();
+    TIntermSequence *sequence = node->getSequence();
+    switch (op)
+    {
+      case EOpNull:
+      case EOpSequence:
+      case EOpFunction:
+      case EOpParameters:
+        return true;
+      case EOpFunctionCall:
+      case EOpPrototype:
+        if (node->getName().empty())
+            return false;
+        break;
+      case EOpConstructStruct:
+        if (node->getType().getStruct() == NULL)
+            return false;
+        break;
+      case EOpDeclaration:
+      case EOpInvariantDeclaration:
+        break;
+      default:
+        if (op >= EOpConstructInt && op <= EOpConstructMat4)
+        {
+            TBasicType basicType = node->getBasicType();
+            if (basicType != EbtFloat && basicType != EbtInt && basicType != EbtUInt &&
+                basicType != EbtBool)
+            {
+                return false;
+            }
+        }
+        else if (sequence->size() < 2)
+        {
+            // Built-in functions of one argument are unary nodes.
+            return false;
+        }
+        break;
+    }
+
+    // The arguments of calls and constructors, and declarations.
+    for (size_t i = 0; i < sequence->size(); ++i)
+    {
+        TIntermTyped *child = (*sequence)[i]->getAsTyped();
+        if (child == NULL || (op != EOpPrototype && child->getBasicType() == EbtVoid))
+            return false;
+    }
+    return true;
+}
+
+class TreeWriter
+{
+  public:
+    TreeWriter() : mStringCount(0), mTableSize(0), mDepth(0), mMaxDepth(0) {}
+
+    void writeNode(TIntermNode *node);
+    // Writes the tables, followed by the nodes written so far.
+    void finish(BlobWriter *writer) const;
+
+    int getMaxDepth() const { return mMaxDepth; }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(TreeWriter);
+
+    int getString(const TString &value);
+    int getType(const TType &type);
+    int getFieldList(const TFieldListCollection *fieldList, TableEntryKind kind);
+    // Writes the properties of |type| to the table. The interface block of
+    // the types of fields is written as a FieldBlock, |owner| being the
+    // block that has the fields, if any.
+    void writeTypeProperties(const TType &type, bool field, const TInterfaceBlock *owner);
+    void writeFields(const TFieldList &fields, const TInterfaceBlock *owner);
+    void writeLine(const TSourceLoc &line);
+    void writeConstantUnion(TIntermConstantUnion *node, int type, size_t size);
+
+    std::map<TString, int> mStringIndices;
+    BlobWriter mStrings;
+    int mStringCount;
+
+    std::map<const TType *, int> mTypeIndices;
+    std::map<const TFieldListCollection *, int> mFieldListIndices;
+    BlobWriter mTable;
+    int mTableSize;
+
+    BlobWriter mNodes;
+    int mDepth;
+    int mMaxDepth;
+};
+
+int TreeWriter::getString(const TString &value)
+{
+    std::map<TString, int>::const_iterator found = mStringIndices.find(value);
+    if (found != mStringIndices.end())
+        return found->second;
+
+    mStrings.writeString(std::string(value.c_str(), value.size()));
+    mStringIndices[value] = mStringCount;
+    return mStringCount++;
+}
+
+int TreeWriter::getType(const TType &type)
+{
+    std::map<const TType *, int>::const_iterator found = mTypeIndices.find(&type);
+    if (found != mTypeIndices.end())
+        return found->second;
+
+    // The structures the type refers to come first.
+    if (type.getStruct())
+        getFieldList(type.getStruct(), kStructureEntry);
+    if (type.getInterfaceBlock())
+        getFieldList(type.getInterfaceBlock(), kInterfaceBlockEntry);
+
+    mTable.writeVarInt(kTypeEntry);
+    writeTypeProperties(type, false, NULL);
+    mTypeIndices[&type] = mTableSize;
+    return mTableSize++;
+}
+
+int TreeWriter::getFieldList(const TFieldListCollection *fieldList, TableEntryKind kind)
+{
+    std::map<const TFieldListCollection *, int>::const_iterator found =
+        mFieldListIndices.find(fieldList);
+    if (found != mFieldListIndices.end())
+        return found->second;
+
+    const TInterfaceBlock *block = NULL;
+    if (kind == kInterfaceBlockEntry)
+        block = static_cast<const TInterfaceBlock *>(fieldList);
+
+    const TFieldList &fields = fieldList->fields();
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        const TType *fieldType = fields[i]->type();
+        if (fieldType->getStruct())
+            getFieldList(fieldType->getStruct(), kStructureEntry);
+    }
+
+    mTable.writeVarInt(kind);
+    mTable.writeVarInt(getString(fieldList->name()));
+    if (block)
+    {
+        mTable.writeVarInt(block->hasInstanceName());
+        if (block->hasInstanceName())
+            mTable.writeVarInt(getString(block->instanceName()));
+        mTable.writeVarInt(block->arraySize());
+        mTable.writeVarInt(block->blockStorage());
+        mTable.writeVarInt(block->matrixPacking());
+    }
+    writeFields(fields, block);
+
+    mFieldListIndices[fieldList] = mTableSize;
+    return mTableSize++;
+}
+
+void TreeWriter::writeTypeProperties(const TType &type, bool field,
+                                     const TInterfaceBlock *owner)
+{
+    mTable.writeVarInt(type.getBasicType());
+    mTable.writeVarInt(type.getPrecision());
+    mTable.writeVarInt(type.getQualifier());
+    TLayoutQualifier layoutQualifier = type.getLayoutQualifier();
+    mTable.writeVarInt(layoutQualifier.location);
+    mTable.writeVarInt(layoutQualifier.matrixPacking);
+    mTable.writeVarInt(layoutQualifier.blockStorage);
+    mTable.writeVarInt(type.getNominalSize());
+    mTable.writeVarInt(type.getSecondarySize());
+    mTable.writeVarInt(type.isArray());
+    mTable.writeVarInt(type.getArraySize());
+
+    // Table indices are written plus one, so that zero means none.
+    mTable.writeVarInt(type.getStruct() ? mFieldListIndices[type.getStruct()] + 1 : 0);
+    const TInterfaceBlock *block = type.getInterfaceBlock();
+    if (field)
+        mTable.writeVarInt(block != NULL && block == owner ? kOwnerBlock : kNoBlock);
+    else
+        mTable.writeVarInt(block ? mFieldListIndices[block] + 1 : 0);
+}
+
+void TreeWriter::writeFields(const TFieldList &fields, const TInterfaceBlock *owner)
+{
+    mTable.writeVarInt(static_cast<int>(fields.size()));
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        mTable.writeVarInt(getString(fields[i]->name()));
+        const TSourceLoc &line = fields[i]->line();
+        mTable.writeVarInt(line.first_file);
+        mTable.writeVarInt(line.first_line);
+        mTable.writeVarInt(line.last_file);
+        mTable.writeVarInt(line.last_line);
+        writeTypeProperties(*fields[i]->type(), true, owner);
+    }
+}
+
+void TreeWriter::writeLine(const TSourceLoc &line)
+{
+    // Most nodes start and end on the same line.
+    mNodes.writeVarInt(line.first_file);
+    mNodes.writeVarInt(line.first_line);
+    mNodes.writeVarInt(line.last_file - line.first_file);
+    mNodes.writeVarInt(line.last_line - line.first_line);
+}
+
+void TreeWriter::writeConstantUnion(TIntermConstantUnion *node, int type, size_t size)
+{
+    mNodes.writeVarInt(kConstantUnionNode);
+    mNodes.writeVarInt(type);
+    writeLine(node->getLine());
+
+    ConstantUnion *values = node->getUnionArrayPointer();
+    mNodes.writeVarInt(values != NULL ? static_cast<int>(size) : 0);
+    if (values == NULL)
+        return;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        mNodes.writeVarInt(values[i].getType());
+        switch (values[i].getType())
+        {
+          case EbtFloat:
+            {
+                // Floats are written as their bits, which are rarely small.
+                float value = values[i].getFConst();
+                int bits = 0;
+                memcpy(&bits, &value, sizeof(bits));
+                mNodes.writeInt(bits);
+            }
+            break;
+          case EbtInt:
+            mNodes.writeVarInt(values[i].getIConst());
+            break;
+          case EbtUInt:
+            mNodes.writeVarInt(static_cast<int>(values[i].getUConst()));
+            break;
+          case EbtBool:
+            mNodes.writeVarInt(values[i].getBConst());
+            break;
+          default:
+            break;
+        }
+    }
+}
+
+void TreeWriter::writeNode(TIntermNode *node)
+{
+    ScopedDepth depth(&mDepth, &mMaxDepth);
+    if (node == NULL)
+    {
+        mNodes.writeVarInt(kNullNode);
+        return;
+    }
+
+    if (TIntermTyped *typed = node->getAsTyped())
+    {
+        // The type is written first, as it may add entries to the tables.
+        int type = getType(typed->getType());
+
+        if (TIntermSymbol *symbol = node->getAsSymbolNode())
+        {
+            mNodes.writeVarInt(kSymbolNode);
+            mNodes.writeVarInt(type);
+            writeLine(node->getLine());
+            mNodes.writeVarInt(symbol->getId());
+            mNodes.writeVarInt(getString(symbol->getSymbol()));
+            return;
+        }
+
+        if (TIntermRaw *raw = node->getAsRawNode())
+        {
+            mNodes.writeVarInt(kRawNode);
+            mNodes.writeVarInt(type);
+            writeLine(node->getLine());
+            mNodes.writeVarInt(getString(raw->getRawText()));
+            return;
+        }
+
+        if (TIntermConstantUnion *constant = node->getAsConstantUnion())
+        {
+            writeConstantUnion(constant, type, constant->getType().getObjectSize());
+            return;
+        }
+
+        if (TIntermBinary *binary = node->getAsBinaryNode())
+        {
+            mNodes.writeVarInt(kBinaryNode);
+            mNodes.writeVarInt(type);
+            writeLine(node->getLine());
+            mNodes.writeVarInt(binary->getOp());
+            mNodes.writeVarInt(binary->getAddIndexClamp());
+            writeNode(binary->getLeft());
+
+            // The indices of fields have the type of the field, but a
+            // single value.
+            TIntermConstantUnion *fieldIndex = binary->getRight()->getAsConstantUnion();
+            if (fieldIndex && (binary->getOp() == EOpIndexDirectStruct ||
+                               binary->getOp() == EOpIndexDirectInterfaceBlock))
+            {
+                ScopedDepth indexDepth(&mDepth, &mMaxDepth);
+                writeConstantUnion(fieldIndex, getType(fieldIndex->getType()), 1);
+            }
+            else
+            {
+                writeNode(binary->getRight());
+            }
+            return;
+        }
+
+        if (TIntermUnary *unary = node->getAsUnaryNode())
+        {
+            mNodes.writeVarInt(kUnaryNode);
+            mNodes.writeVarInt(type);
+            writeLine(node->getLine());
+            mNodes.writeVarInt(unary->getOp());
+            mNodes.writeVarInt(unary->getUseEmulatedFunction());
+            writeNode(unary->getOperand());
+            return;
+        }
+
+        if (TIntermAggregate *aggregate = node->getAsAggregate())
+        {
+            mNodes.writeVarInt(kAggregateNode);
+            mNodes.writeVarInt(type);
+            writeLine(node->getLine());
+            mNodes.writeVarInt(aggregate->getOp());
+            mNodes.writeVarInt(getString(aggregate->getName()));
+            mNodes.writeVarInt(aggregate->isUserDefined());
+            mNodes.writeVarInt(aggregate->getOptimize());
+            mNodes.writeVarInt(aggregate->getDebug());
+            mNodes.writeVarInt(aggregate->getUseEmulatedFunction());
+
+            TIntermSequence *sequence = aggregate->getSequence();
+            mNodes.writeVarInt(static_cast<int>(sequence->size()));
+            for (size_t i = 0; i < sequence->size(); ++i)
+                writeNode((*sequence)[i]);
+            return;
+        }
+
+        if (TIntermSelection *selection = node->getAsSelectionNode())
+        {
+            mNodes.writeVarInt(kSelectionNode);
+            mNodes.writeVarInt(type);
+            writeLine(node->getLine());
+            writeNode(selection->getCondition());
+            writeNode(selection->getTrueBlock());
+            writeNode(selection->getFalseBlock());
+            return;
+        }
+    }
+
+    if (TIntermLoop *loop = node->getAsLoopNode())
+    {
+        mNodes.writeVarInt(kLoopNode);
+        writeLine(node->getLine());
+        mNodes.writeVarInt(loop->getType());
+        mNodes.writeVarInt(loop->getUnrollFlag());
+        writeNode(loop->getInit());
+        writeNode(loop->getCondition());
+        writeNode(loop->getExpression());
+        writeNode(loop->getBody());
+        return;
+    }
+
+    if (TIntermBranch *branch = node->getAsBranchNode())
+    {
+        mNodes.writeVarInt(kBranchNode);
+        writeLine(node->getLine());
+        mNodes.writeVarInt(branch->getFlowOp());
+        writeNode(branch->getExpression());
+        return;
+    }
+
+    UNREACHABLE();
+}
+
+void TreeWriter::finish(BlobWriter *writer) const
+{
+    writer->writeVarInt(mStringCount);
+    writer->writeString(mStrings.data());
+    writer->writeVarInt(mTableSize);
+    writer->writeString(mTable.data());
+    writer->writeString(mNodes.data());
+}
+
+class TreeReader
+{
+  public:
+    TreeReader()
+        : mError(false),
+          mDepth(0),
+          mMaxDepth(0),
+          mFieldIndex(false),
+          mEmptyString(NULL),
+          mVoidType(NULL)
+    {
+    }
+
+    // Returns NULL if the data is not a valid tree.
+    TIntermNode *read(BlobReader *reader);
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(TreeReader);
+
+    struct TableEntry
+    {
+        TType *type;
+        TStructure *structure;
+        TInterfaceBlock *interfaceBlock;
+    };
+
+    bool readStrings(BlobReader *reader);
+    bool readTable(BlobReader *reader);
+    // Reads a value between 0 and |max|, or sets the error flag.
+    int readEnum(BlobReader *reader, int max);
+    const TString &readString(BlobReader *reader);
+    // Reads the properties written by TreeWriter::writeTypeProperties().
+    // The FieldBlock of fields is returned in |ownerBlock|, which is NULL
+    // for the other types.
+    TType *readTypeProperties(BlobReader *reader, bool *ownerBlock);
+    // Reads fields, returning whether the type of each belongs to the
+    // interface block that has them in |ownerBlockFields| if it is not NULL.
+    TFieldList *readFields(BlobReader *reader, std::vector<bool> *ownerBlockFields);
+    TSourceLoc readLine(BlobReader *reader);
+    const TType &readType(BlobReader *reader);
+
+    TIntermNode *readNode(BlobReader *reader);
+    TIntermTyped *readTyped(BlobReader *reader, bool optional);
+
+    bool mError;
+    int mDepth;
+    int mMaxDepth;
+    // Set while the next node read is the index of a field.
+    bool mFieldIndex;
+    // Returned when reading a string or a type fails.
+    const TString *mEmptyString;
+    const TType *mVoidType;
+    std::vector<const TString *> mStrings;
+    std::vector<TableEntry> mTable;
+    std::map<int, int> mSymbolIds;
+};
+
+int TreeReader::readEnum(BlobReader *reader, int max)
+{
+    int value = reader->readVarInt();
+    if (value < 0 || value > max)
+    {
+        mError = true;
+        return 0;
+    }
+    return value;
+}
+
+const TString &TreeReader::readString(BlobReader *reader)
+{
+    if (mStrings.empty())
+    {
+        mError = true;
+        return *mEmptyString;
+    }
+    return *mStrings[readEnum(reader, static_cast<int>(mStrings.size()) - 1)];
+}
+
+bool TreeReader::readStrings(BlobReader *reader)
+{
+    int count = reader->readVarInt();
+    std::string data;
+    reader->readString(&data);
+    if (reader->error() || count < 0 || static_cast<size_t>(count) > data.size() / 4)
+        return false;
+
+    BlobReader strings(data);
+    mStrings.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        std::string value;
+        strings.readString(&value);
+        mStrings.push_back(NewPoolTString(value.c_str()));
+    }
+    return !strings.error() && strings.endOfData();
+}
+
+TType *TreeReader::readTypeProperties(BlobReader *reader, bool *ownerBlock)
+{
+    TBasicType basicType = static_cast<TBasicType>(readEnum(reader, EbtAddress));
+    TPrecision precision = static_cast<TPrecision>(readEnum(reader, EbpHigh));
+    TQualifier qualifier = static_cast<TQualifier>(readEnum(reader, EvqLast - 1));
+    TLayoutQualifier layoutQualifier = TLayoutQualifier::create();
+    layoutQualifier.location = reader->readVarInt();
+    layoutQualifier.matrixPacking =
+        static_cast<TLayoutMatrixPacking>(readEnum(reader, EmpColumnMajor));
+    layoutQualifier.blockStorage = static_cast<TLayoutBlockStorage>(readEnum(reader, EbsStd140));
+    int primarySize = readEnum(reader, 4);
+    int secondarySize = readEnum(reader, 4);
+    bool array = readEnum(reader, 1) != 0;
+    int arraySize = reader->readVarInt();
+
+    TType *type = new TType(basicType, precision, qualifier,
+                            static_cast<unsigned char>(primarySize),
+                            static_cast<unsigned char>(secondarySize));
+    type->setLayoutQualifier(layoutQualifier);
+    if (array)
+        type->setArraySize(arraySize);
+
+    int tableSize = static_cast<int>(mTable.size());
+    int structure = readEnum(reader, tableSize);
+    if (structure > 0)
+    {
+        if (mTable[structure - 1].structure == NULL)
+            mError = true;
+        type->setStruct(mTable[structure - 1].structure);
+    }
+    if (ownerBlock)
+    {
+        // The block does not exist yet, and is set by the caller.
+        *ownerBlock = (readEnum(reader, kOwnerBlock) == kOwnerBlock);
+    }
+    else
+    {
+        int interfaceBlock = readEnum(reader, tableSize);
+        if (interfaceBlock > 0)
+        {
+            if (mTable[interfaceBlock - 1].interfaceBlock == NULL)
+                mError = true;
+            type->setInterfaceBlock(mTable[interfaceBlock - 1].interfaceBlock);
+        }
+    }
+
+    if (primarySize == 0 || secondarySize == 0 || arraySize < 0 ||
+        (basicType == EbtStruct) != (type->getStruct() != NULL))
+    {
+        mError = true;
+    }
+    return type;
+}
+
+TFieldList *TreeReader::readFields(BlobReader *reader, std::vector<bool> *ownerBlockFields)
+{
+    int count = reader->readVarInt();
+    if (count < 0 || static_cast<size_t>(count) > reader->remainingSize())
+    {
+        mError = true;
+        return NULL;
+    }
+
+    TFieldList *fields = NewPoolTFieldList();
+    for (int i = 0; i < count && !mError; ++i)
+    {
+        const TString &name = readString(reader);
+        TSourceLoc line;
+        line.first_file = reader->readVarInt();
+        line.first_line = reader->readVarInt();
+        line.last_file = reader->readVarInt();
+        line.last_line = reader->readVarInt();
+        bool ownerBlock = false;
+        TType *type = readTypeProperties(reader, &ownerBlock);
+
+        // Fields of structures cannot belong to interface blocks.
+        if (ownerBlock && ownerBlockFields == NULL)
+            mError = true;
+        if (ownerBlockFields)
+            ownerBlockFields->push_back(ownerBlock);
+
+        fields->push_back(new TField(type, NewPoolTString(name.c_str()), line));
+    }
+    return fields;
+}
+
+bool TreeReader::readTable(BlobReader *reader)
+{
+    int size = reader->readVarInt();
+    std::string data;
+    reader->readString(&data);
+    if (reader->error() || size < 0 || static_cast<size_t>(size) > data.size())
+        return false;
+
+    BlobReader table(data);
+    mTable.reserve(size);
+    for (int i = 0; i < size && !mError && !table.error(); ++i)
+    {
+        TableEntry entry = { NULL, NULL, NULL };
+        switch (readEnum(&table, kInterfaceBlockEntry))
+        {
+          case kTypeEntry:
+            entry.type = readTypeProperties(&table, NULL);
+            break;
+          case kStructureEntry:
+            {
+                const TString &name = readString(&table);
+                TFieldList *fields = readFields(&table, NULL);
+                entry.structure = new TStructure(NewPoolTString(name.c_str()), fields);
+                entry.structure->setUniqueId(TSymbolTable::nextUniqueId());
+            }
+            break;
+          case kInterfaceBlockEntry:
+            {
+                const TString &name = readString(&table);
+                const TString *instanceName = NULL;
+                if (readEnum(&table, 1))
+                    instanceName = NewPoolTString(readString(&table).c_str());
+                int arraySize = table.readVarInt();
+                TLayoutQualifier layoutQualifier = TLayoutQualifier::create();
+                layoutQualifier.blockStorage =
+                    static_cast<TLayoutBlockStorage>(readEnum(&table, EbsStd140));
+                layoutQualifier.matrixPacking =
+                    static_cast<TLayoutMatrixPacking>(readEnum(&table, EmpColumnMajor));
+
+                std::vector<bool> ownerBlockFields;
+                TFieldList *fields = readFields(&table, &ownerBlockFields);
+                if (mError)
+                    break;
+                entry.interfaceBlock = new TInterfaceBlock(NewPoolTString(name.c_str()), fields,
+                                                           instanceName, arraySize,
+                                                           layoutQualifier);
+                for (size_t j = 0; j < fields->size(); ++j)
+                {
+                    if (ownerBlockFields[j])
+                        (*fields)[j]->type()->setInterfaceBlock(entry.interfaceBlock);
+                }
+            }
+            break;
+        }
+        mTable.push_back(entry);
+    }
+    return !mError && !table.error() && table.endOfData();
+}
+
+TSourceLoc TreeReader::readLine(BlobReader *reader)
+{
+    TSourceLoc line;
+    line.first_file = reader->readVarInt();
+    line.first_line = reader->readVarInt();
+    line.last_file = line.first_file + reader->readVarInt();
+    line.last_line = line.first_line + reader->readVarInt();
+    return line;
+}
+
+const TType &TreeReader::readType(BlobReader *reader)
+{
+    if (mTable.empty())
+    {
+        mError = true;
+        return *mVoidType;
+    }
+
+    const TableEntry &entry = mTable[readEnum(reader, static_cast<int>(mTable.size()) - 1)];
+    if (entry.type == NULL)
+    {
+        mError = true;
+        return *mVoidType;
+    }
+    return *entry.type;
+}
+
+TIntermTyped *TreeReader::readTyped(BlobReader *reader, bool optional)
+{
+    TIntermNode *node = readNode(reader);
+    if (node == NULL)
+    {
+        if (!optional)
+            mError = true;
+        return NULL;
+    }
+
+    if (node->getAsTyped() == NULL)
+        mError = true;
+    return node->getAsTyped();
+}
+
+TIntermNode *TreeReader::readNode(BlobReader *reader)
+{
+    ScopedDepth depth(&mDepth, &mMaxDepth);
+    if (mDepth > kMaxSerializedTreeDepth)
+        mError = true;
+    bool fieldIndex = mFieldIndex;
+    mFieldIndex = false;
+
+    NodeKind kind = static_cast<NodeKind>(readEnum(reader, kBranchNode));
+    if (mError || reader->error() || kind == kNullNode)
+        return NULL;
+
+    if (kind == kLoopNode)
+    {
+        TSourceLoc line = readLine(reader);
+        TLoopType type = static_cast<TLoopType>(readEnum(reader, ELoopDoWhile));
+        bool unroll = readEnum(reader, 1) != 0;
+        TIntermNode *init = readNode(reader);
+        TIntermTyped *condition = readTyped(reader, true);
+        TIntermTyped *expression = readTyped(reader, true);
+        TIntermNode *body = readNode(reader);
+        if (condition && !IsBoolCondition(condition))
+            mError = true;
+
+        TIntermLoop *loop = new TIntermLoop(type, init, condition, expression, body);
+        loop->setUnrollFlag(unroll);
+        loop->setLine(line);
+        return loop;
+    }
+
+    if (kind == kBranchNode)
+    {
+        TSourceLoc line = readLine(reader);
+        TOperator op = static_cast<TOperator>(readEnum(reader, EOpDivAssign));
+        TIntermTyped *expression = readTyped(reader, true);
+        if (op < EOpKill || op > EOpContinue || (expression != NULL && op != EOpReturn))
+            mError = true;
+        TIntermBranch *branch = new TIntermBranch(op, expression);
+        branch->setLine(line);
+        return branch;
+    }
+
+    const TType &type = readType(reader);
+    TSourceLoc line = readLine(reader);
+    TIntermTyped *node = NULL;
+    switch (kind)
+    {
+      case kSymbolNode:
+        {
+            // Ids are only compared within the tree, and are replaced by
+            // ids that no other symbol of this process has.
+            int id = reader->readVarInt();
+            if (id > 0)
+            {
+                std::map<int, int>::iterator found = mSymbolIds.find(id);
+                if (found == mSymbolIds.end())
+                    found = mSymbolIds.insert(std::make_pair(id, TSymbolTable::nextUniqueId())).first;
+                id = found->second;
+            }
+            node = new TIntermSymbol(id, readString(reader), type);
+        }
+        break;
+      case kRawNode:
+        node = new TIntermRaw(type, readString(reader));
+        break;
+      case kConstantUnionNode:
+        {
+            // Indices of fields have fewer values than their type has,
+            // and the values that are not written are left zero.
+            ConstantUnion *values = NULL;
+            size_t size = type.getObjectSize();
+            int count = reader->readVarInt();
+            if (count < 0 || static_cast<size_t>(count) > size ||
+                static_cast<size_t>(count) > reader->remainingSize())
+            {
+                mError = true;
+                return NULL;
+            }
+            // Constants of structures hold the values of their fields.
+            TBasicType basicType = type.getBasicType();
+            if ((basicType != EbtFloat && basicType != EbtInt && basicType != EbtUInt &&
+                 basicType != EbtBool && basicType != EbtStruct) ||
+                (fieldIndex && count != 1))
+            {
+                mError = true;
+                return NULL;
+            }
+            if (count > 0)
+            {
+                values = new ConstantUnion[size];
+                for (int i = 0; i < count; ++i)
+                {
+                    TBasicType valueType = static_cast<TBasicType>(readEnum(reader, EbtBool));
+                    if (fieldIndex ? valueType != EbtInt :
+                                     (basicType != EbtStruct && valueType != basicType))
+                    {
+                        mError = true;
+                    }
+                    switch (valueType)
+                    {
+                      case EbtFloat:
+                        {
+                            int bits = reader->readInt();
+                            float value = 0.0f;
+                            memcpy(&value, &bits, sizeof(value));
+                            values[i].setFConst(value);
+                        }
+                        break;
+                      case EbtInt:
+                        values[i].setIConst(reader->readVarInt());
+                        break;
+                      case EbtUInt:
+                        values[i].setUConst(static_cast<unsigned int>(reader->readVarInt()));
+                        break;
+                      case EbtBool:
+                        values[i].setBConst(reader->readVarInt() != 0);
+                        break;
+                      default:
+                        break;
+                    }
+                }
+            }
+            node = new TIntermConstantUnion(values, type);
+        }
+        break;
+      case kBinaryNode:
+        {
+            TOperator op = static_cast<TOperator>(readEnum(reader, EOpDivAssign));
+            TIntermBinary *binary = new TIntermBinary(op);
+            binary->setType(type);
+            if (readEnum(reader, 1))
+                binary->setAddIndexClamp();
+            binary->setLeft(readTyped(reader, false));
+            mFieldIndex = (op == EOpIndexDirectStruct || op == EOpIndexDirectInterfaceBlock);
+            binary->setRight(readTyped(reader, false));
+            if (mError || !IsBinaryOp(op) || !IsValidBinary(binary))
+            {
+                mError = true;
+                return NULL;
+            }
+            node = binary;
+        }
+        break;
+      case kUnaryNode:
+        {
+            TOperator op = static_cast<TOperator>(readEnum(reader, EOpDivAssign));
+            TIntermUnary *unary = new TIntermUnary(op, type);
+            if (readEnum(reader, 1))
+                unary->setUseEmulatedFunction();
+            unary->setOperand(readTyped(reader, false));
+            if (mError || !IsUnaryOp(op) || !IsArithmeticType(unary->getOperand()->getType()))
+            {
+                mError = true;
+                return NULL;
+            }
+            node = unary;
+        }
+        break;
+      case kAggregateNode:
+        {
+            TOperator op = static_cast<TOperator>(readEnum(reader, EOpDivAssign));
+            TIntermAggregate *aggregate = new TIntermAggregate(op);
+            aggregate->setType(type);
+            aggregate->setName(readString(reader));
+            if (readEnum(reader, 1))
+                aggregate->setUserDefined();
+            aggregate->setOptimize(readEnum(reader, 1) != 0);
+            aggregate->setDebug(readEnum(reader, 1) != 0);
+            if (readEnum(reader, 1))
+                aggregate->setUseEmulatedFunction();
+
+            int count = reader->readVarInt();
+            if (count < 0 || static_cast<size_t>(count) > reader->remainingSize())
+            {
+                mError = true;
+                return NULL;
+            }
+            TIntermSequence *sequence = aggregate->getSequence();
+            sequence->reserve(count);
+            for (int i = 0; i < count && !mError; ++i)
+            {
+                TIntermNode *child = readNode(reader);
+                if (child == NULL)
+                    mError = true;
+                sequence->push_back(child);
+            }
+            if (mError || !IsAggregateOp(op) || !IsValidAggregate(aggregate))
+            {
+                mError = true;
+                return NULL;
+            }
+            node = aggregate;
+        }
+        break;
+      case kSelectionNode:
+        {
+            TIntermTyped *condition = readTyped(reader, false);
+            TIntermNode *trueBlock = readNode(reader);
+            TIntermNode *falseBlock = readNode(reader);
+            if (mError || !IsBoolCondition(condition))
+            {
+                mError = true;
+                return NULL;
+            }
+            // The ternary operator has a type, and an expression on each
+            // side.
+            if (type.getBasicType() != EbtVoid &&
+                (trueBlock == NULL || trueBlock->getAsTyped() == NULL ||
+                 falseBlock == NULL || falseBlock->getAsTyped() == NULL))
+            {
+                mError = true;
+                return NULL;
+            }
+            node = new TIntermSelection(condition, trueBlock, falseBlock, type);
+        }
+        break;
+      default:
+        UNREACHABLE();
+        return NULL;
+    }
+
+    node->setLine(line);
+    return node;
+}
+
+TIntermNode *TreeReader::read(BlobReader *reader)
+{
+    mEmptyString = NewPoolTString("");
+    mVoidType = new TType(EbtVoid, EbpUndefined);
+    if (!readStrings(reader) || !readTable(reader))
+        return NULL;
+
+    std::string nodes;
+    reader->readString(&nodes);
+    if (reader->error())
+        return NULL;
+
+    BlobReader nodeReader(nodes);
+    TIntermNode *root = readNode(&nodeReader);
+    if (mError || nodeReader.error() || !nodeReader.endOfData())
+        return NULL;
+    return root;
+}
+
+}  // anonymous namespace
+
+bool SerializeTree(TIntermNode *root, BlobWriter *writer)
+{
+    TreeWriter treeWriter;
+    treeWriter.writeNode(root);
+    if (treeWriter.getMaxDepth() > kMaxSerializedTreeDepth)
+        return false;
+    treeWriter.finish(writer);
+    return true;
+}
+
+TIntermNode *DeserializeTree(BlobReader *reader)
+{
+    TreeReader treeReader;
+    return treeReader.read(reader);
+}
+
+}
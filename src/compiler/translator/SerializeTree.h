@@ -0,0 +1,38 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// SerializeTree.h: Binary serialization of an intermediate tree.
+//
+
+#ifndef COMPILER_SERIALIZE_TREE_H_
+#define COMPILER_SERIALIZE_TREE_H_
+
+class BlobReader;
+class BlobWriter;
+class TIntermNode;
+
+namespace sh
+{
+
+// Trees are read recursively, so deeper ones are neither written nor read.
+const int kMaxSerializedTreeDepth = 1024;
+
+// Appends the tree under |root| to |writer|. Every node is written with
+// its line, its annotations and the values of its constants. The types,
+// structures and strings of the tree are written once each, in tables that
+// precede the nodes. Returns false, having written nothing, if the tree is
+// nested deeper than kMaxSerializedTreeDepth.
+bool SerializeTree(TIntermNode *root, BlobWriter *writer);
+
+// Reads a tree written by SerializeTree, allocated from the current pool.
+// Structures and symbols get new unique ids, so that the tree can be used
+// with those of this process. Returns NULL if the data is not a valid tree:
+// one nested too deeply, or with a node whose operator, type or children
+// the parser would not have given it.
+TIntermNode *DeserializeTree(BlobReader *reader);
+
+}
+
+#endif // COMPILER_SERIALIZE_TREE_H_
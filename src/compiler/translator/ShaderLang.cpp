@@ -11,13 +11,21 @@
 
 #include "GLSLANG/ShaderLang.h"
 
+#include "compiler/translator/CompileStatistics.h"
 #include "compiler/translator/Compiler.h"
 #include "compiler/translator/InitializeDll.h"
 #include "compiler/translator/length_limits.h"
+#include "compiler/translator/Prologue.h"
+#include "compiler/translator/TranslationCache.h"
 #include "compiler/translator/TranslatorHLSL.h"
 #include "compiler/translator/VariablePacker.h"
 #include "angle_gl.h"
 
+#include "common/mutex.h"
+#include "common/workerpool.h"
+
+#include <algorithm>
+
 namespace
 {
 
@@ -32,6 +40,39 @@ enum ShaderVariableType
     
 bool isInitialized = false;
 
+// Created by the first ShCompileBatch call, destroyed by ShFinalize.
+Mutex gCompileWorkerPoolMutex;
+WorkerPool *gCompileWorkerPool = NULL;
+
+class CompileTask : public WorkerTask
+{
+  public:
+    explicit CompileTask(ShCompileJob *job)
+        : mJob(job)
+    {
+    }
+
+    virtual void run()
+    {
+        mJob->result = ShCompile(mJob->handle, mJob->shaderStrings,
+                                 mJob->numStrings, mJob->compileOptions);
+    }
+
+  private:
+    ShCompileJob *mJob;
+};
+
+WorkerPool *GetCompileWorkerPool()
+{
+    ScopedLock lock(&gCompileWorkerPoolMutex);
+    if (!gCompileWorkerPool)
+    {
+        // The thread calling ShCompileBatch compiles too.
+        gCompileWorkerPool = new WorkerPool(WorkerPool::GetProcessorCount() - 1);
+    }
+    return gCompileWorkerPool;
+}
+
 //
 // This is the platform independent interface between an OGL driver
 // and the shading language compiler.
@@ -122,6 +163,11 @@ bool ShFinalize()
 {
     if (isInitialized)
     {
+        {
+            ScopedLock lock(&gCompileWorkerPoolMutex);
+            delete gCompileWorkerPool;
+            gCompileWorkerPool = NULL;
+        }
         DetachProcess();
         isInitialized = false;
     }
@@ -172,6 +218,8 @@ void ShInitBuiltInResources(ShBuiltInResources* resources)
 
     resources->MaxExpressionComplexity = 256;
     resources->MaxCallStackDepth = 256;
+    resources->MaxUnrolledLoopCost = 512;
+    resources->MaxCompileMemory = 64 * 1024 * 1024;
 }
 
 //
@@ -232,6 +280,151 @@ bool ShCompile(
     return compiler->compile(shaderStrings, numStrings, compileOptions);
 }
 
+bool ShCompileBatch(ShCompileJob *jobs, size_t numJobs)
+{
+    std::vector<CompileTask> tasks;
+    tasks.reserve(numJobs);
+    std::vector<WorkerTask*> taskPointers(numJobs);
+    for (size_t i = 0; i < numJobs; ++i)
+    {
+        tasks.push_back(CompileTask(&jobs[i]));
+        taskPointers[i] = &tasks[i];
+    }
+
+    if (numJobs > 0)
+    {
+        GetCompileWorkerPool()->runTasks(&taskPointers[0], numJobs);
+    }
+
+    bool success = true;
+    for (size_t i = 0; i < numJobs; ++i)
+    {
+        success = success && jobs[i].result;
+    }
+    return success;
+}
+
+bool ShCompileMultipleTargets(
+    const ShHandle handles[],
+    size_t numHandles,
+    const char *const shaderStrings[],
+    size_t numStrings,
+    int compileOptions)
+{
+    if (numHandles == 0)
+        return true;
+
+    std::vector<TCompiler*> compilers(numHandles);
+    for (size_t i = 0; i < numHandles; ++i)
+    {
+        compilers[i] = GetCompilerFromHandle(handles[i]);
+        ASSERT(compilers[i]);
+    }
+
+    return compilers[0]->compileMultipleTargets(shaderStrings, numStrings, compileOptions,
+                                                &compilers[0] + 1, numHandles - 1);
+}
+
+bool ShCompileSerializedAST(
+    const ShHandle handle,
+    const char *serializedAST,
+    size_t length,
+    int compileOptions)
+{
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+
+    return compiler->compileSerializedAST(serializedAST, length, compileOptions);
+}
+
+ShPrologue ShCreatePrologue(
+    const ShHandle handle,
+    const char *const prologueStrings[],
+    size_t numStrings)
+{
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+
+    return compiler->createPrologue(prologueStrings, numStrings);
+}
+
+void ShDestructPrologue(ShPrologue prologue)
+{
+    delete static_cast<TPrologue *>(prologue);
+}
+
+bool ShSetPrologue(const ShHandle handle, const ShPrologue prologue)
+{
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+
+    return compiler->setPrologue(static_cast<const TPrologue *>(prologue));
+}
+
+bool ShLinkVaryings(const ShHandle vertexHandle, const ShHandle fragmentHandle)
+{
+    TCompiler *vertexCompiler = GetCompilerFromHandle(vertexHandle);
+    TCompiler *fragmentCompiler = GetCompilerFromHandle(fragmentHandle);
+    if (!vertexCompiler || !fragmentCompiler)
+        return false;
+
+    return vertexCompiler->linkVaryings(fragmentCompiler);
+}
+
+bool ShGetPoolAllocatorStats(const ShHandle handle, ShPoolAllocatorStats *stats)
+{
+    if (!handle || !stats)
+        return false;
+
+    TShHandleBase *base = static_cast<TShHandleBase *>(handle);
+    base->getPoolAllocator().getStats(stats);
+    return true;
+}
+
+bool ShGetCompileStatistics(const ShHandle handle, ShCompileStatistics *stats)
+{
+    if (!handle || !stats)
+        return false;
+
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    if (!compiler)
+        return false;
+
+    *stats = compiler->getCompileStatistics();
+    return true;
+}
+
+const char *ShGetCompilePhaseName(ShCompilePhase phase)
+{
+    return sh::GetCompilePhaseName(phase);
+}
+
+void ShSetPoolAllocatorMaxCachedBytes(const ShHandle handle, size_t maxBytes)
+{
+    if (!handle)
+        return;
+
+    TShHandleBase *base = static_cast<TShHandleBase *>(handle);
+    TPoolAllocator &allocator = base->getPoolAllocator();
+    allocator.setMaxCachedPages(maxBytes / allocator.getPageSize());
+}
+
+void ShSetTranslationCacheMaxSize(size_t maxSize)
+{
+    GetTranslationCache()->setMaxSize(maxSize);
+}
+
+void ShSetTranslationCacheDirectory(const char *directory)
+{
+    GetTranslationCache()->setBackend(
+        directory ? new DirectoryTranslationCacheBackend(directory) : NULL);
+}
+
+void ShClearTranslationCache()
+{
+    GetTranslationCache()->clear();
+}
+
 int ShGetShaderVersion(const ShHandle handle)
 {
     TCompiler* compiler = GetCompilerFromHandle(handle);
@@ -270,6 +463,42 @@ const std::string &ShGetObjectCode(const ShHandle handle)
     return infoSink.obj.str();
 }
 
+const std::string &ShGetSerializedAST(const ShHandle handle)
+{
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+
+    return compiler->getSerializedAST();
+}
+
+size_t ShGetObjectCodeLength(const ShHandle handle)
+{
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+
+    TInfoSink &infoSink = compiler->getInfoSink();
+    return static_cast<size_t>(infoSink.obj.size());
+}
+
+//
+// Hand the object code to the application without concatenating it.
+//
+void ShGetObjectCodeChunks(const ShHandle handle,
+                           ShObjectCodeCallback callback,
+                           void *userData)
+{
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+    ASSERT(callback);
+
+    const TInfoSinkBase &obj = compiler->getInfoSink().obj;
+    for (size_t i = 0; i < obj.chunkCount(); ++i)
+    {
+        const TPersistString &chunk = obj.chunk(i);
+        callback(chunk.c_str(), chunk.size(), userData);
+    }
+}
+
 const std::map<std::string, std::string> *ShGetNameHashingMap(
     const ShHandle handle)
 {
@@ -319,6 +548,68 @@ bool ShCheckVariablesWithinPackingLimits(
     return packer.CheckVariablesWithinPackingLimits(maxVectors, variables);
 }
 
+bool ShPackVariables(int maxVectors, ShVariableInfo *varInfoArray, size_t varInfoArraySize,
+                     ShVariablePlacement *placementArray)
+{
+    if (varInfoArraySize == 0)
+        return true;
+    ASSERT(varInfoArray && placementArray);
+    std::vector<sh::ShaderVariable> variables;
+    for (size_t ii = 0; ii < varInfoArraySize; ++ii)
+    {
+        sh::ShaderVariable var(varInfoArray[ii].type, varInfoArray[ii].size);
+        variables.push_back(var);
+    }
+    VariablePacker packer;
+    std::vector<ShVariablePlacement> placements;
+    if (!packer.PackVariables(maxVectors, variables, &placements))
+        return false;
+    std::copy(placements.begin(), placements.end(), placementArray);
+    return true;
+}
+
+bool ShGetPackedUniformArray(const ShHandle handle,
+                             std::string *nameOut,
+                             std::string *mappedNameOut,
+                             int *sizeOut)
+{
+    ASSERT(nameOut && mappedNameOut && sizeOut);
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+
+    const sh::PackedUniforms &packedUniforms = compiler->getPackedUniforms();
+    if (packedUniforms.arraySize == 0)
+    {
+        return false;
+    }
+
+    *nameOut = packedUniforms.arrayName;
+    *mappedNameOut = packedUniforms.mappedArrayName;
+    *sizeOut = packedUniforms.arraySize;
+    return true;
+}
+
+bool ShGetPackedUniformPlacement(const ShHandle handle,
+                                 const std::string &uniformName,
+                                 ShVariablePlacement *placementOut)
+{
+    ASSERT(placementOut);
+    TCompiler *compiler = GetCompilerFromHandle(handle);
+    ASSERT(compiler);
+
+    const std::map<std::string, ShVariablePlacement> &placements =
+        compiler->getPackedUniforms().placements;
+    std::map<std::string, ShVariablePlacement>::const_iterator placement =
+        placements.find(uniformName);
+    if (placement == placements.end())
+    {
+        return false;
+    }
+
+    *placementOut = placement->second;
+    return true;
+}
+
 bool ShGetInterfaceBlockRegister(const ShHandle handle,
                                  const std::string &interfaceBlockName,
                                  unsigned int *indexOut)
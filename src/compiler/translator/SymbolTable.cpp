@@ -15,10 +15,21 @@
 
 #include "compiler/translator/SymbolTable.h"
 
+#include "common/platform.h"
+
 #include <stdio.h>
 #include <algorithm>
 
-int TSymbolTable::uniqueIdCounter = 0;
+volatile int TSymbolTable::uniqueIdCounter = 0;
+
+int TSymbolTable::nextUniqueId()
+{
+#if defined(ANGLE_PLATFORM_WINDOWS)
+    return InterlockedIncrement(reinterpret_cast<volatile LONG*>(&uniqueIdCounter));
+#else
+    return __sync_add_and_fetch(&uniqueIdCounter, 1);
+#endif
+}
 
 //
 // Functions have buried pointers to delete.
@@ -30,31 +41,88 @@ TFunction::~TFunction()
 }
 
 //
-// Symbol table levels are a map of pointers to symbols that have to be deleted.
+// Symbol table levels are a hash table of pointers to symbols that have to be deleted.
 //
 TSymbolTableLevel::~TSymbolTableLevel()
 {
-    for (tLevel::iterator it = level.begin(); it != level.end(); ++it)
-        delete (*it).second;
+    for (size_t i = 0; i < mSlots.size(); ++i)
+        delete mSlots[i].symbol;
+}
+
+size_t TSymbolTableLevel::HashName(const TString &name)
+{
+    // FNV-1a
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < name.size(); ++i)
+    {
+        hash ^= static_cast<unsigned char>(name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
 }
 
 bool TSymbolTableLevel::insert(TSymbol *symbol)
 {
     symbol->setUniqueId(TSymbolTable::nextUniqueId());
 
-    // returning true means symbol was added to the table
-    tInsertResult result = level.insert(tLevelPair(symbol->getMangledName(), symbol));
+    // Keep the table at most half full.
+    if ((mSymbolCount + 1) * 2 > mSlots.size())
+        grow();
 
-    return result.second;
+    const TString &name = symbol->getMangledName();
+    size_t hash = HashName(name);
+    size_t mask = mSlots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        Slot &slot = mSlots[i];
+        if (slot.symbol == NULL)
+        {
+            slot.hash = hash;
+            slot.symbol = symbol;
+            ++mSymbolCount;
+            // returning true means symbol was added to the table
+            return true;
+        }
+        if (slot.hash == hash && slot.symbol->getMangledName() == name)
+            return false;
+    }
 }
 
-TSymbol *TSymbolTableLevel::find(const TString &name) const
+TSymbol *TSymbolTableLevel::find(const TString &name, size_t hash) const
 {
-    tLevel::const_iterator it = level.find(name);
-    if (it == level.end())
+    if (mSymbolCount == 0)
         return 0;
-    else
-        return (*it).second;
+
+    size_t mask = mSlots.size() - 1;
+    for (size_t i = hash & mask; ; i = (i + 1) & mask)
+    {
+        const Slot &slot = mSlots[i];
+        if (slot.symbol == NULL)
+            return 0;
+        if (slot.hash == hash && slot.symbol->getMangledName() == name)
+            return slot.symbol;
+    }
+}
+
+void TSymbolTableLevel::grow()
+{
+    std::vector<Slot> oldSlots;
+    oldSlots.swap(mSlots);
+
+    Slot emptySlot = { 0, NULL };
+    mSlots.resize(oldSlots.empty() ? 16 : oldSlots.size() * 2, emptySlot);
+
+    size_t mask = mSlots.size() - 1;
+    for (size_t i = 0; i < oldSlots.size(); ++i)
+    {
+        if (oldSlots[i].symbol == NULL)
+            continue;
+
+        size_t j = oldSlots[i].hash & mask;
+        while (mSlots[j].symbol != NULL)
+            j = (j + 1) & mask;
+        mSlots[j] = oldSlots[i];
+    }
 }
 
 //
@@ -65,11 +133,11 @@ TSymbol *TSymbolTableLevel::find(const TString &name) const
 //
 void TSymbolTableLevel::relateToOperator(const char *name, TOperator op)
 {
-    for (tLevel::iterator it = level.begin(); it != level.end(); ++it)
+    for (size_t i = 0; i < mSlots.size(); ++i)
     {
-        if ((*it).second->isFunction())
+        if (mSlots[i].symbol && mSlots[i].symbol->isFunction())
         {
-            TFunction *function = static_cast<TFunction*>((*it).second);
+            TFunction *function = static_cast<TFunction*>(mSlots[i].symbol);
             if (function->getName() == name)
                 function->relateToOperator(op);
         }
@@ -84,14 +152,42 @@ void TSymbolTableLevel::relateToOperator(const char *name, TOperator op)
 //
 void TSymbolTableLevel::relateToExtension(const char *name, const TString &ext)
 {
-    for (tLevel::iterator it = level.begin(); it != level.end(); ++it)
+    for (size_t i = 0; i < mSlots.size(); ++i)
     {
-        TSymbol *symbol = it->second;
-        if (symbol->getName() == name)
+        TSymbol *symbol = mSlots[i].symbol;
+        if (symbol && symbol->getName() == name)
             symbol->relateToExtension(ext);
     }
 }
 
+void TSymbolTableLevel::precomputeLazyData() const
+{
+    for (size_t i = 0; i < mSlots.size(); ++i)
+    {
+        const TSymbol *symbol = mSlots[i].symbol;
+        if (symbol == NULL)
+            continue;
+
+        if (symbol->isVariable())
+        {
+            const TType &type = static_cast<const TVariable *>(symbol)->getType();
+            type.getMangledName();
+            if (type.getStruct())
+            {
+                type.getStruct()->deepestNesting();
+                type.getStruct()->objectSize();
+            }
+        }
+        else if (symbol->isFunction())
+        {
+            const TFunction *function = static_cast<const TFunction *>(symbol);
+            function->getReturnType().getMangledName();
+            for (size_t i = 0; i < function->getParamCount(); ++i)
+                function->getParam(i).type->getMangledName();
+        }
+    }
+}
+
 TSymbol::TSymbol(const TSymbol &copyOf)
 {
     name = NewPoolTString(copyOf.name->c_str());
@@ -102,6 +198,7 @@ TSymbol *TSymbolTable::find(const TString &name, int shaderVersion,
                             bool *builtIn, bool *sameScope) const
 {
     int level = currentLevel();
+    size_t hash = TSymbolTableLevel::HashName(name);
     TSymbol *symbol;
 
     do
@@ -111,7 +208,7 @@ TSymbol *TSymbolTable::find(const TString &name, int shaderVersion,
         if (level == ESSL1_BUILTINS && shaderVersion != 100)
             level--;
 
-        symbol = table[level]->find(name);
+        symbol = table[level]->find(name, hash);
     }
     while (symbol == 0 && --level >= 0);
 
@@ -126,6 +223,7 @@ TSymbol *TSymbolTable::find(const TString &name, int shaderVersion,
 TSymbol *TSymbolTable::findBuiltIn(
     const TString &name, int shaderVersion) const
 {
+    size_t hash = TSymbolTableLevel::HashName(name);
     for (int level = LAST_BUILTIN_LEVEL; level >= 0; level--)
     {
         if (level == ESSL3_BUILTINS && shaderVersion != 300)
@@ -133,7 +231,7 @@ TSymbol *TSymbolTable::findBuiltIn(
         if (level == ESSL1_BUILTINS && shaderVersion != 100)
             level--;
 
-        TSymbol *symbol = table[level]->find(name);
+        TSymbol *symbol = table[level]->find(name, hash);
 
         if (symbol)
             return symbol;
@@ -148,6 +246,25 @@ TSymbolTable::~TSymbolTable()
         pop();
 }
 
+void TSymbolTable::shareBuiltInLevels(const TSymbolTable &builtIns)
+{
+    assert(isEmpty());
+    assert(builtIns.currentLevel() == LAST_BUILTIN_LEVEL);
+
+    for (int level = 0; level <= LAST_BUILTIN_LEVEL; ++level)
+    {
+        table.push_back(builtIns.table[level]);
+        precisionStack.push_back(builtIns.precisionStack[level]);
+    }
+    mSharedBuiltIns = true;
+}
+
+void TSymbolTable::precomputeBuiltInLazyData() const
+{
+    for (int level = 0; level <= LAST_BUILTIN_LEVEL; ++level)
+        table[level]->precomputeLazyData();
+}
+
 void TSymbolTable::insertBuiltIn(
     ESymbolLevel level, TType *rvalue, const char *name,
     TType *ptype1, TType *ptype2, TType *ptype3, TType *ptype4, TType *ptype5)
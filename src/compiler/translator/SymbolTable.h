@@ -32,6 +32,7 @@
 
 #include <assert.h>
 #include <set>
+#include <vector>
 
 #include "common/angleutils.h"
 #include "compiler/translator/InfoSink.h"
@@ -279,25 +280,45 @@ class TInterfaceBlockName : public TSymbol
 class TSymbolTableLevel
 {
   public:
-    typedef TMap<TString, TSymbol *> tLevel;
-    typedef tLevel::const_iterator const_iterator;
-    typedef const tLevel::value_type tLevelPair;
-    typedef std::pair<tLevel::iterator, bool> tInsertResult;
-
     TSymbolTableLevel()
+        : mSymbolCount(0)
     {
     }
     ~TSymbolTableLevel();
 
     bool insert(TSymbol *symbol);
 
-    TSymbol *find(const TString &name) const;
+    TSymbol *find(const TString &name) const
+    {
+        return find(name, HashName(name));
+    }
+    // |hash| must be HashName(name). This lets a lookup that walks several
+    // levels hash the name only once.
+    TSymbol *find(const TString &name, size_t hash) const;
 
     void relateToOperator(const char *name, TOperator op);
     void relateToExtension(const char *name, const TString &ext);
 
+    // Computes the lazily evaluated data of the symbols in this level, such as
+    // the mangled names of their types, so that the level can afterwards be
+    // shared read-only between compilers on any thread.
+    void precomputeLazyData() const;
+
+    static size_t HashName(const TString &name);
+
   protected:
-    tLevel level;
+    // Symbols are kept in an open-addressing hash table keyed by their
+    // mangled names, using linear probing. Empty slots have no symbol.
+    struct Slot
+    {
+        size_t hash;
+        TSymbol *symbol;
+    };
+
+    void grow();
+
+    std::vector<Slot> mSlots;  // Empty or a power of two in size.
+    size_t mSymbolCount;
 };
 
 // Define ESymbolLevel as int rather than an enum since level can go
@@ -314,7 +335,9 @@ class TSymbolTable
 {
   public:
     TSymbolTable()
-        : mGlobalInvariant(false)
+        : mGlobalInvariant(false),
+          mSharedBuiltIns(false),
+          mDeclaredSymbolCount(0)
     {
         // The symbol table cannot be used until push() is called, but
         // the lack of an initial call to push() can be used to detect
@@ -346,13 +369,23 @@ class TSymbolTable
 
     void pop()
     {
-        delete table.back();
+        // Shared built-in levels are owned by the table they were shared from.
+        if (!mSharedBuiltIns || !atBuiltInLevel())
+        {
+            delete table.back();
+            delete precisionStack.back();
+        }
         table.pop_back();
-
-        delete precisionStack.back();
         precisionStack.pop_back();
     }
 
+    // Makes this empty table use the built-in levels of |builtIns| instead
+    // of its own copy. The built-in levels are not owned by this table;
+    // |builtIns| must not be modified and must outlive this table.
+    void shareBuiltInLevels(const TSymbolTable &builtIns);
+    // Prepares the built-in levels to be shared. See precomputeLazyData().
+    void precomputeBuiltInLazyData() const;
+
     bool declare(TSymbol *symbol)
     {
         return insert(currentLevel(), symbol);
@@ -360,9 +393,17 @@ class TSymbolTable
 
     bool insert(ESymbolLevel level, TSymbol *symbol)
     {
-        return table[level]->insert(symbol);
+        if (!table[level]->insert(symbol))
+            return false;
+        if (level > LAST_BUILTIN_LEVEL)
+            ++mDeclaredSymbolCount;
+        return true;
     }
 
+    // Number of symbols inserted above the built-in levels since the table
+    // was created.
+    size_t getDeclaredSymbolCount() const { return mDeclaredSymbolCount; }
+
     bool insertConstInt(ESymbolLevel level, const char *name, int value)
     {
         TVariable *constant = new TVariable(
@@ -379,10 +420,10 @@ class TSymbolTable
                   bool *builtIn = NULL, bool *sameScope = NULL) const;
     TSymbol *findBuiltIn(const TString &name, int shaderVersion) const;
     
-    TSymbolTableLevel *getOuterLevel()
+    bool declareInOuterLevel(TSymbol *symbol)
     {
         assert(currentLevel() >= 1);
-        return table[currentLevel() - 1];
+        return insert(currentLevel() - 1, symbol);
     }
 
     void relateToOperator(ESymbolLevel level, const char *name, TOperator op)
@@ -430,10 +471,9 @@ class TSymbolTable
     void setGlobalInvariant() { mGlobalInvariant = true; }
     bool getGlobalInvariant() const { return mGlobalInvariant; }
 
-    static int nextUniqueId()
-    {
-        return ++uniqueIdCounter;
-    }
+    // Thread-safe, since compilers on different threads draw ids from the
+    // same counter.
+    static int nextUniqueId();
 
   private:
     ESymbolLevel currentLevel() const
@@ -448,7 +488,12 @@ class TSymbolTable
     std::set<TString> mInvariantVaryings;
     bool mGlobalInvariant;
 
-    static int uniqueIdCounter;
+    // True if the built-in levels are borrowed through shareBuiltInLevels().
+    bool mSharedBuiltIns;
+
+    size_t mDeclaredSymbolCount;
+
+    static volatile int uniqueIdCounter;
 };
 
 #endif // _SYMBOL_TABLE_INCLUDED_
@@ -0,0 +1,477 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/TranslationCache.h"
+
+#include <stdio.h>
+
+#include "GLSLANG/ShaderLang.h"
+#include "third_party/murmurhash/MurmurHash3.h"
+
+namespace
+{
+
+const char kCacheFileMagic[] = "ANGLE translation cache";
+// Increment when the layout of cache files or of the serialized results
+// written by TCompiler::serializeResults changes.
+const int kCacheFileVersion = 1;
+const char kCacheFileExtension[] = ".shcache";
+
+TranslationCache gTranslationCache;
+
+std::string HashKey(const std::string &key)
+{
+    uint32_t hash[4];
+    MurmurHash3_x64_128(key.data(), static_cast<int>(key.size()), 0, hash);
+
+    static const char kHexDigits[] = "0123456789abcdef";
+    std::string hex;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        for (int shift = 28; shift >= 0; shift -= 4)
+        {
+            hex += kHexDigits[(hash[i] >> shift) & 0xf];
+        }
+    }
+    return hex;
+}
+
+bool ReadFile(const std::string &path, std::string *contents)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    contents->clear();
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        contents->append(buffer, count);
+    }
+
+    bool success = (ferror(file) == 0);
+    fclose(file);
+    return success;
+}
+
+void WriteVariable(BlobWriter *writer, const sh::ShaderVariable &variable)
+{
+    writer->writeInt(variable.type);
+    writer->writeInt(variable.precision);
+    writer->writeString(variable.name);
+    writer->writeString(variable.mappedName);
+    writer->writeInt(variable.arraySize);
+    writer->writeInt(variable.staticUse);
+    writer->writeString(variable.structName);
+    WriteVariableList(writer, variable.fields);
+}
+
+void ReadVariable(BlobReader *reader, sh::ShaderVariable *variable)
+{
+    variable->type = reader->readInt();
+    variable->precision = reader->readInt();
+    reader->readString(&variable->name);
+    reader->readString(&variable->mappedName);
+    variable->arraySize = reader->readInt();
+    variable->staticUse = (reader->readInt() != 0);
+    reader->readString(&variable->structName);
+    ReadVariableList(reader, &variable->fields);
+}
+
+void WriteVariable(BlobWriter *writer, const sh::Attribute &variable)
+{
+    WriteVariable(writer, static_cast<const sh::ShaderVariable&>(variable));
+    writer->writeInt(variable.location);
+}
+
+void ReadVariable(BlobReader *reader, sh::Attribute *variable)
+{
+    ReadVariable(reader, static_cast<sh::ShaderVariable*>(variable));
+    variable->location = reader->readInt();
+}
+
+void WriteVariable(BlobWriter *writer, const sh::Varying &variable)
+{
+    WriteVariable(writer, static_cast<const sh::ShaderVariable&>(variable));
+    writer->writeInt(variable.interpolation);
+    writer->writeInt(variable.isInvariant);
+}
+
+void ReadVariable(BlobReader *reader, sh::Varying *variable)
+{
+    ReadVariable(reader, static_cast<sh::ShaderVariable*>(variable));
+    variable->interpolation = static_cast<sh::InterpolationType>(reader->readInt());
+    variable->isInvariant = (reader->readInt() != 0);
+}
+
+void WriteVariable(BlobWriter *writer, const sh::InterfaceBlockField &variable)
+{
+    WriteVariable(writer, static_cast<const sh::ShaderVariable&>(variable));
+    writer->writeInt(variable.isRowMajorLayout);
+}
+
+void ReadVariable(BlobReader *reader, sh::InterfaceBlockField *variable)
+{
+    ReadVariable(reader, static_cast<sh::ShaderVariable*>(variable));
+    variable->isRowMajorLayout = (reader->readInt() != 0);
+}
+
+void WriteVariable(BlobWriter *writer, const sh::InterfaceBlock &block)
+{
+    writer->writeString(block.name);
+    writer->writeString(block.mappedName);
+    writer->writeString(block.instanceName);
+    writer->writeInt(block.arraySize);
+    writer->writeInt(block.layout);
+    writer->writeInt(block.isRowMajorLayout);
+    writer->writeInt(block.staticUse);
+    WriteVariableList(writer, block.fields);
+}
+
+void ReadVariable(BlobReader *reader, sh::InterfaceBlock *block)
+{
+    reader->readString(&block->name);
+    reader->readString(&block->mappedName);
+    reader->readString(&block->instanceName);
+    block->arraySize = reader->readInt();
+    block->layout = static_cast<sh::BlockLayoutType>(reader->readInt());
+    block->isRowMajorLayout = (reader->readInt() != 0);
+    block->staticUse = (reader->readInt() != 0);
+    ReadVariableList(reader, &block->fields);
+}
+
+}  // namespace anonymous
+
+template <typename VarT>
+void WriteVariableList(BlobWriter *writer, const std::vector<VarT> &variables)
+{
+    writer->writeInt(static_cast<int>(variables.size()));
+    for (size_t i = 0; i < variables.size(); ++i)
+    {
+        WriteVariable(writer, variables[i]);
+    }
+}
+
+template <typename VarT>
+void ReadVariableList(BlobReader *reader, std::vector<VarT> *variables)
+{
+    variables->clear();
+    int count = reader->readInt();
+    for (int i = 0; i < count && !reader->error(); ++i)
+    {
+        variables->push_back(VarT());
+        ReadVariable(reader, &variables->back());
+    }
+}
+
+template void WriteVariableList(BlobWriter *, const std::vector<sh::ShaderVariable> &);
+template void WriteVariableList(BlobWriter *, const std::vector<sh::Uniform> &);
+template void WriteVariableList(BlobWriter *, const std::vector<sh::Attribute> &);
+template void WriteVariableList(BlobWriter *, const std::vector<sh::Varying> &);
+template void WriteVariableList(BlobWriter *, const std::vector<sh::InterfaceBlockField> &);
+template void WriteVariableList(BlobWriter *, const std::vector<sh::InterfaceBlock> &);
+template void ReadVariableList(BlobReader *, std::vector<sh::ShaderVariable> *);
+template void ReadVariableList(BlobReader *, std::vector<sh::Uniform> *);
+template void ReadVariableList(BlobReader *, std::vector<sh::Attribute> *);
+template void ReadVariableList(BlobReader *, std::vector<sh::Varying> *);
+template void ReadVariableList(BlobReader *, std::vector<sh::InterfaceBlockField> *);
+template void ReadVariableList(BlobReader *, std::vector<sh::InterfaceBlock> *);
+
+void BlobWriter::writeInt(int value)
+{
+    unsigned int bits = static_cast<unsigned int>(value);
+    for (int i = 0; i < 4; ++i)
+    {
+        mData += static_cast<char>((bits >> (i * 8)) & 0xff);
+    }
+}
+
+void BlobWriter::writeVarInt(int value)
+{
+    // Zigzag encoding maps small negative values to small codes as well.
+    unsigned int bits = static_cast<unsigned int>(value);
+    unsigned int code = (bits << 1) ^ (value < 0 ? 0xffffffffu : 0u);
+    while (code >= 0x80)
+    {
+        mData += static_cast<char>((code & 0x7f) | 0x80);
+        code >>= 7;
+    }
+    mData += static_cast<char>(code);
+}
+
+void BlobWriter::writeString(const std::string &value)
+{
+    writeInt(static_cast<int>(value.size()));
+    mData += value;
+}
+
+BlobReader::BlobReader(const std::string &data)
+    : mData(data),
+      mOffset(0),
+      mError(false)
+{
+}
+
+int BlobReader::readInt()
+{
+    if (mError || mData.size() - mOffset < 4)
+    {
+        mError = true;
+        return 0;
+    }
+
+    unsigned int bits = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        bits |= static_cast<unsigned int>(static_cast<unsigned char>(mData[mOffset++])) << (i * 8);
+    }
+    return static_cast<int>(bits);
+}
+
+int BlobReader::readVarInt()
+{
+    unsigned int code = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (mError || mOffset == mData.size())
+            break;
+
+        unsigned int byte = static_cast<unsigned char>(mData[mOffset++]);
+        code |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return static_cast<int>((code >> 1) ^ (0u - (code & 1)));
+    }
+
+    mError = true;
+    return 0;
+}
+
+void BlobReader::readString(std::string *value)
+{
+    int length = readInt();
+    if (mError || length < 0 || mData.size() - mOffset < static_cast<size_t>(length))
+    {
+        mError = true;
+        value->clear();
+        return;
+    }
+
+    value->assign(mData, mOffset, length);
+    mOffset += length;
+}
+
+DirectoryTranslationCacheBackend::DirectoryTranslationCacheBackend(const std::string &directory)
+    : mDirectory(directory)
+{
+}
+
+bool DirectoryTranslationCacheBackend::load(const std::string &hash, std::string *entry)
+{
+    std::string contents;
+    if (!ReadFile(getPath(hash), &contents))
+    {
+        return false;
+    }
+
+    BlobReader reader(contents);
+    std::string magic;
+    reader.readString(&magic);
+    int fileVersion = reader.readInt();
+    int shVersion = reader.readInt();
+    reader.readString(entry);
+
+    return !reader.error() && reader.endOfData() && magic == kCacheFileMagic &&
+           fileVersion == kCacheFileVersion && shVersion == ANGLE_SH_VERSION;
+}
+
+void DirectoryTranslationCacheBackend::store(const std::string &hash, const std::string &entry)
+{
+    BlobWriter writer;
+    writer.writeString(kCacheFileMagic);
+    writer.writeInt(kCacheFileVersion);
+    writer.writeInt(ANGLE_SH_VERSION);
+    writer.writeString(entry);
+    const std::string &contents = writer.data();
+
+    // Write to a temporary file first so that a concurrent reader never
+    // sees a partially written entry.
+    std::string path = getPath(hash);
+    std::string temporaryPath = path + ".tmp";
+    FILE *file = fopen(temporaryPath.c_str(), "wb");
+    if (!file)
+    {
+        return;
+    }
+
+    bool success = (fwrite(contents.data(), 1, contents.size(), file) == contents.size());
+    success = (fclose(file) == 0) && success;
+
+    if (success)
+    {
+        remove(path.c_str());
+        success = (rename(temporaryPath.c_str(), path.c_str()) == 0);
+    }
+    if (!success)
+    {
+        remove(temporaryPath.c_str());
+    }
+}
+
+std::string DirectoryTranslationCacheBackend::getPath(const std::string &hash) const
+{
+    return mDirectory + "/" + hash + kCacheFileExtension;
+}
+
+TranslationCache::TranslationCache()
+    : mSize(0),
+      mMaxSize(kDefaultMaxSize),
+      mBackend(NULL)
+{
+}
+
+TranslationCache::~TranslationCache()
+{
+    delete mBackend;
+}
+
+bool TranslationCache::lookup(const std::string &key, bool persistent, std::string *results)
+{
+    std::string hash = HashKey(key);
+
+    ScopedLock lock(&mMutex);
+
+    EntryMap::iterator found = mEntryMap.find(hash);
+    if (found != mEntryMap.end())
+    {
+        EntryList::iterator entry = found->second;
+        if (entry->key != key)
+        {
+            return false;
+        }
+
+        mEntries.splice(mEntries.begin(), mEntries, entry);
+        *results = entry->results;
+        return true;
+    }
+
+    if (persistent && mBackend)
+    {
+        std::string stored;
+        if (!mBackend->load(hash, &stored))
+        {
+            return false;
+        }
+
+        BlobReader reader(stored);
+        std::string storedKey;
+        reader.readString(&storedKey);
+        reader.readString(results);
+        if (reader.error() || storedKey != key)
+        {
+            return false;
+        }
+
+        insertLocked(hash, key, *results);
+        return true;
+    }
+
+    return false;
+}
+
+void TranslationCache::insert(const std::string &key, bool persistent, const std::string &results)
+{
+    std::string hash = HashKey(key);
+
+    ScopedLock lock(&mMutex);
+
+    insertLocked(hash, key, results);
+
+    if (persistent && mBackend)
+    {
+        BlobWriter writer;
+        writer.writeString(key);
+        writer.writeString(results);
+        mBackend->store(hash, writer.data());
+    }
+}
+
+void TranslationCache::setMaxSize(size_t maxSize)
+{
+    ScopedLock lock(&mMutex);
+    mMaxSize = maxSize;
+    evictLocked(mMaxSize);
+}
+
+void TranslationCache::setBackend(TranslationCacheBackend *backend)
+{
+    ScopedLock lock(&mMutex);
+    delete mBackend;
+    mBackend = backend;
+}
+
+void TranslationCache::clear()
+{
+    ScopedLock lock(&mMutex);
+    evictLocked(0);
+}
+
+size_t TranslationCache::getSize()
+{
+    ScopedLock lock(&mMutex);
+    return mSize;
+}
+
+size_t TranslationCache::getEntryCount()
+{
+    ScopedLock lock(&mMutex);
+    return mEntries.size();
+}
+
+void TranslationCache::insertLocked(const std::string &hash, const std::string &key,
+                                    const std::string &results)
+{
+    EntryMap::iterator found = mEntryMap.find(hash);
+    if (found != mEntryMap.end())
+    {
+        mSize -= found->second->key.size() + found->second->results.size();
+        mEntries.erase(found->second);
+        mEntryMap.erase(found);
+    }
+
+    size_t entrySize = key.size() + results.size();
+    if (entrySize > mMaxSize)
+    {
+        return;
+    }
+    evictLocked(mMaxSize - entrySize);
+
+    Entry entry;
+    entry.hash = hash;
+    entry.key = key;
+    entry.results = results;
+    mEntries.push_front(entry);
+    mEntryMap[hash] = mEntries.begin();
+    mSize += entrySize;
+}
+
+void TranslationCache::evictLocked(size_t maxSize)
+{
+    while (mSize > maxSize)
+    {
+        const Entry &entry = mEntries.back();
+        mSize -= entry.key.size() + entry.results.size();
+        mEntryMap.erase(entry.hash);
+        mEntries.pop_back();
+    }
+}
+
+TranslationCache *GetTranslationCache()
+{
+    return &gTranslationCache;
+}
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// TranslationCache.h: Process-wide cache of compilation results, used by
+// TCompiler::compile when SH_CACHE_TRANSLATION is set.
+//
+// Entries are addressed by a 128-bit hash of a key that covers everything
+// that affects the results: the shader sources, compile options, shader
+// type, spec, output type and built-in resources. The complete key is
+// stored with each entry and compared on lookup, so hash collisions can
+// only cause misses. Recently used entries are kept in memory; a
+// TranslationCacheBackend can additionally persist entries across runs.
+
+#ifndef COMPILER_TRANSLATOR_TRANSLATIONCACHE_H_
+#define COMPILER_TRANSLATOR_TRANSLATIONCACHE_H_
+
+#include "GLSLANG/ShaderLang.h"
+
+#include "common/angleutils.h"
+#include "common/mutex.h"
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// Appends integers and strings to a byte string.
+class BlobWriter
+{
+  public:
+    void writeInt(int value);
+    // Writes |value| in one to five bytes, fewer for values close to zero.
+    void writeVarInt(int value);
+    void writeString(const std::string &value);
+
+    const std::string &data() const { return mData; }
+
+  private:
+    std::string mData;
+};
+
+// Reads values written by BlobWriter. Reading past the end of the data
+// sets the error flag and returns zero values.
+class BlobReader
+{
+  public:
+    explicit BlobReader(const std::string &data);
+
+    int readInt();
+    int readVarInt();
+    void readString(std::string *value);
+
+    bool error() const { return mError; }
+    bool endOfData() const { return mOffset == mData.size(); }
+    size_t remainingSize() const { return mData.size() - mOffset; }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(BlobReader);
+
+    const std::string &mData;
+    size_t mOffset;
+    bool mError;
+};
+
+// Serialization of the variables collected by TCompiler.
+template <typename VarT>
+void WriteVariableList(BlobWriter *writer, const std::vector<VarT> &variables);
+template <typename VarT>
+void ReadVariableList(BlobReader *reader, std::vector<VarT> *variables);
+
+// Persistent storage for translation cache entries. Implementations are
+// only called with the cache lock held.
+class TranslationCacheBackend
+{
+  public:
+    virtual ~TranslationCacheBackend() {}
+
+    // |hash| is a hex string suitable for use as a file name. Returns
+    // false if no valid entry is stored under |hash|.
+    virtual bool load(const std::string &hash, std::string *entry) = 0;
+    virtual void store(const std::string &hash, const std::string &entry) = 0;
+};
+
+// Stores each entry in its own file in a directory. Every file starts with
+// a header holding the file format version and ANGLE_SH_VERSION; files
+// written by another version are ignored and overwritten.
+class DirectoryTranslationCacheBackend : public TranslationCacheBackend
+{
+  public:
+    explicit DirectoryTranslationCacheBackend(const std::string &directory);
+
+    virtual bool load(const std::string &hash, std::string *entry);
+    virtual void store(const std::string &hash, const std::string &entry);
+
+  private:
+    std::string getPath(const std::string &hash) const;
+
+    std::string mDirectory;
+};
+
+class TranslationCache
+{
+  public:
+    TranslationCache();
+    ~TranslationCache();
+
+    // Looks up the results stored for |key|. If |persistent| is true the
+    // backend is consulted on an in-memory miss.
+    bool lookup(const std::string &key, bool persistent, std::string *results);
+    void insert(const std::string &key, bool persistent, const std::string &results);
+
+    // Evicts least recently used entries until at most |maxSize| bytes of
+    // keys and results are held in memory.
+    void setMaxSize(size_t maxSize);
+    // Takes ownership of |backend|, which may be NULL.
+    void setBackend(TranslationCacheBackend *backend);
+    // Drops all in-memory entries. Persisted entries are kept.
+    void clear();
+
+    size_t getSize();
+    size_t getEntryCount();
+
+    static const size_t kDefaultMaxSize = 8 * 1024 * 1024;
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(TranslationCache);
+
+    struct Entry
+    {
+        std::string hash;
+        std::string key;
+        std::string results;
+    };
+    typedef std::list<Entry> EntryList;
+    typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+    void insertLocked(const std::string &hash, const std::string &key,
+                      const std::string &results);
+    void evictLocked(size_t maxSize);
+
+    Mutex mMutex;
+    // Most recently used first.
+    EntryList mEntries;
+    EntryMap mEntryMap;
+    size_t mSize;
+    size_t mMaxSize;
+    TranslationCacheBackend *mBackend;
+};
+
+TranslationCache *GetTranslationCache();
+
+#endif // COMPILER_TRANSLATOR_TRANSLATIONCACHE_H_
@@ -8,6 +8,35 @@
 
 #include "compiler/translator/InitializeParseContext.h"
 #include "compiler/translator/OutputHLSL.h"
+#include "compiler/translator/TranslationCache.h"
+
+namespace
+{
+
+void WriteRegisterMap(BlobWriter *writer, const std::map<std::string, unsigned int> &registerMap)
+{
+    writer->writeInt(static_cast<int>(registerMap.size()));
+    for (std::map<std::string, unsigned int>::const_iterator it = registerMap.begin();
+         it != registerMap.end(); ++it)
+    {
+        writer->writeString(it->first);
+        writer->writeInt(it->second);
+    }
+}
+
+void ReadRegisterMap(BlobReader *reader, std::map<std::string, unsigned int> *registerMap)
+{
+    registerMap->clear();
+    int count = reader->readInt();
+    for (int i = 0; i < count && !reader->error(); ++i)
+    {
+        std::string name;
+        reader->readString(&name);
+        (*registerMap)[name] = reader->readInt();
+    }
+}
+
+}  // namespace anonymous
 
 TranslatorHLSL::TranslatorHLSL(sh::GLenum type, ShShaderSpec spec, ShShaderOutput output)
     : TCompiler(type, spec, output)
@@ -19,12 +48,26 @@ void TranslatorHLSL::translate(TIntermNode *root)
     TParseContext& parseContext = *GetGlobalParseContext();
     sh::OutputHLSL outputHLSL(parseContext, this);
 
-    outputHLSL.output();
+    outputHLSL.output(root, getInfoSink().obj);
 
     mInterfaceBlockRegisterMap = outputHLSL.getInterfaceBlockRegisterMap();
     mUniformRegisterMap = outputHLSL.getUniformRegisterMap();
 }
 
+void TranslatorHLSL::serializeResults(BlobWriter *writer) const
+{
+    TCompiler::serializeResults(writer);
+    WriteRegisterMap(writer, mInterfaceBlockRegisterMap);
+    WriteRegisterMap(writer, mUniformRegisterMap);
+}
+
+void TranslatorHLSL::deserializeResults(BlobReader *reader)
+{
+    TCompiler::deserializeResults(reader);
+    ReadRegisterMap(reader, &mInterfaceBlockRegisterMap);
+    ReadRegisterMap(reader, &mUniformRegisterMap);
+}
+
 bool TranslatorHLSL::hasInterfaceBlock(const std::string &interfaceBlockName) const
 {
     return (mInterfaceBlockRegisterMap.count(interfaceBlockName) > 0);
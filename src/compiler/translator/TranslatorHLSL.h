@@ -23,6 +23,8 @@ class TranslatorHLSL : public TCompiler
 
   protected:
     virtual void translate(TIntermNode* root);
+    virtual void serializeResults(BlobWriter *writer) const;
+    virtual void deserializeResults(BlobReader *reader);
 
     std::map<std::string, unsigned int> mInterfaceBlockRegisterMap;
     std::map<std::string, unsigned int> mUniformRegisterMap;
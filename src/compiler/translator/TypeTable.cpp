@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "compiler/translator/TypeTable.h"
+
+#include "common/tls.h"
+
+#include <assert.h>
+
+namespace
+{
+
+TLSIndex GlobalTypeTableIndex = TLS_INVALID_INDEX;
+
+const size_t kInitialSlotCount = 64;
+
+size_t HashType(const TType &type)
+{
+    const TLayoutQualifier layoutQualifier = type.getLayoutQualifier();
+    size_t hash = type.getBasicType();
+    hash = hash * 31 + type.getPrecision();
+    hash = hash * 31 + type.getQualifier();
+    hash = hash * 31 + type.getNominalSize();
+    hash = hash * 31 + type.getSecondarySize();
+    hash = hash * 31 + (type.isArray() ? type.getArraySize() + 1 : 0);
+    hash = hash * 31 + layoutQualifier.location;
+    hash = hash * 31 + layoutQualifier.matrixPacking;
+    hash = hash * 31 + layoutQualifier.blockStorage;
+    hash = hash * 31 + reinterpret_cast<size_t>(type.getStruct());
+    hash = hash * 31 + reinterpret_cast<size_t>(type.getInterfaceBlock());
+    return hash;
+}
+
+bool IdenticalTypes(const TType &a, const TType &b)
+{
+    const TLayoutQualifier layoutA = a.getLayoutQualifier();
+    const TLayoutQualifier layoutB = b.getLayoutQualifier();
+    return a.getBasicType() == b.getBasicType() &&
+           a.getPrecision() == b.getPrecision() &&
+           a.getQualifier() == b.getQualifier() &&
+           a.getNominalSize() == b.getNominalSize() &&
+           a.getSecondarySize() == b.getSecondarySize() &&
+           a.isArray() == b.isArray() &&
+           a.getArraySize() == b.getArraySize() &&
+           layoutA.location == layoutB.location &&
+           layoutA.matrixPacking == layoutB.matrixPacking &&
+           layoutA.blockStorage == layoutB.blockStorage &&
+           a.getStruct() == b.getStruct() &&
+           a.getInterfaceBlock() == b.getInterfaceBlock();
+}
+
+}  // anonymous namespace
+
+TTypeTable::TTypeTable()
+    : mSlots(kInitialSlotCount),
+      mCount(0)
+{
+}
+
+const TType *TTypeTable::intern(const TType &type)
+{
+    size_t mask = mSlots.size() - 1;
+    size_t slot = HashType(type) & mask;
+    while (mSlots[slot] != NULL)
+    {
+        if (IdenticalTypes(*mSlots[slot], type))
+            return mSlots[slot];
+        slot = (slot + 1) & mask;
+    }
+
+    const TType *shared = new TType(type);
+    mSlots[slot] = shared;
+    ++mCount;
+    if (mCount * 2 > mSlots.size())
+        grow();
+    return shared;
+}
+
+void TTypeTable::grow()
+{
+    TVector<const TType *> slots(mSlots.size() * 2);
+    size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < mSlots.size(); ++i)
+    {
+        if (mSlots[i] == NULL)
+            continue;
+        size_t slot = HashType(*mSlots[i]) & mask;
+        while (slots[slot] != NULL)
+            slot = (slot + 1) & mask;
+        slots[slot] = mSlots[i];
+    }
+    mSlots.swap(slots);
+}
+
+bool InitializeTypeTableIndex()
+{
+    assert(GlobalTypeTableIndex == TLS_INVALID_INDEX);
+
+    GlobalTypeTableIndex = CreateTLSIndex();
+    return GlobalTypeTableIndex != TLS_INVALID_INDEX;
+}
+
+void FreeTypeTableIndex()
+{
+    assert(GlobalTypeTableIndex != TLS_INVALID_INDEX);
+
+    DestroyTLSIndex(GlobalTypeTableIndex);
+    GlobalTypeTableIndex = TLS_INVALID_INDEX;
+}
+
+void SetGlobalTypeTable(TTypeTable *table)
+{
+    assert(GlobalTypeTableIndex != TLS_INVALID_INDEX);
+    SetTLSValue(GlobalTypeTableIndex, table);
+}
+
+TTypeTable *GetGlobalTypeTable()
+{
+    assert(GlobalTypeTableIndex != TLS_INVALID_INDEX);
+    return static_cast<TTypeTable *>(GetTLSValue(GlobalTypeTableIndex));
+}
+
+const TType *InternType(const TType &type)
+{
+    TTypeTable *table = GetGlobalTypeTable();
+    if (table == NULL)
+        return new TType(type);
+    return table->intern(type);
+}
@@ -0,0 +1,54 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TypeTable.h: Sharing of the types of AST nodes during a compilation.
+//
+
+#ifndef COMPILER_TYPE_TABLE_H_
+#define COMPILER_TYPE_TABLE_H_
+
+#include "common/angleutils.h"
+#include "compiler/translator/Types.h"
+
+//
+// Keeps one pool-allocated copy of each distinct type, so that the nodes
+// of a tree share their types, and the mangled name of each type is built
+// at most once. Types are distinct if any of their properties, including
+// precision, qualifier and layout, differ. The table must be created and
+// destroyed within the pool scope its types are used in.
+//
+class TTypeTable
+{
+  public:
+    TTypeTable();
+
+    // Returns the shared copy of |type|. It must not be modified.
+    const TType *intern(const TType &type);
+
+    size_t size() const { return mCount; }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(TTypeTable);
+
+    void grow();
+
+    // Open addressing, with a power of two number of slots.
+    TVector<const TType *> mSlots;
+    size_t mCount;
+};
+
+bool InitializeTypeTableIndex();
+void FreeTypeTableIndex();
+
+// Sets the table used by InternType() on the current thread. It is set
+// for the duration of a compilation.
+void SetGlobalTypeTable(TTypeTable *table);
+TTypeTable *GetGlobalTypeTable();
+
+// Returns the shared copy of |type| from the current table, or a new
+// pool-allocated copy if no table is set.
+const TType *InternType(const TType &type);
+
+#endif // COMPILER_TYPE_TABLE_H_
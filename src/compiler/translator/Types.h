@@ -379,7 +379,7 @@ class TType
         structure = s;
     }
 
-    const TString &getMangledName()
+    const TString &getMangledName() const
     {
         if (mangled.empty())
         {
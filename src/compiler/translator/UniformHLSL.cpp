@@ -68,7 +68,19 @@ UniformHLSL::UniformHLSL(StructureHLSL *structureHLSL, TranslatorHLSL *translato
       mStructureHLSL(structureHLSL),
       mOutputType(translator->getOutputType()),
       mUniforms(translator->getUniforms())
-{}
+{
+    // The array of SH_PACK_UNIFORMS is declared like the uniforms it holds.
+    const PackedUniforms &packedUniforms = translator->getPackedUniforms();
+    if (packedUniforms.arraySize > 0)
+    {
+        mPackedUniform.name = packedUniforms.arrayName;
+        mPackedUniform.mappedName = packedUniforms.mappedArrayName;
+        mPackedUniform.type = GL_FLOAT_VEC4;
+        mPackedUniform.precision = GL_HIGH_FLOAT;
+        mPackedUniform.arraySize = packedUniforms.arraySize;
+        mPackedUniform.staticUse = true;
+    }
+}
 
 void UniformHLSL::reserveUniformRegisters(unsigned int registerCount)
 {
@@ -82,6 +94,11 @@ void UniformHLSL::reserveInterfaceBlockRegisters(unsigned int registerCount)
 
 const Uniform *UniformHLSL::findUniformByName(const TString &name) const
 {
+    if (mPackedUniform.arraySize > 0 && mPackedUniform.name == name.c_str())
+    {
+        return &mPackedUniform;
+    }
+
     for (size_t uniformIndex = 0; uniformIndex < mUniforms.size(); ++uniformIndex)
     {
         if (mUniforms[uniformIndex].name == name.c_str())
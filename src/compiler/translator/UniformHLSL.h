@@ -54,6 +54,7 @@ class UniformHLSL
     ShShaderOutput mOutputType;
 
     const std::vector<Uniform> &mUniforms;
+    Uniform mPackedUniform;
     std::map<std::string, unsigned int> mInterfaceBlockRegisterMap;
     std::map<std::string, unsigned int> mUniformRegisterMap;
 };
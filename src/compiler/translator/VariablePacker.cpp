@@ -81,6 +81,24 @@ struct TVariableInfoComparer
     }
 };
 
+// Orders the indices of variables like TVariableInfoComparer orders the
+// variables.
+template <typename VarT>
+struct TVariableIndexComparer
+{
+    TVariableIndexComparer(const std::vector<VarT> &variables)
+        : variables(variables)
+    {
+    }
+
+    bool operator()(size_t lhs, size_t rhs) const
+    {
+        return TVariableInfoComparer()(variables[lhs], variables[rhs]);
+    }
+
+    const std::vector<VarT> &variables;
+};
+
 unsigned VariablePacker::makeColumnFlags(int column, int numComponentsPerRow)
 {
     return ((kColumnMask << (kNumColumns - numComponentsPerRow)) &
@@ -151,12 +169,20 @@ bool VariablePacker::searchColumn(int column, int numRows, int* destRow, int* de
 template <typename VarT>
 bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int maxVectors,
                                                        const std::vector<VarT> &in_variables)
+{
+    return PackVariables(maxVectors, in_variables, NULL);
+}
+
+template <typename VarT>
+bool VariablePacker::PackVariables(unsigned int maxVectors,
+                                   const std::vector<VarT> &in_variables,
+                                   std::vector<ShVariablePlacement> *placements)
 {
     ASSERT(maxVectors > 0);
     maxRows_ = maxVectors;
     topNonFullRow_ = 0;
     bottomNonFullRow_ = maxRows_ - 1;
-    std::vector<VarT> variables(in_variables);
+    const std::vector<VarT> &variables = in_variables;
 
     // Check whether each variable fits in the available vectors.
     for (size_t i = 0; i < variables.size(); i++) {
@@ -167,19 +193,32 @@ bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int maxVectors,
     }
 
     // As per GLSL 1.017 Appendix A, Section 7 variables are packed in specific
-    // order by type, then by size of array, largest first.
-    std::sort(variables.begin(), variables.end(), TVariableInfoComparer());
+    // order by type, then by size of array, largest first. The variables
+    // are sorted by their indices, so that their placements can be returned
+    // in the order they were passed in.
+    std::vector<size_t> order(variables.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), TVariableIndexComparer<VarT>(variables));
     rows_.clear();
     rows_.resize(maxVectors, 0);
 
+    std::vector<ShVariablePlacement> packed(variables.size());
+
     // Packs the 4 column variables.
     size_t ii = 0;
     for (; ii < variables.size(); ++ii) {
-        const sh::ShaderVariable &variable = variables[ii];
+        const sh::ShaderVariable &variable = variables[order[ii]];
         if (GetNumComponentsPerRow(variable.type) != 4) {
             break;
         }
-        topNonFullRow_ += GetNumRows(variable.type) * variable.elementCount();
+        int numRows = GetNumRows(variable.type) * variable.elementCount();
+        ShVariablePlacement &placement = packed[order[ii]];
+        placement.row = topNonFullRow_;
+        placement.column = 0;
+        placement.rows = numRows;
+        topNonFullRow_ += numRows;
     }
 
     if (topNonFullRow_ > maxRows_) {
@@ -189,11 +228,16 @@ bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int maxVectors,
     // Packs the 3 column variables.
     int num3ColumnRows = 0;
     for (; ii < variables.size(); ++ii) {
-        const sh::ShaderVariable &variable = variables[ii];
+        const sh::ShaderVariable &variable = variables[order[ii]];
         if (GetNumComponentsPerRow(variable.type) != 3) {
             break;
         }
-        num3ColumnRows += GetNumRows(variable.type) * variable.elementCount();
+        int numRows = GetNumRows(variable.type) * variable.elementCount();
+        ShVariablePlacement &placement = packed[order[ii]];
+        placement.row = topNonFullRow_ + num3ColumnRows;
+        placement.column = 0;
+        placement.rows = numRows;
+        num3ColumnRows += numRows;
     }
 
     if (topNonFullRow_ + num3ColumnRows > maxRows_) {
@@ -202,20 +246,30 @@ bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int maxVectors,
 
     fillColumns(topNonFullRow_, num3ColumnRows, 0, 3);
 
-    // Packs the 2 column variables.
+    // Packs the 2 column variables. Columns 0 and 1 are filled from the top
+    // down, and columns 2 and 3 from the bottom up, so the rows of the
+    // latter are only known once all of them are counted.
     int top2ColumnRow = topNonFullRow_ + num3ColumnRows;
     int twoColumnRowsAvailable = maxRows_ - top2ColumnRow;
     int rowsAvailableInColumns01 = twoColumnRowsAvailable;
     int rowsAvailableInColumns23 = twoColumnRowsAvailable;
+    std::vector<size_t> variablesInColumns23;
     for (; ii < variables.size(); ++ii) {
-        const sh::ShaderVariable &variable = variables[ii];
+        const sh::ShaderVariable &variable = variables[order[ii]];
         if (GetNumComponentsPerRow(variable.type) != 2) {
             break;
         }
         int numRows = GetNumRows(variable.type) * variable.elementCount();
+        ShVariablePlacement &placement = packed[order[ii]];
+        placement.rows = numRows;
         if (numRows <= rowsAvailableInColumns01) {
+            placement.row = maxRows_ - rowsAvailableInColumns01;
+            placement.column = 0;
             rowsAvailableInColumns01 -= numRows;
         } else if (numRows <= rowsAvailableInColumns23) {
+            placement.row = twoColumnRowsAvailable - rowsAvailableInColumns23;
+            placement.column = 2;
+            variablesInColumns23.push_back(order[ii]);
             rowsAvailableInColumns23 -= numRows;
         } else {
             return false;
@@ -229,10 +283,13 @@ bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int maxVectors,
     fillColumns(top2ColumnRow, numRowsUsedInColumns01, 0, 2);
     fillColumns(maxRows_ - numRowsUsedInColumns23, numRowsUsedInColumns23,
                 2, 2);
+    for (size_t i = 0; i < variablesInColumns23.size(); ++i) {
+        packed[variablesInColumns23[i]].row += maxRows_ - numRowsUsedInColumns23;
+    }
 
     // Packs the 1 column variables.
     for (; ii < variables.size(); ++ii) {
-        const sh::ShaderVariable &variable = variables[ii];
+        const sh::ShaderVariable &variable = variables[order[ii]];
         ASSERT(1 == GetNumComponentsPerRow(variable.type));
         int numRows = GetNumRows(variable.type) * variable.elementCount();
         int smallestColumn = -1;
@@ -255,10 +312,17 @@ bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int maxVectors,
         }
 
         fillColumns(topRow, numRows, smallestColumn, 1);
+        ShVariablePlacement &placement = packed[order[ii]];
+        placement.row = topRow;
+        placement.column = smallestColumn;
+        placement.rows = numRows;
     }
 
     ASSERT(variables.size() == ii);
 
+    if (placements) {
+        placements->swap(packed);
+    }
     return true;
 }
 
@@ -267,3 +331,4 @@ template bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int, co
 template bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int, const std::vector<sh::Attribute> &);
 template bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int, const std::vector<sh::Uniform> &);
 template bool VariablePacker::CheckVariablesWithinPackingLimits(unsigned int, const std::vector<sh::Varying> &);
+template bool VariablePacker::PackVariables(unsigned int, const std::vector<sh::ShaderVariable> &, std::vector<ShVariablePlacement> *);
@@ -8,6 +8,7 @@
 #define _VARIABLEPACKER_INCLUDED_
 
 #include <vector>
+#include "GLSLANG/ShaderLang.h"
 #include "compiler/translator/VariableInfo.h"
 
 class VariablePacker {
@@ -18,6 +19,14 @@ class VariablePacker {
     bool CheckVariablesWithinPackingLimits(unsigned int maxVectors,
                                            const std::vector<VarT> &in_variables);
 
+    // Like CheckVariablesWithinPackingLimits, and also returns where each
+    // variable is packed, in the order of |in_variables|, if |placements|
+    // is not NULL. A row holds a vector, or a column of a matrix.
+    template <typename VarT>
+    bool PackVariables(unsigned int maxVectors,
+                       const std::vector<VarT> &in_variables,
+                       std::vector<ShVariablePlacement> *placements);
+
     // Gets how many components in a row a data type takes.
     static int GetNumComponentsPerRow(sh::GLenum type);
 
@@ -877,7 +877,7 @@ function_prototype
         {
             // Insert the unmangled name to detect potential future redefinition as a variable.
             TFunction *function = new TFunction(NewPoolTString($1->getName().c_str()), $1->getReturnType());
-            context->symbolTable.getOuterLevel()->insert(function);
+            context->symbolTable.declareInOuterLevel(function);
         }
 
         //
@@ -889,7 +889,7 @@ function_prototype
 
         // We're at the inner scope level of the function's arguments and body statement.
         // Add the function prototype to the surrounding scope instead.
-        context->symbolTable.getOuterLevel()->insert($$.function);
+        context->symbolTable.declareInOuterLevel($$.function);
     }
     ;
 
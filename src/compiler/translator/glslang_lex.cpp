@@ -3182,8 +3182,13 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 #define YYTABLES_NAME "yytables"
 
 yy_size_t string_input(char* buf, yy_size_t max_size, yyscan_t yyscanner) {
+    // The input ends early once the memory budget is used up.
+    TParseContext* context = yyget_extra(yyscanner);
+    if (context->memoryBudgetExceeded())
+        return 0;
+
     pp::Token token;
-    yyget_extra(yyscanner)->preprocessor.lex(&token);
+    context->preprocessor.lex(&token);
     yy_size_t len = token.type == pp::Token::LAST ? 0 : token.text.size();
     if (len < max_size)
         memcpy(buf, token.text.c_str(), len);
@@ -3295,7 +3300,9 @@ int floatsuffix_check(TParseContext* context)
 }
 
 void yyerror(YYLTYPE* lloc, TParseContext* context, const char* reason) {
-    context->error(*lloc, reason, yyget_text(context->scanner));
+    // Syntax errors at the early end of the input are not reported.
+    if (!context->memoryBudgetExceeded())
+        context->error(*lloc, reason, yyget_text(context->scanner));
     context->recover();
 }
 
@@ -3340,18 +3347,24 @@ int glslang_scan(size_t count, const char* const string[], const int length[],
     yyset_column(0,context->scanner);
     yyset_lineno(1,context->scanner);
 
-    // Initialize preprocessor.
-    if (!context->preprocessor.init(count, string, length))
-        return 1;
-
-    // Define extension macros.
-    const TExtensionBehavior& extBehavior = context->extensionBehavior();
-    for (TExtensionBehavior::const_iterator iter = extBehavior.begin();
-         iter != extBehavior.end(); ++iter) {
-        context->preprocessor.predefineMacro(iter->first.c_str(), 1);
+    // Initialize preprocessor. The state after a prologue includes the
+    // extension macros.
+    if (context->prologue) {
+        if (!context->preprocessor.init(*context->prologue, count, string, length))
+            return 1;
+    } else {
+        if (!context->preprocessor.init(count, string, length))
+            return 1;
+
+        // Define extension macros.
+        const TExtensionBehavior& extBehavior = context->extensionBehavior();
+        for (TExtensionBehavior::const_iterator iter = extBehavior.begin();
+             iter != extBehavior.end(); ++iter) {
+            context->preprocessor.predefineMacro(iter->first.c_str(), 1);
+        }
+        if (context->fragmentPrecisionHigh)
+            context->preprocessor.predefineMacro("GL_FRAGMENT_PRECISION_HIGH", 1);
     }
-    if (context->fragmentPrecisionHigh)
-        context->preprocessor.predefineMacro("GL_FRAGMENT_PRECISION_HIGH", 1);
 
     context->preprocessor.setMaxTokenSize(GetGlobalMaxTokenSize(context->shaderSpec));
 
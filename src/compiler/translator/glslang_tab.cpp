@@ -3426,7 +3426,7 @@ yyreduce:
         {
             // Insert the unmangled name to detect potential future redefinition as a variable.
             TFunction *function = new TFunction(NewPoolTString((yyvsp[(1) - (2)].interm.function)->getName().c_str()), (yyvsp[(1) - (2)].interm.function)->getReturnType());
-            context->symbolTable.getOuterLevel()->insert(function);
+            context->symbolTable.declareInOuterLevel(function);
         }
 
         //
@@ -3438,7 +3438,7 @@ yyreduce:
 
         // We're at the inner scope level of the function's arguments and body statement.
         // Add the function prototype to the surrounding scope instead.
-        context->symbolTable.getOuterLevel()->insert((yyval.interm).function);
+        context->symbolTable.declareInOuterLevel((yyval.interm).function);
     }
     break;
 
@@ -24,9 +24,9 @@ inline void WriteColor(const uint8_t *source, uint8_t *dest)
 template <typename sourceType, typename destType, typename colorDataType>
 inline void CopyPixel(const uint8_t *source, uint8_t *dest)
 {
-    colorDataType temp;
-    ReadColor<sourceType, colorDataType>(source, &temp);
-    WriteColor<destType, colorDataType>(&temp, dest);
+    gl::Color<colorDataType> temp;
+    ReadColor<sourceType, colorDataType>(source, reinterpret_cast<uint8_t*>(&temp));
+    WriteColor<destType, colorDataType>(reinterpret_cast<const uint8_t*>(&temp), dest);
 }
 
 }
@@ -11,6 +11,10 @@
 
 #include "common/mathutil.h"
 
+#include "angle_gl.h"
+
+#include <cstdint>
+
 namespace rx
 {
 
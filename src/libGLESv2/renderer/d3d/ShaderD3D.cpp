@@ -34,6 +34,11 @@ const char *GetShaderTypeString(GLenum type)
     }
 }
 
+void AppendObjectCodeChunk(const char *chunk, size_t length, void *userData)
+{
+    static_cast<std::string*>(userData)->append(chunk, length);
+}
+
 }
 
 namespace rx
@@ -261,7 +266,10 @@ void ShaderD3D::compileToHLSL(void *compiler, const std::string &source)
     }
     else if (result)
     {
-        mHlsl = ShGetObjectCode(compiler);
+        // Copy the object code straight out of the translator's chunks
+        mHlsl.clear();
+        mHlsl.reserve(ShGetObjectCodeLength(compiler));
+        ShGetObjectCodeChunks(compiler, AppendObjectCodeChunk, &mHlsl);
 
 #ifdef _DEBUG
         // Prefix hlsl shader with commented out glsl shader
@@ -232,7 +232,7 @@ void AddDXGIFormat(DXGIFormatInfoMap *map, DXGI_FORMAT dxgiFormat, GLuint pixelB
 
     info.componentType = componentType;
 
-    info.mipGenerationFunction = mipFunc;
+    info.mipGenerationFunction = GetMipFunction(mipFunc);
     info.colorReadFunction = readFunc;
 
     static const D3D11FastCopyMap fastCopyMap = BuildFastCopyMap();
@@ -457,7 +457,7 @@ static void UnreachableLoadFunction(size_t width, size_t height, size_t depth,
 static inline void InsertLoadFunction(D3D11LoadFunctionMap *map, GLenum internalFormat, GLenum type,
                                       LoadImageFunction loadFunc)
 {
-    (*map)[internalFormat].push_back(TypeLoadFunctionPair(type, loadFunc));
+    (*map)[internalFormat].push_back(TypeLoadFunctionPair(type, GetLoadFunction(loadFunc)));
 }
 
 D3D11LoadFunctionMap BuildD3D11LoadFunctionMap()
@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// generatemip.cpp: Chooses the variants of the mip generation functions and
+// generates whole mip chains.
+
+#include "libGLESv2/renderer/generatemip.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace rx
+{
+
+#if defined(ANGLE_LOAD_IMAGE_X86)
+#define MIP_VARIANT_X86(function) function
+#else
+#define MIP_VARIANT_X86(function) NULL
+#endif
+
+struct MipFunctionVariants
+{
+    MipGenerationFunction scalar;
+    MipGenerationFunction sse2;
+};
+
+static const MipFunctionVariants mipFunctionVariants[] =
+{
+    { GenerateMip<R8G8B8A8>,      MIP_VARIANT_X86(GenerateMipR8G8B8A8_SSE2)      },
+    { GenerateMip<B8G8R8A8>,      MIP_VARIANT_X86(GenerateMipB8G8R8A8_SSE2)      },
+    { GenerateMip<L8>,            MIP_VARIANT_X86(GenerateMipL8_SSE2)            },
+    { GenerateMip<A8>,            MIP_VARIANT_X86(GenerateMipA8_SSE2)            },
+    { GenerateMip<R16G16B16A16F>, MIP_VARIANT_X86(GenerateMipR16G16B16A16F_SSE2) },
+    { GenerateMip<R32G32B32A32F>, MIP_VARIANT_X86(GenerateMipR32G32B32A32F_SSE2) },
+};
+
+MipGenerationFunction GetMipFunctionVariant(MipGenerationFunction mipFunction, LoadInstructionSet instructionSet)
+{
+    if (instructionSet == LOAD_INSTRUCTION_SET_SCALAR)
+    {
+        return mipFunction;
+    }
+
+    if (instructionSet != LOAD_INSTRUCTION_SET_SSE2 || !SupportsLoadInstructionSet(instructionSet))
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < ArraySize(mipFunctionVariants); i++)
+    {
+        if (mipFunctionVariants[i].scalar == mipFunction)
+        {
+            return mipFunctionVariants[i].sse2;
+        }
+    }
+
+    return NULL;
+}
+
+MipGenerationFunction GetMipFunction(MipGenerationFunction mipFunction)
+{
+    MipGenerationFunction variant = GetMipFunctionVariant(mipFunction, LOAD_INSTRUCTION_SET_SSE2);
+    return (variant != NULL) ? variant : mipFunction;
+}
+
+void GenerateMipChain(MipGenerationFunction mipFunction, size_t pixelBytes,
+                      size_t width, size_t height, size_t depth, size_t levelCount,
+                      uint8_t *const *levelData, const size_t *levelRowPitches, const size_t *levelDepthPitches)
+{
+    std::vector<size_t> levelWidths(levelCount);
+    std::vector<size_t> levelHeights(levelCount);
+    std::vector<size_t> levelDepths(levelCount);
+    for (size_t level = 0; level < levelCount; level++)
+    {
+        levelWidths[level] = std::max<size_t>(1, width >> level);
+        levelHeights[level] = std::max<size_t>(1, height >> level);
+        levelDepths[level] = std::max<size_t>(1, depth >> level);
+    }
+
+    // Strips of a power of two rows that hold about kMipChainStripBytes.
+    size_t stripRows = 2;
+    while (stripRows * 2 * width * pixelBytes <= kMipChainStripBytes)
+    {
+        stripRows *= 2;
+    }
+
+    // Strips only hold whole 2x2 reductions, so they stop at the level at
+    // which a strip has one row left, or the first level whose source is one
+    // pixel wide or high. 3D images are small enough to generate a level at
+    // a time.
+    size_t stripLevels = 0;
+    if (depth == 1)
+    {
+        while (stripLevels + 1 < levelCount && (stripRows >> stripLevels) > 1 &&
+               levelWidths[stripLevels] > 1 && levelHeights[stripLevels] > 1)
+        {
+            stripLevels++;
+        }
+    }
+
+    for (size_t stripY = 0; stripLevels > 0 && stripY < height; stripY += stripRows)
+    {
+        for (size_t level = 1; level <= stripLevels; level++)
+        {
+            // The rows of the strip in the source level. They start on an even
+            // row, so their reduction is the same as that of the whole level;
+            // an odd last row is dropped either way.
+            size_t sourceY = stripY >> (level - 1);
+            size_t sourceHeight = std::min(stripRows >> (level - 1), levelHeights[level - 1] - sourceY);
+            if (sourceHeight < 2)
+            {
+                break;
+            }
+
+            mipFunction(levelWidths[level - 1], sourceHeight, 1,
+                        levelData[level - 1] + sourceY * levelRowPitches[level - 1],
+                        levelRowPitches[level - 1], levelDepthPitches[level - 1],
+                        levelData[level] + (sourceY / 2) * levelRowPitches[level],
+                        levelRowPitches[level], levelDepthPitches[level]);
+        }
+    }
+
+    for (size_t level = stripLevels + 1; level < levelCount; level++)
+    {
+        mipFunction(levelWidths[level - 1], levelHeights[level - 1], levelDepths[level - 1],
+                    levelData[level - 1], levelRowPitches[level - 1], levelDepthPitches[level - 1],
+                    levelData[level], levelRowPitches[level], levelDepthPitches[level]);
+    }
+}
+
+}
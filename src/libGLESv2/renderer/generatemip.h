@@ -11,7 +11,9 @@
 #define LIBGLESV2_RENDERER_GENERATEMIP_H_
 
 #include "libGLESv2/renderer/imageformats.h"
+#include "libGLESv2/renderer/loadimage.h"
 #include "libGLESv2/angletypes.h"
+#include "libGLESv2/formatutils.h"
 
 namespace rx
 {
@@ -21,6 +23,61 @@ inline void GenerateMip(size_t sourceWidth, size_t sourceHeight, size_t sourceDe
                         const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
                         uint8_t *destData, size_t destRowPitch, size_t destDepthPitch);
 
+// Variants of GenerateMip for one instruction set, which write the same bytes
+// as the GenerateMip<T> they are variants of. They are chosen with
+// GetMipFunction rather than called directly.
+
+// generatemipSSE2.cpp
+void GenerateMipR8G8B8A8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                              const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                              uint8_t *destData, size_t destRowPitch, size_t destDepthPitch);
+
+void GenerateMipB8G8R8A8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                              const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                              uint8_t *destData, size_t destRowPitch, size_t destDepthPitch);
+
+void GenerateMipL8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                        const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                        uint8_t *destData, size_t destRowPitch, size_t destDepthPitch);
+
+void GenerateMipA8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                        const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                        uint8_t *destData, size_t destRowPitch, size_t destDepthPitch);
+
+void GenerateMipR16G16B16A16F_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                                   const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                                   uint8_t *destData, size_t destRowPitch, size_t destDepthPitch);
+
+void GenerateMipR32G32B32A32F_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                                   const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                                   uint8_t *destData, size_t destRowPitch, size_t destDepthPitch);
+
+// Returns the variant of |mipFunction| for |instructionSet|, or NULL if it has
+// none or the instruction set is not supported. The scalar variant of a
+// function is the function itself.
+MipGenerationFunction GetMipFunctionVariant(MipGenerationFunction mipFunction, LoadInstructionSet instructionSet);
+
+// Returns the fastest supported variant of |mipFunction|, which is
+// |mipFunction| itself if it has no other. Like GetLoadFunction, the format
+// tables call this when they are built.
+MipGenerationFunction GetMipFunction(MipGenerationFunction mipFunction);
+
+// GenerateMipChain splits the base level into strips of whole rows, a power
+// of two of them and about this many bytes, and reduces each strip through
+// as many levels as it has rows before reading the next.
+const size_t kMipChainStripBytes = 128 * 1024;
+
+// Generates levels 1 to |levelCount| - 1 of a mip chain from level 0, which
+// is |width| x |height| x |depth| pixels of |pixelBytes| bytes, with
+// |mipFunction|. Each level is half the size of the one above it, as GL
+// defines them. The levels of 2D images are generated a strip of the base
+// level at a time, so that each level is written while the one above it is
+// still in the cache rather than read back from memory. The result is the
+// same as that of calling |mipFunction| for each level in turn.
+void GenerateMipChain(MipGenerationFunction mipFunction, size_t pixelBytes,
+                      size_t width, size_t height, size_t depth, size_t levelCount,
+                      uint8_t *const *levelData, const size_t *levelRowPitches, const size_t *levelDepthPitches);
+
 }
 
 #include "generatemip.inl"
@@ -0,0 +1,404 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// generatemipSSE2.cpp: Defines the SSE2 variants of the mip generation
+// functions. It's in a separated file for GCC, which can enable SSE usage
+// only per-file.
+
+#include "libGLESv2/renderer/generatemip.h"
+
+#if defined(ANGLE_LOAD_IMAGE_X86)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+namespace rx
+{
+
+namespace
+{
+
+// Like gl::average on each byte: rounds down, where _mm_avg_epu8 rounds up.
+inline __m128i AverageUNorm8(__m128i a, __m128i b)
+{
+    __m128i roundedUp = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1));
+    return _mm_sub_epi8(_mm_avg_epu8(a, b), roundedUp);
+}
+
+inline __m128 AverageFloat(__m128 a, __m128 b)
+{
+    return _mm_mul_ps(_mm_add_ps(a, b), _mm_set1_ps(0.5f));
+}
+
+// Converts four half floats, in the low 16 bits of each lane, like
+// gl::float16ToFloat32.
+inline __m128 Float16ToFloat32(__m128i halves)
+{
+    __m128i magnitude = _mm_slli_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x7FFF)), 13);
+    __m128i sign = _mm_slli_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x8000)), 16);
+
+    // Rebiasing the exponent handles normals, and infinities and NaNs once
+    // their exponent is rebiased to all ones too. Denormals are exact in
+    // float: bias them as normals and subtract the implicit one.
+    __m128i isInfinityOrNaN = _mm_cmpeq_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x7C00)), _mm_set1_epi32(0x7C00));
+    __m128i normal = _mm_add_epi32(magnitude, _mm_set1_epi32(112 << 23));
+    normal = _mm_add_epi32(normal, _mm_and_si128(isInfinityOrNaN, _mm_set1_epi32(112 << 23)));
+    __m128 denormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(magnitude, _mm_set1_epi32(113 << 23))),
+                                 _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+    __m128i isDenormal = _mm_cmpeq_epi32(_mm_and_si128(halves, _mm_set1_epi32(0x7C00)), _mm_setzero_si128());
+
+    __m128i value = _mm_or_si128(_mm_and_si128(isDenormal, _mm_castps_si128(denormal)),
+                                 _mm_andnot_si128(isDenormal, normal));
+    return _mm_castsi128_ps(_mm_or_si128(value, sign));
+}
+
+// Converts four floats to half floats in the low 16 bits of each lane, with
+// the same rounding and clamping as gl::float32ToFloat16.
+inline __m128i Float32ToFloat16(__m128 values)
+{
+    __m128i bits = _mm_castps_si128(values);
+    __m128i abs = _mm_and_si128(bits, _mm_set1_epi32(0x7FFFFFFF));
+
+    // Values below 0x2D000000 become zero. Those between it and the smallest
+    // normal half become denormals, which are rare enough to leave to the
+    // scalar conversion.
+    __m128i zero = _mm_cmplt_epi32(abs, _mm_set1_epi32(0x2D000000));
+    __m128i denormal = _mm_andnot_si128(zero, _mm_cmplt_epi32(abs, _mm_set1_epi32(0x38800000)));
+    if (_mm_movemask_epi8(denormal) != 0)
+    {
+        float lanes[4];
+        _mm_storeu_ps(lanes, values);
+        return _mm_setr_epi32(gl::float32ToFloat16(lanes[0]), gl::float32ToFloat16(lanes[1]),
+                              gl::float32ToFloat16(lanes[2]), gl::float32ToFloat16(lanes[3]));
+    }
+
+    __m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+    __m128i roundToEven = _mm_and_si128(_mm_srli_epi32(abs, 13), _mm_set1_epi32(1));
+    __m128i normal = _mm_add_epi32(_mm_add_epi32(abs, _mm_set1_epi32(static_cast<int>(0xC8000FFF))), roundToEven);
+    normal = _mm_andnot_si128(zero, _mm_srli_epi32(normal, 13));
+
+    __m128i infinity = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x47FFEFFF));
+    __m128i value = _mm_or_si128(_mm_andnot_si128(infinity, normal), _mm_and_si128(infinity, _mm_set1_epi32(0x7FFF)));
+    return _mm_or_si128(value, sign);
+}
+
+// Like gl::averageHalfFloat on four half floats in the low 16 bits of each
+// lane.
+inline __m128i AverageFloat16(__m128i a, __m128i b)
+{
+    return Float32ToFloat16(AverageFloat(Float16ToFloat32(a), Float16ToFloat32(b)));
+}
+
+// Packs the half floats in the low 16 bits of the lanes of |a| and |b|.
+inline __m128i PackFloat16(__m128i a, __m128i b)
+{
+    // Sign extend so that the saturating pack keeps all 16 bits.
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                           _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+}
+
+inline __m128i Load(const uint8_t *source)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+inline void Store(uint8_t *dest, __m128i value)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), value);
+}
+
+// Each format reduces a step of destPixels pixels at a time. The source rows
+// are averaged first and then neighbouring pixels, in the same order as
+// GenerateMip<T>, so the results are the same to the bit.
+
+// Formats with one to four unsigned normalized 8-bit channels, whose average
+// averages each byte.
+template <typename T>
+struct UNorm8Format
+{
+    typedef T Pixel;
+    static const size_t destPixels = 16 / sizeof(T);
+
+    // Averages neighbouring pixels of the 32 bytes in |v0| and |v1|.
+    static __m128i AverageNeighbours(__m128i v0, __m128i v1)
+    {
+        __m128i even, odd;
+        if (sizeof(T) == 4)
+        {
+            even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(v0), _mm_castsi128_ps(v1), _MM_SHUFFLE(2, 0, 2, 0)));
+            odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(v0), _mm_castsi128_ps(v1), _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        else
+        {
+            const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+            even = _mm_packus_epi16(_mm_and_si128(v0, lowBytes), _mm_and_si128(v1, lowBytes));
+            odd = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+        }
+        return AverageUNorm8(even, odd);
+    }
+
+    static void Reduce2(const uint8_t *row0, const uint8_t *row1, uint8_t *dest)
+    {
+        __m128i v0 = AverageUNorm8(Load(row0), Load(row1));
+        __m128i v1 = AverageUNorm8(Load(row0 + 16), Load(row1 + 16));
+        Store(dest, AverageNeighbours(v0, v1));
+    }
+
+    static void Reduce4(const uint8_t *row0, const uint8_t *row1, const uint8_t *row2, const uint8_t *row3, uint8_t *dest)
+    {
+        __m128i v0 = AverageUNorm8(AverageUNorm8(Load(row0), Load(row1)), AverageUNorm8(Load(row2), Load(row3)));
+        __m128i v1 = AverageUNorm8(AverageUNorm8(Load(row0 + 16), Load(row1 + 16)),
+                                   AverageUNorm8(Load(row2 + 16), Load(row3 + 16)));
+        Store(dest, AverageNeighbours(v0, v1));
+    }
+};
+
+struct R32G32B32A32FFormat
+{
+    typedef R32G32B32A32F Pixel;
+    static const size_t destPixels = 1;
+
+    static __m128 LoadPixel(const uint8_t *source)
+    {
+        return _mm_loadu_ps(reinterpret_cast<const float*>(source));
+    }
+
+    static void Reduce2(const uint8_t *row0, const uint8_t *row1, uint8_t *dest)
+    {
+        __m128 v0 = AverageFloat(LoadPixel(row0), LoadPixel(row1));
+        __m128 v1 = AverageFloat(LoadPixel(row0 + 16), LoadPixel(row1 + 16));
+        _mm_storeu_ps(reinterpret_cast<float*>(dest), AverageFloat(v0, v1));
+    }
+
+    static void Reduce4(const uint8_t *row0, const uint8_t *row1, const uint8_t *row2, const uint8_t *row3, uint8_t *dest)
+    {
+        __m128 v0 = AverageFloat(AverageFloat(LoadPixel(row0), LoadPixel(row1)),
+                                 AverageFloat(LoadPixel(row2), LoadPixel(row3)));
+        __m128 v1 = AverageFloat(AverageFloat(LoadPixel(row0 + 16), LoadPixel(row1 + 16)),
+                                 AverageFloat(LoadPixel(row2 + 16), LoadPixel(row3 + 16)));
+        _mm_storeu_ps(reinterpret_cast<float*>(dest), AverageFloat(v0, v1));
+    }
+};
+
+struct R16G16B16A16FFormat
+{
+    typedef R16G16B16A16F Pixel;
+    static const size_t destPixels = 2;
+
+    // Loads four pixels, one to a vector with a channel in each lane.
+    static void LoadPixels(const uint8_t *source, __m128i pixels[4])
+    {
+        __m128i p01 = Load(source);
+        __m128i p23 = Load(source + 16);
+        pixels[0] = _mm_unpacklo_epi16(p01, _mm_setzero_si128());
+        pixels[1] = _mm_unpackhi_epi16(p01, _mm_setzero_si128());
+        pixels[2] = _mm_unpacklo_epi16(p23, _mm_setzero_si128());
+        pixels[3] = _mm_unpackhi_epi16(p23, _mm_setzero_si128());
+    }
+
+    static void StoreAverageNeighbours(uint8_t *dest, const __m128i v[4])
+    {
+        Store(dest, PackFloat16(AverageFloat16(v[0], v[1]), AverageFloat16(v[2], v[3])));
+    }
+
+    static void Reduce2(const uint8_t *row0, const uint8_t *row1, uint8_t *dest)
+    {
+        __m128i p0[4], p1[4], v[4];
+        LoadPixels(row0, p0);
+        LoadPixels(row1, p1);
+        for (size_t i = 0; i < 4; i++)
+        {
+            v[i] = AverageFloat16(p0[i], p1[i]);
+        }
+        StoreAverageNeighbours(dest, v);
+    }
+
+    static void Reduce4(const uint8_t *row0, const uint8_t *row1, const uint8_t *row2, const uint8_t *row3, uint8_t *dest)
+    {
+        __m128i p0[4], p1[4], p2[4], p3[4], v[4];
+        LoadPixels(row0, p0);
+        LoadPixels(row1, p1);
+        LoadPixels(row2, p2);
+        LoadPixels(row3, p3);
+        for (size_t i = 0; i < 4; i++)
+        {
+            v[i] = AverageFloat16(AverageFloat16(p0[i], p1[i]), AverageFloat16(p2[i], p3[i]));
+        }
+        StoreAverageNeighbours(dest, v);
+    }
+};
+
+// Reduces a row of 2x2 pixels, from two source rows.
+template <typename Format>
+void ReduceRow2(const uint8_t *row0, const uint8_t *row1, uint8_t *dest, size_t destWidth)
+{
+    typedef typename Format::Pixel T;
+
+    size_t x = 0;
+    for (; x + Format::destPixels <= destWidth; x += Format::destPixels)
+    {
+        Format::Reduce2(row0 + x * 2 * sizeof(T), row1 + x * 2 * sizeof(T), dest + x * sizeof(T));
+    }
+
+    const T *src0 = reinterpret_cast<const T*>(row0);
+    const T *src1 = reinterpret_cast<const T*>(row1);
+    T *dst = reinterpret_cast<T*>(dest);
+    for (; x < destWidth; x++)
+    {
+        T tmp0, tmp1;
+
+        T::average(&tmp0, &src0[x * 2], &src1[x * 2]);
+        T::average(&tmp1, &src0[x * 2 + 1], &src1[x * 2 + 1]);
+        T::average(&dst[x], &tmp0, &tmp1);
+    }
+}
+
+// Reduces a row of 2x2x2 pixels, from the rows (y, z), (y, z + 1),
+// (y + 1, z) and (y + 1, z + 1) of the source.
+template <typename Format>
+void ReduceRow4(const uint8_t *row0, const uint8_t *row1, const uint8_t *row2, const uint8_t *row3,
+                uint8_t *dest, size_t destWidth)
+{
+    typedef typename Format::Pixel T;
+
+    size_t x = 0;
+    for (; x + Format::destPixels <= destWidth; x += Format::destPixels)
+    {
+        size_t offset = x * 2 * sizeof(T);
+        Format::Reduce4(row0 + offset, row1 + offset, row2 + offset, row3 + offset, dest + x * sizeof(T));
+    }
+
+    const T *src0 = reinterpret_cast<const T*>(row0);
+    const T *src1 = reinterpret_cast<const T*>(row1);
+    const T *src2 = reinterpret_cast<const T*>(row2);
+    const T *src3 = reinterpret_cast<const T*>(row3);
+    T *dst = reinterpret_cast<T*>(dest);
+    for (; x < destWidth; x++)
+    {
+        T tmp0, tmp1, tmp2, tmp3, tmp4, tmp5;
+
+        T::average(&tmp0, &src0[x * 2], &src1[x * 2]);
+        T::average(&tmp1, &src2[x * 2], &src3[x * 2]);
+        T::average(&tmp2, &src0[x * 2 + 1], &src1[x * 2 + 1]);
+        T::average(&tmp3, &src2[x * 2 + 1], &src3[x * 2 + 1]);
+
+        T::average(&tmp4, &tmp0, &tmp1);
+        T::average(&tmp5, &tmp2, &tmp3);
+
+        T::average(&dst[x], &tmp4, &tmp5);
+    }
+}
+
+// Reduces images that are more than one pixel wide and either high or deep;
+// the others are small enough for GenerateMip<T>.
+template <typename Format>
+void GenerateMip_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                      const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                      uint8_t *destData, size_t destRowPitch, size_t destDepthPitch)
+{
+    size_t destWidth = sourceWidth >> 1;
+    size_t destHeight = sourceHeight >> 1;
+    size_t destDepth = sourceDepth >> 1;
+
+    if (sourceWidth > 1 && sourceHeight > 1 && sourceDepth == 1)
+    {
+        for (size_t y = 0; y < destHeight; y++)
+        {
+            ReduceRow2<Format>(sourceData + y * 2 * sourceRowPitch, sourceData + (y * 2 + 1) * sourceRowPitch,
+                               destData + y * destRowPitch, destWidth);
+        }
+    }
+    else if (sourceWidth > 1 && sourceHeight == 1 && sourceDepth > 1)
+    {
+        for (size_t z = 0; z < destDepth; z++)
+        {
+            ReduceRow2<Format>(sourceData + z * 2 * sourceDepthPitch, sourceData + (z * 2 + 1) * sourceDepthPitch,
+                               destData + z * destDepthPitch, destWidth);
+        }
+    }
+    else if (sourceWidth > 1 && sourceHeight > 1 && sourceDepth > 1)
+    {
+        for (size_t z = 0; z < destDepth; z++)
+        {
+            for (size_t y = 0; y < destHeight; y++)
+            {
+                const uint8_t *source = sourceData + y * 2 * sourceRowPitch + z * 2 * sourceDepthPitch;
+                ReduceRow4<Format>(source, source + sourceDepthPitch,
+                                   source + sourceRowPitch, source + sourceRowPitch + sourceDepthPitch,
+                                   destData + y * destRowPitch + z * destDepthPitch, destWidth);
+            }
+        }
+    }
+    else
+    {
+        GenerateMip<typename Format::Pixel>(sourceWidth, sourceHeight, sourceDepth,
+                                            sourceData, sourceRowPitch, sourceDepthPitch,
+                                            destData, destRowPitch, destDepthPitch);
+    }
+}
+
+}
+
+void GenerateMipR8G8B8A8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                              const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                              uint8_t *destData, size_t destRowPitch, size_t destDepthPitch)
+{
+    GenerateMip_SSE2<UNorm8Format<R8G8B8A8> >(sourceWidth, sourceHeight, sourceDepth,
+                                              sourceData, sourceRowPitch, sourceDepthPitch,
+                                              destData, destRowPitch, destDepthPitch);
+}
+
+void GenerateMipB8G8R8A8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                              const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                              uint8_t *destData, size_t destRowPitch, size_t destDepthPitch)
+{
+    GenerateMip_SSE2<UNorm8Format<B8G8R8A8> >(sourceWidth, sourceHeight, sourceDepth,
+                                              sourceData, sourceRowPitch, sourceDepthPitch,
+                                              destData, destRowPitch, destDepthPitch);
+}
+
+void GenerateMipL8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                        const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                        uint8_t *destData, size_t destRowPitch, size_t destDepthPitch)
+{
+    GenerateMip_SSE2<UNorm8Format<L8> >(sourceWidth, sourceHeight, sourceDepth,
+                                        sourceData, sourceRowPitch, sourceDepthPitch,
+                                        destData, destRowPitch, destDepthPitch);
+}
+
+void GenerateMipA8_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                        const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                        uint8_t *destData, size_t destRowPitch, size_t destDepthPitch)
+{
+    GenerateMip_SSE2<UNorm8Format<A8> >(sourceWidth, sourceHeight, sourceDepth,
+                                        sourceData, sourceRowPitch, sourceDepthPitch,
+                                        destData, destRowPitch, destDepthPitch);
+}
+
+void GenerateMipR16G16B16A16F_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                                   const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                                   uint8_t *destData, size_t destRowPitch, size_t destDepthPitch)
+{
+    GenerateMip_SSE2<R16G16B16A16FFormat>(sourceWidth, sourceHeight, sourceDepth,
+                                          sourceData, sourceRowPitch, sourceDepthPitch,
+                                          destData, destRowPitch, destDepthPitch);
+}
+
+void GenerateMipR32G32B32A32F_SSE2(size_t sourceWidth, size_t sourceHeight, size_t sourceDepth,
+                                   const uint8_t *sourceData, size_t sourceRowPitch, size_t sourceDepthPitch,
+                                   uint8_t *destData, size_t destRowPitch, size_t destDepthPitch)
+{
+    GenerateMip_SSE2<R32G32B32A32FFormat>(sourceWidth, sourceHeight, sourceDepth,
+                                          sourceData, sourceRowPitch, sourceDepthPitch,
+                                          destData, destRowPitch, destDepthPitch);
+}
+
+}
+
+#endif // defined(ANGLE_LOAD_IMAGE_X86)
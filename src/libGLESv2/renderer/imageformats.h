@@ -11,6 +11,7 @@
 #define LIBGLESV2_RENDERER_IMAGEFORMATS_H_
 
 #include "common/mathutil.h"
+#include "libGLESv2/angletypes.h"
 
 namespace rx
 {
@@ -8,6 +8,14 @@
 
 #include "libGLESv2/renderer/loadimage.h"
 
+#if defined(ANGLE_LOAD_IMAGE_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
 namespace rx
 {
 
@@ -341,7 +349,7 @@ void LoadRGBA8ToBGRA8(size_t width, size_t height, size_t depth,
             for (size_t x = 0; x < width; x++)
             {
                 uint32_t rgba = source[x];
-                dest[x] = (_rotl(rgba, 16) & 0x00ff00ff) | (rgba & 0xff00ff00);
+                dest[x] = (gl::rotl(rgba, 16) & 0x00ff00ff) | (rgba & 0xff00ff00);
             }
         }
     }
@@ -658,4 +666,177 @@ void LoadR32ToR24G8(size_t width, size_t height, size_t depth,
     }
 }
 
+#if defined(ANGLE_LOAD_IMAGE_X86)
+#define LOAD_VARIANT_X86(function) function
+#else
+#define LOAD_VARIANT_X86(function) NULL
+#endif
+
+#if defined(ANGLE_LOAD_IMAGE_NEON)
+#define LOAD_VARIANT_NEON(function) function
+#else
+#define LOAD_VARIANT_NEON(function) NULL
+#endif
+
+struct LoadFunctionVariants
+{
+    LoadImageFunction scalar;
+    LoadImageFunction sse2;
+    LoadImageFunction ssse3;
+    LoadImageFunction avx2;
+    LoadImageFunction neon;
+};
+
+// The variants of each scalar function. Functions that write the same bytes
+// share their variants.
+static const LoadFunctionVariants loadFunctionVariants[] =
+{
+    { LoadA8ToRGBA8,                     LOAD_VARIANT_X86(LoadA8ToBGRA8_SSE2),       NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadA8ToBGRA8_NEON)       },
+    { LoadA8ToBGRA8,                     LOAD_VARIANT_X86(LoadA8ToBGRA8_SSE2),       NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadA8ToBGRA8_NEON)       },
+    { LoadL8ToRGBA8,                     LOAD_VARIANT_X86(LoadL8ToRGBA8_SSE2),       NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadL8ToRGBA8_NEON)       },
+    { LoadL8ToBGRA8,                     LOAD_VARIANT_X86(LoadL8ToRGBA8_SSE2),       NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadL8ToRGBA8_NEON)       },
+    { LoadLA8ToRGBA8,                    LOAD_VARIANT_X86(LoadLA8ToRGBA8_SSE2),      NULL,                                       LOAD_VARIANT_X86(LoadLA8ToRGBA8_AVX2),      LOAD_VARIANT_NEON(LoadLA8ToRGBA8_NEON)      },
+    { LoadLA8ToBGRA8,                    LOAD_VARIANT_X86(LoadLA8ToRGBA8_SSE2),      NULL,                                       LOAD_VARIANT_X86(LoadLA8ToRGBA8_AVX2),      LOAD_VARIANT_NEON(LoadLA8ToRGBA8_NEON)      },
+    { LoadRGB8ToBGRX8,                   NULL,                                       LOAD_VARIANT_X86(LoadRGB8ToBGRX8_SSSE3),    LOAD_VARIANT_X86(LoadRGB8ToBGRX8_AVX2),     LOAD_VARIANT_NEON(LoadRGB8ToBGRX8_NEON)     },
+    { LoadToNative3To4<GLubyte, 0xFF>,   NULL,                                       LOAD_VARIANT_X86(LoadRGB8ToRGBA8_SSSE3),    LOAD_VARIANT_X86(LoadRGB8ToRGBA8_AVX2),     LOAD_VARIANT_NEON(LoadRGB8ToRGBA8_NEON)     },
+    { LoadRGBA8ToBGRA8,                  LOAD_VARIANT_X86(LoadRGBA8ToBGRA8_SSE2),    LOAD_VARIANT_X86(LoadRGBA8ToBGRA8_SSSE3),   LOAD_VARIANT_X86(LoadRGBA8ToBGRA8_AVX2),    LOAD_VARIANT_NEON(LoadRGBA8ToBGRA8_NEON)    },
+    { LoadRGBA4ToRGBA8,                  LOAD_VARIANT_X86(LoadRGBA4ToRGBA8_SSE2),    NULL,                                       LOAD_VARIANT_X86(LoadRGBA4ToRGBA8_AVX2),    LOAD_VARIANT_NEON(LoadRGBA4ToRGBA8_NEON)    },
+    { LoadBGRA4ToBGRA8,                  LOAD_VARIANT_X86(LoadRGBA4ToRGBA8_SSE2),    NULL,                                       LOAD_VARIANT_X86(LoadRGBA4ToRGBA8_AVX2),    LOAD_VARIANT_NEON(LoadRGBA4ToRGBA8_NEON)    },
+    { LoadRGBA4ToBGRA8,                  LOAD_VARIANT_X86(LoadRGBA4ToBGRA8_SSE2),    NULL,                                       LOAD_VARIANT_X86(LoadRGBA4ToBGRA8_AVX2),    LOAD_VARIANT_NEON(LoadRGBA4ToBGRA8_NEON)    },
+    { LoadRGB5A1ToRGBA8,                 LOAD_VARIANT_X86(LoadRGB5A1ToRGBA8_SSE2),   NULL,                                       LOAD_VARIANT_X86(LoadRGB5A1ToRGBA8_AVX2),   LOAD_VARIANT_NEON(LoadRGB5A1ToRGBA8_NEON)   },
+    { LoadBGR5A1ToBGRA8,                 LOAD_VARIANT_X86(LoadRGB5A1ToRGBA8_SSE2),   NULL,                                       LOAD_VARIANT_X86(LoadRGB5A1ToRGBA8_AVX2),   LOAD_VARIANT_NEON(LoadRGB5A1ToRGBA8_NEON)   },
+    { LoadRGB5A1ToBGRA8,                 LOAD_VARIANT_X86(LoadRGB5A1ToBGRA8_SSE2),   NULL,                                       LOAD_VARIANT_X86(LoadRGB5A1ToBGRA8_AVX2),   LOAD_VARIANT_NEON(LoadRGB5A1ToBGRA8_NEON)   },
+    { LoadR5G6B5ToRGBA8,                 LOAD_VARIANT_X86(LoadR5G6B5ToRGBA8_SSE2),   NULL,                                       LOAD_VARIANT_X86(LoadR5G6B5ToRGBA8_AVX2),   LOAD_VARIANT_NEON(LoadR5G6B5ToRGBA8_NEON)   },
+    { LoadR5G6B5ToBGRA8,                 LOAD_VARIANT_X86(LoadR5G6B5ToBGRA8_SSE2),   NULL,                                       LOAD_VARIANT_X86(LoadR5G6B5ToBGRA8_AVX2),   LOAD_VARIANT_NEON(LoadR5G6B5ToBGRA8_NEON)   },
+    { LoadA32FToRGBA32F,                 LOAD_VARIANT_X86(LoadA32FToRGBA32F_SSE2),   NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadA32FToRGBA32F_NEON)   },
+    { LoadL32FToRGBA32F,                 LOAD_VARIANT_X86(LoadL32FToRGBA32F_SSE2),   NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadL32FToRGBA32F_NEON)   },
+    { LoadLA32FToRGBA32F,                LOAD_VARIANT_X86(LoadLA32FToRGBA32F_SSE2),  NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadLA32FToRGBA32F_NEON)  },
+    { LoadA16FToRGBA16F,                 LOAD_VARIANT_X86(LoadA16FToRGBA16F_SSE2),   NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadA16FToRGBA16F_NEON)   },
+    { LoadL16FToRGBA16F,                 LOAD_VARIANT_X86(LoadL16FToRGBA16F_SSE2),   NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadL16FToRGBA16F_NEON)   },
+    { LoadLA16FToRGBA16F,                LOAD_VARIANT_X86(LoadLA16FToRGBA16F_SSE2),  NULL,                                       NULL,                                       LOAD_VARIANT_NEON(LoadLA16FToRGBA16F_NEON)  },
+};
+
+#if defined(ANGLE_LOAD_IMAGE_X86)
+static void QueryCPUID(unsigned int leaf, unsigned int registers[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(reinterpret_cast<int*>(registers), leaf, 0);
+#else
+    __cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// Returns the state components the OS saves on context switches.
+static uint64_t QueryXCR0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+static unsigned int QuerySupportedInstructionSets()
+{
+    unsigned int supported = 1 << LOAD_INSTRUCTION_SET_SCALAR;
+
+#if defined(ANGLE_LOAD_IMAGE_X86)
+    unsigned int registers[4] = { 0 };
+    QueryCPUID(0, registers);
+    unsigned int maxLeaf = registers[0];
+
+    if (maxLeaf >= 1)
+    {
+        QueryCPUID(1, registers);
+        if (registers[3] & (1 << 26))
+        {
+            supported |= 1 << LOAD_INSTRUCTION_SET_SSE2;
+        }
+        if (registers[2] & (1 << 9))
+        {
+            supported |= 1 << LOAD_INSTRUCTION_SET_SSSE3;
+        }
+
+        // AVX2 needs the OS to save the upper halves of the YMM registers
+        bool osSavesYMM = (registers[2] & (1 << 27)) != 0 && (QueryXCR0() & 0x6) == 0x6;
+        bool hasAVX = (registers[2] & (1 << 28)) != 0;
+        if (osSavesYMM && hasAVX && maxLeaf >= 7)
+        {
+            QueryCPUID(7, registers);
+            if (registers[1] & (1 << 5))
+            {
+                supported |= 1 << LOAD_INSTRUCTION_SET_AVX2;
+            }
+        }
+    }
+#elif defined(ANGLE_LOAD_IMAGE_NEON)
+    supported |= 1 << LOAD_INSTRUCTION_SET_NEON;
+#endif
+
+    return supported;
+}
+
+bool SupportsLoadInstructionSet(LoadInstructionSet instructionSet)
+{
+    static const unsigned int supported = QuerySupportedInstructionSets();
+    return (supported & (1 << instructionSet)) != 0;
+}
+
+LoadImageFunction GetLoadFunctionVariant(LoadImageFunction loadFunction, LoadInstructionSet instructionSet)
+{
+    if (instructionSet == LOAD_INSTRUCTION_SET_SCALAR)
+    {
+        return loadFunction;
+    }
+
+    if (!SupportsLoadInstructionSet(instructionSet))
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < ArraySize(loadFunctionVariants); i++)
+    {
+        const LoadFunctionVariants &variants = loadFunctionVariants[i];
+        if (variants.scalar == loadFunction)
+        {
+            switch (instructionSet)
+            {
+              case LOAD_INSTRUCTION_SET_SSE2:  return variants.sse2;
+              case LOAD_INSTRUCTION_SET_SSSE3: return variants.ssse3;
+              case LOAD_INSTRUCTION_SET_AVX2:  return variants.avx2;
+              case LOAD_INSTRUCTION_SET_NEON:  return variants.neon;
+              default: UNREACHABLE();          return NULL;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+LoadImageFunction GetLoadFunction(LoadImageFunction loadFunction)
+{
+    // From the fastest to the slowest
+    static const LoadInstructionSet preferredInstructionSets[] =
+    {
+        LOAD_INSTRUCTION_SET_AVX2,
+        LOAD_INSTRUCTION_SET_SSSE3,
+        LOAD_INSTRUCTION_SET_SSE2,
+        LOAD_INSTRUCTION_SET_NEON,
+    };
+
+    for (size_t i = 0; i < ArraySize(preferredInstructionSets); i++)
+    {
+        LoadImageFunction variant = GetLoadFunctionVariant(loadFunction, preferredInstructionSets[i]);
+        if (variant != NULL)
+        {
+            return variant;
+        }
+    }
+
+    return loadFunction;
+}
+
 }
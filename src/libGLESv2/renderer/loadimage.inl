@@ -153,4 +153,26 @@ inline void Initialize4ComponentData(size_t width, size_t height, size_t depth,
     }
 }
 
+template <size_t sourcePixelSize, size_t destPixelSize>
+inline void LoadRows(LoadRowFunction loadRow, LoadImageFunction loadRemainder,
+                     size_t width, size_t height, size_t depth,
+                     const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                     uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    for (size_t z = 0; z < depth; z++)
+    {
+        for (size_t y = 0; y < height; y++)
+        {
+            const uint8_t *source = OffsetDataPointer<uint8_t>(input, y, z, inputRowPitch, inputDepthPitch);
+            uint8_t *dest = OffsetDataPointer<uint8_t>(output, y, z, outputRowPitch, outputDepthPitch);
+
+            size_t x = loadRow(source, dest, width);
+            if (x < width)
+            {
+                loadRemainder(width - x, 1, 1, source + x * sourcePixelSize, 0, 0, dest + x * destPixelSize, 0, 0);
+            }
+        }
+    }
+}
+
 }
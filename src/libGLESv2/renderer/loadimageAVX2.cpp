@@ -0,0 +1,284 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// loadimageAVX2.cpp: Defines the AVX2 variants of the image loading
+// functions that gain from converting twice as many pixels per instruction
+// as the SSE2 and SSSE3 ones. Expanding A8 and L8 is bound by the stores,
+// and is no faster with AVX2.
+
+#include "libGLESv2/renderer/loadimage.h"
+
+#if defined(ANGLE_LOAD_IMAGE_X86)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// GCC and clang only allow AVX2 instructions in functions compiled for it.
+// These functions are only called once the CPU and OS are known to support it.
+#if defined(__GNUC__)
+#define LOAD_AVX2 __attribute__((target("avx2")))
+#else
+#define LOAD_AVX2
+#endif
+
+namespace rx
+{
+
+namespace
+{
+
+// Expands the |bits| wide field at |shift| of sixteen 16-bit pixels to eight
+// bits, by repeating its high bits below it.
+template <int shift, int bits>
+LOAD_AVX2 inline __m256i ExpandField(__m256i pixels)
+{
+    __m256i field = _mm256_and_si256(_mm256_srli_epi16(pixels, shift), _mm256_set1_epi16((1 << bits) - 1));
+    return _mm256_or_si256(_mm256_slli_epi16(field, 8 - bits), _mm256_srli_epi16(field, 2 * bits - 8));
+}
+
+// Expands the bit at |shift| of sixteen 16-bit pixels to 0x00 or 0xFF.
+template <int shift>
+LOAD_AVX2 inline __m256i ExpandBit(__m256i pixels)
+{
+    __m256i bit = _mm256_and_si256(_mm256_srli_epi16(pixels, shift), _mm256_set1_epi16(1));
+    return _mm256_sub_epi16(_mm256_slli_epi16(bit, 8), bit);
+}
+
+// Writes sixteen 4-byte pixels whose channels are in the low bytes of the
+// 16-bit lanes of |c0| to |c3|.
+LOAD_AVX2 inline void StorePixels(uint8_t *dest, const __m256i &c0, const __m256i &c1, const __m256i &c2, const __m256i &c3)
+{
+    __m256i c01 = _mm256_or_si256(c0, _mm256_slli_epi16(c1, 8));
+    __m256i c23 = _mm256_or_si256(c2, _mm256_slli_epi16(c3, 8));
+
+    // Unpacking works within each 128-bit lane, so lo holds pixels 0-3 and
+    // 8-11 and hi holds 4-7 and 12-15.
+    __m256i lo = _mm256_unpacklo_epi16(c01, c23);
+    __m256i hi = _mm256_unpackhi_epi16(c01, c23);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+struct RGBA4ToRGBA8
+{
+    LOAD_AVX2 static void Store(uint8_t *dest, __m256i p)
+    {
+        StorePixels(dest, ExpandField<12, 4>(p), ExpandField<8, 4>(p), ExpandField<4, 4>(p), ExpandField<0, 4>(p));
+    }
+};
+
+struct RGBA4ToBGRA8
+{
+    LOAD_AVX2 static void Store(uint8_t *dest, __m256i p)
+    {
+        StorePixels(dest, ExpandField<4, 4>(p), ExpandField<8, 4>(p), ExpandField<12, 4>(p), ExpandField<0, 4>(p));
+    }
+};
+
+struct RGB5A1ToRGBA8
+{
+    LOAD_AVX2 static void Store(uint8_t *dest, __m256i p)
+    {
+        StorePixels(dest, ExpandField<11, 5>(p), ExpandField<6, 5>(p), ExpandField<1, 5>(p), ExpandBit<0>(p));
+    }
+};
+
+struct RGB5A1ToBGRA8
+{
+    LOAD_AVX2 static void Store(uint8_t *dest, __m256i p)
+    {
+        StorePixels(dest, ExpandField<1, 5>(p), ExpandField<6, 5>(p), ExpandField<11, 5>(p), ExpandBit<0>(p));
+    }
+};
+
+struct R5G6B5ToRGBA8
+{
+    LOAD_AVX2 static void Store(uint8_t *dest, __m256i p)
+    {
+        StorePixels(dest, ExpandField<11, 5>(p), ExpandField<5, 6>(p), ExpandField<0, 5>(p), _mm256_set1_epi16(0xFF));
+    }
+};
+
+struct R5G6B5ToBGRA8
+{
+    LOAD_AVX2 static void Store(uint8_t *dest, __m256i p)
+    {
+        StorePixels(dest, ExpandField<0, 5>(p), ExpandField<5, 6>(p), ExpandField<11, 5>(p), _mm256_set1_epi16(0xFF));
+    }
+};
+
+template <typename Format>
+LOAD_AVX2 size_t LoadPacked16Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + x * 2));
+        Format::Store(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+LOAD_AVX2 size_t LoadLA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 0, 0, 1, 4, 4, 4, 5,
+                                                                      8, 8, 8, 9, 12, 12, 12, 13));
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i *in = reinterpret_cast<const __m128i*>(source + x * 2);
+        __m256i *out = reinterpret_cast<__m256i*>(dest + x * 4);
+
+        __m256i first = _mm256_cvtepu16_epi32(_mm_loadu_si128(in + 0));
+        __m256i second = _mm256_cvtepu16_epi32(_mm_loadu_si128(in + 1));
+        _mm256_storeu_si256(out + 0, _mm256_shuffle_epi8(first, shuffle));
+        _mm256_storeu_si256(out + 1, _mm256_shuffle_epi8(second, shuffle));
+    }
+    return x;
+}
+
+// Converts eight 3-byte pixels to 4-byte pixels at a time. The low lane is
+// loaded from the first byte and the high lane from the eighth, so that
+// neither load reads past the pixels converted, and |shuffle| picks the
+// first four pixels of the low lane and the last four of the high lane.
+LOAD_AVX2 inline size_t LoadRGB8Row(const uint8_t *source, uint8_t *dest, size_t width, const __m256i &shuffle)
+{
+    const __m256i opaque = _mm256_set1_epi32(0xFF000000);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        const uint8_t *in = source + x * 3;
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+        __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        __m256i result = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), opaque);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + x * 4), result);
+    }
+    return x;
+}
+
+LOAD_AVX2 size_t LoadRGB8ToBGRX8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                             6, 5, 4, -1, 9, 8, 7, -1, 12, 11, 10, -1, 15, 14, 13, -1);
+    return LoadRGB8Row(source, dest, width, shuffle);
+}
+
+LOAD_AVX2 size_t LoadRGB8ToRGBA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    return LoadRGB8Row(source, dest, width, shuffle);
+}
+
+LOAD_AVX2 size_t LoadRGBA8ToBGRA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                                                      10, 9, 8, 11, 14, 13, 12, 15));
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m256i *in = reinterpret_cast<const __m256i*>(source + x * 4);
+        __m256i *out = reinterpret_cast<__m256i*>(dest + x * 4);
+
+        _mm256_storeu_si256(out + 0, _mm256_shuffle_epi8(_mm256_loadu_si256(in + 0), shuffle));
+        _mm256_storeu_si256(out + 1, _mm256_shuffle_epi8(_mm256_loadu_si256(in + 1), shuffle));
+    }
+    return x;
+}
+
+}
+
+void LoadLA8ToRGBA8_AVX2(size_t width, size_t height, size_t depth,
+                         const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                         uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadLA8Row, LoadLA8ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB8ToBGRX8_AVX2(size_t width, size_t height, size_t depth,
+                          const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                          uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<3, 4>(LoadRGB8ToBGRX8Row, LoadRGB8ToBGRX8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB8ToRGBA8_AVX2(size_t width, size_t height, size_t depth,
+                          const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                          uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<3, 4>(LoadRGB8ToRGBA8Row, LoadToNative3To4<GLubyte, 0xFF>, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA8ToBGRA8_AVX2(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 4>(LoadRGBA8ToBGRA8Row, LoadRGBA8ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA4ToRGBA8_AVX2(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGBA4ToRGBA8>, LoadRGBA4ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA4ToBGRA8_AVX2(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGBA4ToBGRA8>, LoadRGBA4ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB5A1ToRGBA8_AVX2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGB5A1ToRGBA8>, LoadRGB5A1ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB5A1ToBGRA8_AVX2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGB5A1ToBGRA8>, LoadRGB5A1ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadR5G6B5ToRGBA8_AVX2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<R5G6B5ToRGBA8>, LoadR5G6B5ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadR5G6B5ToBGRA8_AVX2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<R5G6B5ToBGRA8>, LoadR5G6B5ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+}
+
+#endif // defined(ANGLE_LOAD_IMAGE_X86)
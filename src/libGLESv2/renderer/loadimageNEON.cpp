@@ -0,0 +1,435 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// loadimageNEON.cpp: Defines the NEON variants of the image loading
+// functions. The interleaving loads and stores of NEON split and join the
+// channels of whole pixels, so most variants only move registers around.
+
+#include "libGLESv2/renderer/loadimage.h"
+
+#if defined(ANGLE_LOAD_IMAGE_NEON)
+
+#include <arm_neon.h>
+
+namespace rx
+{
+
+namespace
+{
+
+// Expands the |bits| wide field at |shift| of eight 16-bit pixels to eight
+// bits, by repeating its high bits below it.
+template <int shift, int bits>
+inline uint8x8_t ExpandField(uint16x8_t pixels)
+{
+    uint16x8_t field = vandq_u16(vshlq_u16(pixels, vdupq_n_s16(-shift)), vdupq_n_u16((1 << bits) - 1));
+    uint16x8_t expanded = vorrq_u16(vshlq_u16(field, vdupq_n_s16(8 - bits)), vshlq_u16(field, vdupq_n_s16(8 - 2 * bits)));
+    return vmovn_u16(expanded);
+}
+
+// Expands the bit at |shift| of eight 16-bit pixels to 0x00 or 0xFF.
+template <int shift>
+inline uint8x8_t ExpandBit(uint16x8_t pixels)
+{
+    uint16x8_t bit = vandq_u16(vshlq_u16(pixels, vdupq_n_s16(-shift)), vdupq_n_u16(1));
+    return vmovn_u16(vmulq_n_u16(bit, 0xFF));
+}
+
+struct RGBA4ToRGBA8
+{
+    static uint8x8x4_t Expand(uint16x8_t p)
+    {
+        uint8x8x4_t c = { { ExpandField<12, 4>(p), ExpandField<8, 4>(p), ExpandField<4, 4>(p), ExpandField<0, 4>(p) } };
+        return c;
+    }
+};
+
+struct RGBA4ToBGRA8
+{
+    static uint8x8x4_t Expand(uint16x8_t p)
+    {
+        uint8x8x4_t c = { { ExpandField<4, 4>(p), ExpandField<8, 4>(p), ExpandField<12, 4>(p), ExpandField<0, 4>(p) } };
+        return c;
+    }
+};
+
+struct RGB5A1ToRGBA8
+{
+    static uint8x8x4_t Expand(uint16x8_t p)
+    {
+        uint8x8x4_t c = { { ExpandField<11, 5>(p), ExpandField<6, 5>(p), ExpandField<1, 5>(p), ExpandBit<0>(p) } };
+        return c;
+    }
+};
+
+struct RGB5A1ToBGRA8
+{
+    static uint8x8x4_t Expand(uint16x8_t p)
+    {
+        uint8x8x4_t c = { { ExpandField<1, 5>(p), ExpandField<6, 5>(p), ExpandField<11, 5>(p), ExpandBit<0>(p) } };
+        return c;
+    }
+};
+
+struct R5G6B5ToRGBA8
+{
+    static uint8x8x4_t Expand(uint16x8_t p)
+    {
+        uint8x8x4_t c = { { ExpandField<11, 5>(p), ExpandField<5, 6>(p), ExpandField<0, 5>(p), vdup_n_u8(0xFF) } };
+        return c;
+    }
+};
+
+struct R5G6B5ToBGRA8
+{
+    static uint8x8x4_t Expand(uint16x8_t p)
+    {
+        uint8x8x4_t c = { { ExpandField<0, 5>(p), ExpandField<5, 6>(p), ExpandField<11, 5>(p), vdup_n_u8(0xFF) } };
+        return c;
+    }
+};
+
+template <typename Format>
+size_t LoadPacked16Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        uint16x8_t pixels = vld1q_u16(reinterpret_cast<const uint16_t*>(source + x * 2));
+        vst4_u8(dest + x * 4, Format::Expand(pixels));
+    }
+    return x;
+}
+
+size_t LoadA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint8x16x4_t pixels;
+    pixels.val[0] = vdupq_n_u8(0);
+    pixels.val[1] = pixels.val[0];
+    pixels.val[2] = pixels.val[0];
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        pixels.val[3] = vld1q_u8(source + x);
+        vst4q_u8(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+size_t LoadL8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint8x16x4_t pixels;
+    pixels.val[3] = vdupq_n_u8(0xFF);
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        pixels.val[0] = vld1q_u8(source + x);
+        pixels.val[1] = pixels.val[0];
+        pixels.val[2] = pixels.val[0];
+        vst4q_u8(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+size_t LoadLA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x2_t la = vld2q_u8(source + x * 2);
+        uint8x16x4_t pixels = { { la.val[0], la.val[0], la.val[0], la.val[1] } };
+        vst4q_u8(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+size_t LoadRGB8ToBGRX8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint8x16x4_t pixels;
+    pixels.val[3] = vdupq_n_u8(0xFF);
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t rgb = vld3q_u8(source + x * 3);
+        pixels.val[0] = rgb.val[2];
+        pixels.val[1] = rgb.val[1];
+        pixels.val[2] = rgb.val[0];
+        vst4q_u8(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+size_t LoadRGB8ToRGBA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint8x16x4_t pixels;
+    pixels.val[3] = vdupq_n_u8(0xFF);
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t rgb = vld3q_u8(source + x * 3);
+        pixels.val[0] = rgb.val[0];
+        pixels.val[1] = rgb.val[1];
+        pixels.val[2] = rgb.val[2];
+        vst4q_u8(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+size_t LoadRGBA8ToBGRA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x4_t pixels = vld4q_u8(source + x * 4);
+        uint8x16_t r = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = r;
+        vst4q_u8(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+size_t LoadA32FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint32x4x4_t pixels;
+    pixels.val[0] = vdupq_n_u32(0);
+    pixels.val[1] = pixels.val[0];
+    pixels.val[2] = pixels.val[0];
+
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        pixels.val[3] = vld1q_u32(reinterpret_cast<const uint32_t*>(source + x * 4));
+        vst4q_u32(reinterpret_cast<uint32_t*>(dest + x * 16), pixels);
+    }
+    return x;
+}
+
+size_t LoadL32FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint32x4x4_t pixels;
+    pixels.val[3] = vdupq_n_u32(gl::Float32One);
+
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        pixels.val[0] = vld1q_u32(reinterpret_cast<const uint32_t*>(source + x * 4));
+        pixels.val[1] = pixels.val[0];
+        pixels.val[2] = pixels.val[0];
+        vst4q_u32(reinterpret_cast<uint32_t*>(dest + x * 16), pixels);
+    }
+    return x;
+}
+
+size_t LoadLA32FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        uint32x4x2_t la = vld2q_u32(reinterpret_cast<const uint32_t*>(source + x * 8));
+        uint32x4x4_t pixels = { { la.val[0], la.val[0], la.val[0], la.val[1] } };
+        vst4q_u32(reinterpret_cast<uint32_t*>(dest + x * 16), pixels);
+    }
+    return x;
+}
+
+size_t LoadA16FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint16x8x4_t pixels;
+    pixels.val[0] = vdupq_n_u16(0);
+    pixels.val[1] = pixels.val[0];
+    pixels.val[2] = pixels.val[0];
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        pixels.val[3] = vld1q_u16(reinterpret_cast<const uint16_t*>(source + x * 2));
+        vst4q_u16(reinterpret_cast<uint16_t*>(dest + x * 8), pixels);
+    }
+    return x;
+}
+
+size_t LoadL16FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    uint16x8x4_t pixels;
+    pixels.val[3] = vdupq_n_u16(gl::Float16One);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        pixels.val[0] = vld1q_u16(reinterpret_cast<const uint16_t*>(source + x * 2));
+        pixels.val[1] = pixels.val[0];
+        pixels.val[2] = pixels.val[0];
+        vst4q_u16(reinterpret_cast<uint16_t*>(dest + x * 8), pixels);
+    }
+    return x;
+}
+
+size_t LoadLA16FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        uint16x8x2_t la = vld2q_u16(reinterpret_cast<const uint16_t*>(source + x * 4));
+        uint16x8x4_t pixels = { { la.val[0], la.val[0], la.val[0], la.val[1] } };
+        vst4q_u16(reinterpret_cast<uint16_t*>(dest + x * 8), pixels);
+    }
+    return x;
+}
+
+}
+
+void LoadA8ToBGRA8_NEON(size_t width, size_t height, size_t depth,
+                        const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                        uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<1, 4>(LoadA8Row, LoadA8ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadL8ToRGBA8_NEON(size_t width, size_t height, size_t depth,
+                        const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                        uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<1, 4>(LoadL8Row, LoadL8ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadLA8ToRGBA8_NEON(size_t width, size_t height, size_t depth,
+                         const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                         uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadLA8Row, LoadLA8ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB8ToBGRX8_NEON(size_t width, size_t height, size_t depth,
+                          const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                          uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<3, 4>(LoadRGB8ToBGRX8Row, LoadRGB8ToBGRX8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB8ToRGBA8_NEON(size_t width, size_t height, size_t depth,
+                          const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                          uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<3, 4>(LoadRGB8ToRGBA8Row, LoadToNative3To4<GLubyte, 0xFF>, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA8ToBGRA8_NEON(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 4>(LoadRGBA8ToBGRA8Row, LoadRGBA8ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA4ToRGBA8_NEON(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGBA4ToRGBA8>, LoadRGBA4ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA4ToBGRA8_NEON(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGBA4ToBGRA8>, LoadRGBA4ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB5A1ToRGBA8_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGB5A1ToRGBA8>, LoadRGB5A1ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB5A1ToBGRA8_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGB5A1ToBGRA8>, LoadRGB5A1ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadR5G6B5ToRGBA8_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<R5G6B5ToRGBA8>, LoadR5G6B5ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadR5G6B5ToBGRA8_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<R5G6B5ToBGRA8>, LoadR5G6B5ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadA32FToRGBA32F_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 16>(LoadA32FRow, LoadA32FToRGBA32F, width, height, depth,
+                    input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadL32FToRGBA32F_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 16>(LoadL32FRow, LoadL32FToRGBA32F, width, height, depth,
+                    input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadLA32FToRGBA32F_NEON(size_t width, size_t height, size_t depth,
+                             const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                             uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<8, 16>(LoadLA32FRow, LoadLA32FToRGBA32F, width, height, depth,
+                    input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadA16FToRGBA16F_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 8>(LoadA16FRow, LoadA16FToRGBA16F, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadL16FToRGBA16F_NEON(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 8>(LoadL16FRow, LoadL16FToRGBA16F, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadLA16FToRGBA16F_NEON(size_t width, size_t height, size_t depth,
+                             const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                             uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 8>(LoadLA16FRow, LoadLA16FToRGBA16F, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+}
+
+#endif // defined(ANGLE_LOAD_IMAGE_NEON)
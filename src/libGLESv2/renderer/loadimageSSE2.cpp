@@ -10,19 +10,270 @@
 
 #include "libGLESv2/renderer/loadimage.h"
 
+#if defined(ANGLE_LOAD_IMAGE_X86)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
 namespace rx
 {
 
+namespace
+{
+
+// Expands the |bits| wide field at |shift| of eight 16-bit pixels to eight
+// bits, by repeating its high bits below it.
+template <int shift, int bits>
+inline __m128i ExpandField(__m128i pixels)
+{
+    __m128i field = _mm_and_si128(_mm_srli_epi16(pixels, shift), _mm_set1_epi16((1 << bits) - 1));
+    return _mm_or_si128(_mm_slli_epi16(field, 8 - bits), _mm_srli_epi16(field, 2 * bits - 8));
+}
+
+// Expands the bit at |shift| of eight 16-bit pixels to 0x00 or 0xFF.
+template <int shift>
+inline __m128i ExpandBit(__m128i pixels)
+{
+    __m128i bit = _mm_and_si128(_mm_srli_epi16(pixels, shift), _mm_set1_epi16(1));
+    return _mm_sub_epi16(_mm_slli_epi16(bit, 8), bit);
+}
+
+// Writes eight 4-byte pixels whose channels are in the low bytes of the
+// 16-bit lanes of |c0| to |c3|.
+inline void StorePixels(uint8_t *dest, const __m128i &c0, const __m128i &c1, const __m128i &c2, const __m128i &c3)
+{
+    __m128i c01 = _mm_or_si128(c0, _mm_slli_epi16(c1, 8));
+    __m128i c23 = _mm_or_si128(c2, _mm_slli_epi16(c3, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi16(c01, c23));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 16), _mm_unpackhi_epi16(c01, c23));
+}
+
+struct RGBA4ToRGBA8
+{
+    static void Store(uint8_t *dest, __m128i p)
+    {
+        StorePixels(dest, ExpandField<12, 4>(p), ExpandField<8, 4>(p), ExpandField<4, 4>(p), ExpandField<0, 4>(p));
+    }
+};
+
+struct RGBA4ToBGRA8
+{
+    static void Store(uint8_t *dest, __m128i p)
+    {
+        StorePixels(dest, ExpandField<4, 4>(p), ExpandField<8, 4>(p), ExpandField<12, 4>(p), ExpandField<0, 4>(p));
+    }
+};
+
+struct RGB5A1ToRGBA8
+{
+    static void Store(uint8_t *dest, __m128i p)
+    {
+        StorePixels(dest, ExpandField<11, 5>(p), ExpandField<6, 5>(p), ExpandField<1, 5>(p), ExpandBit<0>(p));
+    }
+};
+
+struct RGB5A1ToBGRA8
+{
+    static void Store(uint8_t *dest, __m128i p)
+    {
+        StorePixels(dest, ExpandField<1, 5>(p), ExpandField<6, 5>(p), ExpandField<11, 5>(p), ExpandBit<0>(p));
+    }
+};
+
+struct R5G6B5ToRGBA8
+{
+    static void Store(uint8_t *dest, __m128i p)
+    {
+        StorePixels(dest, ExpandField<11, 5>(p), ExpandField<5, 6>(p), ExpandField<0, 5>(p), _mm_set1_epi16(0xFF));
+    }
+};
+
+struct R5G6B5ToBGRA8
+{
+    static void Store(uint8_t *dest, __m128i p)
+    {
+        StorePixels(dest, ExpandField<0, 5>(p), ExpandField<5, 6>(p), ExpandField<11, 5>(p), _mm_set1_epi16(0xFF));
+    }
+};
+
+template <typename Format>
+size_t LoadPacked16Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 2));
+        Format::Store(dest + x * 4, pixels);
+    }
+    return x;
+}
+
+size_t LoadL8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m128i opaque = _mm_set1_epi8(-1);
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 4);
+
+        // Pair each l with itself and with 0xFF, then interleave the pairs
+        __m128i ll = _mm_unpacklo_epi8(l, l);
+        __m128i la = _mm_unpacklo_epi8(l, opaque);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(ll, la));
+
+        ll = _mm_unpackhi_epi8(l, l);
+        la = _mm_unpackhi_epi8(l, opaque);
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(ll, la));
+    }
+    return x;
+}
+
+size_t LoadLA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i la = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 2));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 4);
+
+        __m128i l = _mm_and_si128(la, lowBytes);
+        __m128i ll = _mm_or_si128(l, _mm_slli_epi16(l, 8));
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(ll, la));
+    }
+    return x;
+}
+
+size_t LoadA32FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 16);
+
+        __m128i lo = _mm_unpacklo_epi32(zero, a);
+        __m128i hi = _mm_unpackhi_epi32(zero, a);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi64(zero, lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi64(zero, lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi64(zero, hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi64(zero, hi));
+    }
+    return x;
+}
+
+size_t LoadL32FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m128i rgbMask = _mm_set_epi32(0, -1, -1, -1);
+    const __m128i alpha = _mm_set_epi32(gl::Float32One, 0, 0, 0);
+
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 16);
+
+        _mm_storeu_si128(out + 0, _mm_or_si128(_mm_and_si128(_mm_shuffle_epi32(l, _MM_SHUFFLE(0, 0, 0, 0)), rgbMask), alpha));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_and_si128(_mm_shuffle_epi32(l, _MM_SHUFFLE(1, 1, 1, 1)), rgbMask), alpha));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_and_si128(_mm_shuffle_epi32(l, _MM_SHUFFLE(2, 2, 2, 2)), rgbMask), alpha));
+        _mm_storeu_si128(out + 3, _mm_or_si128(_mm_and_si128(_mm_shuffle_epi32(l, _MM_SHUFFLE(3, 3, 3, 3)), rgbMask), alpha));
+    }
+    return x;
+}
+
+size_t LoadLA32FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 2 <= width; x += 2)
+    {
+        __m128i la = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 8));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 16);
+
+        _mm_storeu_si128(out + 0, _mm_shuffle_epi32(la, _MM_SHUFFLE(1, 0, 0, 0)));
+        _mm_storeu_si128(out + 1, _mm_shuffle_epi32(la, _MM_SHUFFLE(3, 2, 2, 2)));
+    }
+    return x;
+}
+
+size_t LoadA16FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 2));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 8);
+
+        __m128i lo = _mm_unpacklo_epi16(zero, a);
+        __m128i hi = _mm_unpackhi_epi16(zero, a);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi32(zero, lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi32(zero, lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi32(zero, hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi32(zero, hi));
+    }
+    return x;
+}
+
+size_t LoadL16FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m128i one = _mm_set1_epi16(gl::Float16One);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 2));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 8);
+
+        __m128i ll = _mm_unpacklo_epi16(l, l);
+        __m128i la = _mm_unpacklo_epi16(l, one);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi32(ll, la));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi32(ll, la));
+
+        ll = _mm_unpackhi_epi16(l, l);
+        la = _mm_unpackhi_epi16(l, one);
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi32(ll, la));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi32(ll, la));
+    }
+    return x;
+}
+
+size_t LoadLA16FRow(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    size_t x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i la = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 8);
+
+        __m128i first = _mm_shufflelo_epi16(la, _MM_SHUFFLE(1, 0, 0, 0));
+        __m128i second = _mm_shufflelo_epi16(la, _MM_SHUFFLE(3, 2, 2, 2));
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi64(first, second));
+
+        first = _mm_shufflehi_epi16(la, _MM_SHUFFLE(1, 0, 0, 0));
+        second = _mm_shufflehi_epi16(la, _MM_SHUFFLE(3, 2, 2, 2));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi64(first, second));
+    }
+    return x;
+}
+
+}
+
 void LoadA8ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
                         const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
                         uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
 {
-#if defined(_M_ARM)
-    // Ensure that this function is reported as not implemented for ARM builds because
-    // the instructions below are not present for that architecture.
-    UNIMPLEMENTED();
-    return;
-#else
     __m128i zeroWide = _mm_setzero_si128();
 
     for (size_t z = 0; z < depth; z++)
@@ -60,19 +311,28 @@ void LoadA8ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
             }
         }
     }
-#endif
+}
+
+void LoadL8ToRGBA8_SSE2(size_t width, size_t height, size_t depth,
+                        const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                        uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<1, 4>(LoadL8Row, LoadL8ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadLA8ToRGBA8_SSE2(size_t width, size_t height, size_t depth,
+                         const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                         uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadLA8Row, LoadLA8ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
 }
 
 void LoadRGBA8ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
 {
-#if defined(_M_ARM)
-    // Ensure that this function is reported as not implemented for ARM builds because
-    // the instructions below are not present for that architecture.
-    UNIMPLEMENTED();
-    return;
-#else
     __m128i brMask = _mm_set1_epi32(0x00ff00ff);
 
     for (size_t z = 0; z < depth; z++)
@@ -88,7 +348,7 @@ void LoadRGBA8ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
             for (; ((reinterpret_cast<intptr_t>(&dest[x]) & 15) != 0) && x < width; x++)
             {
                 uint32_t rgba = source[x];
-                dest[x] = (_rotl(rgba, 16) & 0x00ff00ff) | (rgba & 0xff00ff00);
+                dest[x] = (gl::rotl(rgba, 16) & 0x00ff00ff) | (rgba & 0xff00ff00);
             }
 
             for (; x + 3 < width; x += 4)
@@ -108,11 +368,108 @@ void LoadRGBA8ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
             for (; x < width; x++)
             {
                 uint32_t rgba = source[x];
-                dest[x] = (_rotl(rgba, 16) & 0x00ff00ff) | (rgba & 0xff00ff00);
+                dest[x] = (gl::rotl(rgba, 16) & 0x00ff00ff) | (rgba & 0xff00ff00);
             }
         }
     }
-#endif
 }
 
+void LoadRGBA4ToRGBA8_SSE2(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGBA4ToRGBA8>, LoadRGBA4ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA4ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGBA4ToBGRA8>, LoadRGBA4ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB5A1ToRGBA8_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGB5A1ToRGBA8>, LoadRGB5A1ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB5A1ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<RGB5A1ToBGRA8>, LoadRGB5A1ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadR5G6B5ToRGBA8_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<R5G6B5ToRGBA8>, LoadR5G6B5ToRGBA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadR5G6B5ToBGRA8_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 4>(LoadPacked16Row<R5G6B5ToBGRA8>, LoadR5G6B5ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
 }
+
+void LoadA32FToRGBA32F_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 16>(LoadA32FRow, LoadA32FToRGBA32F, width, height, depth,
+                    input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadL32FToRGBA32F_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 16>(LoadL32FRow, LoadL32FToRGBA32F, width, height, depth,
+                    input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadLA32FToRGBA32F_SSE2(size_t width, size_t height, size_t depth,
+                             const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                             uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<8, 16>(LoadLA32FRow, LoadLA32FToRGBA32F, width, height, depth,
+                    input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadA16FToRGBA16F_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 8>(LoadA16FRow, LoadA16FToRGBA16F, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadL16FToRGBA16F_SSE2(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<2, 8>(LoadL16FRow, LoadL16FToRGBA16F, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadLA16FToRGBA16F_SSE2(size_t width, size_t height, size_t depth,
+                             const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                             uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 8>(LoadLA16FRow, LoadLA16FToRGBA16F, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+}
+
+#endif // defined(ANGLE_LOAD_IMAGE_X86)
@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// loadimageSSSE3.cpp: Defines the SSSE3 variants of the image loading
+// functions that reorder bytes, which PSHUFB does in one instruction.
+
+#include "libGLESv2/renderer/loadimage.h"
+
+#if defined(ANGLE_LOAD_IMAGE_X86)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// GCC and clang only allow SSSE3 instructions in functions compiled for it.
+// These functions are only called once the CPU is known to support it.
+#if defined(__GNUC__)
+#define LOAD_SSSE3 __attribute__((target("ssse3")))
+#else
+#define LOAD_SSSE3
+#endif
+
+namespace rx
+{
+
+namespace
+{
+
+// Converts sixteen 3-byte pixels to 4-byte pixels at a time, with |shuffle|
+// reordering each group of four.
+LOAD_SSSE3 inline size_t LoadRGB8Row(const uint8_t *source, uint8_t *dest, size_t width, const __m128i &shuffle)
+{
+    const __m128i opaque = _mm_set1_epi32(0xFF000000);
+
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i *in = reinterpret_cast<const __m128i*>(source + x * 3);
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 4);
+
+        __m128i a = _mm_loadu_si128(in + 0);
+        __m128i b = _mm_loadu_si128(in + 1);
+        __m128i c = _mm_loadu_si128(in + 2);
+
+        // Bring each group of four pixels, 12 bytes, to the bottom of a register
+        _mm_storeu_si128(out + 0, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), opaque));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), opaque));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), opaque));
+        _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), opaque));
+    }
+    return x;
+}
+
+LOAD_SSSE3 size_t LoadRGB8ToBGRX8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    return LoadRGB8Row(source, dest, width, _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+}
+
+LOAD_SSSE3 size_t LoadRGB8ToRGBA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    return LoadRGB8Row(source, dest, width, _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+}
+
+LOAD_SSSE3 size_t LoadRGBA8ToBGRA8Row(const uint8_t *source, uint8_t *dest, size_t width)
+{
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        const __m128i *in = reinterpret_cast<const __m128i*>(source + x * 4);
+        __m128i *out = reinterpret_cast<__m128i*>(dest + x * 4);
+
+        _mm_storeu_si128(out + 0, _mm_shuffle_epi8(_mm_loadu_si128(in + 0), shuffle));
+        _mm_storeu_si128(out + 1, _mm_shuffle_epi8(_mm_loadu_si128(in + 1), shuffle));
+    }
+    return x;
+}
+
+}
+
+void LoadRGB8ToBGRX8_SSSE3(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<3, 4>(LoadRGB8ToBGRX8Row, LoadRGB8ToBGRX8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGB8ToRGBA8_SSSE3(size_t width, size_t height, size_t depth,
+                           const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                           uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<3, 4>(LoadRGB8ToRGBA8Row, LoadToNative3To4<GLubyte, 0xFF>, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadRGBA8ToBGRA8_SSSE3(size_t width, size_t height, size_t depth,
+                            const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                            uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    LoadRows<4, 4>(LoadRGBA8ToBGRA8Row, LoadRGBA8ToBGRA8, width, height, depth,
+                   input, inputRowPitch, inputDepthPitch, output, outputRowPitch, outputDepthPitch);
+}
+
+}
+
+#endif // defined(ANGLE_LOAD_IMAGE_X86)
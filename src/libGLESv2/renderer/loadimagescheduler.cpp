@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// loadimagescheduler.cpp: Splits large texture uploads into bands of rows or
+// slices and converts the bands on a shared pool of worker threads.
+
+#include "libGLESv2/renderer/loadimagescheduler.h"
+
+#include "common/workerpool.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace rx
+{
+
+namespace
+{
+
+// Guards the settings and the pool, and is held while a load runs on the
+// pool so that it cannot be replaced underneath it.
+Mutex gLoadWorkerPoolMutex;
+
+// Created by the first parallel load, and again when the thread count
+// changes. It lives for the rest of the process once created: joining its
+// threads while the library unloads is not safe on every platform.
+WorkerPool *gLoadWorkerPool = NULL;
+
+size_t gLoadThreadCount = 0;
+
+class LoadImageTask : public WorkerTask
+{
+  public:
+    LoadImageTask(LoadImageFunction loadFunction,
+                  size_t width, size_t height, size_t depth,
+                  const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                  uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+        : mLoadFunction(loadFunction),
+          mWidth(width),
+          mHeight(height),
+          mDepth(depth),
+          mInput(input),
+          mInputRowPitch(inputRowPitch),
+          mInputDepthPitch(inputDepthPitch),
+          mOutput(output),
+          mOutputRowPitch(outputRowPitch),
+          mOutputDepthPitch(outputDepthPitch)
+    {
+    }
+
+    virtual void run()
+    {
+        mLoadFunction(mWidth, mHeight, mDepth,
+                      mInput, mInputRowPitch, mInputDepthPitch,
+                      mOutput, mOutputRowPitch, mOutputDepthPitch);
+    }
+
+  private:
+    LoadImageFunction mLoadFunction;
+    size_t mWidth;
+    size_t mHeight;
+    size_t mDepth;
+    const uint8_t *mInput;
+    size_t mInputRowPitch;
+    size_t mInputDepthPitch;
+    uint8_t *mOutput;
+    size_t mOutputRowPitch;
+    size_t mOutputDepthPitch;
+};
+
+}
+
+void SetLoadImageThreadCount(size_t threadCount)
+{
+    ScopedLock lock(&gLoadWorkerPoolMutex);
+
+    if (gLoadWorkerPool && gLoadWorkerPool->getThreadCount() != threadCount)
+    {
+        delete gLoadWorkerPool;
+        gLoadWorkerPool = NULL;
+    }
+
+    gLoadThreadCount = threadCount;
+}
+
+size_t GetLoadImageThreadCount()
+{
+    ScopedLock lock(&gLoadWorkerPoolMutex);
+    return gLoadThreadCount;
+}
+
+void ScheduleLoadImage(LoadImageFunction loadFunction,
+                       size_t width, size_t height, size_t depth,
+                       const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                       uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    // Waiting for another upload to leave the pool would take longer than
+    // converting this one alone, so only a free pool is used.
+    if (width * height * depth >= kMinParallelLoadPixels && gLoadWorkerPoolMutex.tryLock())
+    {
+        bool loaded = false;
+        if (gLoadThreadCount > 0)
+        {
+            if (!gLoadWorkerPool)
+            {
+                gLoadWorkerPool = new WorkerPool(gLoadThreadCount);
+            }
+
+            LoadImageInBands(gLoadWorkerPool, loadFunction, width, height, depth,
+                             input, inputRowPitch, inputDepthPitch,
+                             output, outputRowPitch, outputDepthPitch);
+            loaded = true;
+        }
+        gLoadWorkerPoolMutex.unlock();
+
+        if (loaded)
+        {
+            return;
+        }
+    }
+
+    loadFunction(width, height, depth,
+                 input, inputRowPitch, inputDepthPitch,
+                 output, outputRowPitch, outputDepthPitch);
+}
+
+void LoadImageInBands(WorkerPool *pool, LoadImageFunction loadFunction,
+                      size_t width, size_t height, size_t depth,
+                      const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                      uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch)
+{
+    size_t bandCount = pool->getThreadCount() + 1;
+
+    // Split the slices if there are enough of them, otherwise split the rows
+    // and convert the same rows of every slice in a band.
+    bool sliceBands = (depth >= bandCount);
+    size_t extent = sliceBands ? depth : height;
+    bandCount = std::min(bandCount, extent);
+
+    if (bandCount <= 1)
+    {
+        loadFunction(width, height, depth,
+                     input, inputRowPitch, inputDepthPitch,
+                     output, outputRowPitch, outputDepthPitch);
+        return;
+    }
+
+    size_t inputBandPitch = sliceBands ? inputDepthPitch : inputRowPitch;
+    size_t outputBandPitch = sliceBands ? outputDepthPitch : outputRowPitch;
+
+    std::vector<LoadImageTask> tasks;
+    tasks.reserve(bandCount);
+    for (size_t band = 0; band < bandCount; band++)
+    {
+        // The first (extent % bandCount) bands are one larger than the rest.
+        size_t start = band * (extent / bandCount) + std::min(band, extent % bandCount);
+        size_t size = extent / bandCount + (band < extent % bandCount ? 1 : 0);
+
+        tasks.push_back(LoadImageTask(loadFunction,
+                                      width, sliceBands ? height : size, sliceBands ? size : depth,
+                                      input + start * inputBandPitch, inputRowPitch, inputDepthPitch,
+                                      output + start * outputBandPitch, outputRowPitch, outputDepthPitch));
+    }
+
+    std::vector<WorkerTask*> taskPointers(bandCount);
+    for (size_t band = 0; band < bandCount; band++)
+    {
+        taskPointers[band] = &tasks[band];
+    }
+
+    pool->runTasks(&taskPointers[0], bandCount);
+}
+
+}
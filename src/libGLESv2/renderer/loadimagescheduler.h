@@ -0,0 +1,54 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+// loadimagescheduler.h: Splits large texture uploads into bands of rows or
+// slices and converts the bands on a shared pool of worker threads.
+
+#ifndef LIBGLESV2_RENDERER_LOADIMAGESCHEDULER_H_
+#define LIBGLESV2_RENDERER_LOADIMAGESCHEDULER_H_
+
+#include "libGLESv2/formatutils.h"
+
+#include <cstdint>
+
+class WorkerPool;
+
+namespace rx
+{
+
+// Regions with fewer pixels than this are converted on the calling thread;
+// below it, waking the workers costs more than they save.
+const size_t kMinParallelLoadPixels = 256 * 256;
+
+// Sets the number of worker threads that convert uploads alongside the
+// calling thread. With 0, every upload is converted by a single call to its
+// load function on the calling thread. Defaults to 0, so the workers are only
+// started for embedders that ask for them.
+void SetLoadImageThreadCount(size_t threadCount);
+size_t GetLoadImageThreadCount();
+
+// Converts the region with |loadFunction|, like a single call to it does.
+// Regions of at least kMinParallelLoadPixels are split into bands that run
+// on the shared worker pool. While the pool is busy with the upload of
+// another thread, the region is converted on the calling thread instead.
+void ScheduleLoadImage(LoadImageFunction loadFunction,
+                       size_t width, size_t height, size_t depth,
+                       const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                       uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch);
+
+// Converts the region with |loadFunction| in one band for each thread of
+// |pool| and for the calling thread, whatever its size. Regions at least as
+// deep as the band count are split into slices, others into rows that span
+// every slice. The bands do not overlap, so the output is the same as that
+// of a single call.
+void LoadImageInBands(WorkerPool *pool, LoadImageFunction loadFunction,
+                      size_t width, size_t height, size_t depth,
+                      const uint8_t *input, size_t inputRowPitch, size_t inputDepthPitch,
+                      uint8_t *output, size_t outputRowPitch, size_t outputDepthPitch);
+
+}
+
+#endif // LIBGLESV2_RENDERER_LOADIMAGESCHEDULER_H_
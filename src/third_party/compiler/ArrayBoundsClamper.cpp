@@ -42,8 +42,8 @@ namespace {
 
 class ArrayBoundsClamperMarker : public TIntermTraverser {
 public:
-    ArrayBoundsClamperMarker()
-        : mNeedsClamp(false)
+    ArrayBoundsClamperMarker(bool* needsClamp)
+        : mNeedsClamp(needsClamp)
    {
    }
 
@@ -55,16 +55,14 @@ public:
            if (left->isArray() || left->isVector() || left->isMatrix())
            {
                node->setAddIndexClamp();
-               mNeedsClamp = true;
+               *mNeedsClamp = true;
            }
        }
        return true;
    }
 
-    bool GetNeedsClamp() { return mNeedsClamp; }
-
 private:
-    bool mNeedsClamp;
+    bool* mNeedsClamp;
 };
 
 }  // anonymous namespace
@@ -84,12 +82,13 @@ void ArrayBoundsClamper::MarkIndirectArrayBoundsForClamping(TIntermNode* root)
 {
     ASSERT(root);
 
-    ArrayBoundsClamperMarker clamper;
+    ArrayBoundsClamperMarker clamper(&mArrayBoundsClampDefinitionNeeded);
     root->traverse(&clamper);
-    if (clamper.GetNeedsClamp())
-    {
-        SetArrayBoundsClampDefinitionNeeded();
-    }
+}
+
+TIntermTraverser* ArrayBoundsClamper::CreateClampingMarker()
+{
+    return new ArrayBoundsClamperMarker(&mArrayBoundsClampDefinitionNeeded);
 }
 
 void ArrayBoundsClamper::OutputClampingFunctionDefinition(TInfoSinkBase& out) const
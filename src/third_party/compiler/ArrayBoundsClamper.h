@@ -40,6 +40,10 @@ public:
     // Marks nodes in the tree that index arrays indirectly as
     // requiring clamping.
     void MarkIndirectArrayBoundsForClamping(TIntermNode* root);
+    // Returns a traverser that does the marking of
+    // MarkIndirectArrayBoundsForClamping, to be run together with other
+    // passes. It is allocated from the current pool.
+    TIntermTraverser* CreateClampingMarker();
 
     // If necessary, output array clamp function source into the shader source.
     void OutputClampingFunctionDefinition(TInfoSinkBase& out) const;
@@ -51,7 +55,6 @@ public:
 
 private:
     bool GetArrayBoundsClampDefinitionNeeded() const { return mArrayBoundsClampDefinitionNeeded; }
-    void SetArrayBoundsClampDefinitionNeeded() { mArrayBoundsClampDefinitionNeeded = true; }
 
     ShArrayIndexClampingStrategy mClampingStrategy;
     bool mArrayBoundsClampDefinitionNeeded;
@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// BuiltInSymbolTableCache_test.cpp:
+//   Tests that compilers share the built-in levels of their symbol tables.
+//
+
+#include <vector>
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+#include "compiler/translator/BuiltInSymbolTableCache.h"
+#include "compiler/translator/TranslatorESSL.h"
+
+class BuiltInSymbolTableCacheTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShInitBuiltInResources(&mResources);
+        FreeBuiltInSymbolTableCache();
+    }
+
+    virtual void TearDown()
+    {
+        FreeBuiltInSymbolTableCache();
+    }
+
+    TranslatorESSL *createTranslator(sh::GLenum type, ShShaderSpec spec)
+    {
+        TranslatorESSL *translator = new TranslatorESSL(type, spec);
+        EXPECT_TRUE(translator->Init(mResources));
+        return translator;
+    }
+
+    bool compile(TCompiler *compiler, const std::string &shaderString)
+    {
+        const char *shaderStrings[] = { shaderString.c_str() };
+        return compiler->compile(shaderStrings, 1, SH_OBJECT_CODE);
+    }
+
+    ShBuiltInResources mResources;
+};
+
+// Compilers created with the same type, spec and resources use the same built-ins.
+TEST_F(BuiltInSymbolTableCacheTest, SameResourcesShareBuiltIns)
+{
+    TranslatorESSL *first = createTranslator(GL_FRAGMENT_SHADER, SH_GLES2_SPEC);
+    TranslatorESSL *second = createTranslator(GL_FRAGMENT_SHADER, SH_GLES2_SPEC);
+
+    EXPECT_EQ(1u, GetBuiltInSymbolTableCacheSize());
+    TSymbol *firstSymbol = first->getSymbolTable().findBuiltIn("gl_FragColor", 100);
+    ASSERT_TRUE(firstSymbol != NULL);
+    EXPECT_EQ(firstSymbol, second->getSymbolTable().findBuiltIn("gl_FragColor", 100));
+
+    delete first;
+    delete second;
+}
+
+// Any difference in type, spec or resources gets its own built-ins.
+TEST_F(BuiltInSymbolTableCacheTest, DifferentResourcesDoNotShareBuiltIns)
+{
+    TranslatorESSL *fragment = createTranslator(GL_FRAGMENT_SHADER, SH_GLES2_SPEC);
+    TranslatorESSL *vertex = createTranslator(GL_VERTEX_SHADER, SH_GLES2_SPEC);
+    TranslatorESSL *webgl = createTranslator(GL_FRAGMENT_SHADER, SH_WEBGL_SPEC);
+    mResources.MaxDrawBuffers = 4;
+    TranslatorESSL *drawBuffers = createTranslator(GL_FRAGMENT_SHADER, SH_GLES2_SPEC);
+
+    EXPECT_EQ(4u, GetBuiltInSymbolTableCacheSize());
+
+    TVariable *maxDrawBuffers = static_cast<TVariable *>(
+        fragment->getSymbolTable().findBuiltIn("gl_MaxDrawBuffers", 100));
+    ASSERT_TRUE(maxDrawBuffers != NULL);
+    EXPECT_EQ(1, maxDrawBuffers->getConstPointer()->getIConst());
+
+    maxDrawBuffers = static_cast<TVariable *>(
+        drawBuffers->getSymbolTable().findBuiltIn("gl_MaxDrawBuffers", 100));
+    ASSERT_TRUE(maxDrawBuffers != NULL);
+    EXPECT_EQ(4, maxDrawBuffers->getConstPointer()->getIConst());
+
+    delete fragment;
+    delete vertex;
+    delete webgl;
+    delete drawBuffers;
+}
+
+// Built-ins in use stay valid after the cache drops them, and compiles using
+// them do not affect other compilers.
+TEST_F(BuiltInSymbolTableCacheTest, BuiltInsOutliveCache)
+{
+    const std::string shaderString =
+        "precision mediump float;\n"
+        "uniform vec4 u;\n"
+        "void main() {\n"
+        "   gl_FragColor = normalize(u) * gl_FragCoord;\n"
+        "}\n";
+
+    TranslatorESSL *first = createTranslator(GL_FRAGMENT_SHADER, SH_GLES2_SPEC);
+    TranslatorESSL *second = createTranslator(GL_FRAGMENT_SHADER, SH_GLES2_SPEC);
+    EXPECT_TRUE(compile(first, shaderString));
+
+    FreeBuiltInSymbolTableCache();
+    EXPECT_EQ(0u, GetBuiltInSymbolTableCacheSize());
+    delete first;
+
+    EXPECT_TRUE(compile(second, shaderString));
+    EXPECT_NE(std::string::npos, second->getInfoSink().obj.str().find("normalize"));
+    delete second;
+}
+
+// Compilers constructed while the cache holds their built-ins reuse them
+// instead of building new ones, which they only do once the cache drops them.
+TEST_F(BuiltInSymbolTableCacheTest, WarmCacheDoesNotRebuildBuiltIns)
+{
+    const int kCompilerCount = 10;
+
+    TranslatorESSL *cold = createTranslator(GL_FRAGMENT_SHADER, SH_GLES3_SPEC);
+    TSymbol *fragCoord = cold->getSymbolTable().findBuiltIn("gl_FragCoord", 300);
+    ASSERT_TRUE(fragCoord != NULL);
+
+    std::vector<TranslatorESSL *> compilers;
+    for (int i = 0; i < kCompilerCount; ++i)
+    {
+        TranslatorESSL *warm = createTranslator(GL_FRAGMENT_SHADER, SH_GLES3_SPEC);
+        EXPECT_EQ(fragCoord, warm->getSymbolTable().findBuiltIn("gl_FragCoord", 300));
+        compilers.push_back(warm);
+    }
+    EXPECT_EQ(1u, GetBuiltInSymbolTableCacheSize());
+
+    FreeBuiltInSymbolTableCache();
+    TranslatorESSL *rebuilt = createTranslator(GL_FRAGMENT_SHADER, SH_GLES3_SPEC);
+    EXPECT_NE(fragCoord, rebuilt->getSymbolTable().findBuiltIn("gl_FragCoord", 300));
+
+    delete cold;
+    delete rebuilt;
+    for (size_t i = 0; i < compilers.size(); ++i)
+        delete compilers[i];
+}
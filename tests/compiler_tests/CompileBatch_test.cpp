@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// CompileBatch_test.cpp:
+//   Tests that shaders compiled in parallel by ShCompileBatch produce the
+//   same results as shaders compiled one at a time.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const size_t kNumShaders = 32;
+
+std::string MakeFragmentShader(size_t index)
+{
+    std::ostringstream stream;
+    stream << "precision mediump float;\n"
+              "uniform vec4 u" << index << ";\n"
+              "varying vec2 v;\n"
+              "float f(float x) { return x * " << index << ".0 + sin(x); }\n"
+              "void main() {\n"
+              "    vec4 c = u" << index << ";\n"
+              "    for (int i = 0; i < " << (index % 4 + 1) << "; ++i) {\n"
+              "        c.x += f(v.x);\n"
+              "    }\n";
+    // Every fourth shader has a type error.
+    if (index % 4 == 3)
+    {
+        stream << "    c = 1;\n";
+    }
+    stream << "    gl_FragColor = c;\n"
+              "}\n";
+    return stream.str();
+}
+
+}  // anonymous namespace
+
+class CompileBatchTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShInitBuiltInResources(&mResources);
+
+        for (size_t i = 0; i < kNumShaders; ++i)
+        {
+            mSources.push_back(MakeFragmentShader(i));
+        }
+    }
+
+    virtual void TearDown()
+    {
+        destroyCompilers();
+    }
+
+    void createCompilers()
+    {
+        for (size_t i = 0; i < kNumShaders; ++i)
+        {
+            ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                    SH_GLSL_OUTPUT, &mResources);
+            ASSERT_TRUE(compiler != NULL);
+            mCompilers.push_back(compiler);
+        }
+    }
+
+    void destroyCompilers()
+    {
+        for (size_t i = 0; i < mCompilers.size(); ++i)
+        {
+            ShDestruct(mCompilers[i]);
+        }
+        mCompilers.clear();
+    }
+
+    ShBuiltInResources mResources;
+    std::vector<std::string> mSources;
+    std::vector<ShHandle> mCompilers;
+};
+
+TEST_F(CompileBatchTest, MatchesSerialCompilation)
+{
+    const int compileOptions = SH_OBJECT_CODE | SH_VARIABLES;
+
+    createCompilers();
+    std::vector<bool> serialResults;
+    std::vector<std::string> serialObjectCode;
+    std::vector<std::string> serialInfoLogs;
+    for (size_t i = 0; i < kNumShaders; ++i)
+    {
+        const char *source = mSources[i].c_str();
+        serialResults.push_back(ShCompile(mCompilers[i], &source, 1, compileOptions));
+        serialObjectCode.push_back(ShGetObjectCode(mCompilers[i]));
+        serialInfoLogs.push_back(ShGetInfoLog(mCompilers[i]));
+    }
+    destroyCompilers();
+
+    createCompilers();
+    std::vector<const char*> sources(kNumShaders);
+    std::vector<ShCompileJob> jobs(kNumShaders);
+    for (size_t i = 0; i < kNumShaders; ++i)
+    {
+        sources[i] = mSources[i].c_str();
+        jobs[i].handle = mCompilers[i];
+        jobs[i].shaderStrings = &sources[i];
+        jobs[i].numStrings = 1;
+        jobs[i].compileOptions = compileOptions;
+        jobs[i].result = false;
+    }
+    EXPECT_FALSE(ShCompileBatch(&jobs[0], jobs.size()));
+
+    for (size_t i = 0; i < kNumShaders; ++i)
+    {
+        EXPECT_EQ(i % 4 != 3, jobs[i].result);
+        EXPECT_EQ(serialResults[i], jobs[i].result);
+        EXPECT_EQ(serialObjectCode[i], ShGetObjectCode(mCompilers[i]));
+        EXPECT_EQ(serialInfoLogs[i], ShGetInfoLog(mCompilers[i]));
+        if (jobs[i].result)
+        {
+            ASSERT_TRUE(ShGetUniforms(mCompilers[i]) != NULL);
+            EXPECT_EQ(1u, ShGetUniforms(mCompilers[i])->size());
+        }
+    }
+}
+
+TEST_F(CompileBatchTest, AllJobsSucceed)
+{
+    createCompilers();
+
+    std::vector<const char*> sources;
+    std::vector<ShCompileJob> jobs;
+    for (size_t i = 0; i < kNumShaders; ++i)
+    {
+        if (i % 4 != 3)
+        {
+            sources.push_back(mSources[i].c_str());
+        }
+    }
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        ShCompileJob job = { mCompilers[i], &sources[i], 1, SH_OBJECT_CODE, false };
+        jobs.push_back(job);
+    }
+
+    // Repeated batches reuse the same worker pool.
+    for (int iteration = 0; iteration < 3; ++iteration)
+    {
+        EXPECT_TRUE(ShCompileBatch(&jobs[0], jobs.size()));
+    }
+}
+
+TEST_F(CompileBatchTest, EmptyBatch)
+{
+    EXPECT_TRUE(ShCompileBatch(NULL, 0));
+}
@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// CompileStatistics_test.cpp:
+//   Tests for the phase timings and counters recorded with
+//   SH_COMPILE_STATISTICS.
+//
+
+#include <string.h>
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+class CompileStatisticsTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        mCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                        SH_GLSL_OUTPUT, &resources);
+        ASSERT_TRUE(mCompiler != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        ShDestruct(mCompiler);
+    }
+
+    bool compile(int compileOptions)
+    {
+        const char *source =
+            "precision mediump float;\n"
+            "uniform vec4 u;\n"
+            "vec4 f(vec4 a) { vec4 b = a * 2.0; return b; }\n"
+            "void main() {\n"
+            "    vec4 c = f(u);\n"
+            "    gl_FragColor = c;\n"
+            "}\n";
+        return ShCompile(mCompiler, &source, 1, compileOptions);
+    }
+
+    ShHandle mCompiler;
+};
+
+TEST_F(CompileStatisticsTest, RecordsEnabledPhases)
+{
+    ASSERT_TRUE(compile(SH_OBJECT_CODE | SH_VARIABLES | SH_COMPILE_STATISTICS));
+
+    ShCompileStatistics stats;
+    ASSERT_TRUE(ShGetCompileStatistics(mCompiler, &stats));
+
+    double phaseTotal = 0.0;
+    for (int phase = 0; phase < SH_COMPILE_PHASE_COUNT; ++phase)
+    {
+        EXPECT_GE(stats.phaseTimes[phase], 0.0);
+        phaseTotal += stats.phaseTimes[phase];
+    }
+    EXPECT_GT(stats.phaseTimes[SH_COMPILE_PHASE_PARSE], 0.0);
+    EXPECT_GT(stats.phaseTimes[SH_COMPILE_PHASE_TRANSLATE], 0.0);
+    // Phases that are not enabled are not timed.
+    EXPECT_EQ(0.0, stats.phaseTimes[SH_COMPILE_PHASE_TIMING_RESTRICTIONS]);
+    EXPECT_EQ(0.0, stats.phaseTimes[SH_COMPILE_PHASE_PRUNE_DEAD_CODE]);
+    EXPECT_LE(phaseTotal, stats.totalTime);
+
+    EXPECT_GT(stats.astNodeCount, 10u);
+    // u, f, a, b, c and main; the prototype of f adds one more entry.
+    EXPECT_GE(stats.symbolCount, 6u);
+    EXPECT_GT(stats.poolAllocationCount, 0u);
+    EXPECT_GT(stats.poolAllocatedBytes, 0u);
+}
+
+TEST_F(CompileStatisticsTest, ZeroWithoutOption)
+{
+    ASSERT_TRUE(compile(SH_COMPILE_STATISTICS));
+    ASSERT_TRUE(compile(SH_OBJECT_CODE));
+
+    ShCompileStatistics stats;
+    ASSERT_TRUE(ShGetCompileStatistics(mCompiler, &stats));
+    ShCompileStatistics zero;
+    memset(&zero, 0, sizeof(zero));
+    EXPECT_EQ(0, memcmp(&stats, &zero, sizeof(stats)));
+}
+
+TEST(CompileStatisticsPhaseNameTest, NamesArePrintable)
+{
+    EXPECT_STREQ("parse", ShGetCompilePhaseName(SH_COMPILE_PHASE_PARSE));
+    EXPECT_STREQ("translate", ShGetCompilePhaseName(SH_COMPILE_PHASE_TRANSLATE));
+    for (int phase = 0; phase < SH_COMPILE_PHASE_COUNT; ++phase)
+        EXPECT_GT(strlen(ShGetCompilePhaseName(static_cast<ShCompilePhase>(phase))), 0u);
+}
@@ -0,0 +1,314 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// EliminateCommonSubexpressions_test.cpp:
+//   Tests for the common subexpression elimination and loop-invariant code
+//   motion pass enabled by SH_ELIMINATE_COMMON_SUBEXPRESSIONS, which
+//   compare the translations with the expected code.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+class EliminateCommonSubexpressionsTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        mGLSLCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_GLSL_OUTPUT, &resources);
+        mESSLCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_ESSL_OUTPUT, &resources);
+        ASSERT_TRUE(mGLSLCompiler != NULL && mESSLCompiler != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        ShDestruct(mGLSLCompiler);
+        ShDestruct(mESSLCompiler);
+    }
+
+    std::string compile(ShHandle compiler, const char *source, int compileOptions)
+    {
+        if (!ShCompile(compiler, &source, 1, compileOptions))
+        {
+            ADD_FAILURE() << ShGetInfoLog(compiler);
+            return "";
+        }
+        return ShGetObjectCode(compiler);
+    }
+
+    // Checks the GLSL translation of |source| with the pass enabled.
+    void expectTranslation(const char *source, const char *expected)
+    {
+        EXPECT_EQ(expected, compile(mGLSLCompiler, source,
+                                    SH_OBJECT_CODE | SH_ELIMINATE_COMMON_SUBEXPRESSIONS));
+    }
+
+    ShHandle mGLSLCompiler;
+    ShHandle mESSLCompiler;
+};
+
+TEST_F(EliminateCommonSubexpressionsTest, ReusesRepeatedExpressions)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec3 lightDir;\n"
+        "varying vec3 normal;\n"
+        "void main() {\n"
+        "    float diffuse = max(dot(normalize(normal), lightDir), 0.0);\n"
+        "    float rim = 1.0 - max(dot(normalize(normal), vec3(0.0, 0.0, 1.0)), 0.0);\n"
+        "    gl_FragColor = vec4(normalize(normal) * diffuse, rim);\n"
+        "}\n";
+    expectTranslation(source,
+        "uniform vec3 lightDir;\n"
+        "varying vec3 normal;\n"
+        "void main(){\n"
+        "vec3 _cse0 = normalize(normal);\n"
+        "float diffuse = max(dot(_cse0, lightDir), 0.0);\n"
+        "float rim = (1.0 - max(dot(_cse0, vec3(0.0, 0.0, 1.0)), 0.0));\n"
+        "(gl_FragColor = vec4((_cse0 * diffuse), rim));\n"
+        "}\n");
+
+    // Without the option the code is kept.
+    std::string code = compile(mGLSLCompiler, source, SH_OBJECT_CODE);
+    EXPECT_EQ(std::string::npos, code.find("_cse"));
+}
+
+TEST_F(EliminateCommonSubexpressionsTest, HoistsLoopInvariants)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "uniform vec2 offset;\n"
+        "uniform float scale;\n"
+        "uniform vec4 weights[4];\n"
+        "varying vec2 uv;\n"
+        "void main() {\n"
+        "    vec4 sum = vec4(0.0);\n"
+        "    for (int i = 0; i < 4; ++i) {\n"
+        "        sum += texture2D(tex, uv * scale + offset) * weights[i];\n"
+        "        if (sum.a > 1.0) {\n"
+        "            sum *= sqrt(scale);\n"
+        "        }\n"
+        "    }\n"
+        "    gl_FragColor = sum;\n"
+        "}\n";
+    // The lookup is moved out of the loop as a whole, and the expression
+    // in the if-statement, which not all iterations evaluate, is not.
+    expectTranslation(source,
+        "uniform sampler2D tex;\n"
+        "uniform vec2 offset;\n"
+        "uniform float scale;\n"
+        "uniform vec4 weights[4];\n"
+        "varying vec2 uv;\n"
+        "void main(){\n"
+        "vec4 sum = vec4(0.0, 0.0, 0.0, 0.0);\n"
+        "vec4 _cse0 = texture2D(tex, ((uv * scale) + offset));\n"
+        "for (int i = 0; (i < 4); (++i))\n"
+        "{\n"
+        "(sum += (_cse0 * weights[i]));\n"
+        "if ((sum.w > 1.0))\n"
+        "{\n"
+        "(sum *= sqrt(scale));\n"
+        "}\n"
+        "}\n"
+        "(gl_FragColor = sum);\n"
+        "}\n");
+}
+
+TEST_F(EliminateCommonSubexpressionsTest, NestedLoops)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 u;\n"
+        "void main() {\n"
+        "    vec4 sum = vec4(0.0);\n"
+        "    for (int i = 0; i < 3; i++) {\n"
+        "        for (int j = 0; j < 3; j++) {\n"
+        "            sum += vec4(exp(u.z) * 5.0, float(i) * u.x, 0.0, 1.0);\n"
+        "        }\n"
+        "    }\n"
+        "    gl_FragColor = sum;\n"
+        "}\n";
+    // Each expression moves out of the loops that do not change it.
+    expectTranslation(source,
+        "uniform vec4 u;\n"
+        "void main(){\n"
+        "vec4 sum = vec4(0.0, 0.0, 0.0, 0.0);\n"
+        "float _cse0 = (exp(u.z) * 5.0);\n"
+        "for (int i = 0; (i < 3); (i++))\n"
+        "{\n"
+        "float _cse1 = (float(i) * u.x);\n"
+        "for (int j = 0; (j < 3); (j++))\n"
+        "{\n"
+        "(sum += vec4(_cse0, _cse1, 0.0, 1.0));\n"
+        "}\n"
+        "}\n"
+        "(gl_FragColor = sum);\n"
+        "}\n");
+}
+
+TEST_F(EliminateCommonSubexpressionsTest, WritesStartNewValues)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 u;\n"
+        "float total = 0.0;\n"
+        "float accumulate(float x) { total += x; return total; }\n"
+        "void scaleBy(inout float x, float factor) { x *= factor; }\n"
+        "void main() {\n"
+        "    float a = u.x * u.y;\n"
+        "    float b = total * 2.0 + accumulate(a) + total * 2.0;\n"
+        "    scaleBy(a, u.z);\n"
+        "    float c = u.x * u.y + a * u.w;\n"
+        "    a = a * u.w;\n"
+        "    gl_FragColor = vec4(a * u.w, b, c, a * u.w);\n"
+        "}\n";
+    // Calls of user-defined functions write the globals and their out
+    // parameters, and an assignment writes after the reads of its right
+    // operand.
+    expectTranslation(source,
+        "uniform vec4 u;\n"
+        "float total = 0.0;\n"
+        "float accumulate(in float x){\n"
+        "(total += x);\n"
+        "return total;\n"
+        "}\n"
+        "void scaleBy(inout float x, in float factor){\n"
+        "(x *= factor);\n"
+        "}\n"
+        "void main(){\n"
+        "float _cse0 = (u.x * u.y);\n"
+        "float a = _cse0;\n"
+        "float b = (((total * 2.0) + accumulate(a)) + (total * 2.0));\n"
+        "scaleBy(a, u.z);\n"
+        "float _cse1 = (a * u.w);\n"
+        "float c = (_cse0 + _cse1);\n"
+        "(a = _cse1);\n"
+        "float _cse2 = (a * u.w);\n"
+        "(gl_FragColor = vec4(_cse2, b, c, _cse2));\n"
+        "}\n");
+}
+
+TEST_F(EliminateCommonSubexpressionsTest, ConditionalExpressionsStayInPlace)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 u;\n"
+        "void main() {\n"
+        "    bool positive = u.x > 0.0 && sin(u.y) > 0.0;\n"
+        "    float t = positive ? cos(u.z) : sin(u.y);\n"
+        "    float s = sin(u.y) + cos(u.z);\n"
+        "    float r = s > 0.5 ? sin(u.y) + cos(u.z) : 0.0;\n"
+        "    gl_FragColor = vec4(t, s, r, 1.0);\n"
+        "}\n";
+    // Values computed before a conditional expression are still reused
+    // in it.
+    expectTranslation(source,
+        "uniform vec4 u;\n"
+        "void main(){\n"
+        "bool positive = ((u.x > 0.0) && (sin(u.y) > 0.0));\n"
+        "float t = ((positive) ? (cos(u.z)) : (sin(u.y)));\n"
+        "float _cse0 = (sin(u.y) + cos(u.z));\n"
+        "float s = _cse0;\n"
+        "float r = (((s > 0.5)) ? (_cse0) : (0.0));\n"
+        "(gl_FragColor = vec4(t, s, r, 1.0));\n"
+        "}\n");
+}
+
+TEST_F(EliminateCommonSubexpressionsTest, KeepsPrecisionsAndIndices)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform sampler2D samplers[2];\n"
+        "uniform vec4 colors[4];\n"
+        "uniform lowp vec4 tint;\n"
+        "varying vec2 uv;\n"
+        "void main() {\n"
+        "    vec4 sum = vec4(0.0);\n"
+        "    for (int i = 0; i < 2; ++i) {\n"
+        "        sum += texture2D(samplers[i], uv) * colors[i + 1];\n"
+        "        sum += colors[i + 1] * tint.a;\n"
+        "    }\n"
+        "    gl_FragColor = sum * (tint * tint) + tint * tint;\n"
+        "}\n";
+    // Indices keep the form that the limitations of ESSL require.
+    EXPECT_EQ(
+        "uniform lowp sampler2D samplers[2];\n"
+        "uniform mediump vec4 colors[4];\n"
+        "uniform lowp vec4 tint;\n"
+        "varying mediump vec2 uv;\n"
+        "void main(){\n"
+        "mediump vec4 sum = vec4(0.0, 0.0, 0.0, 0.0);\n"
+        "for (mediump int i = 0; (i < 2); (++i))\n"
+        "{\n"
+        "(sum += (texture2D(samplers[i], uv) * colors[(i + 1)]));\n"
+        "(sum += (colors[(i + 1)] * tint.w));\n"
+        "}\n"
+        "lowp vec4 _cse0 = (tint * tint);\n"
+        "(gl_FragColor = ((sum * _cse0) + _cse0));\n"
+        "}\n",
+        compile(mESSLCompiler, source, SH_OBJECT_CODE | SH_ELIMINATE_COMMON_SUBEXPRESSIONS));
+}
+
+// Temporaries do not hide the variables of the shader.
+TEST_F(EliminateCommonSubexpressionsTest, AvoidsShaderNames)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 _cse0;\n"
+        "void main() {\n"
+        "    gl_FragColor = sqrt(_cse0) + sqrt(_cse0);\n"
+        "}\n";
+    expectTranslation(source,
+        "uniform vec4 _cse0;\n"
+        "void main(){\n"
+        "vec4 _cse1 = sqrt(_cse0);\n"
+        "(gl_FragColor = (_cse1 + _cse1));\n"
+        "}\n");
+}
+
+// Reads of different fields are different values, even when their indices
+// have the same type.
+TEST_F(EliminateCommonSubexpressionsTest, DistinguishesStructFields)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "struct Light {\n"
+        "    vec4 color;\n"
+        "    mat4 transform;\n"
+        "    vec4 position;\n"
+        "    mat4 projection;\n"
+        "};\n"
+        "uniform Light light;\n"
+        "varying vec4 pos;\n"
+        "void main() {\n"
+        "    vec4 a = light.transform * pos + light.projection * pos;\n"
+        "    vec4 b = light.color * light.position;\n"
+        "    gl_FragColor = a + light.transform * pos + b + light.color * light.position;\n"
+        "}\n";
+    expectTranslation(source,
+        "struct Light{\n"
+        "vec4 color;\n"
+        "mat4 transform;\n"
+        "vec4 position;\n"
+        "mat4 projection;\n"
+        "} ;\n"
+        "uniform Light light;\n"
+        "varying vec4 pos;\n"
+        "void main(){\n"
+        "vec4 _cse0 = (light.transform * pos);\n"
+        "vec4 a = (_cse0 + (light.projection * pos));\n"
+        "vec4 _cse1 = (light.color * light.position);\n"
+        "vec4 b = _cse1;\n"
+        "(gl_FragColor = (((a + _cse0) + b) + _cse1));\n"
+        "}\n");
+}
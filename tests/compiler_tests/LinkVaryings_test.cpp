@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// LinkVaryings_test.cpp:
+//   Tests that ShLinkVaryings removes the varyings of a vertex shader that
+//   the fragment shader does not read, and the computations feeding them.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+namespace
+{
+
+const char *kVertexShader =
+    "attribute vec4 position;\n"
+    "attribute vec3 normal;\n"
+    "uniform mat4 mvp;\n"
+    "varying vec2 uv, unusedCoord;\n"
+    "varying vec3 unusedNormal;\n"
+    "varying float depth;\n"
+    "invariant unusedNormal;\n"
+    "float shade(vec3 n) { return dot(n, n) * 0.5; }\n"
+    "void main() {\n"
+    "    uv = position.xy * 0.5;\n"
+    "    unusedCoord = vec2(shade(normal));\n"
+    "    unusedNormal = normalize(normal);\n"
+    "    unusedNormal.x += 1.0;\n"
+    "    depth = position.z;\n"
+    "    gl_Position = mvp * position * depth;\n"
+    "}\n";
+
+const int kCompileOptions = SH_OBJECT_CODE | SH_VARIABLES;
+
+bool Contains(const std::string &code, const char *text)
+{
+    return code.find(text) != std::string::npos;
+}
+
+bool HasVarying(ShHandle compiler, const char *name)
+{
+    const std::vector<sh::Varying> *varyings = ShGetVaryings(compiler);
+    for (size_t i = 0; i < varyings->size(); ++i)
+    {
+        if ((*varyings)[i].name == name)
+            return true;
+    }
+    return false;
+}
+
+}  // anonymous namespace
+
+class LinkVaryingsTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        mVertexCompiler = ShConstructCompiler(GL_VERTEX_SHADER, SH_GLES2_SPEC,
+                                              SH_ESSL_OUTPUT, &resources);
+        mFragmentCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                SH_ESSL_OUTPUT, &resources);
+        ASSERT_TRUE(mVertexCompiler != NULL && mFragmentCompiler != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        ShDestruct(mVertexCompiler);
+        ShDestruct(mFragmentCompiler);
+    }
+
+    void compileFragmentShader(const char *source)
+    {
+        ASSERT_TRUE(ShCompile(mFragmentCompiler, &source, 1, kCompileOptions))
+            << ShGetInfoLog(mFragmentCompiler);
+    }
+
+    ShHandle mVertexCompiler;
+    ShHandle mFragmentCompiler;
+};
+
+TEST_F(LinkVaryingsTest, RemovesUnreadVaryings)
+{
+    ASSERT_TRUE(ShCompile(mVertexCompiler, &kVertexShader, 1, kCompileOptions));
+    std::string unlinked = ShGetObjectCode(mVertexCompiler);
+    EXPECT_EQ(5u, ShGetVaryings(mVertexCompiler)->size());
+
+    // Declaring a varying without reading it does not keep it.
+    compileFragmentShader(
+        "precision mediump float;\n"
+        "varying vec2 uv;\n"
+        "varying vec3 unusedNormal;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(uv, 0.0, 1.0);\n"
+        "}\n");
+    ASSERT_TRUE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+
+    std::string linked = ShGetObjectCode(mVertexCompiler);
+    EXPECT_TRUE(Contains(linked, "varying highp vec2 uv;"));
+    EXPECT_FALSE(Contains(linked, "unused"));
+    EXPECT_FALSE(Contains(linked, "shade"));
+    EXPECT_FALSE(Contains(linked, "normalize"));
+    EXPECT_FALSE(Contains(linked, "invariant"));
+    // The vertex shader still reads the value it wrote to depth.
+    EXPECT_TRUE(Contains(linked, "highp float depth;"));
+    EXPECT_FALSE(Contains(linked, "varying highp float depth"));
+    EXPECT_LT(linked.size(), unlinked.size());
+
+    EXPECT_EQ(2u, ShGetVaryings(mVertexCompiler)->size());
+    EXPECT_TRUE(HasVarying(mVertexCompiler, "uv"));
+    EXPECT_TRUE(HasVarying(mVertexCompiler, "gl_Position"));
+}
+
+// The vertex compiler can be linked with another fragment shader, which
+// may read varyings removed by the previous link.
+TEST_F(LinkVaryingsTest, LinksAgain)
+{
+    ASSERT_TRUE(ShCompile(mVertexCompiler, &kVertexShader, 1, kCompileOptions));
+    std::string unlinked = ShGetObjectCode(mVertexCompiler);
+
+    compileFragmentShader(
+        "precision mediump float;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(1.0);\n"
+        "}\n");
+    ASSERT_TRUE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+    EXPECT_FALSE(Contains(ShGetObjectCode(mVertexCompiler), "varying"));
+    EXPECT_TRUE(HasVarying(mVertexCompiler, "gl_Position"));
+
+    compileFragmentShader(
+        "precision mediump float;\n"
+        "varying vec2 uv, unusedCoord;\n"
+        "varying vec3 unusedNormal;\n"
+        "varying float depth;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(uv + unusedCoord, unusedNormal.x, depth);\n"
+        "}\n");
+    ASSERT_TRUE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+    EXPECT_EQ(unlinked, ShGetObjectCode(mVertexCompiler));
+    EXPECT_EQ(5u, ShGetVaryings(mVertexCompiler)->size());
+}
+
+TEST_F(LinkVaryingsTest, ReducesHLSLInterpolators)
+{
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    ShHandle hlslCompiler = ShConstructCompiler(GL_VERTEX_SHADER, SH_GLES2_SPEC,
+                                                SH_HLSL11_OUTPUT, &resources);
+    ASSERT_TRUE(hlslCompiler != NULL);
+    ASSERT_TRUE(ShCompile(hlslCompiler, &kVertexShader, 1, kCompileOptions));
+    std::string unlinked = ShGetObjectCode(hlslCompiler);
+
+    compileFragmentShader(
+        "precision mediump float;\n"
+        "varying vec2 uv;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(uv, 0.0, 1.0);\n"
+        "}\n");
+    ASSERT_TRUE(ShLinkVaryings(hlslCompiler, mFragmentCompiler));
+    std::string linked = ShGetObjectCode(hlslCompiler);
+    EXPECT_TRUE(Contains(unlinked, "_unusedNormal"));
+    EXPECT_FALSE(Contains(linked, "_unusedNormal"));
+    EXPECT_FALSE(Contains(linked, "_unusedCoord"));
+    EXPECT_TRUE(Contains(linked, "_uv"));
+
+    ShDestruct(hlslCompiler);
+}
+
+TEST_F(LinkVaryingsTest, RequiresCompiledShadersWithVariables)
+{
+    compileFragmentShader(
+        "precision mediump float;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(1.0);\n"
+        "}\n");
+
+    // Nothing was compiled yet.
+    EXPECT_FALSE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+
+    ASSERT_TRUE(ShCompile(mVertexCompiler, &kVertexShader, 1, SH_OBJECT_CODE));
+    EXPECT_FALSE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+
+    const char *invalid = "void main() { gl_Position = undeclared; }\n";
+    EXPECT_FALSE(ShCompile(mVertexCompiler, &invalid, 1, kCompileOptions));
+    EXPECT_FALSE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+
+    // The shaders are linked in the right order.
+    ASSERT_TRUE(ShCompile(mVertexCompiler, &kVertexShader, 1, kCompileOptions));
+    EXPECT_FALSE(ShLinkVaryings(mFragmentCompiler, mVertexCompiler));
+    EXPECT_TRUE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+}
+
+// The fragment shader's varyings are only known after it compiled
+// successfully with SH_VARIABLES.
+TEST_F(LinkVaryingsTest, RequiresCompiledFragmentShader)
+{
+    ASSERT_TRUE(ShCompile(mVertexCompiler, &kVertexShader, 1, kCompileOptions));
+    std::string unlinked = ShGetObjectCode(mVertexCompiler);
+
+    const char *invalid =
+        "precision mediump float;\n"
+        "varying vec2 uv;\n"
+        "void main() { gl_FragColor = vec4(uv, undeclared); }\n";
+    EXPECT_FALSE(ShCompile(mFragmentCompiler, &invalid, 1, kCompileOptions));
+    EXPECT_FALSE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+    EXPECT_EQ(unlinked, ShGetObjectCode(mVertexCompiler));
+    EXPECT_EQ(5u, ShGetVaryings(mVertexCompiler)->size());
+}
+
+TEST_F(LinkVaryingsTest, RequiresFragmentShaderVariables)
+{
+    ASSERT_TRUE(ShCompile(mVertexCompiler, &kVertexShader, 1, kCompileOptions));
+    std::string unlinked = ShGetObjectCode(mVertexCompiler);
+
+    const char *fragmentShader =
+        "precision mediump float;\n"
+        "varying vec2 uv;\n"
+        "void main() { gl_FragColor = vec4(uv, 0.0, 1.0); }\n";
+    ASSERT_TRUE(ShCompile(mFragmentCompiler, &fragmentShader, 1, SH_OBJECT_CODE));
+    EXPECT_FALSE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+    EXPECT_EQ(unlinked, ShGetObjectCode(mVertexCompiler));
+    EXPECT_EQ(5u, ShGetVaryings(mVertexCompiler)->size());
+
+    // A later compilation with SH_VARIABLES links.
+    compileFragmentShader(fragmentShader);
+    EXPECT_TRUE(ShLinkVaryings(mVertexCompiler, mFragmentCompiler));
+    EXPECT_TRUE(HasVarying(mVertexCompiler, "uv"));
+    EXPECT_FALSE(HasVarying(mVertexCompiler, "depth"));
+}
@@ -0,0 +1,228 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// LoopCost_test.cpp:
+//   Tests for the loop attributes that SH_UNROLL_LOOPS_BY_COST emits in
+//   the HLSL output.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+class LoopCostTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShInitBuiltInResources(&mResources);
+    }
+
+    // Returns the HLSL11 translation of the ESSL 3.00 fragment shader
+    // |source|.
+    std::string compile(const char *source, int compileOptions)
+    {
+        ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES3_SPEC,
+                                                SH_HLSL11_OUTPUT, &mResources);
+        if (compiler == NULL)
+        {
+            ADD_FAILURE() << "Could not construct a compiler";
+            return "";
+        }
+
+        std::string code;
+        if (ShCompile(compiler, &source, 1, compileOptions | SH_OBJECT_CODE | SH_VARIABLES))
+            code = ShGetObjectCode(compiler);
+        else
+            ADD_FAILURE() << ShGetInfoLog(compiler);
+        ShDestruct(compiler);
+        return code;
+    }
+
+    std::string compile(const char *source)
+    {
+        return compile(source, SH_UNROLL_LOOPS_BY_COST);
+    }
+
+    static bool contains(const std::string &code, const char *text)
+    {
+        return code.find(text) != std::string::npos;
+    }
+
+    static size_t count(const std::string &code, const char *text)
+    {
+        size_t occurrences = 0;
+        for (size_t pos = code.find(text); pos != std::string::npos; pos = code.find(text, pos + 1))
+            ++occurrences;
+        return occurrences;
+    }
+
+    ShBuiltInResources mResources;
+};
+
+TEST_F(LoopCostTest, UnrollsSmallLoops)
+{
+    const char *source =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 uv;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = vec4(0.0);\n"
+        "    for (int i = 10; i > 0; i -= 3)\n"
+        "        color += texture(tex, uv + float(i) * 0.01);\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_TRUE(contains(code, "{[unroll] for("));
+    EXPECT_FALSE(contains(code, "LOOP for("));
+
+    // Without the option, the loop keeps the macro.
+    code = compile(source, 0);
+    EXPECT_TRUE(contains(code, "{LOOP for("));
+    EXPECT_FALSE(contains(code, "[unroll]"));
+}
+
+TEST_F(LoopCostTest, KeepsLargeLoops)
+{
+    const char *source =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 uv;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = vec4(0.0);\n"
+        "    for (int i = 0; i <= 199; i++)\n"
+        "        color += textureLod(tex, uv * float(i), 0.0) * 0.5;\n"
+        "}\n";
+
+    EXPECT_TRUE(contains(compile(source), "{LOOP for("));
+    EXPECT_FALSE(contains(compile(source), "[unroll]"));
+
+    // The budget can be raised.
+    mResources.MaxUnrolledLoopCost = 4096;
+    EXPECT_TRUE(contains(compile(source), "{[unroll] for("));
+}
+
+TEST_F(LoopCostTest, KeepsLoopsWithUnknownTripCount)
+{
+    const char *source =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform int count;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = vec4(0.0);\n"
+        "    for (int i = 0; i < count; ++i)\n"
+        "        color += vec4(0.1);\n"
+        "    for (int j = 0; j < 4; ++j) {\n"
+        "        color *= 0.5;\n"
+        "        j += 1;\n"
+        "    }\n"
+        "    int k = 0;\n"
+        "    do {\n"
+        "        color.x += 0.1;\n"
+        "    } while (++k < 2);\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_FALSE(contains(code, "[unroll]"));
+    EXPECT_TRUE(contains(code, "{LOOP do"));
+    EXPECT_EQ(2u, count(code, "{LOOP for("));
+}
+
+// The unrolled inner loop counts in the cost of the outer loop.
+TEST_F(LoopCostTest, NestedLoops)
+{
+    const char *source =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 uv;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = vec4(0.0);\n"
+        "    for (int y = 0; y < 16; ++y)\n"
+        "        for (int x = 0; x < 4; ++x)\n"
+        "            color += textureLod(tex, uv + vec2(x, y), 0.0);\n"
+        "}\n";
+
+    std::string code = compile(source);
+    size_t outer = code.find("LOOP for(");
+    size_t inner = code.find("[unroll] for(");
+    ASSERT_NE(std::string::npos, outer);
+    ASSERT_NE(std::string::npos, inner);
+    EXPECT_LT(outer, inner);
+}
+
+// Loops marked for unrolling are unrolled regardless of their cost.
+TEST_F(LoopCostTest, MarkedLoops)
+{
+    const char *source =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 uv;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = vec4(0.0);\n"
+        "    for (int i = 0; i < 200; ++i)\n"
+        "        color += textureLod(tex, uv * float(i), 0.0);\n"
+        "}\n";
+
+    std::string code = compile(source, SH_UNROLL_LOOPS_BY_COST |
+                                       SH_UNROLL_FOR_LOOP_WITH_INTEGER_INDEX);
+    EXPECT_TRUE(contains(code, "{[unroll] for("));
+}
+
+// The HLSL compiler has to unroll loops that compute gradients, so they are
+// never marked [loop], however large. Loops with an unknown trip count keep
+// the macro, which the HLSL compiler can still be let to unroll.
+TEST_F(LoopCostTest, GradientLoops)
+{
+    const char *lookupSource =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "in vec2 uv;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = vec4(0.0);\n"
+        "    for (int i = 0; i < 200; ++i)\n"
+        "        color += texture(tex, uv * float(i));\n"
+        "}\n";
+
+    std::string code = compile(lookupSource);
+    EXPECT_TRUE(contains(code, "{[unroll] for("));
+    EXPECT_FALSE(contains(code, "[loop] for("));
+
+    // Derivatives, also in a called function and in a nested loop.
+    const char *derivativeSource =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform int count;\n"
+        "in vec2 uv;\n"
+        "out vec4 color;\n"
+        "float slope(float x) { return dFdx(x) + fwidth(x); }\n"
+        "void main() {\n"
+        "    color = vec4(0.0);\n"
+        "    for (int i = 0; i < 200; ++i)\n"
+        "        color.x += slope(uv.x * float(i));\n"
+        "    for (int y = 0; y < 100; ++y)\n"
+        "        for (int x = 0; x < 4; ++x)\n"
+        "            color.y += dFdy(uv.y * float(x + y));\n"
+        "    for (int j = 0; j < count; ++j)\n"
+        "        color.z += dFdx(uv.x * float(j));\n"
+        "}\n";
+
+    code = compile(derivativeSource);
+    EXPECT_EQ(3u, count(code, "{[unroll] for("));
+    EXPECT_EQ(1u, count(code, "{LOOP for("));
+    EXPECT_FALSE(contains(code, "[loop] for("));
+}
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// MemoryBudget_test.cpp:
+//   Tests that SH_LIMIT_COMPILE_MEMORY fails compilations that need more
+//   memory than MaxCompileMemory, and leaves the others alone.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+namespace
+{
+
+const char *kSmallShader =
+    "precision mediump float;\n"
+    "uniform vec4 color;\n"
+    "void main() {\n"
+    "    gl_FragColor = color * 0.5;\n"
+    "}\n";
+
+// Returns a shader with |count| statements in main().
+std::string LongShader(int count)
+{
+    std::string source = "precision mediump float;\n"
+                         "uniform vec4 u;\n"
+                         "void main() {\n"
+                         "    vec4 a = u;\n";
+    for (int i = 0; i < count; ++i)
+        source += "    a = a * 1.5 + vec4(1.0, 2.0, 3.0, 4.0);\n";
+    source += "    gl_FragColor = a;\n"
+              "}\n";
+    return source;
+}
+
+}  // anonymous namespace
+
+class MemoryBudgetTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        mCompiler = NULL;
+        setBudget(1024 * 1024);
+    }
+
+    virtual void TearDown()
+    {
+        ShDestruct(mCompiler);
+    }
+
+    void setBudget(int maxCompileMemory)
+    {
+        ShDestruct(mCompiler);
+
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        resources.MaxCompileMemory = maxCompileMemory;
+        mCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                        SH_GLSL_OUTPUT, &resources);
+        ASSERT_TRUE(mCompiler != NULL);
+    }
+
+    bool compile(const std::string &source, int compileOptions)
+    {
+        const char *shaderString = source.c_str();
+        return ShCompile(mCompiler, &shaderString, 1, compileOptions);
+    }
+
+    bool infoLogContains(const char *text)
+    {
+        return ShGetInfoLog(mCompiler).find(text) != std::string::npos;
+    }
+
+    ShHandle mCompiler;
+};
+
+TEST_F(MemoryBudgetTest, SmallShadersAreUnaffected)
+{
+    ASSERT_TRUE(compile(kSmallShader, SH_OBJECT_CODE));
+    std::string code = ShGetObjectCode(mCompiler);
+
+    ASSERT_TRUE(compile(kSmallShader, SH_OBJECT_CODE | SH_LIMIT_COMPILE_MEMORY));
+    EXPECT_EQ(code, ShGetObjectCode(mCompiler));
+}
+
+TEST_F(MemoryBudgetTest, LargeTree)
+{
+    std::string source = LongShader(5000);
+    ASSERT_TRUE(compile(source, SH_OBJECT_CODE)) << ShGetInfoLog(mCompiler);
+
+    EXPECT_FALSE(compile(source, SH_OBJECT_CODE | SH_LIMIT_COMPILE_MEMORY));
+    EXPECT_TRUE(infoLogContains("compilation exceeds the memory budget of 1048576 bytes"));
+    // The parse stops early without reporting syntax errors.
+    EXPECT_FALSE(infoLogContains("syntax error"));
+    EXPECT_TRUE(ShGetObjectCode(mCompiler).empty());
+
+    // The budget applies to each compilation on its own.
+    EXPECT_TRUE(compile(kSmallShader, SH_OBJECT_CODE | SH_LIMIT_COMPILE_MEMORY));
+}
+
+TEST_F(MemoryBudgetTest, MacroExpansion)
+{
+    std::string source = "#define D(x) x x\n" + LongShader(0);
+    std::string statement = "a = a * 1.5;";
+    for (int i = 0; i < 20; ++i)
+        statement = "D(" + statement + ")";
+    source.insert(source.find("gl_FragColor"), statement + "\n");
+
+    EXPECT_FALSE(compile(source, SH_OBJECT_CODE | SH_LIMIT_COMPILE_MEMORY));
+    EXPECT_TRUE(infoLogContains("'D' : macro expansion exceeds the memory budget"));
+    EXPECT_FALSE(infoLogContains("syntax error"));
+}
+
+TEST_F(MemoryBudgetTest, LargeObjectCode)
+{
+    // The statements fit in the budget, but the unrolled loop does not.
+    std::string source = "precision mediump float;\n"
+                         "uniform vec4 u[256];\n"
+                         "void main() {\n"
+                         "    vec4 a = vec4(0.0);\n"
+                         "    for (int i = 0; i < 256; ++i) {\n";
+    for (int i = 0; i < 400; ++i)
+        source += "        a += u[i] * sin(a);\n";
+    source += "    }\n"
+              "    gl_FragColor = a;\n"
+              "}\n";
+    const int kOptions = SH_OBJECT_CODE | SH_UNROLL_FOR_LOOP_WITH_INTEGER_INDEX;
+
+    // The budget is half again what the shader takes without the object
+    // code, counting the header and guard blocks that debug builds add to
+    // each allocation.
+    ASSERT_TRUE(compile(source, SH_VARIABLES | SH_COMPILE_STATISTICS)) << ShGetInfoLog(mCompiler);
+    ShCompileStatistics statistics;
+    ASSERT_TRUE(ShGetCompileStatistics(mCompiler, &statistics));
+    const size_t kAllocationOverhead = 64;
+    size_t budget = statistics.poolAllocatedBytes +
+                    statistics.poolAllocationCount * kAllocationOverhead;
+    budget += budget / 2;
+    setBudget(static_cast<int>(budget));
+
+    ASSERT_TRUE(compile(source, kOptions)) << ShGetInfoLog(mCompiler);
+    ASSERT_LT(budget, ShGetObjectCode(mCompiler).size());
+
+    EXPECT_FALSE(compile(source, kOptions | SH_LIMIT_COMPILE_MEMORY));
+    EXPECT_TRUE(infoLogContains("memory budget"));
+    EXPECT_TRUE(ShGetObjectCode(mCompiler).empty());
+
+    // Without the object code, the shader fits.
+    EXPECT_TRUE(compile(source, SH_LIMIT_COMPILE_MEMORY | SH_VARIABLES));
+}
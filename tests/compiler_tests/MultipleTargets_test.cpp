@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// MultipleTargets_test.cpp:
+//   Tests that ShCompileMultipleTargets gives each target the results of
+//   compiling for it alone.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const ShShaderOutput kOutputs[] =
+{
+    SH_GLSL_OUTPUT,
+    SH_ESSL_OUTPUT,
+    SH_HLSL9_OUTPUT,
+    SH_HLSL11_OUTPUT,
+};
+const size_t kOutputCount = sizeof(kOutputs) / sizeof(kOutputs[0]);
+
+// The HLSL names of structs contain an id that differs from compile to
+// compile, and is removed before comparing translations.
+std::string RemoveStructIds(const std::string &code)
+{
+    std::string result;
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        result += code[i];
+        if (code.compare(i, 2, "ss") == 0 && i + 2 < code.size() && isdigit(code[i + 2]))
+        {
+            result += 's';
+            for (i += 2; i < code.size() && isdigit(code[i]); ++i) {}
+            --i;
+        }
+    }
+    return result;
+}
+
+}  // anonymous namespace
+
+class MultipleTargetsTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        for (size_t i = 0; i < kOutputCount; ++i)
+        {
+            mTargets.push_back(ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                   kOutputs[i], &resources));
+            mSeparate.push_back(ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                    kOutputs[i], &resources));
+            ASSERT_TRUE(mTargets.back() != NULL && mSeparate.back() != NULL);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        for (size_t i = 0; i < mTargets.size(); ++i)
+        {
+            ShDestruct(mTargets[i]);
+            ShDestruct(mSeparate[i]);
+        }
+    }
+
+    // Compiles |source| for all targets at once and for each target alone,
+    // and checks that the results match.
+    void compileAndCompare(const char *source, int compileOptions, bool expectSuccess)
+    {
+        bool success = ShCompileMultipleTargets(&mTargets[0], mTargets.size(),
+                                                &source, 1, compileOptions);
+        EXPECT_EQ(expectSuccess, success);
+
+        for (size_t i = 0; i < mTargets.size(); ++i)
+        {
+            EXPECT_EQ(expectSuccess, ShCompile(mSeparate[i], &source, 1, compileOptions));
+            EXPECT_EQ(RemoveStructIds(ShGetObjectCode(mSeparate[i])),
+                      RemoveStructIds(ShGetObjectCode(mTargets[i]))) << "output " << kOutputs[i];
+            EXPECT_EQ(std::string(ShGetInfoLog(mSeparate[i])),
+                      std::string(ShGetInfoLog(mTargets[i]))) << "output " << kOutputs[i];
+            EXPECT_EQ(ShGetShaderVersion(mSeparate[i]), ShGetShaderVersion(mTargets[i]));
+
+            const std::vector<sh::Uniform> *uniforms = ShGetUniforms(mTargets[i]);
+            const std::vector<sh::Uniform> *separateUniforms = ShGetUniforms(mSeparate[i]);
+            ASSERT_EQ(separateUniforms->size(), uniforms->size());
+            for (size_t u = 0; u < uniforms->size(); ++u)
+            {
+                EXPECT_EQ((*separateUniforms)[u].name, (*uniforms)[u].name);
+                EXPECT_EQ((*separateUniforms)[u].mappedName, (*uniforms)[u].mappedName);
+            }
+            EXPECT_EQ(ShGetVaryings(mSeparate[i])->size(), ShGetVaryings(mTargets[i])->size());
+        }
+    }
+
+    std::vector<ShHandle> mTargets;
+    std::vector<ShHandle> mSeparate;
+};
+
+TEST_F(MultipleTargetsTest, MatchesSeparateCompiles)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "struct Light { vec3 direction; vec4 color; };\n"
+        "uniform Light lights[2];\n"
+        "uniform sampler2D tex;\n"
+        "varying vec2 uv;\n"
+        "varying vec3 normal;\n"
+        "const float kAmbient = 0.25;\n"
+        "vec4 shade(Light light) {\n"
+        "    float d = max(dot(normalize(normal), light.direction), 0.0);\n"
+        "    return light.color * (d > 0.5 || d < 0.1 ? d : kAmbient);\n"
+        "}\n"
+        "void main() {\n"
+        "    vec4 c = texture2D(tex, uv);\n"
+        "    for (int i = 0; i < 2; ++i)\n"
+        "        c += shade(lights[i]);\n"
+        "    if (c.a < 0.01) discard;\n"
+        "    gl_FragColor = c;\n"
+        "}\n";
+
+    compileAndCompare(source, SH_OBJECT_CODE | SH_VARIABLES, true);
+    // Passes that modify the tree only modify the copy of their target.
+    compileAndCompare(source, SH_OBJECT_CODE | SH_VARIABLES | SH_PRUNE_DEAD_CODE |
+                              SH_UNFOLD_SHORT_CIRCUIT | SH_EMULATE_BUILT_IN_FUNCTIONS |
+                              SH_UNROLL_FOR_LOOP_WITH_INTEGER_INDEX |
+                              SH_SCALARIZE_VEC_AND_MAT_CONSTRUCTOR_ARGS |
+                              SH_REGENERATE_STRUCT_NAMES | SH_ELIMINATE_COMMON_SUBEXPRESSIONS,
+                      true);
+}
+
+TEST_F(MultipleTargetsTest, ReportsErrorsToAllTargets)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(undeclared);\n"
+        "}\n";
+    compileAndCompare(source, SH_OBJECT_CODE, false);
+    for (size_t i = 0; i < mTargets.size(); ++i)
+    {
+        EXPECT_NE(std::string::npos, std::string(ShGetInfoLog(mTargets[i])).find("undeclared"));
+        EXPECT_EQ(std::string(), ShGetObjectCode(mTargets[i]));
+    }
+}
+
+// Handles that parse differently from the first are compiled on their own.
+TEST_F(MultipleTargetsTest, CompilesMismatchedHandlesSeparately)
+{
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    resources.OES_standard_derivatives = 1;
+    ShHandle derivatives = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                               SH_GLSL_OUTPUT, &resources);
+    ASSERT_TRUE(derivatives != NULL);
+
+    const char *source =
+        "#extension GL_OES_standard_derivatives : enable\n"
+        "precision mediump float;\n"
+        "varying float v;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(dFdx(v));\n"
+        "}\n";
+    ShHandle handles[] = { mTargets[0], derivatives };
+    EXPECT_FALSE(ShCompileMultipleTargets(handles, 2, &source, 1, SH_OBJECT_CODE));
+    EXPECT_EQ(std::string(), ShGetObjectCode(mTargets[0]));
+    EXPECT_NE(std::string::npos, std::string(ShGetObjectCode(derivatives)).find("dFdx"));
+
+    ShDestruct(derivatives);
+}
+
+TEST_F(MultipleTargetsTest, ParsesOnce)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 u;\n"
+        "void main() {\n"
+        "    gl_FragColor = u * 2.0;\n"
+        "}\n";
+    ASSERT_TRUE(ShCompileMultipleTargets(&mTargets[0], mTargets.size(), &source, 1,
+                                         SH_OBJECT_CODE | SH_VARIABLES | SH_COMPILE_STATISTICS));
+
+    ShCompileStatistics stats;
+    ASSERT_TRUE(ShGetCompileStatistics(mTargets[0], &stats));
+    EXPECT_GT(stats.phaseTimes[SH_COMPILE_PHASE_PARSE], 0.0);
+    EXPECT_GT(stats.phaseTimes[SH_COMPILE_PHASE_TRANSLATE], 0.0);
+    for (size_t i = 1; i < mTargets.size(); ++i)
+    {
+        ASSERT_TRUE(ShGetCompileStatistics(mTargets[i], &stats));
+        EXPECT_EQ(0.0, stats.phaseTimes[SH_COMPILE_PHASE_PARSE]);
+        EXPECT_GT(stats.phaseTimes[SH_COMPILE_PHASE_TRANSLATE], 0.0);
+        EXPECT_FALSE(std::string(ShGetObjectCode(mTargets[i])).empty());
+    }
+}
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// ObjectCodeChunks_test.cpp:
+//   Tests for the chunked storage of TInfoSinkBase and for reading object
+//   code with ShGetObjectCodeChunks.
+//
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+#include "compiler/translator/InfoSink.h"
+
+namespace
+{
+
+void CollectChunk(const char *chunk, size_t length, void *userData)
+{
+    static_cast<std::vector<std::string> *>(userData)->push_back(std::string(chunk, length));
+}
+
+}  // anonymous namespace
+
+TEST(InfoSinkTest, SplitsLargeOutputIntoChunks)
+{
+    TInfoSinkBase sink;
+    std::string expected;
+    std::string line(1000, 'x');
+    line += '\n';
+    for (int i = 0; i < 100; ++i)
+    {
+        sink << line.c_str() << i << 0.5f;
+        std::ostringstream stream;
+        stream << line << i << "0.5";
+        expected += stream.str();
+    }
+
+    EXPECT_EQ(expected.size(), static_cast<size_t>(sink.size()));
+    EXPECT_GT(sink.chunkCount(), 1u);
+
+    std::string joined;
+    for (size_t i = 0; i < sink.chunkCount(); ++i)
+    {
+        EXPECT_LE(sink.chunk(i).size(), TInfoSinkBase::kChunkSize);
+        joined += sink.chunk(i);
+    }
+    EXPECT_EQ(expected, joined);
+    EXPECT_EQ(expected, sink.str());
+
+    // Writing after str() invalidates the concatenation.
+    sink << "end";
+    EXPECT_EQ(expected + "end", sink.str());
+
+    TInfoSinkBase copy;
+    copy << "begin";
+    copy.append(sink);
+    EXPECT_EQ("begin" + expected + "end", copy.str());
+
+    sink.erase();
+    EXPECT_EQ(0, sink.size());
+    EXPECT_EQ(0u, sink.chunkCount());
+    EXPECT_EQ("", sink.str());
+}
+
+TEST(ObjectCodeChunksTest, MatchesObjectCode)
+{
+    std::ostringstream source;
+    source << "precision mediump float;\n"
+              "uniform vec4 u;\n"
+              "void main() {\n"
+              "    vec4 c = u;\n";
+    for (int i = 0; i < 2000; ++i)
+        source << "    c = c * u + vec4(" << i << ".0);\n";
+    source << "    gl_FragColor = c;\n"
+              "}\n";
+    std::string sourceString = source.str();
+    const char *sourceStrings[] = { sourceString.c_str() };
+
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    const ShShaderOutput outputs[] = { SH_GLSL_OUTPUT, SH_ESSL_OUTPUT, SH_HLSL11_OUTPUT };
+    for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); ++i)
+    {
+        ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                outputs[i], &resources);
+        ASSERT_TRUE(compiler != NULL);
+        ASSERT_TRUE(ShCompile(compiler, sourceStrings, 1, SH_OBJECT_CODE | SH_VARIABLES));
+
+        std::vector<std::string> chunks;
+        ShGetObjectCodeChunks(compiler, CollectChunk, &chunks);
+        EXPECT_GT(chunks.size(), 1u);
+
+        std::string joined;
+        for (size_t c = 0; c < chunks.size(); ++c)
+            joined += chunks[c];
+        EXPECT_EQ(ShGetObjectCodeLength(compiler), joined.size());
+        EXPECT_EQ(ShGetObjectCode(compiler), joined);
+
+        ShDestruct(compiler);
+    }
+}
@@ -0,0 +1,324 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PackUniforms_test.cpp:
+//   Tests that SH_PACK_UNIFORMS replaces the uniforms with an array of vec4s
+//   at the places that the packing rules give them.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+class PackUniformsTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShInitBuiltInResources(&mResources);
+        mResources.FragmentPrecisionHigh = 1;
+        mCompiler = NULL;
+    }
+
+    virtual void TearDown()
+    {
+        if (mCompiler)
+            ShDestruct(mCompiler);
+    }
+
+    std::string compile(GLenum shaderType, ShShaderSpec spec, ShShaderOutput output,
+                        const char *source, int compileOptions)
+    {
+        if (mCompiler)
+            ShDestruct(mCompiler);
+        mCompiler = ShConstructCompiler(shaderType, spec, output, &mResources);
+        if (!ShCompile(mCompiler, &source, 1, SH_OBJECT_CODE | SH_VARIABLES | compileOptions))
+        {
+            ADD_FAILURE() << ShGetInfoLog(mCompiler);
+            return "";
+        }
+        return ShGetObjectCode(mCompiler);
+    }
+
+    std::string compileGLSL(const char *source)
+    {
+        return compile(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, SH_GLSL_OUTPUT, source,
+                       SH_PACK_UNIFORMS);
+    }
+
+    void expectPlacement(const char *name, int row, int column, int rows)
+    {
+        ShVariablePlacement placement;
+        ASSERT_TRUE(ShGetPackedUniformPlacement(mCompiler, name, &placement)) << name;
+        EXPECT_EQ(row, placement.row) << name;
+        EXPECT_EQ(column, placement.column) << name;
+        EXPECT_EQ(rows, placement.rows) << name;
+    }
+
+    bool isPacked(const char *name)
+    {
+        ShVariablePlacement placement;
+        return ShGetPackedUniformPlacement(mCompiler, name, &placement);
+    }
+
+    ShBuiltInResources mResources;
+    ShHandle mCompiler;
+};
+
+TEST_F(PackUniformsTest, VectorsAndScalars)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 color;\n"
+        "uniform vec2 offset;\n"
+        "uniform float scale;\n"
+        "uniform bool flip;\n"
+        "uniform ivec2 counts;\n"
+        "void main() {\n"
+        "    vec2 p = offset * scale + float(counts.y);\n"
+        "    if (flip) p = -p;\n"
+        "    gl_FragColor = color + vec4(p, color[2], 0.0);\n"
+        "}\n";
+    EXPECT_EQ(
+        "uniform vec4 webgl_FragmentUniforms[5];\n"
+        "void main(){\n"
+        "vec2 p = ((webgl_FragmentUniforms[1].xy * webgl_FragmentUniforms[3].x) + "
+        "float(ivec2(webgl_FragmentUniforms[2].xy).y));\n"
+        "if (bool(webgl_FragmentUniforms[4].x))\n"
+        "(p = (-p));\n"
+        "(gl_FragColor = (webgl_FragmentUniforms[0] + vec4(p, webgl_FragmentUniforms[0][2], 0.0)));\n"
+        "}\n",
+        compileGLSL(source));
+
+    std::string name;
+    std::string mappedName;
+    int size = 0;
+    ASSERT_TRUE(ShGetPackedUniformArray(mCompiler, &name, &mappedName, &size));
+    EXPECT_EQ("webgl_FragmentUniforms", name);
+    EXPECT_EQ(name, mappedName);
+    EXPECT_EQ(5, size);
+
+    // Scalars go to the smallest gap of a column that they fit in.
+    expectPlacement("color", 0, 0, 1);
+    expectPlacement("offset", 1, 0, 1);
+    expectPlacement("counts", 2, 0, 1);
+    expectPlacement("scale", 3, 0, 1);
+    expectPlacement("flip", 4, 0, 1);
+
+    // The uniforms are still reported as they are declared.
+    const std::vector<sh::Uniform> *uniforms = ShGetUniforms(mCompiler);
+    ASSERT_TRUE(uniforms != NULL);
+    EXPECT_EQ(5u, uniforms->size());
+}
+
+TEST_F(PackUniformsTest, PlacementsMatchShPackVariables)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec3 a[2];\n"
+        "uniform float b[3];\n"
+        "uniform mat2 c;\n"
+        "uniform vec2 d;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(a[0] + a[1], b[0] + b[1] + b[2]) + c[0].xyxy + d.xyxy;\n"
+        "}\n";
+    compileGLSL(source);
+
+    ShVariableInfo variables[] = {
+        { GL_FLOAT_VEC3, 2 },
+        { GL_FLOAT, 3 },
+        { GL_FLOAT_MAT2, 1 },
+        { GL_FLOAT_VEC2, 1 },
+    };
+    const char *names[] = { "a", "b", "c", "d" };
+    ShVariablePlacement placements[4];
+    ASSERT_TRUE(ShPackVariables(mResources.MaxFragmentUniformVectors, variables, 4, placements));
+    for (int i = 0; i < 4; ++i)
+        expectPlacement(names[i], placements[i].row, placements[i].column, placements[i].rows);
+}
+
+TEST_F(PackUniformsTest, Matrices)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform mat3 rotation;\n"
+        "uniform mat2 m[2];\n"
+        "varying vec3 v;\n"
+        "void main() {\n"
+        "    vec3 r = rotation * v + rotation[1];\n"
+        "    vec2 s = m[1] * v.xy + m[0][1];\n"
+        "    gl_FragColor = vec4(r, s.x);\n"
+        "}\n";
+    EXPECT_EQ(
+        "uniform vec4 webgl_FragmentUniforms[7];\n"
+        "varying vec3 v;\n"
+        "void main(){\n"
+        "vec3 r = ((mat3(webgl_FragmentUniforms[4].xyz, webgl_FragmentUniforms[5].xyz, "
+        "webgl_FragmentUniforms[6].xyz) * v) + webgl_FragmentUniforms[5].xyz);\n"
+        "vec2 s = ((mat2(webgl_FragmentUniforms[2].xy, webgl_FragmentUniforms[3].xy) * v.xy) + "
+        "webgl_FragmentUniforms[1].xy);\n"
+        "(gl_FragColor = vec4(r, s.x));\n"
+        "}\n",
+        compileGLSL(source));
+
+    expectPlacement("m", 0, 0, 4);
+    expectPlacement("rotation", 4, 0, 3);
+}
+
+TEST_F(PackUniformsTest, DynamicIndices)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 colors[4];\n"
+        "uniform mat2 m[2];\n"
+        "uniform int i;\n"
+        "void main() {\n"
+        "    gl_FragColor = colors[i] + m[i][1].xyxy;\n"
+        "}\n";
+    EXPECT_EQ(
+        "uniform vec4 webgl_FragmentUniforms[9];\n"
+        "void main(){\n"
+        "(gl_FragColor = (webgl_FragmentUniforms[(int(webgl_FragmentUniforms[8].x) + 4)] + "
+        "webgl_FragmentUniforms[((int(webgl_FragmentUniforms[8].x) * 2) + 1)].xy.xyxy));\n"
+        "}\n",
+        compileGLSL(source));
+
+    // Indices that are marked for clamping are clamped to the uniform, as
+    // the packed array is larger.
+    std::string code = compile(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, SH_GLSL_OUTPUT, source,
+                               SH_PACK_UNIFORMS | SH_CLAMP_INDIRECT_ARRAY_BOUNDS);
+    EXPECT_NE(std::string::npos,
+              code.find("webgl_FragmentUniforms[(int(clamp(float(int(webgl_FragmentUniforms[8].x)), "
+                        "0.0, 3.0)) + 4)]"));
+    EXPECT_NE(std::string::npos,
+              code.find("webgl_FragmentUniforms[((int(clamp(float(int(webgl_FragmentUniforms[8].x)), "
+                        "0.0, 1.0)) * 2) + 1)]"));
+}
+
+TEST_F(PackUniformsTest, UnpackableUniformsAreKept)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "struct S { vec4 a; };\n"
+        "uniform S s;\n"
+        "uniform sampler2D tex;\n"
+        "uniform vec3 whole[2];\n"
+        "uniform mat3 rows[2];\n"
+        "uniform vec2 uv;\n"
+        "uniform int i;\n"
+        "vec3 sum(vec3 a[2]) { return a[0] + a[1]; }\n"
+        "void main() {\n"
+        "    gl_FragColor = s.a + texture2D(tex, uv) + vec4(sum(whole) + rows[i][0], 1.0);\n"
+        "}\n";
+    std::string code = compileGLSL(source);
+
+    // Arrays that are used as a whole, and matrix arrays whose elements are
+    // read whole with a dynamic index, are left as they are.
+    EXPECT_TRUE(isPacked("uv"));
+    EXPECT_TRUE(isPacked("i"));
+    EXPECT_TRUE(isPacked("rows"));
+    EXPECT_FALSE(isPacked("s"));
+    EXPECT_FALSE(isPacked("tex"));
+    EXPECT_FALSE(isPacked("whole"));
+    EXPECT_NE(std::string::npos, code.find("uniform S s;\n"));
+    EXPECT_NE(std::string::npos, code.find("uniform sampler2D tex;\n"));
+    EXPECT_NE(std::string::npos, code.find("uniform vec3 whole[2];\n"));
+
+    const char *wholeMatrix =
+        "precision mediump float;\n"
+        "uniform mat2 m[2];\n"
+        "uniform int i;\n"
+        "void main() {\n"
+        "    gl_FragColor = (m[i] * vec2(1.0)).xyxy;\n"
+        "}\n";
+    compileGLSL(wholeMatrix);
+    EXPECT_FALSE(isPacked("m"));
+    EXPECT_TRUE(isPacked("i"));
+
+    // The ints of ESSL 3.00 do not fit in floats.
+    const char *essl3 =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform int n;\n"
+        "uniform vec2 v;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = vec4(v, float(n), 0.0);\n"
+        "}\n";
+    compile(GL_FRAGMENT_SHADER, SH_GLES3_SPEC, SH_ESSL_OUTPUT, essl3, SH_PACK_UNIFORMS);
+    EXPECT_TRUE(isPacked("v"));
+    EXPECT_FALSE(isPacked("n"));
+}
+
+TEST_F(PackUniformsTest, VertexShader)
+{
+    const char *source =
+        "attribute vec4 position;\n"
+        "uniform mat4 mvp;\n"
+        "uniform float webgl_VertexUniforms;\n"
+        "void main() {\n"
+        "    gl_Position = mvp * position * webgl_VertexUniforms;\n"
+        "}\n";
+    std::string code = compile(GL_VERTEX_SHADER, SH_GLES2_SPEC, SH_ESSL_OUTPUT, source,
+                               SH_PACK_UNIFORMS);
+
+    // The array is highp in vertex shaders, and named apart from the
+    // other names of the shader.
+    EXPECT_NE(std::string::npos, code.find("uniform highp vec4 webgl_VertexUniforms1[5];\n"));
+    std::string name;
+    std::string mappedName;
+    int size = 0;
+    ASSERT_TRUE(ShGetPackedUniformArray(mCompiler, &name, &mappedName, &size));
+    EXPECT_EQ("webgl_VertexUniforms1", name);
+    EXPECT_EQ(5, size);
+    expectPlacement("webgl_VertexUniforms", 4, 0, 1);
+}
+
+TEST_F(PackUniformsTest, HLSLRegister)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform sampler2D tex;\n"
+        "uniform vec4 colors[2];\n"
+        "uniform float scale;\n"
+        "void main() {\n"
+        "    gl_FragColor = (colors[0] + colors[1]) * scale + texture2D(tex, vec2(0.5));\n"
+        "}\n";
+    std::string code = compile(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, SH_HLSL11_OUTPUT, source,
+                               SH_PACK_UNIFORMS);
+    EXPECT_NE(std::string::npos,
+              code.find("uniform float4 _webgl_FragmentUniforms[3] : register(c0);"));
+
+    unsigned int registerIndex = 1;
+    EXPECT_TRUE(ShGetUniformRegister(mCompiler, "webgl_FragmentUniforms", &registerIndex));
+    EXPECT_EQ(0u, registerIndex);
+}
+
+TEST_F(PackUniformsTest, TooManyUniforms)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 a[10];\n"
+        "uniform vec4 b[10];\n"
+        "void main() {\n"
+        "    gl_FragColor = a[0] + b[0];\n"
+        "}\n";
+    mResources.MaxFragmentUniformVectors = 16;
+    mCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, SH_GLSL_OUTPUT,
+                                    &mResources);
+    EXPECT_FALSE(ShCompile(mCompiler, &source, 1, SH_OBJECT_CODE | SH_PACK_UNIFORMS));
+    EXPECT_NE(std::string::npos, ShGetInfoLog(mCompiler).find("too many uniforms to pack"));
+
+    std::string name;
+    std::string mappedName;
+    int size = 0;
+    EXPECT_FALSE(ShGetPackedUniformArray(mCompiler, &name, &mappedName, &size));
+
+    // Without the option, the uniforms are not packed.
+    EXPECT_TRUE(ShCompile(mCompiler, &source, 1, SH_OBJECT_CODE));
+    EXPECT_NE(std::string::npos, ShGetObjectCode(mCompiler).find("uniform vec4 a[10];"));
+}
@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PassManager_test.cpp:
+//   Tests that passes fused into one walk by sh::PassManager see the same
+//   visits as when they traverse the tree alone.
+//
+
+#include <sstream>
+#include <string>
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+#include "compiler/translator/IntermNode.h"
+#include "compiler/translator/PassManager.h"
+#include "compiler/translator/PoolAlloc.h"
+
+namespace
+{
+
+// Logs each visit, with the depth and parent node at that point, to a
+// string owned by the caller, since traversers are pool-allocated and not
+// destroyed. Returns false from one chosen visit.
+class RecordingTraverser : public TIntermTraverser
+{
+  public:
+    RecordingTraverser(std::string *log, bool preVisit, bool inVisit, bool postVisit)
+        : TIntermTraverser(preVisit, inVisit, postVisit),
+          mLog(log),
+          mStopNode(NULL),
+          mStopVisit(PreVisit)
+    {
+    }
+
+    void stopAt(Visit visit, TIntermNode *node)
+    {
+        mStopVisit = visit;
+        mStopNode = node;
+    }
+
+    virtual void visitSymbol(TIntermSymbol *node) { record("symbol", PreVisit, node); }
+    virtual bool visitBinary(Visit visit, TIntermBinary *node) { return record("binary", visit, node); }
+    virtual bool visitUnary(Visit visit, TIntermUnary *node) { return record("unary", visit, node); }
+    virtual bool visitSelection(Visit visit, TIntermSelection *node) { return record("selection", visit, node); }
+    virtual bool visitAggregate(Visit visit, TIntermAggregate *node) { return record("aggregate", visit, node); }
+    virtual bool visitLoop(Visit visit, TIntermLoop *node) { return record("loop", visit, node); }
+    virtual bool visitBranch(Visit visit, TIntermBranch *node) { return record("branch", visit, node); }
+
+  private:
+    bool record(const char *kind, Visit visit, TIntermNode *node)
+    {
+        std::ostringstream entry;
+        entry << kind << " " << visit << " " << node << " depth " << mDepth << "/" << mMaxDepth
+              << " parent " << getParentNode() << "\n";
+        *mLog += entry.str();
+        return !(node == mStopNode && visit == mStopVisit);
+    }
+
+    std::string *mLog;
+    TIntermNode *mStopNode;
+    Visit mStopVisit;
+};
+
+}  // anonymous namespace
+
+class PassManagerTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        mAllocator.push();
+        mPreviousAllocator = GetGlobalPoolAllocator();
+        SetGlobalPoolAllocator(&mAllocator);
+        buildTree();
+    }
+
+    virtual void TearDown()
+    {
+        SetGlobalPoolAllocator(mPreviousAllocator);
+        mAllocator.pop();
+    }
+
+    TIntermSymbol *symbol(const char *name)
+    {
+        return new TIntermSymbol(0, name, TType(EbtFloat, 1));
+    }
+
+    // a + -b;
+    // if (c) { d; return e; } else discard;
+    // while (f) { g = h; i; }
+    // { j; k; l; }
+    void buildTree()
+    {
+        mRoot = new TIntermAggregate(EOpSequence);
+
+        mAdd = new TIntermBinary(EOpAdd);
+        TIntermUnary *negate = new TIntermUnary(EOpNegative);
+        negate->setOperand(symbol("b"));
+        mAdd->setLeft(symbol("a"));
+        mAdd->setRight(negate);
+        mRoot->getSequence()->push_back(mAdd);
+
+        TIntermAggregate *trueBlock = new TIntermAggregate(EOpSequence);
+        trueBlock->getSequence()->push_back(symbol("d"));
+        trueBlock->getSequence()->push_back(new TIntermBranch(EOpReturn, symbol("e")));
+        mSelection = new TIntermSelection(symbol("c"), trueBlock, new TIntermBranch(EOpKill, NULL));
+        mRoot->getSequence()->push_back(mSelection);
+
+        TIntermAggregate *body = new TIntermAggregate(EOpSequence);
+        TIntermBinary *assign = new TIntermBinary(EOpAssign);
+        assign->setLeft(symbol("g"));
+        assign->setRight(symbol("h"));
+        body->getSequence()->push_back(assign);
+        body->getSequence()->push_back(symbol("i"));
+        mRoot->getSequence()->push_back(new TIntermLoop(ELoopWhile, NULL, symbol("f"), NULL, body));
+
+        mBlock = new TIntermAggregate(EOpSequence);
+        mBlock->getSequence()->push_back(symbol("j"));
+        mBlock->getSequence()->push_back(symbol("k"));
+        mBlock->getSequence()->push_back(symbol("l"));
+        mRoot->getSequence()->push_back(mBlock);
+    }
+
+    TPoolAllocator mAllocator;
+    TPoolAllocator *mPreviousAllocator;
+    TIntermAggregate *mRoot;
+    TIntermBinary *mAdd;
+    TIntermSelection *mSelection;
+    TIntermAggregate *mBlock;
+};
+
+TEST_F(PassManagerTest, FusedPassesSeeTheirOwnTraversal)
+{
+    const int kPassCount = 6;
+    RecordingTraverser *alone[kPassCount];
+    RecordingTraverser *fused[kPassCount];
+    std::string aloneLogs[kPassCount];
+    std::string fusedLogs[kPassCount];
+    for (int run = 0; run < 2; ++run)
+    {
+        RecordingTraverser **passes = (run == 0) ? alone : fused;
+        std::string *logs = (run == 0) ? aloneLogs : fusedLogs;
+        passes[0] = new RecordingTraverser(&logs[0], true, false, false);
+        passes[1] = new RecordingTraverser(&logs[1], true, false, true);
+        passes[1]->stopAt(PreVisit, mSelection);
+        passes[2] = new RecordingTraverser(&logs[2], true, true, true);
+        passes[2]->stopAt(InVisit, mAdd);
+        passes[3] = new RecordingTraverser(&logs[3], false, true, true);
+        passes[3]->stopAt(InVisit, mBlock);
+        passes[4] = new RecordingTraverser(&logs[4], false, false, true);
+        passes[5] = new RecordingTraverser(&logs[5], true, true, false);
+        passes[5]->stopAt(PreVisit, mRoot);
+    }
+
+    for (int i = 0; i < kPassCount; ++i)
+        mRoot->traverse(alone[i]);
+
+    sh::PassManager passManager(mRoot, NULL);
+    for (int i = 0; i < kPassCount; ++i)
+        passManager.addReadOnlyPass(SH_COMPILE_PHASE_VALIDATE_LIMITATIONS, fused[i]);
+    passManager.flush();
+
+    for (int i = 0; i < kPassCount; ++i)
+    {
+        EXPECT_FALSE(aloneLogs[i].empty());
+        EXPECT_EQ(aloneLogs[i], fusedLogs[i]) << "pass " << i;
+    }
+}
+
+TEST_F(PassManagerTest, MutatingPassFlushesQueuedPasses)
+{
+    ShCompileStatistics statistics = {};
+    std::string readerLog;
+    std::string writerLog;
+    std::string laterReaderLog;
+    RecordingTraverser reader(&readerLog, true, false, false);
+    RecordingTraverser writer(&writerLog, true, false, false);
+    RecordingTraverser laterReader(&laterReaderLog, true, false, false);
+
+    sh::PassManager passManager(mRoot, &statistics);
+    passManager.addReadOnlyPass(SH_COMPILE_PHASE_DETECT_CALL_DEPTH, &reader);
+    passManager.runMutatingPass(SH_COMPILE_PHASE_SCALARIZE, &writer);
+    EXPECT_FALSE(readerLog.empty());
+    EXPECT_EQ(2u, statistics.treeWalks);
+
+    passManager.addReadOnlyPass(SH_COMPILE_PHASE_COLLECT_VARIABLES, &laterReader);
+    EXPECT_TRUE(laterReaderLog.empty());
+    passManager.flush();
+    EXPECT_EQ(readerLog, laterReaderLog);
+    EXPECT_EQ(3u, statistics.treeWalks);
+
+    EXPECT_GT(statistics.phaseVisits[SH_COMPILE_PHASE_DETECT_CALL_DEPTH], 0u);
+    EXPECT_EQ(0u, statistics.phaseVisits[SH_COMPILE_PHASE_SCALARIZE]);
+}
+
+class PassManagerCompileTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        mCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_WEBGL_SPEC,
+                                        SH_GLSL_OUTPUT, &resources);
+        ASSERT_TRUE(mCompiler != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        ShDestruct(mCompiler);
+    }
+
+    ShHandle mCompiler;
+};
+
+// The validation passes share a walk, and the markup passes share one with
+// the collection of variables.
+TEST_F(PassManagerCompileTest, ReadOnlyPassesShareWalks)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform vec4 u[4];\n"
+        "void main() {\n"
+        "    vec4 c = vec4(0.0);\n"
+        "    for (int i = 0; i < 4; ++i)\n"
+        "        c += u[i] * max(c.x, 0.5);\n"
+        "    gl_FragColor = c;\n"
+        "}\n";
+    const int kOptions = SH_OBJECT_CODE | SH_VARIABLES | SH_COMPILE_STATISTICS |
+                         SH_EMULATE_BUILT_IN_FUNCTIONS | SH_CLAMP_INDIRECT_ARRAY_BOUNDS |
+                         SH_UNROLL_FOR_LOOP_WITH_INTEGER_INDEX;
+
+    ASSERT_TRUE(ShCompile(mCompiler, &source, 1, kOptions)) << ShGetInfoLog(mCompiler);
+    ShCompileStatistics stats;
+    ASSERT_TRUE(ShGetCompileStatistics(mCompiler, &stats));
+    EXPECT_EQ(2u, stats.treeWalks);
+    EXPECT_GT(stats.phaseVisits[SH_COMPILE_PHASE_DETECT_CALL_DEPTH], 0u);
+    EXPECT_GT(stats.phaseVisits[SH_COMPILE_PHASE_VALIDATE_LIMITATIONS], 0u);
+    EXPECT_GT(stats.phaseVisits[SH_COMPILE_PHASE_UNROLL_MARKUP], 0u);
+    EXPECT_GT(stats.phaseVisits[SH_COMPILE_PHASE_EMULATION], 0u);
+    EXPECT_GT(stats.phaseVisits[SH_COMPILE_PHASE_COLLECT_VARIABLES], 0u);
+    std::string code = ShGetObjectCode(mCompiler);
+
+    // Unfolding short-circuiting operators modifies the tree, so variables
+    // are collected in a walk of their own.
+    ASSERT_TRUE(ShCompile(mCompiler, &source, 1, kOptions | SH_UNFOLD_SHORT_CIRCUIT));
+    ASSERT_TRUE(ShGetCompileStatistics(mCompiler, &stats));
+    EXPECT_EQ(4u, stats.treeWalks);
+    EXPECT_EQ(code, ShGetObjectCode(mCompiler));
+}
+
+// Only the errors of the first failing validation pass are reported.
+TEST_F(PassManagerCompileTest, ReportsFirstFailingValidation)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "float f(float x) { return f(x); }\n"
+        "void main() {\n"
+        "    for (int i = 0; i < int(u); ++i) {}\n"
+        "    gl_FragColor = vec4(f(u));\n"
+        "}\n";
+    EXPECT_FALSE(ShCompile(mCompiler, &source, 1, SH_OBJECT_CODE));
+    std::string log = ShGetInfoLog(mCompiler);
+    EXPECT_NE(std::string::npos, log.find("Function recursion detected"));
+    EXPECT_EQ(std::string::npos, log.find("Loop index"));
+
+    const char *loopSource =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "void main() {\n"
+        "    for (int i = 0; i < int(u); ++i) {}\n"
+        "    gl_FragColor = vec4(u);\n"
+        "}\n";
+    EXPECT_FALSE(ShCompile(mCompiler, &loopSource, 1, SH_OBJECT_CODE));
+    log = ShGetInfoLog(mCompiler);
+    EXPECT_NE(std::string::npos, log.find("Loop index"));
+}
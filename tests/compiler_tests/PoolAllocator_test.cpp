@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PoolAllocator_test.cpp:
+//   Tests for the page trimming and statistics of TPoolAllocator.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+#include "compiler/translator/PoolAlloc.h"
+
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+const size_t kPageSize = 8 * 1024;
+
+// Makes |pageCount| allocations that each need a page of their own.
+void FillPages(TPoolAllocator *allocator, size_t pageCount)
+{
+    for (size_t i = 0; i < pageCount; ++i)
+    {
+        ASSERT_TRUE(allocator->allocate(kPageSize / 2 + 1) != NULL);
+    }
+}
+
+}  // anonymous namespace
+
+TEST(PoolAllocatorTest, TrimsCachedPagesOnPop)
+{
+    TPoolAllocator allocator(kPageSize);
+    allocator.setMaxCachedPages(4);
+
+    allocator.push();
+    FillPages(&allocator, 20);
+
+    ShPoolAllocatorStats stats;
+    allocator.getStats(&stats);
+    EXPECT_EQ(kPageSize, stats.pageSize);
+    EXPECT_EQ(20u, stats.pagesInUse);
+    EXPECT_EQ(0u, stats.pagesCached);
+
+    allocator.pop();
+    allocator.getStats(&stats);
+    EXPECT_EQ(0u, stats.pagesInUse);
+    EXPECT_EQ(4u, stats.pagesCached);
+    EXPECT_EQ(20 * kPageSize, stats.peakBytes);
+
+    // Cached pages are reused before new ones are obtained.
+    allocator.push();
+    FillPages(&allocator, 2);
+    allocator.getStats(&stats);
+    EXPECT_EQ(2u, stats.pagesCached);
+    allocator.pop();
+
+    allocator.setMaxCachedPages(0);
+    allocator.getStats(&stats);
+    EXPECT_EQ(0u, stats.pagesCached);
+}
+
+TEST(PoolAllocatorTest, MultiPageAllocationsAreNotCached)
+{
+    TPoolAllocator allocator(kPageSize);
+
+    allocator.push();
+    ASSERT_TRUE(allocator.allocate(10 * kPageSize) != NULL);
+
+    ShPoolAllocatorStats stats;
+    allocator.getStats(&stats);
+    EXPECT_EQ(11u, stats.pagesInUse);
+
+    allocator.pop();
+    allocator.getStats(&stats);
+    EXPECT_EQ(0u, stats.pagesInUse);
+    EXPECT_EQ(0u, stats.pagesCached);
+    EXPECT_EQ(11 * kPageSize, stats.peakBytes);
+}
+
+TEST(PoolAllocatorTest, AllocationHistogram)
+{
+    TPoolAllocator allocator(kPageSize);
+    allocator.push();
+
+    allocator.allocate(1);
+    allocator.allocate(16);
+    allocator.allocate(17);
+    allocator.allocate(1024);
+    allocator.allocate(1025);
+    allocator.allocate(100000);
+
+    ShPoolAllocatorStats stats;
+    allocator.getStats(&stats);
+    EXPECT_EQ(6u, stats.allocationCount);
+    EXPECT_EQ(1u + 16u + 17u + 1024u + 1025u + 100000u, stats.allocatedBytes);
+    EXPECT_EQ(2u, stats.allocationSizeHistogram[0]);
+    EXPECT_EQ(1u, stats.allocationSizeHistogram[1]);
+    EXPECT_EQ(1u, stats.allocationSizeHistogram[6]);
+    EXPECT_EQ(2u, stats.allocationSizeHistogram[SH_POOL_ALLOCATION_HISTOGRAM_SIZE - 1]);
+
+    allocator.pop();
+}
+
+// A compiler that has compiled a large shader does not keep more than the
+// configured amount of memory afterwards.
+TEST(PoolAllocatorTest, CompilerReleasesPeakMemory)
+{
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_GLSL_OUTPUT, &resources);
+    ASSERT_TRUE(compiler != NULL);
+    ShSetPoolAllocatorMaxCachedBytes(compiler, 4 * kPageSize);
+
+    std::ostringstream source;
+    source << "precision mediump float;\n"
+              "uniform float u;\n"
+              "void main() {\n"
+              "    float f = u;\n";
+    for (int i = 0; i < 2000; ++i)
+    {
+        source << "    f = f * u + sin(f) * " << i << ".0;\n";
+    }
+    source << "    gl_FragColor = vec4(f);\n"
+              "}\n";
+    std::string sourceString = source.str();
+    const char *sourceStrings[] = { sourceString.c_str() };
+    EXPECT_TRUE(ShCompile(compiler, sourceStrings, 1, SH_OBJECT_CODE));
+
+    ShPoolAllocatorStats stats;
+    ASSERT_TRUE(ShGetPoolAllocatorStats(compiler, &stats));
+    EXPECT_GT(stats.peakBytes, 64 * kPageSize);
+    EXPECT_LE(stats.pagesCached, 4u);
+    EXPECT_GT(stats.allocationCount, 2000u);
+
+    ShDestruct(compiler);
+}
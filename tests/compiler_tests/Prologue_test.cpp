@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Prologue_test.cpp:
+//   Tests that compiling from a preprocessed prologue gives the results of
+//   compiling the prologue together with the shader.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+namespace
+{
+
+const char *kPrologue =
+    "#extension GL_OES_standard_derivatives : enable\n"
+    "#define SCALE 0.5\n"
+    "#define SHADE(c) ((c) * SCALE)\n"
+    "#pragma optimize(off)\n";
+
+}  // anonymous namespace
+
+class PrologueTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        resources.OES_standard_derivatives = 1;
+        mCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                        SH_GLSL_OUTPUT, &resources);
+        ASSERT_TRUE(mCompiler != NULL);
+        mPrologue = ShCreatePrologue(mCompiler, &kPrologue, 1);
+        ASSERT_TRUE(mPrologue != NULL) << ShGetInfoLog(mCompiler);
+    }
+
+    virtual void TearDown()
+    {
+        ShDestruct(mCompiler);
+        ShDestructPrologue(mPrologue);
+    }
+
+    ShHandle mCompiler;
+    ShPrologue mPrologue;
+};
+
+TEST_F(PrologueTest, MatchesConcatenatedSource)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "varying vec4 v;\n"
+        "void main() {\n"
+        "    gl_FragColor = SHADE(v) + dFdx(v);\n"
+        "}\n";
+    const int kOptions = SH_OBJECT_CODE | SH_VARIABLES;
+
+    const char *strings[] = { kPrologue, source };
+    ASSERT_TRUE(ShCompile(mCompiler, strings, 2, kOptions)) << ShGetInfoLog(mCompiler);
+    std::string concatenated = ShGetObjectCode(mCompiler);
+
+    ASSERT_TRUE(ShSetPrologue(mCompiler, mPrologue));
+    ASSERT_TRUE(ShCompile(mCompiler, &source, 1, kOptions)) << ShGetInfoLog(mCompiler);
+    EXPECT_EQ(concatenated, ShGetObjectCode(mCompiler));
+    EXPECT_NE(std::string::npos, concatenated.find("dFdx"));
+
+    // The shader can be compiled again from the same prologue.
+    ASSERT_TRUE(ShCompile(mCompiler, &source, 1, kOptions)) << ShGetInfoLog(mCompiler);
+    EXPECT_EQ(concatenated, ShGetObjectCode(mCompiler));
+
+    // Without the prologue, its macros and extensions are not defined.
+    ASSERT_TRUE(ShSetPrologue(mCompiler, NULL));
+    EXPECT_FALSE(ShCompile(mCompiler, &source, 1, kOptions));
+}
+
+TEST_F(PrologueTest, ErrorsInShaderKeepTheirLocation)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(undeclared);\n"
+        "}\n";
+    ASSERT_TRUE(ShSetPrologue(mCompiler, mPrologue));
+    EXPECT_FALSE(ShCompile(mCompiler, &source, 1, SH_OBJECT_CODE));
+    EXPECT_NE(std::string::npos, std::string(ShGetInfoLog(mCompiler)).find("0:3"));
+}
+
+TEST_F(PrologueTest, RejectsInvalidPrologues)
+{
+    const char *declaration = "#define FOO 1\nuniform float u;\n";
+    EXPECT_TRUE(ShCreatePrologue(mCompiler, &declaration, 1) == NULL);
+    EXPECT_NE(std::string::npos, std::string(ShGetInfoLog(mCompiler)).find("prologue"));
+
+    const char *unterminated = "#ifdef FOO\n";
+    EXPECT_TRUE(ShCreatePrologue(mCompiler, &unterminated, 1) == NULL);
+}
+
+TEST_F(PrologueTest, RequiresMatchingConfiguration)
+{
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    ShHandle other = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                         SH_GLSL_OUTPUT, &resources);
+    ShHandle otherOutput = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                               SH_ESSL_OUTPUT, &resources);
+    resources.OES_standard_derivatives = 1;
+    ShHandle essl = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                        SH_ESSL_OUTPUT, &resources);
+
+    EXPECT_FALSE(ShSetPrologue(other, mPrologue));
+    EXPECT_FALSE(ShSetPrologue(otherOutput, mPrologue));
+    // The output does not matter.
+    EXPECT_TRUE(ShSetPrologue(essl, mPrologue));
+
+    ShDestruct(other);
+    ShDestruct(otherOutput);
+    ShDestruct(essl);
+}
+
+// Cached translations depend on the prologue.
+TEST_F(PrologueTest, CachedTranslations)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "void main() {\n"
+        "#ifdef SCALE\n"
+        "    gl_FragColor = vec4(SCALE);\n"
+        "#else\n"
+        "    gl_FragColor = vec4(2.0);\n"
+        "#endif\n"
+        "}\n";
+    const int kOptions = SH_OBJECT_CODE | SH_CACHE_TRANSLATION;
+
+    ASSERT_TRUE(ShCompile(mCompiler, &source, 1, kOptions));
+    EXPECT_NE(std::string::npos, std::string(ShGetObjectCode(mCompiler)).find("2.0"));
+
+    ASSERT_TRUE(ShSetPrologue(mCompiler, mPrologue));
+    ASSERT_TRUE(ShCompile(mCompiler, &source, 1, kOptions));
+    EXPECT_NE(std::string::npos, std::string(ShGetObjectCode(mCompiler)).find("0.5"));
+}
@@ -0,0 +1,264 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// PruneDeadCode_test.cpp:
+//   Tests for the constant folding and dead code elimination pass enabled
+//   by SH_PRUNE_DEAD_CODE.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+class PruneDeadCodeTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShBuiltInResources resources;
+        ShInitBuiltInResources(&resources);
+        mGLSLCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_GLSL_OUTPUT, &resources);
+        mHLSLCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_HLSL11_OUTPUT, &resources);
+        ASSERT_TRUE(mGLSLCompiler != NULL && mHLSLCompiler != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        ShDestruct(mGLSLCompiler);
+        ShDestruct(mHLSLCompiler);
+    }
+
+    // Returns the GLSL translation of |source| with dead code pruned.
+    std::string compile(const char *source)
+    {
+        return compile(mGLSLCompiler, source, SH_OBJECT_CODE | SH_PRUNE_DEAD_CODE);
+    }
+
+    std::string compile(ShHandle compiler, const char *source, int compileOptions)
+    {
+        if (!ShCompile(compiler, &source, 1, compileOptions))
+        {
+            ADD_FAILURE() << ShGetInfoLog(compiler);
+            return "";
+        }
+        return ShGetObjectCode(compiler);
+    }
+
+    static bool contains(const std::string &code, const char *text)
+    {
+        return code.find(text) != std::string::npos;
+    }
+
+    ShHandle mGLSLCompiler;
+    ShHandle mHLSLCompiler;
+};
+
+TEST_F(PruneDeadCodeTest, RemovesUncalledFunctions)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "float unused(float x);\n"
+        "float helper(float x) { return x * 0.5; }\n"
+        "float used(float x) { return helper(x) + 0.25; }\n"
+        "float unused(float x) { return used(x) * 3.0; }\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(used(gl_FragCoord.x));\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_TRUE(contains(code, "helper"));
+    EXPECT_TRUE(contains(code, "used("));
+    EXPECT_FALSE(contains(code, "unused"));
+
+    // Without the option the code is kept.
+    code = compile(mGLSLCompiler, source, SH_OBJECT_CODE);
+    EXPECT_TRUE(contains(code, "unused"));
+}
+
+TEST_F(PruneDeadCodeTest, PropagatesConstantVariables)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "float globalScale = 2.0;\n"
+        "void main() {\n"
+        "    float scale = globalScale * 4.0;\n"
+        "    float written = 1.0;\n"
+        "    if (u > 0.0) written = u;\n"
+        "    gl_FragColor = vec4(scale * 0.5, written, 0.0, 1.0);\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_FALSE(contains(code, "globalScale"));
+    EXPECT_FALSE(contains(code, "scale"));
+    EXPECT_TRUE(contains(code, "4.0"));
+    // Variables that are assigned after their declaration are kept.
+    EXPECT_TRUE(contains(code, "written = 1.0"));
+}
+
+TEST_F(PruneDeadCodeTest, PrunesConstantBranches)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "void main() {\n"
+        "    bool enabled = false;\n"
+        "    int count = 2;\n"
+        "    float color = 0.5;\n"
+        "    if (enabled || count > 3) {\n"
+        "        color = sin(u);\n"
+        "    }\n"
+        "    float ternary = (count == 2) ? u : cos(u);\n"
+        "    bool dynamic = u > 1.0;\n"
+        "    if (dynamic && true) {\n"
+        "        color += 1.0;\n"
+        "    }\n"
+        "    gl_FragColor = vec4(color, ternary, 0.0, 1.0);\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_FALSE(contains(code, "sin("));
+    EXPECT_FALSE(contains(code, "cos("));
+    EXPECT_FALSE(contains(code, "enabled"));
+    EXPECT_FALSE(contains(code, "count"));
+    EXPECT_TRUE(contains(code, "if (dynamic)"));
+}
+
+TEST_F(PruneDeadCodeTest, RemovesUnreachableStatements)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "float f(float x) {\n"
+        "    return x;\n"
+        "    x = sin(x);\n"
+        "}\n"
+        "void main() {\n"
+        "    float unusedValue = cos(u);\n"
+        "    for (int i = 0; false; ++i) {\n"
+        "        gl_FragColor = vec4(tan(u));\n"
+        "    }\n"
+        "    while (1 > 2) {\n"
+        "        gl_FragColor = vec4(atan(u));\n"
+        "    }\n"
+        "    u * 2.0;\n"
+        "    gl_FragColor = vec4(f(u));\n"
+        "    if (true) {\n"
+        "        return;\n"
+        "    }\n"
+        "    gl_FragColor = vec4(acos(u));\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_FALSE(contains(code, "sin("));
+    EXPECT_FALSE(contains(code, "cos("));
+    EXPECT_FALSE(contains(code, "tan("));
+    EXPECT_FALSE(contains(code, "acos("));
+    EXPECT_FALSE(contains(code, "for ("));
+    EXPECT_FALSE(contains(code, "while ("));
+    EXPECT_FALSE(contains(code, "2.0"));
+}
+
+TEST_F(PruneDeadCodeTest, KeepsSideEffects)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "float counter = 0.0;\n"
+        "bool increment() { counter += 1.0; return true; }\n"
+        "void main() {\n"
+        "    bool unusedResult = increment();\n"
+        "    bool b = increment() || false;\n"
+        "    for (int i = 0; i < 2; ++i) {\n"
+        "        counter += u;\n"
+        "    }\n"
+        "    float zero = 0.0;\n"
+        "    float divided = 1.0 / zero;\n"
+        "    gl_FragColor = vec4(counter, b ? 1.0 : 0.0, divided, 1.0);\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_TRUE(contains(code, "unusedResult = increment()"));
+    EXPECT_TRUE(contains(code, "b = (increment() || false)"));
+    EXPECT_TRUE(contains(code, "for ("));
+    EXPECT_TRUE(contains(code, "counter"));
+    // Folding a division by zero is left to the driver.
+    EXPECT_TRUE(contains(code, "divided = (1.0 / 0.0)"));
+}
+
+// The component lists of swizzles are sequences, but not statements.
+TEST_F(PruneDeadCodeTest, KeepsSwizzles)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "void main() {\n"
+        "    vec4 c = vec4(u);\n"
+        "    c.x += 1.0;\n"
+        "    c.yz = vec2(2.0);\n"
+        "    gl_FragColor = c.wzyx;\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_TRUE(contains(code, "c.x += 1.0"));
+    EXPECT_TRUE(contains(code, "c.yz = vec2(2.0, 2.0)"));
+    EXPECT_TRUE(contains(code, "c.wzyx"));
+}
+
+// Writes to variables that are never read are removed, together with the
+// computation of the values written if it has no side effects.
+TEST_F(PruneDeadCodeTest, RemovesWritesToUnreadVariables)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "float counter = 0.0;\n"
+        "float scale(float x) { float y = x * u; return y * y; }\n"
+        "float count(float x) { counter += 1.0; return x; }\n"
+        "void main() {\n"
+        "    float unread = scale(u);\n"
+        "    unread += exp(u);\n"
+        "    vec3 unreadVector;\n"
+        "    unreadVector.x = count(u);\n"
+        "    unreadVector.yz = vec2(sin(u));\n"
+        "    gl_FragColor = vec4(counter);\n"
+        "}\n";
+
+    std::string code = compile(source);
+    EXPECT_FALSE(contains(code, "unread"));
+    EXPECT_FALSE(contains(code, "scale"));
+    EXPECT_FALSE(contains(code, "exp("));
+    EXPECT_FALSE(contains(code, "sin("));
+    // The call that writes to a global is kept.
+    EXPECT_TRUE(contains(code, "count(u)"));
+}
+
+TEST_F(PruneDeadCodeTest, ReducesHLSLOutput)
+{
+    const char *source =
+        "precision mediump float;\n"
+        "uniform float u;\n"
+        "const bool kUseFog = false;\n"
+        "vec4 fog(vec4 c) { return mix(c, vec4(0.5), exp(-u)); }\n"
+        "vec4 unusedLighting(vec4 c) { return c * dot(c.xyz, vec3(u)); }\n"
+        "void main() {\n"
+        "    vec4 color = vec4(u);\n"
+        "    bool useFog = kUseFog;\n"
+        "    if (useFog) color = fog(color);\n"
+        "    gl_FragColor = color;\n"
+        "}\n";
+
+    std::string unpruned = compile(mHLSLCompiler, source, SH_OBJECT_CODE | SH_VARIABLES);
+    std::string pruned = compile(mHLSLCompiler, source,
+                                 SH_OBJECT_CODE | SH_VARIABLES | SH_PRUNE_DEAD_CODE);
+    EXPECT_TRUE(contains(unpruned, "unusedLighting"));
+    EXPECT_FALSE(contains(pruned, "unusedLighting"));
+    EXPECT_FALSE(contains(pruned, "fog"));
+    EXPECT_LT(pruned.size(), unpruned.size());
+}
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// SerializeTree_test.cpp:
+//   Tests that DeserializeTree rejects trees that are nested too deeply or
+//   that have nodes the parser would not have created.
+//
+
+#include "gtest/gtest.h"
+#include "compiler/translator/IntermNode.h"
+#include "compiler/translator/PoolAlloc.h"
+#include "compiler/translator/SerializeTree.h"
+#include "compiler/translator/TranslationCache.h"
+#include "compiler/translator/TypeTable.h"
+
+#include <string>
+
+namespace
+{
+
+// The kinds of node that SerializeTree writes.
+const int kNullNode = 0;
+const int kLoopNode = 8;
+
+}  // anonymous namespace
+
+class SerializeTreeTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        mAllocator.push();
+        mPreviousAllocator = GetGlobalPoolAllocator();
+        SetGlobalPoolAllocator(&mAllocator);
+
+        mTypeTable = new TTypeTable;
+        SetGlobalTypeTable(mTypeTable);
+    }
+
+    virtual void TearDown()
+    {
+        SetGlobalTypeTable(NULL);
+        delete mTypeTable;
+        SetGlobalPoolAllocator(mPreviousAllocator);
+        mAllocator.pop();
+    }
+
+    TIntermSymbol *symbol(const TType &type)
+    {
+        return new TIntermSymbol(0, "s", type);
+    }
+
+    TIntermTyped *binary(TOperator op, TIntermTyped *left, TIntermTyped *right)
+    {
+        TIntermBinary *node = new TIntermBinary(op);
+        node->setLeft(left);
+        node->setRight(right);
+        node->setType(left->getType());
+        return node;
+    }
+
+    TIntermConstantUnion *intConstant(int value, const TType &type)
+    {
+        ConstantUnion *unionArray = new ConstantUnion[1];
+        unionArray->setIConst(value);
+        return new TIntermConstantUnion(unionArray, type);
+    }
+
+    // Writes |root| and reads it back.
+    TIntermNode *roundTrip(TIntermNode *root)
+    {
+        BlobWriter writer;
+        if (!sh::SerializeTree(root, &writer))
+            return NULL;
+        BlobReader reader(writer.data());
+        return sh::DeserializeTree(&reader);
+    }
+
+    // Reads the nodes in |nodes|, with no strings or types.
+    TIntermNode *readNodes(const std::string &nodes)
+    {
+        BlobWriter writer;
+        writer.writeVarInt(0);
+        writer.writeString("");
+        writer.writeVarInt(0);
+        writer.writeString("");
+        writer.writeString(nodes);
+        BlobReader reader(writer.data());
+        return sh::DeserializeTree(&reader);
+    }
+
+    // Returns |count| for loops, each in the initializer of the previous one.
+    std::string nestedLoops(int count)
+    {
+        BlobWriter nodes;
+        for (int i = 0; i < count; ++i)
+        {
+            nodes.writeVarInt(kLoopNode);
+            for (int j = 0; j < 4; ++j)
+                nodes.writeVarInt(0);
+            nodes.writeVarInt(ELoopFor);
+            nodes.writeVarInt(0);
+        }
+        // The initializer of the innermost loop, then the condition,
+        // expression and body of each loop.
+        nodes.writeVarInt(kNullNode);
+        for (int i = 0; i < count * 3; ++i)
+            nodes.writeVarInt(kNullNode);
+        return nodes.data();
+    }
+
+    TPoolAllocator mAllocator;
+    TPoolAllocator *mPreviousAllocator;
+    TTypeTable *mTypeTable;
+};
+
+TEST_F(SerializeTreeTest, ReadsValidNodes)
+{
+    TType vec4(EbtFloat, EbpMedium, EvqTemporary, 4);
+    TIntermTyped *sum = binary(EOpAdd, symbol(vec4), symbol(vec4));
+    TIntermNode *read = roundTrip(sum);
+    ASSERT_TRUE(read != NULL);
+    ASSERT_TRUE(read->getAsBinaryNode() != NULL);
+    EXPECT_EQ(EOpAdd, read->getAsBinaryNode()->getOp());
+
+    TType intType(EbtInt, EbpHigh, EvqConst);
+    TIntermTyped *element = binary(EOpIndexDirect, symbol(vec4), intConstant(3, intType));
+    EXPECT_TRUE(roundTrip(element) != NULL);
+
+    // The missing initializer of the innermost loop counts as a level too.
+    EXPECT_TRUE(readNodes(nestedLoops(sh::kMaxSerializedTreeDepth - 1)) != NULL);
+}
+
+TEST_F(SerializeTreeTest, RejectsDeepTrees)
+{
+    // Without the limit, reading these would overflow the stack.
+    EXPECT_TRUE(readNodes(nestedLoops(sh::kMaxSerializedTreeDepth)) == NULL);
+    EXPECT_TRUE(readNodes(nestedLoops(200000)) == NULL);
+
+    // Trees the reader would reject are not written.
+    TType vec4(EbtFloat, EbpMedium, EvqTemporary, 4);
+    TIntermTyped *node = symbol(vec4);
+    for (int i = 0; i < sh::kMaxSerializedTreeDepth; ++i)
+    {
+        TIntermUnary *negative = new TIntermUnary(EOpNegative, vec4);
+        negative->setOperand(node);
+        node = negative;
+    }
+    BlobWriter writer;
+    EXPECT_FALSE(sh::SerializeTree(node, &writer));
+    EXPECT_TRUE(writer.data().empty());
+}
+
+TEST_F(SerializeTreeTest, RejectsInvalidOperators)
+{
+    TType vec4(EbtFloat, EbpMedium, EvqTemporary, 4);
+
+    // A unary operator in a binary node.
+    EXPECT_TRUE(roundTrip(binary(EOpNegative, symbol(vec4), symbol(vec4))) == NULL);
+
+    // A binary operator in a unary node.
+    TIntermUnary *unary = new TIntermUnary(EOpAdd, vec4);
+    unary->setOperand(symbol(vec4));
+    EXPECT_TRUE(roundTrip(unary) == NULL);
+
+    // A branch that is not a jump.
+    EXPECT_TRUE(roundTrip(new TIntermBranch(EOpAdd, NULL)) == NULL);
+    EXPECT_TRUE(roundTrip(new TIntermBranch(EOpBreak, symbol(vec4))) == NULL);
+}
+
+TEST_F(SerializeTreeTest, RejectsInvalidOperands)
+{
+    TType vec4(EbtFloat, EbpMedium, EvqTemporary, 4);
+    TType intType(EbtInt, EbpHigh, EvqConst);
+
+    // A field of a value that is not a structure.
+    EXPECT_TRUE(roundTrip(binary(EOpIndexDirectStruct, symbol(vec4),
+                                 intConstant(0, intType))) == NULL);
+    // Indices out of range.
+    TIntermTyped *past = binary(EOpIndexDirect, symbol(vec4), intConstant(4, intType));
+    EXPECT_TRUE(roundTrip(past) == NULL);
+    TIntermTyped *negative = binary(EOpIndexDirect, symbol(vec4), intConstant(-1, intType));
+    EXPECT_TRUE(roundTrip(negative) == NULL);
+
+    // Arithmetic on samplers.
+    TType sampler(EbtSampler2D, EbpLow, EvqUniform);
+    EXPECT_TRUE(roundTrip(binary(EOpAdd, symbol(sampler), symbol(sampler))) == NULL);
+
+    // A condition that is not a boolean.
+    TIntermSelection *selection = new TIntermSelection(symbol(vec4), NULL, NULL);
+    EXPECT_TRUE(roundTrip(selection) == NULL);
+}
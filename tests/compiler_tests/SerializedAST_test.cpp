@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// SerializedAST_test.cpp:
+//   Tests that translating a serialized AST gives the results of compiling
+//   the shader it was created from.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+
+#include <string>
+
+namespace
+{
+
+const char *kFragmentShader =
+    "#extension GL_OES_standard_derivatives : enable\n"
+    "precision mediump float;\n"
+    "struct Light { vec3 direction; vec4 color[2]; };\n"
+    "uniform Light light;\n"
+    "uniform sampler2D tex;\n"
+    "varying vec3 normal;\n"
+    "varying vec2 uv;\n"
+    "const float kScale = 0.5;\n"
+    "vec4 shade(Light l, vec3 n) {\n"
+    "    return l.color[0] * max(dot(n, l.direction), 0.0) + l.color[1];\n"
+    "}\n"
+    "void main() {\n"
+    "    vec4 sum = vec4(0.0);\n"
+    "    for (int i = 0; i < 4; ++i) {\n"
+    "        sum += texture2D(tex, uv * float(i) * kScale);\n"
+    "    }\n"
+    "    Light copy = Light(light.direction, light.color);\n"
+    "    gl_FragColor = sum * shade(copy, normalize(normal)) + dFdx(sum);\n"
+    "}\n";
+
+}  // anonymous namespace
+
+class SerializedASTTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShInitBuiltInResources(&mResources);
+        mResources.OES_standard_derivatives = 1;
+    }
+
+    // Validates |source| with an ESSL compiler, without translating it, and
+    // returns its AST.
+    std::string serialize(GLenum type, ShShaderSpec spec, const char *source)
+    {
+        ShHandle compiler = ShConstructCompiler(type, spec, SH_ESSL_OUTPUT, &mResources);
+        std::string serializedAST;
+        if (ShCompile(compiler, &source, 1, SH_SERIALIZE_AST))
+            serializedAST = ShGetSerializedAST(compiler);
+        else
+            ADD_FAILURE() << ShGetInfoLog(compiler);
+        ShDestruct(compiler);
+        return serializedAST;
+    }
+
+    // Checks that the results of translating the AST of |source| match
+    // those of compiling it, for |output| and |compileOptions|.
+    void expectSameResults(GLenum type, ShShaderSpec spec, ShShaderOutput output,
+                           const char *source, int compileOptions)
+    {
+        std::string serializedAST = serialize(type, spec, source);
+        ShHandle compiled = ShConstructCompiler(type, spec, output, &mResources);
+        ShHandle translated = ShConstructCompiler(type, spec, output, &mResources);
+
+        ASSERT_TRUE(ShCompile(compiled, &source, 1, compileOptions))
+            << ShGetInfoLog(compiled);
+        ASSERT_TRUE(ShCompileSerializedAST(translated, serializedAST.data(),
+                                           serializedAST.size(), compileOptions))
+            << ShGetInfoLog(translated);
+        EXPECT_EQ(ShGetObjectCode(compiled), ShGetObjectCode(translated));
+        EXPECT_EQ(ShGetUniforms(compiled)->size(), ShGetUniforms(translated)->size());
+        EXPECT_EQ(ShGetVaryings(compiled)->size(), ShGetVaryings(translated)->size());
+        EXPECT_EQ(ShGetInterfaceBlocks(compiled)->size(),
+                  ShGetInterfaceBlocks(translated)->size());
+
+        ShDestruct(compiled);
+        ShDestruct(translated);
+    }
+
+    ShBuiltInResources mResources;
+};
+
+TEST_F(SerializedASTTest, MatchesCompiledOutput)
+{
+    const int kOptions = SH_OBJECT_CODE | SH_VARIABLES;
+    expectSameResults(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, SH_GLSL_OUTPUT,
+                      kFragmentShader, kOptions);
+    expectSameResults(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, SH_ESSL_OUTPUT,
+                      kFragmentShader, kOptions);
+    // The options of the translation apply to the AST.
+    expectSameResults(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, SH_ESSL_OUTPUT,
+                      kFragmentShader, kOptions | SH_EMULATE_BUILT_IN_FUNCTIONS |
+                      SH_UNFOLD_SHORT_CIRCUIT | SH_ELIMINATE_COMMON_SUBEXPRESSIONS);
+}
+
+TEST_F(SerializedASTTest, KeepsInvariance)
+{
+    const char *source =
+        "#pragma STDGL invariant(all)\n"
+        "attribute vec4 position;\n"
+        "varying vec4 color;\n"
+        "void main() {\n"
+        "    color = position * 0.5;\n"
+        "    gl_Position = position;\n"
+        "}\n";
+    expectSameResults(GL_VERTEX_SHADER, SH_GLES2_SPEC, SH_GLSL_OUTPUT, source,
+                      SH_OBJECT_CODE | SH_VARIABLES);
+
+    const char *declaration =
+        "attribute vec4 position;\n"
+        "varying vec4 color;\n"
+        "invariant color;\n"
+        "void main() {\n"
+        "    color = position * 0.5;\n"
+        "    gl_Position = position;\n"
+        "}\n";
+    expectSameResults(GL_VERTEX_SHADER, SH_GLES2_SPEC, SH_ESSL_OUTPUT, declaration,
+                      SH_OBJECT_CODE | SH_VARIABLES);
+}
+
+TEST_F(SerializedASTTest, InterfaceBlocks)
+{
+    const char *source =
+        "#version 300 es\n"
+        "precision mediump float;\n"
+        "uniform Material { vec4 albedo; mat3 basis; };\n"
+        "uniform Lights { vec4 colors[4]; } lights;\n"
+        "in vec3 normal;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = albedo * lights.colors[1] + vec4(basis * normal, 0.0);\n"
+        "}\n";
+    // Only the HLSL output supports interface blocks.
+    expectSameResults(GL_FRAGMENT_SHADER, SH_GLES3_SPEC, SH_HLSL11_OUTPUT, source,
+                      SH_OBJECT_CODE | SH_VARIABLES);
+}
+
+TEST_F(SerializedASTTest, InvalidShadersHaveNoAST)
+{
+    ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_ESSL_OUTPUT, &mResources);
+    ASSERT_TRUE(ShCompile(compiler, &kFragmentShader, 1, SH_OBJECT_CODE | SH_SERIALIZE_AST));
+    EXPECT_FALSE(ShGetSerializedAST(compiler).empty());
+
+    const char *invalid = "void main() { gl_FragColor = undeclared; }\n";
+    EXPECT_FALSE(ShCompile(compiler, &invalid, 1, SH_OBJECT_CODE | SH_SERIALIZE_AST));
+    EXPECT_TRUE(ShGetSerializedAST(compiler).empty());
+
+    // Without the option there is no AST either.
+    ASSERT_TRUE(ShCompile(compiler, &kFragmentShader, 1, SH_OBJECT_CODE));
+    EXPECT_TRUE(ShGetSerializedAST(compiler).empty());
+    ShDestruct(compiler);
+}
+
+TEST_F(SerializedASTTest, RejectsOtherConfigurations)
+{
+    std::string serializedAST = serialize(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, kFragmentShader);
+
+    ShHandle vertexCompiler = ShConstructCompiler(GL_VERTEX_SHADER, SH_GLES2_SPEC,
+                                                  SH_GLSL_OUTPUT, &mResources);
+    EXPECT_FALSE(ShCompileSerializedAST(vertexCompiler, serializedAST.data(),
+                                        serializedAST.size(), SH_OBJECT_CODE));
+    EXPECT_NE(std::string::npos, ShGetInfoLog(vertexCompiler).find("serialized AST"));
+    EXPECT_TRUE(ShGetObjectCode(vertexCompiler).empty());
+    ShDestruct(vertexCompiler);
+
+    mResources.MaxDrawBuffers = 4;
+    ShHandle otherResources = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                  SH_GLSL_OUTPUT, &mResources);
+    EXPECT_FALSE(ShCompileSerializedAST(otherResources, serializedAST.data(),
+                                        serializedAST.size(), SH_OBJECT_CODE));
+    ShDestruct(otherResources);
+}
+
+TEST_F(SerializedASTTest, RejectsInvalidData)
+{
+    std::string serializedAST = serialize(GL_FRAGMENT_SHADER, SH_GLES2_SPEC, kFragmentShader);
+    ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_GLSL_OUTPUT, &mResources);
+
+    // Every truncation of the data is rejected.
+    for (size_t length = 0; length < serializedAST.size(); ++length)
+    {
+        EXPECT_FALSE(ShCompileSerializedAST(compiler, serializedAST.data(), length,
+                                            SH_OBJECT_CODE)) << length;
+    }
+
+    // So is every change of a byte.
+    for (size_t i = 0; i < serializedAST.size(); ++i)
+    {
+        std::string corrupted = serializedAST;
+        corrupted[i] = static_cast<char>(corrupted[i] ^ 0x5a);
+        EXPECT_FALSE(ShCompileSerializedAST(compiler, corrupted.data(), corrupted.size(),
+                                            SH_OBJECT_CODE)) << i;
+    }
+
+    ASSERT_TRUE(ShCompileSerializedAST(compiler, serializedAST.data(), serializedAST.size(),
+                                       SH_OBJECT_CODE)) << ShGetInfoLog(compiler);
+    ShDestruct(compiler);
+}
+
+TEST_F(SerializedASTTest, LinksVaryings)
+{
+    const char *vertexSource =
+        "attribute vec4 position;\n"
+        "varying vec2 uv;\n"
+        "varying vec3 unused;\n"
+        "void main() {\n"
+        "    uv = position.xy;\n"
+        "    unused = normalize(position.xyz);\n"
+        "    gl_Position = position;\n"
+        "}\n";
+    const char *fragmentSource =
+        "precision mediump float;\n"
+        "varying vec2 uv;\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(uv, 0.0, 1.0);\n"
+        "}\n";
+    std::string serializedAST = serialize(GL_VERTEX_SHADER, SH_GLES2_SPEC, vertexSource);
+
+    ShHandle vertexCompiler = ShConstructCompiler(GL_VERTEX_SHADER, SH_GLES2_SPEC,
+                                                  SH_GLSL_OUTPUT, &mResources);
+    ShHandle fragmentCompiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                    SH_GLSL_OUTPUT, &mResources);
+    const int kOptions = SH_OBJECT_CODE | SH_VARIABLES;
+    ASSERT_TRUE(ShCompileSerializedAST(vertexCompiler, serializedAST.data(),
+                                       serializedAST.size(), kOptions));
+    ASSERT_TRUE(ShCompile(fragmentCompiler, &fragmentSource, 1, kOptions));
+    EXPECT_NE(std::string::npos, ShGetObjectCode(vertexCompiler).find("unused"));
+
+    ASSERT_TRUE(ShLinkVaryings(vertexCompiler, fragmentCompiler));
+    EXPECT_EQ(std::string::npos, ShGetObjectCode(vertexCompiler).find("unused"));
+    EXPECT_NE(std::string::npos, ShGetObjectCode(vertexCompiler).find("uv"));
+
+    ShDestruct(vertexCompiler);
+    ShDestruct(fragmentCompiler);
+}
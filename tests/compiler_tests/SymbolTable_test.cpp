@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// SymbolTable_test.cpp:
+//   Tests for symbol lookup in TSymbolTable.
+//
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "compiler/translator/PoolAlloc.h"
+#include "compiler/translator/SymbolTable.h"
+
+class SymbolTableTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        mAllocator.push();
+        mPreviousAllocator = GetGlobalPoolAllocator();
+        SetGlobalPoolAllocator(&mAllocator);
+
+        mSymbolTable = new TSymbolTable;
+        mSymbolTable->push();   // COMMON_BUILTINS
+        mSymbolTable->push();   // ESSL1_BUILTINS
+        mSymbolTable->push();   // ESSL3_BUILTINS
+    }
+
+    virtual void TearDown()
+    {
+        delete mSymbolTable;
+        SetGlobalPoolAllocator(mPreviousAllocator);
+        mAllocator.pop();
+    }
+
+    TVariable *insertVariable(ESymbolLevel level, const char *name)
+    {
+        TVariable *variable = new TVariable(NewPoolTString(name), TType(EbtFloat, 1));
+        if (!mSymbolTable->insert(level, variable))
+        {
+            delete variable;
+            return NULL;
+        }
+        return variable;
+    }
+
+    TPoolAllocator mAllocator;
+    TPoolAllocator *mPreviousAllocator;
+    TSymbolTable *mSymbolTable;
+};
+
+TEST_F(SymbolTableTest, InnermostScopeWins)
+{
+    TVariable *builtIn = insertVariable(COMMON_BUILTINS, "x");
+    mSymbolTable->push();   // GLOBAL_LEVEL
+    TVariable *global = insertVariable(GLOBAL_LEVEL, "x");
+    mSymbolTable->push();
+    ASSERT_TRUE(builtIn != NULL && global != NULL);
+
+    bool builtInFound = true;
+    bool sameScope = true;
+    EXPECT_EQ(global, mSymbolTable->find("x", 100, &builtInFound, &sameScope));
+    EXPECT_FALSE(builtInFound);
+    EXPECT_FALSE(sameScope);
+    EXPECT_EQ(builtIn, mSymbolTable->findBuiltIn("x", 100));
+
+    mSymbolTable->pop();
+    mSymbolTable->pop();
+    EXPECT_EQ(builtIn, mSymbolTable->find("x", 100, &builtInFound, &sameScope));
+    EXPECT_TRUE(builtInFound);
+}
+
+TEST_F(SymbolTableTest, DuplicateInsertFails)
+{
+    mSymbolTable->push();
+    EXPECT_TRUE(insertVariable(GLOBAL_LEVEL, "dup") != NULL);
+    EXPECT_TRUE(insertVariable(GLOBAL_LEVEL, "dup") == NULL);
+    mSymbolTable->pop();
+}
+
+TEST_F(SymbolTableTest, ShaderVersionFiltersBuiltInLevels)
+{
+    TVariable *essl1 = insertVariable(ESSL1_BUILTINS, "v");
+    TVariable *essl3 = insertVariable(ESSL3_BUILTINS, "v");
+    mSymbolTable->push();
+
+    EXPECT_EQ(essl1, mSymbolTable->find("v", 100));
+    EXPECT_EQ(essl3, mSymbolTable->find("v", 300));
+    EXPECT_EQ(essl1, mSymbolTable->findBuiltIn("v", 100));
+    EXPECT_EQ(essl3, mSymbolTable->findBuiltIn("v", 300));
+
+    mSymbolTable->pop();
+}
+
+TEST_F(SymbolTableTest, ManySymbols)
+{
+    mSymbolTable->push();
+    const int kSymbolCount = 5000;
+    std::vector<TVariable *> variables;
+    for (int i = 0; i < kSymbolCount; ++i)
+    {
+        std::ostringstream name;
+        name << "symbol" << i;
+        variables.push_back(insertVariable(GLOBAL_LEVEL, name.str().c_str()));
+        ASSERT_TRUE(variables.back() != NULL);
+    }
+    for (int i = 0; i < kSymbolCount; ++i)
+    {
+        std::ostringstream name;
+        name << "symbol" << i;
+        EXPECT_EQ(variables[i], mSymbolTable->find(name.str().c_str(), 100));
+    }
+    EXPECT_TRUE(mSymbolTable->find("symbol", 100) == NULL);
+    mSymbolTable->pop();
+}
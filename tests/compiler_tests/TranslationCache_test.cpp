@@ -0,0 +1,255 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TranslationCache_test.cpp:
+//   Tests for the translation cache used with SH_CACHE_TRANSLATION.
+//
+
+#include "angle_gl.h"
+#include "gtest/gtest.h"
+#include "GLSLANG/ShaderLang.h"
+#include "compiler/translator/TranslationCache.h"
+
+#include <stdio.h>
+#include <map>
+
+namespace
+{
+
+// Backend that keeps "persisted" entries in a map.
+class MapBackend : public TranslationCacheBackend
+{
+  public:
+    MapBackend(std::map<std::string, std::string> *entries)
+        : mEntries(entries)
+    {
+    }
+
+    virtual bool load(const std::string &hash, std::string *entry)
+    {
+        std::map<std::string, std::string>::const_iterator it = mEntries->find(hash);
+        if (it == mEntries->end())
+            return false;
+        *entry = it->second;
+        return true;
+    }
+
+    virtual void store(const std::string &hash, const std::string &entry)
+    {
+        (*mEntries)[hash] = entry;
+    }
+
+  private:
+    std::map<std::string, std::string> *mEntries;
+};
+
+const char kFragmentShader[] =
+    "precision mediump float;\n"
+    "uniform vec4 color;\n"
+    "varying vec2 texCoord;\n"
+    "void main() {\n"
+    "    gl_FragColor = color * texCoord.x;\n"
+    "}\n";
+
+const char kInvalidFragmentShader[] =
+    "precision mediump float;\n"
+    "void main() {\n"
+    "    gl_FragColor = 1;\n"
+    "}\n";
+
+}  // anonymous namespace
+
+class TranslationCacheTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ShInitBuiltInResources(&mResources);
+        ShClearTranslationCache();
+    }
+
+    virtual void TearDown()
+    {
+        ShClearTranslationCache();
+        GetTranslationCache()->setBackend(NULL);
+    }
+
+    bool compile(const char *source, ShShaderOutput output, int compileOptions,
+                 std::string *objectCode, std::string *infoLog,
+                 std::vector<sh::Uniform> *uniforms)
+    {
+        ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                                output, &mResources);
+        bool success = ShCompile(compiler, &source, 1, compileOptions);
+        *objectCode = ShGetObjectCode(compiler);
+        *infoLog = ShGetInfoLog(compiler);
+        *uniforms = *ShGetUniforms(compiler);
+        ShDestruct(compiler);
+        return success;
+    }
+
+    ShBuiltInResources mResources;
+};
+
+// A second compilation of the same shader is served from the cache and
+// produces the same results.
+TEST_F(TranslationCacheTest, HitRestoresResults)
+{
+    const int compileOptions = SH_OBJECT_CODE | SH_VARIABLES | SH_CACHE_TRANSLATION;
+
+    std::string objectCode, infoLog;
+    std::vector<sh::Uniform> uniforms;
+    ASSERT_TRUE(compile(kFragmentShader, SH_GLSL_OUTPUT, compileOptions,
+                        &objectCode, &infoLog, &uniforms));
+    EXPECT_EQ(1u, GetTranslationCache()->getEntryCount());
+
+    std::string cachedObjectCode, cachedInfoLog;
+    std::vector<sh::Uniform> cachedUniforms;
+    ASSERT_TRUE(compile(kFragmentShader, SH_GLSL_OUTPUT, compileOptions,
+                        &cachedObjectCode, &cachedInfoLog, &cachedUniforms));
+    EXPECT_EQ(1u, GetTranslationCache()->getEntryCount());
+
+    EXPECT_NE(std::string::npos, objectCode.find("gl_FragColor"));
+    EXPECT_EQ(objectCode, cachedObjectCode);
+    EXPECT_EQ(infoLog, cachedInfoLog);
+    ASSERT_EQ(1u, cachedUniforms.size());
+    EXPECT_TRUE(uniforms[0] == cachedUniforms[0]);
+}
+
+// Failed compilations are cached with their info log.
+TEST_F(TranslationCacheTest, HitRestoresFailure)
+{
+    const int compileOptions = SH_OBJECT_CODE | SH_CACHE_TRANSLATION;
+
+    std::string objectCode, infoLog;
+    std::vector<sh::Uniform> uniforms;
+    EXPECT_FALSE(compile(kInvalidFragmentShader, SH_GLSL_OUTPUT, compileOptions,
+                         &objectCode, &infoLog, &uniforms));
+    EXPECT_NE(std::string::npos, infoLog.find("ERROR"));
+
+    std::string cachedObjectCode, cachedInfoLog;
+    EXPECT_FALSE(compile(kInvalidFragmentShader, SH_GLSL_OUTPUT, compileOptions,
+                         &cachedObjectCode, &cachedInfoLog, &uniforms));
+    EXPECT_EQ(infoLog, cachedInfoLog);
+    EXPECT_EQ(1u, GetTranslationCache()->getEntryCount());
+}
+
+// Options, output and resources are part of the key.
+TEST_F(TranslationCacheTest, DifferentConfigurationsMiss)
+{
+    std::string objectCode, infoLog;
+    std::vector<sh::Uniform> uniforms;
+
+    compile(kFragmentShader, SH_GLSL_OUTPUT, SH_OBJECT_CODE | SH_CACHE_TRANSLATION,
+            &objectCode, &infoLog, &uniforms);
+    compile(kFragmentShader, SH_ESSL_OUTPUT, SH_OBJECT_CODE | SH_CACHE_TRANSLATION,
+            &objectCode, &infoLog, &uniforms);
+    compile(kFragmentShader, SH_GLSL_OUTPUT,
+            SH_OBJECT_CODE | SH_VARIABLES | SH_CACHE_TRANSLATION,
+            &objectCode, &infoLog, &uniforms);
+    mResources.MaxDrawBuffers = 4;
+    compile(kFragmentShader, SH_GLSL_OUTPUT, SH_OBJECT_CODE | SH_CACHE_TRANSLATION,
+            &objectCode, &infoLog, &uniforms);
+
+    EXPECT_EQ(4u, GetTranslationCache()->getEntryCount());
+
+    // Without the option the cache is not touched.
+    ShClearTranslationCache();
+    compile(kFragmentShader, SH_GLSL_OUTPUT, SH_OBJECT_CODE,
+            &objectCode, &infoLog, &uniforms);
+    EXPECT_EQ(0u, GetTranslationCache()->getEntryCount());
+}
+
+// The least recently used entries are evicted to stay within the size limit.
+TEST_F(TranslationCacheTest, EvictsLeastRecentlyUsed)
+{
+    TranslationCache cache;
+    const std::string results(100, 'r');
+    cache.setMaxSize(3 * (results.size() + 1));
+
+    std::string found;
+    cache.insert("a", false, results);
+    cache.insert("b", false, results);
+    cache.insert("c", false, results);
+    EXPECT_EQ(3u, cache.getEntryCount());
+
+    EXPECT_TRUE(cache.lookup("a", false, &found));
+    cache.insert("d", false, results);
+    EXPECT_EQ(3u, cache.getEntryCount());
+    EXPECT_TRUE(cache.lookup("a", false, &found));
+    EXPECT_FALSE(cache.lookup("b", false, &found));
+    EXPECT_TRUE(cache.lookup("c", false, &found));
+    EXPECT_TRUE(cache.lookup("d", false, &found));
+
+    cache.setMaxSize(0);
+    EXPECT_EQ(0u, cache.getEntryCount());
+    EXPECT_EQ(0u, cache.getSize());
+}
+
+// Entries survive clearing the in-memory cache when a backend is set.
+TEST_F(TranslationCacheTest, BackendPersistsEntries)
+{
+    std::map<std::string, std::string> persisted;
+    TranslationCache cache;
+    cache.setBackend(new MapBackend(&persisted));
+
+    cache.insert("key", true, "results");
+    cache.insert("volatile", false, "results");
+    EXPECT_EQ(1u, persisted.size());
+
+    cache.clear();
+    std::string found;
+    EXPECT_TRUE(cache.lookup("key", true, &found));
+    EXPECT_EQ("results", found);
+    EXPECT_EQ(1u, cache.getEntryCount());
+    EXPECT_FALSE(cache.lookup("volatile", true, &found));
+
+    // A persisted entry stored under the same hash for another key is not
+    // returned.
+    std::string entry = persisted.begin()->second;
+    cache.clear();
+    persisted.begin()->second = entry.replace(entry.find("key"), 3, "kez");
+    EXPECT_FALSE(cache.lookup("key", true, &found));
+}
+
+TEST_F(TranslationCacheTest, DirectoryBackendRoundTrip)
+{
+    DirectoryTranslationCacheBackend backend(".");
+    std::string entry;
+
+    EXPECT_FALSE(backend.load("TranslationCacheTest", &entry));
+    backend.store("TranslationCacheTest", std::string("entry\0data", 10));
+    EXPECT_TRUE(backend.load("TranslationCacheTest", &entry));
+    EXPECT_EQ(std::string("entry\0data", 10), entry);
+
+    // Truncated files are rejected.
+    FILE *file = fopen("./TranslationCacheTest.shcache", "wb");
+    ASSERT_TRUE(file != NULL);
+    fwrite("ANGLE", 1, 5, file);
+    fclose(file);
+    EXPECT_FALSE(backend.load("TranslationCacheTest", &entry));
+
+    remove("./TranslationCacheTest.shcache");
+}
+
+TEST(BlobTest, RoundTrip)
+{
+    BlobWriter writer;
+    writer.writeInt(-5);
+    writer.writeString("angle");
+    writer.writeInt(0x12345678);
+
+    BlobReader reader(writer.data());
+    EXPECT_EQ(-5, reader.readInt());
+    std::string value;
+    reader.readString(&value);
+    EXPECT_EQ("angle", value);
+    EXPECT_EQ(0x12345678, reader.readInt());
+    EXPECT_TRUE(reader.endOfData());
+    EXPECT_FALSE(reader.error());
+
+    reader.readInt();
+    EXPECT_TRUE(reader.error());
+}
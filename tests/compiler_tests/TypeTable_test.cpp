@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TypeTable_test.cpp:
+//   Tests that AST nodes share their types through TTypeTable, and that
+//   changing the type of a node does not affect other nodes.
+//
+
+#include "gtest/gtest.h"
+#include "compiler/translator/IntermNode.h"
+#include "compiler/translator/PoolAlloc.h"
+#include "compiler/translator/TypeTable.h"
+
+class TypeTableTest : public testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        mAllocator.push();
+        mPreviousAllocator = GetGlobalPoolAllocator();
+        SetGlobalPoolAllocator(&mAllocator);
+
+        mTypeTable = new TTypeTable;
+        SetGlobalTypeTable(mTypeTable);
+    }
+
+    virtual void TearDown()
+    {
+        SetGlobalTypeTable(NULL);
+        delete mTypeTable;
+        SetGlobalPoolAllocator(mPreviousAllocator);
+        mAllocator.pop();
+    }
+
+    TIntermSymbol *symbol(const TType &type)
+    {
+        return new TIntermSymbol(0, "s", type);
+    }
+
+    TPoolAllocator mAllocator;
+    TPoolAllocator *mPreviousAllocator;
+    TTypeTable *mTypeTable;
+};
+
+TEST_F(TypeTableTest, EqualTypesAreShared)
+{
+    TIntermSymbol *a = symbol(TType(EbtFloat, EbpMedium, EvqTemporary, 4));
+    TIntermSymbol *b = symbol(TType(EbtFloat, EbpMedium, EvqTemporary, 4));
+    TIntermSymbol *highp = symbol(TType(EbtFloat, EbpHigh, EvqTemporary, 4));
+    TIntermSymbol *uniform = symbol(TType(EbtFloat, EbpMedium, EvqUniform, 4));
+    TIntermSymbol *matrix = symbol(TType(EbtFloat, EbpMedium, EvqTemporary, 4, 4));
+
+    EXPECT_EQ(&a->getType(), &b->getType());
+    EXPECT_NE(&a->getType(), &highp->getType());
+    EXPECT_NE(&a->getType(), &uniform->getType());
+    EXPECT_NE(&a->getType(), &matrix->getType());
+    EXPECT_EQ(4u, mTypeTable->size());
+
+    b->setType(matrix->getType());
+    EXPECT_EQ(&matrix->getType(), &b->getType());
+    EXPECT_EQ(4u, mTypeTable->size());
+}
+
+TEST_F(TypeTableTest, ModifyingCopiesTheType)
+{
+    TIntermSymbol *a = symbol(TType(EbtFloat, EbpMedium, EvqTemporary, 3));
+    TIntermSymbol *b = symbol(TType(EbtFloat, EbpMedium, EvqTemporary, 3));
+
+    b->setQualifier(EvqConst);
+    EXPECT_EQ(EvqTemporary, a->getQualifier());
+    EXPECT_EQ(EvqConst, b->getQualifier());
+
+    b->setPrecision(EbpLow);
+    EXPECT_EQ(EbpMedium, a->getPrecision());
+    EXPECT_EQ(EbpLow, b->getPrecision());
+
+    b->setQualifier(EvqTemporary);
+    b->setPrecision(EbpMedium);
+    EXPECT_EQ(&a->getType(), &b->getType());
+    EXPECT_EQ("vf3;", a->getType().getMangledName());
+}
+
+TEST_F(TypeTableTest, ManyTypes)
+{
+    const int kArraySizeCount = 200;
+    TIntermSymbol *symbols[kArraySizeCount];
+    for (int i = 0; i < kArraySizeCount; ++i)
+    {
+        TType type(EbtInt, EbpHigh, EvqUniform);
+        type.setArraySize(i + 1);
+        symbols[i] = symbol(type);
+    }
+    EXPECT_EQ(static_cast<size_t>(kArraySizeCount), mTypeTable->size());
+    for (int i = 0; i < kArraySizeCount; ++i)
+    {
+        TType type(EbtInt, EbpHigh, EvqUniform);
+        type.setArraySize(i + 1);
+        EXPECT_EQ(&symbols[i]->getType(), &symbol(type)->getType());
+        EXPECT_EQ(i + 1, symbols[i]->getArraySize());
+    }
+}
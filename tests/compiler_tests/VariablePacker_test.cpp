@@ -170,3 +170,59 @@ TEST(VariablePacking, NonSquareMats) {
     EXPECT_FALSE(packer.CheckVariablesWithinPackingLimits(squareSize, vars));
   }
 }
+
+// Check that the placements returned with the packing cover each variable
+// once, without overlapping each other.
+TEST(VariablePacking, Placements) {
+  const int kMaxRows = 16;
+  std::vector<sh::ShaderVariable> vars;
+  vars.push_back(sh::ShaderVariable(GL_FLOAT_VEC4, 0));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT_MAT3, 0));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT_MAT3, 0));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT_VEC2, 6));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT_VEC2, 4));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT_VEC2, 0));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT, 3));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT, 2));
+  vars.push_back(sh::ShaderVariable(GL_FLOAT, 0));
+
+  VariablePacker packer;
+  std::vector<ShVariablePlacement> placements;
+  ASSERT_TRUE(packer.PackVariables(kMaxRows, vars, &placements));
+  ASSERT_EQ(vars.size(), placements.size());
+
+  // The vectors are placed in the order of the spec's example, and the
+  // array that does not fit in columns 0 and 1 goes to the bottom of
+  // columns 2 and 3.
+  EXPECT_EQ(0, placements[0].row);
+  EXPECT_EQ(1, placements[1].row);
+  EXPECT_EQ(4, placements[2].row);
+  EXPECT_EQ(7, placements[3].row);
+  EXPECT_EQ(0, placements[3].column);
+  EXPECT_EQ(12, placements[4].row);
+  EXPECT_EQ(2, placements[4].column);
+  EXPECT_EQ(13, placements[5].row);
+  EXPECT_EQ(0, placements[5].column);
+
+  bool used[kMaxRows][4] = {};
+  for (size_t ii = 0; ii < vars.size(); ++ii) {
+    const ShVariablePlacement &placement = placements[ii];
+    int components = VariablePacker::GetNumComponentsPerRow(vars[ii].type);
+    EXPECT_EQ(VariablePacker::GetNumRows(vars[ii].type) * static_cast<int>(vars[ii].elementCount()),
+              placement.rows);
+    ASSERT_LE(0, placement.row);
+    ASSERT_LE(placement.row + placement.rows, kMaxRows);
+    ASSERT_LE(placement.column + components, 4);
+    for (int row = placement.row; row < placement.row + placement.rows; ++row) {
+      for (int column = placement.column; column < placement.column + components; ++column) {
+        EXPECT_FALSE(used[row][column]) << "row " << row << ", column " << column;
+        used[row][column] = true;
+      }
+    }
+  }
+
+  // Without room for them, no placements are returned.
+  placements.clear();
+  EXPECT_FALSE(packer.PackVariables(kMaxRows - 4, vars, &placements));
+  EXPECT_TRUE(placements.empty());
+}
@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "gtest/gtest.h"
+#include "libGLESv2/renderer/copyimage.h"
+#include "libGLESv2/renderer/imageformats.h"
+
+using namespace rx;
+
+namespace
+{
+
+TEST(CopyImageTest, CopyBGRA8ToRGBA8)
+{
+    uint32_t random = 0x2545F491;
+    for (int i = 0; i < 1000; i++)
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+
+        uint8_t source[4];
+        memcpy(source, &random, sizeof(source));
+
+        uint8_t dest[4];
+        CopyBGRA8ToRGBA8(source, dest);
+
+        EXPECT_EQ(source[2], dest[0]);
+        EXPECT_EQ(source[1], dest[1]);
+        EXPECT_EQ(source[0], dest[2]);
+        EXPECT_EQ(source[3], dest[3]);
+    }
+}
+
+// Normalized 8-bit channels survive a trip through floating point, so
+// copying between the two orders only moves bytes.
+TEST(CopyImageTest, CopyPixelR8G8B8A8ToB8G8R8A8)
+{
+    for (unsigned int value = 0; value < 256; value++)
+    {
+        uint8_t source[4] = { static_cast<uint8_t>(value), static_cast<uint8_t>(255 - value),
+                              static_cast<uint8_t>(value ^ 0x5A), static_cast<uint8_t>(value / 2) };
+        uint8_t dest[4];
+        CopyPixel<R8G8B8A8, B8G8R8A8, GLfloat>(source, dest);
+
+        EXPECT_EQ(source[2], dest[0]) << value;
+        EXPECT_EQ(source[1], dest[1]) << value;
+        EXPECT_EQ(source[0], dest[2]) << value;
+        EXPECT_EQ(source[3], dest[3]) << value;
+    }
+}
+
+TEST(CopyImageTest, ReadColorR5G6B5)
+{
+    for (unsigned int value = 0; value < 0x10000; value += 7)
+    {
+        uint16_t source = static_cast<uint16_t>(value);
+        gl::ColorF color;
+        ReadColor<R5G6B5, GLfloat>(reinterpret_cast<const uint8_t*>(&source), reinterpret_cast<uint8_t*>(&color));
+
+        EXPECT_NEAR(((value >> 11) & 0x1F) / 31.0f, color.red, 1e-6f) << value;
+        EXPECT_NEAR(((value >> 5) & 0x3F) / 63.0f, color.green, 1e-6f) << value;
+        EXPECT_NEAR((value & 0x1F) / 31.0f, color.blue, 1e-6f) << value;
+        EXPECT_EQ(1.0f, color.alpha) << value;
+    }
+}
+
+// Writing a color that was read from a format gives back the same bits.
+TEST(CopyImageTest, WriteColorR5G6B5RoundTrips)
+{
+    for (unsigned int value = 0; value < 0x10000; value++)
+    {
+        uint16_t source = static_cast<uint16_t>(value);
+        uint16_t dest = 0;
+        CopyPixel<R5G6B5, R5G6B5, GLfloat>(reinterpret_cast<const uint8_t*>(&source), reinterpret_cast<uint8_t*>(&dest));
+        ASSERT_EQ(source, dest);
+    }
+}
+
+}
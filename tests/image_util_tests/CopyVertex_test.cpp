@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "gtest/gtest.h"
+#include "libGLESv2/renderer/copyvertex.h"
+
+#include <vector>
+
+using namespace rx;
+
+namespace
+{
+
+// Three GLushort components in a stride of 8 bytes, widened to four with an
+// alpha of 1.
+TEST(CopyVertexTest, CopyNativeVertexDataAddsAlpha)
+{
+    const GLushort input[] = { 1, 2, 3, 0xFFFF,   4, 5, 6, 0xFFFF,   7, 8, 9, 0xFFFF };
+    GLushort output[12];
+
+    CopyNativeVertexData<GLushort, 3, 4, 1>(reinterpret_cast<const uint8_t*>(input), 8, 3,
+                                            reinterpret_cast<uint8_t*>(output));
+
+    const GLushort expected[] = { 1, 2, 3, 1,   4, 5, 6, 1,   7, 8, 9, 1 };
+    for (size_t i = 0; i < ArraySize(expected); i++)
+    {
+        EXPECT_EQ(expected[i], output[i]) << i;
+    }
+}
+
+TEST(CopyVertexTest, CopyNativeVertexDataPacked)
+{
+    const GLfloat input[] = { 1.0f, -2.0f, 3.5f, 0.25f, 5.0f, -6.0f };
+    GLfloat output[6];
+
+    CopyNativeVertexData<GLfloat, 2, 2, 0>(reinterpret_cast<const uint8_t*>(input), 8, 3,
+                                           reinterpret_cast<uint8_t*>(output));
+
+    for (size_t i = 0; i < ArraySize(input); i++)
+    {
+        EXPECT_EQ(input[i], output[i]) << i;
+    }
+}
+
+TEST(CopyVertexTest, UnsignedNormalizedToFloat)
+{
+    std::vector<GLubyte> input(256);
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        input[i] = static_cast<GLubyte>(i);
+    }
+    std::vector<GLfloat> output(input.size());
+
+    CopyTo32FVertexData<GLubyte, 4, 4, true>(&input[0], 4, input.size() / 4, reinterpret_cast<uint8_t*>(&output[0]));
+
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        EXPECT_NEAR(i / 255.0f, output[i], 1e-6f) << i;
+    }
+}
+
+// Signed normalized values map [-128, 127] onto [-1, 1] with (2c + 1) / 255,
+// as in ES 2.0.
+TEST(CopyVertexTest, SignedNormalizedToFloat)
+{
+    std::vector<GLbyte> input(256);
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        input[i] = static_cast<GLbyte>(static_cast<int>(i) - 128);
+    }
+    std::vector<GLfloat> output(input.size());
+
+    CopyTo32FVertexData<GLbyte, 2, 2, true>(reinterpret_cast<const uint8_t*>(&input[0]), 2, input.size() / 2,
+                                            reinterpret_cast<uint8_t*>(&output[0]));
+
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        EXPECT_NEAR((2.0f * input[i] + 1.0f) / 255.0f, output[i], 1e-6f) << i;
+    }
+    EXPECT_EQ(-1.0f, output[0]);
+    EXPECT_EQ(1.0f, output[255]);
+}
+
+TEST(CopyVertexTest, Snorm8ToSnorm16)
+{
+    std::vector<GLbyte> input(256);
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        input[i] = static_cast<GLbyte>(static_cast<int>(i) - 128);
+    }
+    std::vector<GLshort> output(input.size());
+
+    Copy8SnormTo16SnormVertexData<4, 4>(reinterpret_cast<const uint8_t*>(&input[0]), 4, input.size() / 4,
+                                        reinterpret_cast<uint8_t*>(&output[0]));
+
+    EXPECT_EQ(-32768, output[0]);
+    EXPECT_EQ(0, output[128]);
+    EXPECT_EQ(32767, output[255]);
+    for (size_t i = 129; i < input.size(); i++)
+    {
+        // Positive values are scaled by 32767 / 127, to within one.
+        float scaled = input[i] * 32767.0f / 127.0f;
+        EXPECT_NEAR(scaled, output[i], 1.0f) << i;
+    }
+}
+
+TEST(CopyVertexTest, FixedToFloat)
+{
+    const GLfixed input[] = { 0x00010000, 0x00018000, -0x00020000, 0x00000001 };
+    GLfloat output[4];
+
+    Copy32FixedTo32FVertexData<4, 4>(reinterpret_cast<const uint8_t*>(input), 16, 1, reinterpret_cast<uint8_t*>(output));
+
+    EXPECT_EQ(1.0f, output[0]);
+    EXPECT_EQ(1.5f, output[1]);
+    EXPECT_EQ(-2.0f, output[2]);
+    EXPECT_EQ(1.0f / 65536.0f, output[3]);
+}
+
+}
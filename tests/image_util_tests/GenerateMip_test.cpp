@@ -0,0 +1,473 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "gtest/gtest.h"
+#include "libGLESv2/renderer/generatemip.h"
+
+#include <string.h>
+#include <vector>
+
+using namespace rx;
+
+namespace
+{
+
+// The reference averages of two channels: rounded down for integers.
+uint8_t AverageChannel(uint8_t a, uint8_t b)
+{
+    return static_cast<uint8_t>((static_cast<unsigned int>(a) + b) / 2);
+}
+
+uint16_t AverageChannel(uint16_t a, uint16_t b)
+{
+    return static_cast<uint16_t>((static_cast<unsigned int>(a) + b) / 2);
+}
+
+float AverageChannel(float a, float b)
+{
+    return (a + b) * 0.5f;
+}
+
+uint8_t RandomChannel(uint32_t random, uint8_t) { return static_cast<uint8_t>(random >> 24); }
+uint16_t RandomChannel(uint32_t random, uint16_t) { return static_cast<uint16_t>(random >> 16); }
+float RandomChannel(uint32_t random, float) { return static_cast<float>(random >> 8) / (1 << 24); }
+
+struct Extents
+{
+    size_t width;
+    size_t height;
+    size_t depth;
+};
+
+// Sizes that reduce along every combination of axes, some of them odd, in
+// which case the last row, column or slice is dropped.
+const Extents sourceExtents[] =
+{
+    { 5, 1, 1 },
+    { 1, 6, 1 },
+    { 8, 6, 1 },
+    { 7, 5, 1 },
+    { 1, 1, 4 },
+    { 6, 1, 4 },
+    { 1, 4, 6 },
+    { 4, 6, 3 },
+    { 9, 7, 5 },
+};
+
+// An image of |channelCount| channels of |Channel| per pixel, with its rows
+// padded by |rowPadding| bytes.
+template <typename Channel, size_t channelCount>
+class Image
+{
+  public:
+    Image(size_t width, size_t height, size_t depth, size_t rowPadding)
+        : mWidth(width),
+          mHeight(height),
+          mDepth(depth),
+          mRowPitch(width * sizeof(Channel) * channelCount + rowPadding),
+          mDepthPitch(mRowPitch * height),
+          mData(mDepthPitch * depth, 0xCD)
+    {
+    }
+
+    Channel channel(size_t x, size_t y, size_t z, size_t c) const
+    {
+        Channel value;
+        memcpy(&value, &mData[offset(x, y, z, c)], sizeof(Channel));
+        return value;
+    }
+
+    void setChannel(size_t x, size_t y, size_t z, size_t c, Channel value)
+    {
+        memcpy(&mData[offset(x, y, z, c)], &value, sizeof(Channel));
+    }
+
+    size_t width() const { return mWidth; }
+    size_t height() const { return mHeight; }
+    size_t depth() const { return mDepth; }
+    size_t rowPitch() const { return mRowPitch; }
+    size_t depthPitch() const { return mDepthPitch; }
+    const std::vector<uint8_t> &data() const { return mData; }
+    std::vector<uint8_t> &data() { return mData; }
+
+  private:
+    size_t offset(size_t x, size_t y, size_t z, size_t c) const
+    {
+        return z * mDepthPitch + y * mRowPitch + (x * channelCount + c) * sizeof(Channel);
+    }
+
+    size_t mWidth;
+    size_t mHeight;
+    size_t mDepth;
+    size_t mRowPitch;
+    size_t mDepthPitch;
+    std::vector<uint8_t> mData;
+};
+
+// Averages the up to eight source pixels of each destination pixel, first
+// along Z, then along Y, then along X, which is the order in which integer
+// averages round.
+template <typename Channel, size_t channelCount>
+void ReferenceMip(const Image<Channel, channelCount> &source, Image<Channel, channelCount> *dest)
+{
+    size_t xSamples = (source.width() > 1) ? 2 : 1;
+    size_t ySamples = (source.height() > 1) ? 2 : 1;
+    size_t zSamples = (source.depth() > 1) ? 2 : 1;
+
+    for (size_t z = 0; z < dest->depth(); z++)
+    {
+        for (size_t y = 0; y < dest->height(); y++)
+        {
+            for (size_t x = 0; x < dest->width(); x++)
+            {
+                for (size_t c = 0; c < channelCount; c++)
+                {
+                    Channel alongY[2];
+                    for (size_t dx = 0; dx < xSamples; dx++)
+                    {
+                        Channel alongZ[2];
+                        for (size_t dy = 0; dy < ySamples; dy++)
+                        {
+                            alongZ[dy] = source.channel(x * 2 + dx, y * 2 + dy, z * 2, c);
+                            if (zSamples == 2)
+                            {
+                                alongZ[dy] = AverageChannel(alongZ[dy], source.channel(x * 2 + dx, y * 2 + dy, z * 2 + 1, c));
+                            }
+                        }
+                        alongY[dx] = (ySamples == 2) ? AverageChannel(alongZ[0], alongZ[1]) : alongZ[0];
+                    }
+                    dest->setChannel(x, y, z, c, (xSamples == 2) ? AverageChannel(alongY[0], alongY[1]) : alongY[0]);
+                }
+            }
+        }
+    }
+}
+
+template <typename T, typename Channel, size_t channelCount>
+void CheckGenerateMip()
+{
+    META_ASSERT(sizeof(T) == sizeof(Channel) * channelCount);
+
+    uint32_t random = 0x2545F491;
+
+    for (size_t e = 0; e < ArraySize(sourceExtents); e++)
+    {
+        const Extents &extents = sourceExtents[e];
+        for (size_t rowPadding = 0; rowPadding <= 4; rowPadding += 4)
+        {
+            Image<Channel, channelCount> source(extents.width, extents.height, extents.depth, rowPadding);
+            for (size_t z = 0; z < source.depth(); z++)
+            {
+                for (size_t y = 0; y < source.height(); y++)
+                {
+                    for (size_t x = 0; x < source.width(); x++)
+                    {
+                        for (size_t c = 0; c < channelCount; c++)
+                        {
+                            random ^= random << 13;
+                            random ^= random >> 17;
+                            random ^= random << 5;
+                            source.setChannel(x, y, z, c, RandomChannel(random, Channel()));
+                        }
+                    }
+                }
+            }
+
+            size_t mipWidth = std::max<size_t>(1, extents.width / 2);
+            size_t mipHeight = std::max<size_t>(1, extents.height / 2);
+            size_t mipDepth = std::max<size_t>(1, extents.depth / 2);
+
+            Image<Channel, channelCount> expected(mipWidth, mipHeight, mipDepth, rowPadding + 1);
+            ReferenceMip(source, &expected);
+
+            Image<Channel, channelCount> actual(mipWidth, mipHeight, mipDepth, rowPadding + 1);
+            GenerateMip<T>(source.width(), source.height(), source.depth(), &source.data()[0],
+                           source.rowPitch(), source.depthPitch(),
+                           &actual.data()[0], actual.rowPitch(), actual.depthPitch());
+
+            ASSERT_TRUE(expected.data() == actual.data())
+                << extents.width << "x" << extents.height << "x" << extents.depth << ", row padding " << rowPadding;
+        }
+    }
+}
+
+TEST(GenerateMipTest, R8G8B8A8)
+{
+    CheckGenerateMip<R8G8B8A8, uint8_t, 4>();
+}
+
+TEST(GenerateMipTest, B8G8R8A8)
+{
+    CheckGenerateMip<B8G8R8A8, uint8_t, 4>();
+}
+
+TEST(GenerateMipTest, A8)
+{
+    CheckGenerateMip<A8, uint8_t, 1>();
+}
+
+TEST(GenerateMipTest, L8)
+{
+    CheckGenerateMip<L8, uint8_t, 1>();
+}
+
+TEST(GenerateMipTest, R8G8)
+{
+    CheckGenerateMip<R8G8, uint8_t, 2>();
+}
+
+TEST(GenerateMipTest, R16G16B16A16)
+{
+    CheckGenerateMip<R16G16B16A16, uint16_t, 4>();
+}
+
+TEST(GenerateMipTest, R32G32B32A32F)
+{
+    CheckGenerateMip<R32G32B32A32F, float, 4>();
+}
+
+// Random bytes, which for the float formats include infinities, NaNs and
+// denormals.
+void FillRandom(std::vector<uint8_t> *data, uint32_t seed)
+{
+    uint32_t random = seed;
+    for (size_t i = 0; i < data->size(); i++)
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        (*data)[i] = static_cast<uint8_t>(random >> 24);
+    }
+}
+
+// Makes the float channels of |channelBytes| bytes finite, by clearing the
+// low bit of the exponent of infinities and NaNs. When NaNs of both signs are
+// averaged, either may come out, as the compiler chooses the order of the
+// operands of the scalar add; and gl::float32ToFloat16 turns infinities into
+// NaNs.
+void MakeFinite(std::vector<uint8_t> *data, size_t channelBytes)
+{
+    for (size_t i = 0; i + channelBytes <= data->size(); i += channelBytes)
+    {
+        if (channelBytes == 2)
+        {
+            uint16_t half;
+            memcpy(&half, &(*data)[i], 2);
+            if ((half & 0x7C00) == 0x7C00)
+            {
+                half &= ~0x0400;
+            }
+            memcpy(&(*data)[i], &half, 2);
+        }
+        else
+        {
+            uint32_t bits;
+            memcpy(&bits, &(*data)[i], 4);
+            if ((bits & 0x7F800000) == 0x7F800000)
+            {
+                bits &= ~0x00800000;
+            }
+            memcpy(&(*data)[i], &bits, 4);
+        }
+    }
+}
+
+// Sizes wide enough for the variants to reduce whole vectors of pixels and
+// leave some over, along every combination of axes.
+const Extents variantExtents[] =
+{
+    { 37, 1, 1 },
+    { 1, 37, 1 },
+    { 70, 9, 1 },
+    { 64, 64, 1 },
+    { 33, 1, 6 },
+    { 1, 5, 8 },
+    { 41, 6, 5 },
+};
+
+// Keeps the channels of the source rows aligned, for MakeFinite.
+const size_t kVariantRowPadding = 4;
+
+// Generates a mip of |extents| with both functions and compares the bytes,
+// including the padding of each destination row.
+void ExpectSameMip(MipGenerationFunction expectedFunction, MipGenerationFunction actualFunction,
+                   size_t pixelBytes, const Extents &extents, const std::vector<uint8_t> &source)
+{
+    size_t sourceRowPitch = extents.width * pixelBytes + kVariantRowPadding;
+    size_t sourceDepthPitch = sourceRowPitch * extents.height;
+    ASSERT_LE(sourceDepthPitch * extents.depth, source.size());
+
+    size_t destWidth = std::max<size_t>(1, extents.width / 2);
+    size_t destHeight = std::max<size_t>(1, extents.height / 2);
+    size_t destDepth = std::max<size_t>(1, extents.depth / 2);
+    size_t destRowPitch = destWidth * pixelBytes + 5;
+    size_t destDepthPitch = destRowPitch * destHeight;
+
+    std::vector<uint8_t> expected(destDepthPitch * destDepth, 0xCD);
+    std::vector<uint8_t> actual(expected.size(), 0xCD);
+    expectedFunction(extents.width, extents.height, extents.depth, &source[0], sourceRowPitch, sourceDepthPitch,
+                     &expected[0], destRowPitch, destDepthPitch);
+    actualFunction(extents.width, extents.height, extents.depth, &source[0], sourceRowPitch, sourceDepthPitch,
+                   &actual[0], destRowPitch, destDepthPitch);
+
+    ASSERT_TRUE(expected == actual) << extents.width << "x" << extents.height << "x" << extents.depth;
+}
+
+// |floatChannelBytes| is the size of the channels of float formats, and 0
+// for the others.
+template <typename T>
+void CheckMipFunctionVariant(size_t floatChannelBytes)
+{
+    MipGenerationFunction scalar = GenerateMip<T>;
+    MipGenerationFunction variant = GetMipFunction(scalar);
+    if (variant == scalar)
+    {
+        // No variant on this CPU or target.
+        return;
+    }
+
+    for (size_t e = 0; e < ArraySize(variantExtents); e++)
+    {
+        const Extents &extents = variantExtents[e];
+        std::vector<uint8_t> source((extents.width * sizeof(T) + kVariantRowPadding) * extents.height * extents.depth);
+        FillRandom(&source, 0x2545F491 + static_cast<uint32_t>(e));
+        if (floatChannelBytes > 0)
+        {
+            MakeFinite(&source, floatChannelBytes);
+        }
+
+        ExpectSameMip(scalar, variant, sizeof(T), extents, source);
+    }
+}
+
+TEST(GenerateMipTest, R8G8B8A8Variant)
+{
+    CheckMipFunctionVariant<R8G8B8A8>(0);
+}
+
+TEST(GenerateMipTest, B8G8R8A8Variant)
+{
+    CheckMipFunctionVariant<B8G8R8A8>(0);
+}
+
+TEST(GenerateMipTest, L8Variant)
+{
+    CheckMipFunctionVariant<L8>(0);
+}
+
+TEST(GenerateMipTest, A8Variant)
+{
+    CheckMipFunctionVariant<A8>(0);
+}
+
+TEST(GenerateMipTest, R16G16B16A16FVariant)
+{
+    CheckMipFunctionVariant<R16G16B16A16F>(2);
+}
+
+TEST(GenerateMipTest, R32G32B32A32FVariant)
+{
+    CheckMipFunctionVariant<R32G32B32A32F>(4);
+}
+
+// Every half float value, in each of the four pixels that are averaged into
+// one channel, so that all of them are converted to float and back.
+TEST(GenerateMipTest, R16G16B16A16FVariantAllValues)
+{
+    Extents extents = { 2 * 0x10000 / 4, 2, 1 };
+    size_t sourceRowPitch = extents.width * sizeof(R16G16B16A16F) + kVariantRowPadding;
+    std::vector<uint8_t> source(sourceRowPitch * extents.height);
+
+    for (size_t y = 0; y < extents.height; y++)
+    {
+        for (size_t value = 0; value < 0x10000; value++)
+        {
+            uint16_t half = static_cast<uint16_t>(value);
+            size_t x = (value / 4) * 2;
+            size_t channel = value % 4;
+            memcpy(&source[y * sourceRowPitch + (x * 4 + channel) * 2], &half, 2);
+            memcpy(&source[y * sourceRowPitch + ((x + 1) * 4 + channel) * 2], &half, 2);
+        }
+    }
+
+    MipGenerationFunction scalar = GenerateMip<R16G16B16A16F>;
+    ExpectSameMip(scalar, GetMipFunction(scalar), sizeof(R16G16B16A16F), extents, source);
+}
+
+// Generates |levelCount| levels of |extents| with GenerateMipChain and one
+// level at a time, and compares every level.
+void CheckMipChain(MipGenerationFunction mipFunction, size_t pixelBytes, const Extents &extents, size_t levelCount)
+{
+    std::vector<std::vector<uint8_t> > expected(levelCount);
+    std::vector<std::vector<uint8_t> > actual(levelCount);
+    std::vector<uint8_t*> actualData(levelCount);
+    std::vector<size_t> rowPitches(levelCount);
+    std::vector<size_t> depthPitches(levelCount);
+
+    for (size_t level = 0; level < levelCount; level++)
+    {
+        size_t width = std::max<size_t>(1, extents.width >> level);
+        size_t height = std::max<size_t>(1, extents.height >> level);
+        size_t depth = std::max<size_t>(1, extents.depth >> level);
+
+        rowPitches[level] = width * pixelBytes + 4;
+        depthPitches[level] = rowPitches[level] * height;
+        expected[level].assign(depthPitches[level] * depth, 0xCD);
+        actual[level].assign(depthPitches[level] * depth, 0xCD);
+        actualData[level] = &actual[level][0];
+    }
+
+    FillRandom(&expected[0], 0x2545F491);
+    actual[0] = expected[0];
+
+    for (size_t level = 1; level < levelCount; level++)
+    {
+        mipFunction(std::max<size_t>(1, extents.width >> (level - 1)),
+                    std::max<size_t>(1, extents.height >> (level - 1)),
+                    std::max<size_t>(1, extents.depth >> (level - 1)),
+                    &expected[level - 1][0], rowPitches[level - 1], depthPitches[level - 1],
+                    &expected[level][0], rowPitches[level], depthPitches[level]);
+    }
+
+    GenerateMipChain(mipFunction, pixelBytes, extents.width, extents.height, extents.depth, levelCount,
+                     &actualData[0], &rowPitches[0], &depthPitches[0]);
+
+    for (size_t level = 0; level < levelCount; level++)
+    {
+        ASSERT_TRUE(expected[level] == actual[level])
+            << "level " << level << " of " << extents.width << "x" << extents.height << "x" << extents.depth;
+    }
+}
+
+// Sizes that are and are not multiples of the tile size, that run out of
+// rows or columns while still inside the tiles, and a 3D image.
+TEST(GenerateMipTest, MipChainMatchesLevelByLevel)
+{
+    const Extents chainExtents[] =
+    {
+        { 1, 1, 1 },
+        { 64, 64, 1 },
+        { 256, 128, 1 },
+        { 300, 200, 1 },
+        { 129, 65, 1 },
+        { 7, 300, 1 },
+        { 500, 3, 1 },
+        { 20, 12, 9 },
+    };
+
+    for (size_t e = 0; e < ArraySize(chainExtents); e++)
+    {
+        const Extents &extents = chainExtents[e];
+        size_t fullLevelCount = gl::log2(static_cast<int>(std::max(std::max(extents.width, extents.height), extents.depth))) + 1;
+
+        CheckMipChain(GetMipFunction(GenerateMip<R8G8B8A8>), 4, extents, fullLevelCount);
+        CheckMipChain(GenerateMip<R8G8B8A8>, 4, extents, fullLevelCount);
+        CheckMipChain(GetMipFunction(GenerateMip<L8>), 1, extents, std::min<size_t>(fullLevelCount, 3));
+        CheckMipChain(GetMipFunction(GenerateMip<R32G32B32A32F>), 16, extents, fullLevelCount);
+    }
+}
+
+}
@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "gtest/gtest.h"
+#include "common/workerpool.h"
+#include "libGLESv2/renderer/loadimage.h"
+#include "libGLESv2/renderer/loadimagescheduler.h"
+
+#include <thread>
+#include <vector>
+
+using namespace rx;
+
+namespace
+{
+
+const size_t kSourcePixelSize = 3;
+const size_t kDestPixelSize = 4;
+
+// A region of RGB8 pixels converted to BGRX8, with padding after every row
+// and slice of both images and a guard row after the output, so that writes
+// outside the region show up.
+class LoadImageSchedulerTest : public testing::Test
+{
+  protected:
+    void setRegion(size_t width, size_t height, size_t depth)
+    {
+        mWidth = width;
+        mHeight = height;
+        mDepth = depth;
+
+        mInputRowPitch = width * kSourcePixelSize + 5;
+        mInputDepthPitch = mInputRowPitch * height + 7;
+        mOutputRowPitch = width * kDestPixelSize + 12;
+        mOutputDepthPitch = mOutputRowPitch * height + 16;
+
+        uint32_t random = 0x2545F491;
+        mInput.resize(mInputDepthPitch * depth + mInputRowPitch);
+        for (size_t i = 0; i < mInput.size(); i++)
+        {
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            mInput[i] = static_cast<uint8_t>(random);
+        }
+
+        mExpected.assign(outputSize(), 0xCD);
+        LoadRGB8ToBGRX8(mWidth, mHeight, mDepth, &mInput[0], mInputRowPitch, mInputDepthPitch,
+                        &mExpected[0], mOutputRowPitch, mOutputDepthPitch);
+    }
+
+    size_t outputSize() const
+    {
+        return mOutputDepthPitch * mDepth + mOutputRowPitch;
+    }
+
+    void expectOutputMatches(const std::vector<uint8_t> &output) const
+    {
+        ASSERT_EQ(mExpected.size(), output.size());
+        for (size_t i = 0; i < output.size(); i++)
+        {
+            ASSERT_EQ(mExpected[i], output[i]) << "byte " << i << " of " << mWidth << "x" << mHeight << "x" << mDepth;
+        }
+    }
+
+    void loadInBands(WorkerPool *pool, std::vector<uint8_t> *output) const
+    {
+        output->assign(outputSize(), 0xCD);
+        LoadImageInBands(pool, LoadRGB8ToBGRX8, mWidth, mHeight, mDepth,
+                         &mInput[0], mInputRowPitch, mInputDepthPitch,
+                         &(*output)[0], mOutputRowPitch, mOutputDepthPitch);
+    }
+
+    size_t mWidth;
+    size_t mHeight;
+    size_t mDepth;
+    size_t mInputRowPitch;
+    size_t mInputDepthPitch;
+    size_t mOutputRowPitch;
+    size_t mOutputDepthPitch;
+    std::vector<uint8_t> mInput;
+    std::vector<uint8_t> mExpected;
+};
+
+// Fewer rows or slices than bands, uneven bands, and regions deep enough to
+// be split by slice.
+TEST_F(LoadImageSchedulerTest, BandsMatchSingleLoad)
+{
+    const size_t threadCounts[] = { 0, 1, 2, 3, 7 };
+    const size_t regions[][3] =
+    {
+        { 1, 1, 1 },
+        { 17, 1, 1 },
+        { 5, 3, 1 },
+        { 33, 31, 1 },
+        { 64, 64, 1 },
+        { 9, 11, 2 },
+        { 13, 5, 3 },
+        { 7, 9, 8 },
+        { 16, 16, 17 },
+    };
+
+    for (size_t threadIt = 0; threadIt < ArraySize(threadCounts); threadIt++)
+    {
+        WorkerPool pool(threadCounts[threadIt]);
+        for (size_t regionIt = 0; regionIt < ArraySize(regions); regionIt++)
+        {
+            setRegion(regions[regionIt][0], regions[regionIt][1], regions[regionIt][2]);
+
+            std::vector<uint8_t> output;
+            loadInBands(&pool, &output);
+            expectOutputMatches(output);
+        }
+    }
+}
+
+// Converting the same region again gives the same bytes, whichever thread
+// converts which band.
+TEST_F(LoadImageSchedulerTest, BandsAreDeterministic)
+{
+    WorkerPool pool(3);
+    setRegion(129, 67, 1);
+
+    for (int i = 0; i < 20; i++)
+    {
+        std::vector<uint8_t> output;
+        loadInBands(&pool, &output);
+        expectOutputMatches(output);
+    }
+}
+
+// Regions above the threshold run on the shared pool, and with no worker
+// threads every region is converted on the calling thread.
+TEST_F(LoadImageSchedulerTest, ScheduleLoadImage)
+{
+    // The workers are only started when asked for.
+    size_t defaultThreadCount = GetLoadImageThreadCount();
+    EXPECT_EQ(0u, defaultThreadCount);
+
+    const size_t threadCounts[] = { 0, 3 };
+    for (size_t threadIt = 0; threadIt < ArraySize(threadCounts); threadIt++)
+    {
+        SetLoadImageThreadCount(threadCounts[threadIt]);
+        EXPECT_EQ(threadCounts[threadIt], GetLoadImageThreadCount());
+
+        setRegion(300, 250, 1);
+        ASSERT_GE(mWidth * mHeight * mDepth, kMinParallelLoadPixels);
+
+        std::vector<uint8_t> output(outputSize(), 0xCD);
+        ScheduleLoadImage(LoadRGB8ToBGRX8, mWidth, mHeight, mDepth,
+                          &mInput[0], mInputRowPitch, mInputDepthPitch,
+                          &output[0], mOutputRowPitch, mOutputDepthPitch);
+        expectOutputMatches(output);
+    }
+
+    SetLoadImageThreadCount(defaultThreadCount);
+}
+
+// Threads that upload while the pool is busy convert their regions
+// themselves, with the same results.
+TEST_F(LoadImageSchedulerTest, ConcurrentUploads)
+{
+    size_t defaultThreadCount = GetLoadImageThreadCount();
+    SetLoadImageThreadCount(3);
+    setRegion(300, 250, 1);
+
+    std::vector<std::vector<uint8_t> > outputs(4, std::vector<uint8_t>(outputSize(), 0xCD));
+    std::vector<std::thread> threads;
+    for (size_t threadIt = 0; threadIt < outputs.size(); threadIt++)
+    {
+        std::vector<uint8_t> *output = &outputs[threadIt];
+        threads.push_back(std::thread([this, output]()
+        {
+            for (int i = 0; i < 10; i++)
+            {
+                ScheduleLoadImage(LoadRGB8ToBGRX8, mWidth, mHeight, mDepth,
+                                  &mInput[0], mInputRowPitch, mInputDepthPitch,
+                                  &(*output)[0], mOutputRowPitch, mOutputDepthPitch);
+            }
+        }));
+    }
+    for (size_t threadIt = 0; threadIt < threads.size(); threadIt++)
+    {
+        threads[threadIt].join();
+    }
+
+    for (size_t threadIt = 0; threadIt < outputs.size(); threadIt++)
+    {
+        expectOutputMatches(outputs[threadIt]);
+    }
+
+    SetLoadImageThreadCount(defaultThreadCount);
+}
+
+}
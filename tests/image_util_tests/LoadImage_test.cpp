@@ -0,0 +1,331 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "gtest/gtest.h"
+#include "libGLESv2/renderer/loadimage.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace rx;
+
+namespace
+{
+
+// Reference conversions, written per pixel from the definitions of the
+// formats rather than from the loaders.
+typedef void (*ReferenceFunction)(const uint8_t *source, uint8_t *dest);
+
+template <typename T>
+T ReadValue(const uint8_t *source)
+{
+    T value;
+    memcpy(&value, source, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void WriteValues(uint8_t *dest, T c0, T c1, T c2, T c3)
+{
+    T values[] = { c0, c1, c2, c3 };
+    memcpy(dest, values, sizeof(values));
+}
+
+// Widens the |bits| wide field of |value| at |shift| to 8 bits by repeating
+// its bits below it, which is how the loaders expand normalized values.
+uint8_t ExpandField(uint32_t value, int shift, int bits)
+{
+    if (bits == 0)
+    {
+        return 0xFF;
+    }
+
+    uint32_t field = (value >> shift) & ((1u << bits) - 1);
+    uint32_t expanded = 0;
+    for (int position = 8 - bits; position > -bits; position -= bits)
+    {
+        expanded |= (position >= 0) ? (field << position) : (field >> -position);
+    }
+    return static_cast<uint8_t>(expanded);
+}
+
+void ReferenceA8ToRGBA8(const uint8_t *source, uint8_t *dest)   { WriteValues<uint8_t>(dest, 0, 0, 0, source[0]); }
+void ReferenceL8ToRGBA8(const uint8_t *source, uint8_t *dest)   { WriteValues<uint8_t>(dest, source[0], source[0], source[0], 0xFF); }
+void ReferenceLA8ToRGBA8(const uint8_t *source, uint8_t *dest)  { WriteValues<uint8_t>(dest, source[0], source[0], source[0], source[1]); }
+void ReferenceR8ToBGRX8(const uint8_t *source, uint8_t *dest)   { WriteValues<uint8_t>(dest, 0, 0, source[0], 0xFF); }
+void ReferenceRG8ToBGRX8(const uint8_t *source, uint8_t *dest)  { WriteValues<uint8_t>(dest, 0, source[1], source[0], 0xFF); }
+void ReferenceRGB8ToBGRX8(const uint8_t *source, uint8_t *dest) { WriteValues<uint8_t>(dest, source[2], source[1], source[0], 0xFF); }
+void ReferenceRGB8ToRGBA8(const uint8_t *source, uint8_t *dest) { WriteValues<uint8_t>(dest, source[0], source[1], source[2], 0xFF); }
+void ReferenceRGBA8ToBGRA8(const uint8_t *source, uint8_t *dest) { WriteValues<uint8_t>(dest, source[2], source[1], source[0], source[3]); }
+
+// A packed format with the fields of its first, second, third and fourth
+// output channels at the given positions. A field with no bits is opaque.
+template <typename T, int shift0, int bits0, int shift1, int bits1, int shift2, int bits2, int shift3, int bits3>
+void ReferencePacked(const uint8_t *source, uint8_t *dest)
+{
+    uint32_t value = ReadValue<T>(source);
+    WriteValues<uint8_t>(dest, ExpandField(value, shift0, bits0), ExpandField(value, shift1, bits1),
+                         ExpandField(value, shift2, bits2), ExpandField(value, shift3, bits3));
+}
+
+// Floating point channels are compared by their bits, so that the random
+// input may hold NaNs.
+const uint32_t Float32OneBits = 0x3F800000;
+const uint16_t Float16OneBits = 0x3C00;
+
+template <typename T>
+void ReferenceAToRGBA(const uint8_t *source, uint8_t *dest)
+{
+    WriteValues<T>(dest, 0, 0, 0, ReadValue<T>(source));
+}
+
+template <typename T, T one>
+void ReferenceLToRGBA(const uint8_t *source, uint8_t *dest)
+{
+    T luminance = ReadValue<T>(source);
+    WriteValues<T>(dest, luminance, luminance, luminance, one);
+}
+
+template <typename T>
+void ReferenceLAToRGBA(const uint8_t *source, uint8_t *dest)
+{
+    T luminance = ReadValue<T>(source);
+    WriteValues<T>(dest, luminance, luminance, luminance, ReadValue<T>(source + sizeof(T)));
+}
+
+struct LoadFunctionInfo
+{
+    const char *name;
+    LoadImageFunction function;
+    ReferenceFunction reference;
+    size_t sourcePixelSize;
+    size_t destPixelSize;
+};
+
+const LoadFunctionInfo loadFunctions[] =
+{
+    { "LoadA8ToRGBA8",      LoadA8ToRGBA8,                   ReferenceA8ToRGBA8,                                      1,  4 },
+    { "LoadA8ToBGRA8",      LoadA8ToBGRA8,                   ReferenceA8ToRGBA8,                                      1,  4 },
+    { "LoadL8ToRGBA8",      LoadL8ToRGBA8,                   ReferenceL8ToRGBA8,                                      1,  4 },
+    { "LoadL8ToBGRA8",      LoadL8ToBGRA8,                   ReferenceL8ToRGBA8,                                      1,  4 },
+    { "LoadLA8ToRGBA8",     LoadLA8ToRGBA8,                  ReferenceLA8ToRGBA8,                                     2,  4 },
+    { "LoadLA8ToBGRA8",     LoadLA8ToBGRA8,                  ReferenceLA8ToRGBA8,                                     2,  4 },
+    { "LoadR8ToBGRX8",      LoadR8ToBGRX8,                   ReferenceR8ToBGRX8,                                      1,  4 },
+    { "LoadRG8ToBGRX8",     LoadRG8ToBGRX8,                  ReferenceRG8ToBGRX8,                                     2,  4 },
+    { "LoadRGB8ToBGRX8",    LoadRGB8ToBGRX8,                 ReferenceRGB8ToBGRX8,                                    3,  4 },
+    { "LoadRGB8ToRGBA8",    LoadToNative3To4<GLubyte, 0xFF>, ReferenceRGB8ToRGBA8,                                    3,  4 },
+    { "LoadRGBA8ToBGRA8",   LoadRGBA8ToBGRA8,                ReferenceRGBA8ToBGRA8,                                   4,  4 },
+    { "LoadRGBA4ToRGBA8",   LoadRGBA4ToRGBA8,                ReferencePacked<uint16_t, 12, 4,  8, 4,  4, 4,  0, 4>,   2,  4 },
+    { "LoadBGRA4ToBGRA8",   LoadBGRA4ToBGRA8,                ReferencePacked<uint16_t, 12, 4,  8, 4,  4, 4,  0, 4>,   2,  4 },
+    { "LoadRGBA4ToBGRA8",   LoadRGBA4ToBGRA8,                ReferencePacked<uint16_t,  4, 4,  8, 4, 12, 4,  0, 4>,   2,  4 },
+    { "LoadRGB5A1ToRGBA8",  LoadRGB5A1ToRGBA8,               ReferencePacked<uint16_t, 11, 5,  6, 5,  1, 5,  0, 1>,   2,  4 },
+    { "LoadBGR5A1ToBGRA8",  LoadBGR5A1ToBGRA8,               ReferencePacked<uint16_t, 11, 5,  6, 5,  1, 5,  0, 1>,   2,  4 },
+    { "LoadRGB5A1ToBGRA8",  LoadRGB5A1ToBGRA8,               ReferencePacked<uint16_t,  1, 5,  6, 5, 11, 5,  0, 1>,   2,  4 },
+    { "LoadR5G6B5ToRGBA8",  LoadR5G6B5ToRGBA8,               ReferencePacked<uint16_t, 11, 5,  5, 6,  0, 5,  0, 0>,   2,  4 },
+    { "LoadR5G6B5ToBGRA8",  LoadR5G6B5ToBGRA8,               ReferencePacked<uint16_t,  0, 5,  5, 6, 11, 5,  0, 0>,   2,  4 },
+    { "LoadRGB10A2ToRGBA8", LoadRGB10A2ToRGBA8,              ReferencePacked<uint32_t,  0, 10, 10, 10, 20, 10, 30, 2>, 4,  4 },
+    { "LoadA32FToRGBA32F",  LoadA32FToRGBA32F,               ReferenceAToRGBA<uint32_t>,                              4, 16 },
+    { "LoadL32FToRGBA32F",  LoadL32FToRGBA32F,               ReferenceLToRGBA<uint32_t, Float32OneBits>,              4, 16 },
+    { "LoadLA32FToRGBA32F", LoadLA32FToRGBA32F,              ReferenceLAToRGBA<uint32_t>,                             8, 16 },
+    { "LoadA16FToRGBA16F",  LoadA16FToRGBA16F,               ReferenceAToRGBA<uint16_t>,                              2,  8 },
+    { "LoadL16FToRGBA16F",  LoadL16FToRGBA16F,               ReferenceLToRGBA<uint16_t, Float16OneBits>,              2,  8 },
+    { "LoadLA16FToRGBA16F", LoadLA16FToRGBA16F,              ReferenceLAToRGBA<uint16_t>,                             4,  8 },
+};
+
+const LoadInstructionSet instructionSets[] =
+{
+    LOAD_INSTRUCTION_SET_SSE2,
+    LOAD_INSTRUCTION_SET_SSSE3,
+    LOAD_INSTRUCTION_SET_AVX2,
+    LOAD_INSTRUCTION_SET_NEON,
+};
+
+const char *const instructionSetNames[] = { "scalar", "SSE2", "SSSE3", "AVX2", "NEON" };
+
+// A small generator, so the data is the same on every run.
+class Random
+{
+  public:
+    Random() : mState(0x2545F491) {}
+
+    uint8_t next()
+    {
+        mState ^= mState << 13;
+        mState ^= mState >> 17;
+        mState ^= mState << 5;
+        return static_cast<uint8_t>(mState >> 24);
+    }
+
+  private:
+    uint32_t mState;
+};
+
+// Runs |load| on a region of |width| pixels with rows padded by |rowPadding|
+// bytes, and returns the whole output buffer, padding included.
+std::vector<uint8_t> Load(LoadImageFunction load, const LoadFunctionInfo &info,
+                          const std::vector<uint8_t> &input, size_t width, size_t rowPadding)
+{
+    const size_t height = 3;
+    const size_t depth = 2;
+
+    size_t inputRowPitch = width * info.sourcePixelSize + rowPadding;
+    size_t outputRowPitch = width * info.destPixelSize + rowPadding;
+
+    std::vector<uint8_t> output(outputRowPitch * height * depth, 0xCD);
+    load(width, height, depth, &input[0], inputRowPitch, inputRowPitch * height,
+         &output[0], outputRowPitch, outputRowPitch * height);
+    return output;
+}
+
+// Applies |info.reference| to each pixel of the region that Load() converts.
+std::vector<uint8_t> ReferenceLoad(const LoadFunctionInfo &info, const std::vector<uint8_t> &input,
+                                   size_t width, size_t rowPadding)
+{
+    const size_t height = 3;
+    const size_t depth = 2;
+
+    size_t inputRowPitch = width * info.sourcePixelSize + rowPadding;
+    size_t outputRowPitch = width * info.destPixelSize + rowPadding;
+
+    std::vector<uint8_t> output(outputRowPitch * height * depth, 0xCD);
+    for (size_t z = 0; z < depth; z++)
+    {
+        for (size_t y = 0; y < height; y++)
+        {
+            for (size_t x = 0; x < width; x++)
+            {
+                size_t row = y + z * height;
+                info.reference(&input[row * inputRowPitch + x * info.sourcePixelSize],
+                               &output[row * outputRowPitch + x * info.destPixelSize]);
+            }
+        }
+    }
+    return output;
+}
+
+// The scalar functions, and the variants GetLoadFunction() picks for this
+// machine, must produce the reference conversion of every pixel.
+TEST(LoadImageTest, MatchesReferenceConversions)
+{
+    const size_t widths[] = { 1, 2, 3, 7, 16, 33, 64 };
+
+    for (size_t f = 0; f < ArraySize(loadFunctions); f++)
+    {
+        const LoadFunctionInfo &info = loadFunctions[f];
+        LoadImageFunction chosen = GetLoadFunction(info.function);
+
+        for (size_t w = 0; w < ArraySize(widths); w++)
+        {
+            for (size_t rowPadding = 0; rowPadding <= 3; rowPadding += 3)
+            {
+                size_t width = widths[w];
+
+                Random random;
+                std::vector<uint8_t> input((width * info.sourcePixelSize + rowPadding) * 3 * 2);
+                for (size_t i = 0; i < input.size(); i++)
+                {
+                    input[i] = random.next();
+                }
+
+                std::vector<uint8_t> expected = ReferenceLoad(info, input, width, rowPadding);
+                ASSERT_TRUE(expected == Load(info.function, info, input, width, rowPadding))
+                    << info.name << ", width " << width << ", row padding " << rowPadding;
+                ASSERT_TRUE(expected == Load(chosen, info, input, width, rowPadding))
+                    << info.name << " (selected variant), width " << width << ", row padding " << rowPadding;
+            }
+        }
+    }
+}
+
+// Repeating the bits of a field is within one of rounding its normalized
+// value to 8 bits, and keeps zero and one exact.
+TEST(LoadImageTest, ExpandedFieldsAreWithinOneOfRounded)
+{
+    for (int bits = 1; bits <= 8; bits++)
+    {
+        uint32_t maximum = (1u << bits) - 1;
+        EXPECT_EQ(0u, ExpandField(0, 0, bits));
+        EXPECT_EQ(255u, ExpandField(maximum, 0, bits));
+
+        for (uint32_t field = 0; field <= maximum; field++)
+        {
+            int rounded = static_cast<int>((field * 255 + maximum / 2) / maximum);
+            int expanded = ExpandField(field, 0, bits);
+            EXPECT_LE(abs(expanded - rounded), 1) << bits << " bits, field " << field;
+        }
+    }
+}
+
+// Each variant must write the same bytes as the scalar function, for widths
+// that do and do not fill its blocks, and leave the row padding alone.
+TEST(LoadImageTest, VariantsMatchScalar)
+{
+    for (size_t f = 0; f < ArraySize(loadFunctions); f++)
+    {
+        const LoadFunctionInfo &info = loadFunctions[f];
+
+        for (size_t s = 0; s < ArraySize(instructionSets); s++)
+        {
+            LoadImageFunction variant = GetLoadFunctionVariant(info.function, instructionSets[s]);
+            if (variant == NULL)
+            {
+                continue;
+            }
+
+            for (size_t width = 1; width <= 67; width++)
+            {
+                for (size_t rowPadding = 0; rowPadding <= 5; rowPadding += 5)
+                {
+                    Random random;
+                    std::vector<uint8_t> input((width * info.sourcePixelSize + rowPadding) * 3 * 2);
+                    for (size_t i = 0; i < input.size(); i++)
+                    {
+                        input[i] = random.next();
+                    }
+
+                    std::vector<uint8_t> expected = Load(info.function, info, input, width, rowPadding);
+                    std::vector<uint8_t> actual = Load(variant, info, input, width, rowPadding);
+                    ASSERT_TRUE(expected == actual) << info.name << " " << instructionSetNames[instructionSets[s]]
+                                                    << ", width " << width << ", row padding " << rowPadding;
+                }
+            }
+        }
+    }
+}
+
+TEST(LoadImageTest, ScalarVariantIsFunction)
+{
+    EXPECT_EQ(LoadL8ToRGBA8, GetLoadFunctionVariant(LoadL8ToRGBA8, LOAD_INSTRUCTION_SET_SCALAR));
+    EXPECT_TRUE(SupportsLoadInstructionSet(LOAD_INSTRUCTION_SET_SCALAR));
+}
+
+TEST(LoadImageTest, FunctionsWithoutVariants)
+{
+    EXPECT_EQ(LoadR32ToR16, GetLoadFunction(LoadR32ToR16));
+    for (size_t s = 0; s < ArraySize(instructionSets); s++)
+    {
+        EXPECT_TRUE(GetLoadFunctionVariant(LoadR32ToR16, instructionSets[s]) == NULL);
+    }
+}
+
+TEST(LoadImageTest, GetLoadFunctionUsesSupportedVariant)
+{
+    for (size_t f = 0; f < ArraySize(loadFunctions); f++)
+    {
+        LoadImageFunction function = loadFunctions[f].function;
+        LoadImageFunction chosen = GetLoadFunction(function);
+
+        bool found = (chosen == function);
+        for (size_t s = 0; s < ArraySize(instructionSets); s++)
+        {
+            found = found || (chosen == GetLoadFunctionVariant(function, instructionSets[s]));
+        }
+        EXPECT_TRUE(found) << loadFunctions[f].name;
+    }
+}
+
+}
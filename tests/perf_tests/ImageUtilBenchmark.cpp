@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "ImageUtilBenchmark.h"
+
+#include "common/mathutil.h"
+#include "common/workerpool.h"
+#include "libGLESv2/renderer/generatemip.h"
+#include "libGLESv2/renderer/loadimagescheduler.h"
+#include "third_party/perf/perf_test.h"
+
+#include <chrono>
+#include <sstream>
+
+namespace
+{
+
+// Each combination is converted at least kMinIterations times and for at
+// least kMinRunTimeSeconds.
+const unsigned int kMinIterations = 5;
+const double kMinRunTimeSeconds = 0.05;
+
+}
+
+ImageUtilBenchmarkParams::ImageUtilBenchmarkParams()
+    : loadFunction(NULL),
+      mipFunction(NULL),
+      sourcePixelSize(0),
+      destPixelSize(0),
+      width(0),
+      height(0),
+      depth(1),
+      pitchAlignment(1),
+      workerPool(NULL),
+      mipChain(false),
+      tiledMipChain(false)
+{
+}
+
+std::string ImageUtilBenchmarkParams::suffix() const
+{
+    std::stringstream strstr;
+
+    strstr << "_" << functionName;
+    if (mipChain)
+    {
+        strstr << (tiledMipChain ? "_tiledchain" : "_levelchain");
+    }
+    strstr << "_" << variantName << "_" << width << "x" << height;
+    if (depth > 1)
+    {
+        strstr << "x" << depth;
+    }
+    strstr << "_align" << pitchAlignment;
+    if (workerPool)
+    {
+        strstr << "_threads" << (workerPool->getThreadCount() + 1);
+    }
+
+    return strstr.str();
+}
+
+ImageUtilBenchmark::ImageUtilBenchmark(const ImageUtilBenchmarkParams &params)
+    : mName("image_util"),
+      mSuffix(params.suffix()),
+      mParams(params),
+      mDestWidth(params.mipFunction ? std::max<size_t>(1, params.width / 2) : params.width),
+      mDestHeight(params.mipFunction ? std::max<size_t>(1, params.height / 2) : params.height),
+      mSourceRowPitch(rx::roundUp(params.width * params.sourcePixelSize, params.pitchAlignment)),
+      mDestRowPitch(rx::roundUp(mDestWidth * params.destPixelSize, params.pitchAlignment)),
+      mSourceDepthPitch(mSourceRowPitch * params.height),
+      mDestDepthPitch(mDestRowPitch * mDestHeight)
+{
+    // Small floating point values, so that the mip functions average
+    // normal numbers.
+    mSource.resize(mSourceDepthPitch * params.depth);
+    for (size_t i = 0; i < mSource.size(); i++)
+    {
+        mSource[i] = static_cast<uint8_t>(0x30 + (i * 7) % 16);
+    }
+    mDest.resize(mDestDepthPitch * (params.mipFunction ? 1 : params.depth));
+
+    if (params.mipChain)
+    {
+        size_t levelCount = gl::log2(static_cast<int>(std::max(params.width, params.height))) + 1;
+        mLevels.resize(levelCount);
+        mLevelData.resize(levelCount);
+        mLevelRowPitches.resize(levelCount);
+        mLevelDepthPitches.resize(levelCount);
+        for (size_t level = 0; level < levelCount; level++)
+        {
+            size_t levelWidth = std::max<size_t>(1, params.width >> level);
+            size_t levelHeight = std::max<size_t>(1, params.height >> level);
+
+            mLevelRowPitches[level] = rx::roundUp(levelWidth * params.destPixelSize, params.pitchAlignment);
+            mLevelDepthPitches[level] = mLevelRowPitches[level] * levelHeight;
+            mLevels[level] = (level == 0) ? mSource : std::vector<uint8_t>(mLevelDepthPitches[level]);
+            mLevelData[level] = &mLevels[level][0];
+        }
+    }
+}
+
+void ImageUtilBenchmark::convert()
+{
+    if (mParams.loadFunction && mParams.workerPool)
+    {
+        rx::LoadImageInBands(mParams.workerPool, mParams.loadFunction,
+                             mParams.width, mParams.height, mParams.depth,
+                             &mSource[0], mSourceRowPitch, mSourceDepthPitch,
+                             &mDest[0], mDestRowPitch, mDestDepthPitch);
+    }
+    else if (mParams.loadFunction)
+    {
+        mParams.loadFunction(mParams.width, mParams.height, mParams.depth, &mSource[0], mSourceRowPitch, mSourceDepthPitch,
+                             &mDest[0], mDestRowPitch, mDestDepthPitch);
+    }
+    else if (mParams.mipChain && mParams.tiledMipChain)
+    {
+        rx::GenerateMipChain(mParams.mipFunction, mParams.destPixelSize, mParams.width, mParams.height, 1,
+                             mLevels.size(), &mLevelData[0], &mLevelRowPitches[0], &mLevelDepthPitches[0]);
+    }
+    else if (mParams.mipChain)
+    {
+        for (size_t level = 1; level < mLevels.size(); level++)
+        {
+            mParams.mipFunction(std::max<size_t>(1, mParams.width >> (level - 1)),
+                                std::max<size_t>(1, mParams.height >> (level - 1)), 1,
+                                mLevelData[level - 1], mLevelRowPitches[level - 1], mLevelDepthPitches[level - 1],
+                                mLevelData[level], mLevelRowPitches[level], mLevelDepthPitches[level]);
+        }
+    }
+    else
+    {
+        mParams.mipFunction(mParams.width, mParams.height, 1, &mSource[0], mSourceRowPitch, mSource.size(),
+                            &mDest[0], mDestRowPitch, mDest.size());
+    }
+}
+
+void ImageUtilBenchmark::run()
+{
+    // Warm the caches and fault in the destination first.
+    convert();
+
+    unsigned int iterations = 0;
+    std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed(0.0);
+    while (iterations < kMinIterations || elapsed.count() < kMinRunTimeSeconds)
+    {
+        convert();
+        iterations++;
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+    }
+
+    double seconds = elapsed.count();
+
+    // Only the pixels count, not the padding of the rows.
+    double sourceBytes = static_cast<double>(mParams.width * mParams.sourcePixelSize * mParams.height * mParams.depth);
+    double megabytes = sourceBytes * iterations / (1024.0 * 1024.0);
+
+    printResult("throughput", megabytes / seconds, "MB/s", true);
+    printResult("time", 1000.0 * seconds / iterations, "ms", false);
+}
+
+void ImageUtilBenchmark::printResult(const std::string &trace, double value, const std::string &units, bool important) const
+{
+    perf_test::PrintResult(mName, mSuffix, trace, value, units, important);
+}
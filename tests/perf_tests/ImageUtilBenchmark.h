@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// ImageUtilBenchmark.h:
+//   Headless benchmark of the CPU pixel conversions: the texture load
+//   functions and mip generation. Reports the throughput of one function
+//   for one image size and row pitch alignment, optionally for a load split
+//   into bands on a pool of worker threads or for a whole mip chain.
+//
+
+#ifndef PERF_TESTS_IMAGE_UTIL_BENCHMARK_H
+#define PERF_TESTS_IMAGE_UTIL_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+#include "common/angleutils.h"
+#include "libGLESv2/formatutils.h"
+
+class WorkerPool;
+
+struct ImageUtilBenchmarkParams
+{
+    ImageUtilBenchmarkParams();
+
+    std::string suffix() const;
+
+    // Exactly one of the functions is set.
+    LoadImageFunction loadFunction;
+    MipGenerationFunction mipFunction;
+
+    // Names the function, and which of its variants it is, in the results.
+    std::string functionName;
+    std::string variantName;
+
+    size_t sourcePixelSize;
+    size_t destPixelSize;
+
+    // The size of the source image, which for mips is halved in the
+    // destination.
+    size_t width;
+    size_t height;
+    size_t depth;
+
+    // Rows of both images start at multiples of this many bytes, as with
+    // GL_UNPACK_ALIGNMENT.
+    size_t pitchAlignment;
+
+    // If set, loads are split into bands that run on this pool and the
+    // calling thread, as texture uploads are.
+    WorkerPool *workerPool;
+
+    // If set, every level of the mip chain below the source is generated,
+    // with GenerateMipChain if tiledMipChain is set and otherwise a level at
+    // a time.
+    bool mipChain;
+    bool tiledMipChain;
+};
+
+class ImageUtilBenchmark
+{
+  public:
+    explicit ImageUtilBenchmark(const ImageUtilBenchmarkParams &params);
+
+    void run();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(ImageUtilBenchmark);
+
+    void convert();
+
+    void printResult(const std::string &trace, double value, const std::string &units, bool important) const;
+
+    std::string mName;
+    std::string mSuffix;
+    ImageUtilBenchmarkParams mParams;
+
+    size_t mDestWidth;
+    size_t mDestHeight;
+    size_t mSourceRowPitch;
+    size_t mDestRowPitch;
+    size_t mSourceDepthPitch;
+    size_t mDestDepthPitch;
+    std::vector<uint8_t> mSource;
+    std::vector<uint8_t> mDest;
+
+    // The source and the levels below it, for mip chains.
+    std::vector<std::vector<uint8_t> > mLevels;
+    std::vector<uint8_t*> mLevelData;
+    std::vector<size_t> mLevelRowPitches;
+    std::vector<size_t> mLevelDepthPitches;
+};
+
+#endif // PERF_TESTS_IMAGE_UTIL_BENCHMARK_H
@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// ImageUtilBenchmarks.cpp:
+//   Entry point of image_util_perftests. Runs each load and mip generation
+//   function, in its scalar form and in the variant GetLoadFunction() or
+//   GetMipFunction() picks for this CPU, for a range of image sizes and row
+//   pitch alignments. Then runs large 2D and 3D uploads split into bands
+//   on worker pools of increasing size, to show how loads scale with cores,
+//   and generates whole mip chains a level at a time and a tile at a time.
+//   Usage: image_util_perftests [filter]
+//   Only the combinations whose result name contains the filter run.
+//
+
+#include "ImageUtilBenchmark.h"
+
+#include "libGLESv2/renderer/generatemip.h"
+#include "libGLESv2/renderer/loadimage.h"
+
+#include "common/workerpool.h"
+
+using namespace rx;
+
+struct LoadFunction
+{
+    const char *name;
+    LoadImageFunction function;
+    size_t sourcePixelSize;
+    size_t destPixelSize;
+};
+
+const LoadFunction loadFunctions[] =
+{
+    { "LoadA8ToRGBA8",        LoadA8ToRGBA8,                   1,  4 },
+    { "LoadA8ToBGRA8",        LoadA8ToBGRA8,                   1,  4 },
+    { "LoadL8ToRGBA8",        LoadL8ToRGBA8,                   1,  4 },
+    { "LoadLA8ToRGBA8",       LoadLA8ToRGBA8,                  2,  4 },
+    { "LoadR8ToBGRX8",        LoadR8ToBGRX8,                   1,  4 },
+    { "LoadRG8ToBGRX8",       LoadRG8ToBGRX8,                  2,  4 },
+    { "LoadRGB8ToBGRX8",      LoadRGB8ToBGRX8,                 3,  4 },
+    { "LoadRGB8ToRGBA8",      LoadToNative3To4<GLubyte, 0xFF>, 3,  4 },
+    { "LoadRGBA8ToRGBA8",     LoadToNative<GLubyte, 4>,        4,  4 },
+    { "LoadRGBA8ToBGRA8",     LoadRGBA8ToBGRA8,                4,  4 },
+    { "LoadRGBA4ToRGBA8",     LoadRGBA4ToRGBA8,                2,  4 },
+    { "LoadRGBA4ToBGRA8",     LoadRGBA4ToBGRA8,                2,  4 },
+    { "LoadRGB5A1ToRGBA8",    LoadRGB5A1ToRGBA8,               2,  4 },
+    { "LoadRGB5A1ToBGRA8",    LoadRGB5A1ToBGRA8,               2,  4 },
+    { "LoadR5G6B5ToRGBA8",    LoadR5G6B5ToRGBA8,               2,  4 },
+    { "LoadR5G6B5ToBGRA8",    LoadR5G6B5ToBGRA8,               2,  4 },
+    { "LoadRGB10A2ToRGBA8",   LoadRGB10A2ToRGBA8,              4,  4 },
+    { "LoadA32FToRGBA32F",    LoadA32FToRGBA32F,               4, 16 },
+    { "LoadL32FToRGBA32F",    LoadL32FToRGBA32F,               4, 16 },
+    { "LoadLA32FToRGBA32F",   LoadLA32FToRGBA32F,              8, 16 },
+    { "LoadA16FToRGBA16F",    LoadA16FToRGBA16F,               2,  8 },
+    { "LoadL16FToRGBA16F",    LoadL16FToRGBA16F,               2,  8 },
+    { "LoadLA16FToRGBA16F",   LoadLA16FToRGBA16F,              4,  8 },
+    { "LoadRGB32FToRGBA16F",  LoadRGB32FToRGBA16F,            12,  8 },
+    { "LoadRGB32FToRGB9E5",   LoadRGB32FToRGB9E5,             12,  4 },
+    { "LoadRGB32FToRG11B10F", LoadRGB32FToRG11B10F,           12,  4 },
+};
+
+struct MipFunction
+{
+    const char *name;
+    MipGenerationFunction function;
+    size_t pixelSize;
+};
+
+const MipFunction mipFunctions[] =
+{
+    { "GenerateMipR8G8B8A8",      GenerateMip<R8G8B8A8>,       4 },
+    { "GenerateMipB8G8R8A8",      GenerateMip<B8G8R8A8>,       4 },
+    { "GenerateMipL8",            GenerateMip<L8>,             1 },
+    { "GenerateMipA8",            GenerateMip<A8>,             1 },
+    { "GenerateMipR16G16B16A16F", GenerateMip<R16G16B16A16F>,  8 },
+    { "GenerateMipR32G32B32A32F", GenerateMip<R32G32B32A32F>, 16 },
+};
+
+// Powers of two, and an odd size whose rows are only aligned by the pitch.
+const size_t sizes[] = { 64, 255, 1024 };
+
+// The unpack alignments that applications use most.
+const size_t pitchAlignments[] = { 1, 4, 16 };
+
+// Uploads large enough that ScheduleLoadImage splits them into bands.
+struct ScalingLoad
+{
+    const LoadFunction *load;
+    size_t width;
+    size_t height;
+    size_t depth;
+};
+
+const ScalingLoad scalingLoads[] =
+{
+    { &loadFunctions[7], 4096, 4096,  1 }, // LoadRGB8ToRGBA8
+    { &loadFunctions[9],  256,  256, 64 }, // LoadRGBA8ToBGRA8
+    { &loadFunctions[2], 2048, 2048,  1 }, // LoadL8ToRGBA8
+};
+
+// Mip chains larger and smaller than the caches.
+const size_t mipChainSizes[] = { 512, 2048 };
+
+bool Matches(const ImageUtilBenchmarkParams &params, const std::string &filter)
+{
+    return filter.empty() || params.suffix().find(filter) != std::string::npos;
+}
+
+int main(int argc, char **argv)
+{
+    std::string filter = (argc > 1) ? argv[1] : "";
+
+    for (size_t sizeIt = 0; sizeIt < ArraySize(sizes); sizeIt++)
+    {
+        for (size_t alignmentIt = 0; alignmentIt < ArraySize(pitchAlignments); alignmentIt++)
+        {
+            ImageUtilBenchmarkParams params;
+            params.width = sizes[sizeIt];
+            params.height = sizes[sizeIt];
+            params.pitchAlignment = pitchAlignments[alignmentIt];
+
+            for (size_t loadIt = 0; loadIt < ArraySize(loadFunctions); loadIt++)
+            {
+                const LoadFunction &load = loadFunctions[loadIt];
+                params.functionName = load.name;
+                params.sourcePixelSize = load.sourcePixelSize;
+                params.destPixelSize = load.destPixelSize;
+                params.mipFunction = NULL;
+
+                params.loadFunction = load.function;
+                params.variantName = "scalar";
+                if (Matches(params, filter))
+                {
+                    ImageUtilBenchmark(params).run();
+                }
+
+                // Only functions with a variant for this CPU have a second result.
+                params.loadFunction = GetLoadFunction(load.function);
+                params.variantName = "selected";
+                if (params.loadFunction != load.function && Matches(params, filter))
+                {
+                    ImageUtilBenchmark(params).run();
+                }
+            }
+
+            for (size_t mipIt = 0; mipIt < ArraySize(mipFunctions); mipIt++)
+            {
+                const MipFunction &mip = mipFunctions[mipIt];
+                params.functionName = mip.name;
+                params.sourcePixelSize = mip.pixelSize;
+                params.destPixelSize = mip.pixelSize;
+                params.loadFunction = NULL;
+
+                params.mipFunction = mip.function;
+                params.variantName = "scalar";
+                if (Matches(params, filter))
+                {
+                    ImageUtilBenchmark(params).run();
+                }
+
+                params.mipFunction = GetMipFunction(mip.function);
+                params.variantName = "selected";
+                if (params.mipFunction != mip.function && Matches(params, filter))
+                {
+                    ImageUtilBenchmark(params).run();
+                }
+            }
+        }
+    }
+
+    // Thread counts that double up to the number of processors, to choose
+    // the count to give SetLoadImageThreadCount.
+    std::vector<size_t> threadCounts;
+    size_t processorCount = WorkerPool::GetProcessorCount();
+    for (size_t threadCount = 1; threadCount < processorCount; threadCount *= 2)
+    {
+        threadCounts.push_back(threadCount);
+    }
+    threadCounts.push_back(processorCount);
+
+    for (size_t threadIt = 0; threadIt < threadCounts.size(); threadIt++)
+    {
+        WorkerPool workerPool(threadCounts[threadIt] - 1);
+
+        for (size_t loadIt = 0; loadIt < ArraySize(scalingLoads); loadIt++)
+        {
+            const ScalingLoad &scaling = scalingLoads[loadIt];
+
+            ImageUtilBenchmarkParams params;
+            params.functionName = scaling.load->name;
+            params.variantName = "selected";
+            params.loadFunction = GetLoadFunction(scaling.load->function);
+            params.sourcePixelSize = scaling.load->sourcePixelSize;
+            params.destPixelSize = scaling.load->destPixelSize;
+            params.width = scaling.width;
+            params.height = scaling.height;
+            params.depth = scaling.depth;
+            params.pitchAlignment = 4;
+            params.workerPool = &workerPool;
+
+            if (Matches(params, filter))
+            {
+                ImageUtilBenchmark(params).run();
+            }
+        }
+    }
+
+    for (size_t sizeIt = 0; sizeIt < ArraySize(mipChainSizes); sizeIt++)
+    {
+        for (size_t mipIt = 0; mipIt < ArraySize(mipFunctions); mipIt++)
+        {
+            const MipFunction &mip = mipFunctions[mipIt];
+
+            ImageUtilBenchmarkParams params;
+            params.functionName = mip.name;
+            params.variantName = "selected";
+            params.mipFunction = GetMipFunction(mip.function);
+            params.sourcePixelSize = mip.pixelSize;
+            params.destPixelSize = mip.pixelSize;
+            params.width = mipChainSizes[sizeIt];
+            params.height = mipChainSizes[sizeIt];
+            params.pitchAlignment = 4;
+            params.mipChain = true;
+
+            for (int tiled = 0; tiled < 2; tiled++)
+            {
+                params.tiledMipChain = (tiled != 0);
+                if (Matches(params, filter))
+                {
+                    ImageUtilBenchmark(params).run();
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "TranslatorBenchmark.h"
+
+#include "angle_gl.h"
+#include "third_party/perf/perf_test.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+
+// Each shader is compiled at least kMinIterations times and for at least
+// kMinRunTimeSeconds.
+const unsigned int kMinIterations = 10;
+const double kMinRunTimeSeconds = 0.25;
+
+bool ReadFile(const std::string &path, std::string *contents)
+{
+    std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+    if (!stream)
+    {
+        return false;
+    }
+
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    *contents = buffer.str();
+    return true;
+}
+
+bool EndsWith(const std::string &str, const std::string &suffix)
+{
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Result names may not contain colons or equals signs; also replace dots
+// so that file extensions read as part of the name.
+std::string TraceName(const std::string &fileName)
+{
+    std::string name = fileName;
+    for (size_t i = 0; i < name.size(); i++)
+    {
+        if (name[i] == '.' || name[i] == ':' || name[i] == '=')
+        {
+            name[i] = '_';
+        }
+    }
+    return name;
+}
+
+}
+
+std::string TranslatorBenchmarkParams::suffix() const
+{
+    std::stringstream strstr;
+
+    switch (output)
+    {
+      case SH_ESSL_OUTPUT: strstr << "_essl"; break;
+      case SH_GLSL_OUTPUT: strstr << "_glsl"; break;
+      case SH_HLSL9_OUTPUT: strstr << "_hlsl9"; break;
+      case SH_HLSL11_OUTPUT: strstr << "_hlsl11"; break;
+      default: strstr << "_output" << output; break;
+    }
+
+    strstr << "_" << optionsName;
+
+    return strstr.str();
+}
+
+TranslatorBenchmark::TranslatorBenchmark(const TranslatorBenchmarkParams &params,
+                                         const std::string &corpusDirectory,
+                                         const std::vector<std::string> &corpus)
+    : mName("translator"),
+      mSuffix(params.suffix()),
+      mParams(params),
+      mCorpusDirectory(corpusDirectory),
+      mCorpus(corpus)
+{
+}
+
+int TranslatorBenchmark::run()
+{
+    int result = 0;
+    for (size_t shaderIndex = 0; shaderIndex < mCorpus.size(); shaderIndex++)
+    {
+        if (!runShader(mCorpus[shaderIndex]))
+        {
+            result = -1;
+        }
+    }
+    return result;
+}
+
+bool TranslatorBenchmark::runShader(const std::string &fileName)
+{
+    std::string source;
+    if (!ReadFile(mCorpusDirectory + "/" + fileName, &source))
+    {
+        std::cerr << "Could not read " << mCorpusDirectory << "/" << fileName << std::endl;
+        return false;
+    }
+
+    GLenum shaderType = EndsWith(fileName, ".vert") ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER;
+    bool isESSL3 = (source.compare(0, 15, "#version 300 es") == 0);
+    ShShaderSpec spec = isESSL3 ? SH_GLES3_SPEC : SH_GLES2_SPEC;
+
+    // ESSL 3.00 shaders are only translated for Direct3D 11.
+    if (isESSL3 && mParams.output == SH_HLSL9_OUTPUT)
+    {
+        return true;
+    }
+
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    resources.MaxVertexUniformVectors = 256;
+    resources.FragmentPrecisionHigh = 1;
+    resources.MaxDrawBuffers = 4;
+    resources.OES_standard_derivatives = 1;
+
+    // A new compiler for each shader, so that its peak pool memory is the
+    // one needed by this shader.
+    ShHandle compiler = ShConstructCompiler(shaderType, spec, mParams.output, &resources);
+    if (!compiler)
+    {
+        std::cerr << "Could not construct a compiler for " << fileName << std::endl;
+        return false;
+    }
+
+    const char *sourceStrings[] = { source.c_str() };
+    if (!ShCompile(compiler, sourceStrings, 1, mParams.compileOptions))
+    {
+        std::cerr << "Failed to compile " << fileName << mSuffix << ":\n"
+                  << ShGetInfoLog(compiler) << std::endl;
+        ShDestruct(compiler);
+        return false;
+    }
+    size_t objectCodeSize = ShGetObjectCode(compiler).size();
+
+    unsigned int iterations = 0;
+    std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed(0.0);
+    while (iterations < kMinIterations || elapsed.count() < kMinRunTimeSeconds)
+    {
+        ShCompile(compiler, sourceStrings, 1, mParams.compileOptions);
+        iterations++;
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+    }
+
+    ShPoolAllocatorStats poolStats;
+    ShGetPoolAllocatorStats(compiler, &poolStats);
+    ShDestruct(compiler);
+
+    double seconds = elapsed.count();
+    double megabytes = static_cast<double>(source.size()) * iterations / (1024.0 * 1024.0);
+
+    std::string trace = TraceName(fileName);
+    printResult(trace + "_compile_latency", 1000.0 * seconds / iterations, "ms", true);
+    printResult(trace + "_throughput", megabytes / seconds, "MB/s", false);
+    printResult(trace + "_peak_pool_memory", poolStats.peakBytes, "bytes", false);
+    printResult(trace + "_object_code_size", objectCodeSize, "bytes", false);
+
+    return true;
+}
+
+void TranslatorBenchmark::printResult(const std::string &trace, double value, const std::string &units, bool important) const
+{
+    perf_test::PrintResult(mName, mSuffix, trace, value, units, important);
+}
+
+void TranslatorBenchmark::printResult(const std::string &trace, size_t value, const std::string &units, bool important) const
+{
+    perf_test::PrintResult(mName, mSuffix, trace, value, units, important);
+}
@@ -0,0 +1,60 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TranslatorBenchmark.h:
+//   Headless benchmark that compiles a corpus of shaders with the
+//   translator and reports compile latency, throughput, peak pool memory
+//   and the size of the emitted code.
+//
+
+#ifndef PERF_TESTS_TRANSLATOR_BENCHMARK_H
+#define PERF_TESTS_TRANSLATOR_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+#include "GLSLANG/ShaderLang.h"
+#include "common/angleutils.h"
+
+struct TranslatorBenchmarkParams
+{
+    std::string suffix() const;
+
+    ShShaderOutput output;
+    int compileOptions;
+    // Describes compileOptions in the names of the results.
+    std::string optionsName;
+};
+
+class TranslatorBenchmark
+{
+  public:
+    // |corpus| lists the shader files to compile, relative to |corpusDirectory|.
+    // Files ending in .vert are vertex shaders; the others are fragment
+    // shaders. Shaders that start with "#version 300 es" are compiled
+    // against the ES 3.0 spec.
+    TranslatorBenchmark(const TranslatorBenchmarkParams &params,
+                        const std::string &corpusDirectory,
+                        const std::vector<std::string> &corpus);
+
+    // Returns 0 if every shader of the corpus compiled.
+    int run();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(TranslatorBenchmark);
+
+    bool runShader(const std::string &fileName);
+
+    void printResult(const std::string &trace, double value, const std::string &units, bool important) const;
+    void printResult(const std::string &trace, size_t value, const std::string &units, bool important) const;
+
+    std::string mName;
+    std::string mSuffix;
+    TranslatorBenchmarkParams mParams;
+    std::string mCorpusDirectory;
+    std::vector<std::string> mCorpus;
+};
+
+#endif // PERF_TESTS_TRANSLATOR_BENCHMARK_H
@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TranslatorBenchmarks.cpp:
+//   Entry point of translator_perftests. Compiles the shaders in
+//   translator_corpus for each output with the option combinations that
+//   the ANGLE renderers and WebGL implementations commonly use, then runs
+//   the benchmarks of single translator stages.
+//   Usage: translator_perftests [corpus directory]
+//
+
+#include "TranslatorBenchmark.h"
+#include "TranslatorMicroBenchmarks.h"
+
+const char *corpus[] =
+{
+    "phong_lighting.frag",
+    "gaussian_blur.frag",
+    "procedural_noise.frag",
+    "skinning.vert",
+    "deferred_lighting.frag",
+    "instanced_particles.vert",
+};
+
+const int webGLOptions = SH_OBJECT_CODE | SH_VARIABLES | SH_VALIDATE_LOOP_INDEXING |
+                         SH_ENFORCE_PACKING_RESTRICTIONS | SH_LIMIT_EXPRESSION_COMPLEXITY |
+                         SH_LIMIT_CALL_STACK_DEPTH | SH_CLAMP_INDIRECT_ARRAY_BOUNDS |
+                         SH_INIT_VARYINGS_WITHOUT_STATIC_USE | SH_EMULATE_BUILT_IN_FUNCTIONS;
+
+struct OptionSet
+{
+    ShShaderOutput output;
+    int compileOptions;
+    const char *name;
+};
+
+const OptionSet optionSets[] =
+{
+    { SH_ESSL_OUTPUT, SH_OBJECT_CODE, "default" },
+    { SH_ESSL_OUTPUT, webGLOptions, "webgl" },
+    { SH_GLSL_OUTPUT, SH_OBJECT_CODE, "default" },
+    { SH_GLSL_OUTPUT, webGLOptions, "webgl" },
+    // The options used by the Direct3D renderers.
+    { SH_HLSL9_OUTPUT, SH_OBJECT_CODE | SH_VARIABLES, "default" },
+    { SH_HLSL11_OUTPUT, SH_OBJECT_CODE | SH_VARIABLES, "default" },
+    { SH_HLSL11_OUTPUT, SH_OBJECT_CODE | SH_VARIABLES | SH_UNROLL_LOOPS_BY_COST, "loop_cost" },
+};
+
+// The corpus is copied next to the executable unless a directory is given.
+std::string DefaultCorpusDirectory(const char *executablePath)
+{
+    std::string directory(executablePath);
+    size_t separator = directory.find_last_of("/\\");
+    directory = (separator == std::string::npos) ? "." : directory.substr(0, separator);
+    return directory + "/translator_corpus";
+}
+
+int main(int argc, char **argv)
+{
+    std::string corpusDirectory = (argc > 1) ? argv[1] : DefaultCorpusDirectory(argv[0]);
+    std::vector<std::string> corpusFiles(corpus, corpus + ArraySize(corpus));
+
+    ShInitialize();
+
+    int result = 0;
+    for (size_t optionsIt = 0; optionsIt < ArraySize(optionSets); optionsIt++)
+    {
+        TranslatorBenchmarkParams params;
+        params.output = optionSets[optionsIt].output;
+        params.compileOptions = optionSets[optionsIt].compileOptions;
+        params.optionsName = optionSets[optionsIt].name;
+
+        TranslatorBenchmark benchmark(params, corpusDirectory, corpusFiles);
+        if (benchmark.run() != 0)
+        {
+            result = -1;
+        }
+    }
+
+    if (RunPreprocessorBenchmarks() != 0)
+    {
+        result = -1;
+    }
+    if (RunSymbolLookupBenchmark() != 0)
+    {
+        result = -1;
+    }
+    RunCompilerConstructionBenchmark();
+
+    ShFinalize();
+
+    return result;
+}
@@ -0,0 +1,319 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include "TranslatorMicroBenchmarks.h"
+
+#include "angle_gl.h"
+#include "GLSLANG/ShaderLang.h"
+#include "compiler/preprocessor/DiagnosticsBase.h"
+#include "compiler/preprocessor/DirectiveHandlerBase.h"
+#include "compiler/preprocessor/Preprocessor.h"
+#include "compiler/preprocessor/Token.h"
+#include "compiler/translator/BuiltInSymbolTableCache.h"
+#include "third_party/perf/perf_test.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// Each input is processed at least kMinIterations times and for at least
+// kMinRunTimeSeconds, like the shaders of TranslatorBenchmark.
+const unsigned int kMinIterations = 10;
+const double kMinRunTimeSeconds = 0.25;
+
+class CountingDiagnostics : public pp::Diagnostics
+{
+  public:
+    CountingDiagnostics() : mCount(0) {}
+
+    size_t count() const { return mCount; }
+
+  protected:
+    virtual void print(ID id, const pp::SourceLocation &loc, const std::string &text)
+    {
+        mCount++;
+    }
+
+  private:
+    size_t mCount;
+};
+
+class IgnoringDirectiveHandler : public pp::DirectiveHandler
+{
+  public:
+    virtual void handleError(const pp::SourceLocation &loc, const std::string &msg) {}
+    virtual void handlePragma(const pp::SourceLocation &loc, const std::string &name,
+                              const std::string &value, bool stdgl) {}
+    virtual void handleExtension(const pp::SourceLocation &loc, const std::string &name,
+                                 const std::string &behavior) {}
+    virtual void handleVersion(const pp::SourceLocation &loc, int version) {}
+};
+
+// Preprocesses |source| to the end, returning false if that produced any
+// diagnostics.
+bool Preprocess(const std::string &source)
+{
+    CountingDiagnostics diagnostics;
+    IgnoringDirectiveHandler directiveHandler;
+    pp::Preprocessor preprocessor(&diagnostics, &directiveHandler);
+
+    const char *sourceString = source.c_str();
+    if (!preprocessor.init(1, &sourceString, NULL))
+    {
+        return false;
+    }
+
+    pp::Token token;
+    do
+    {
+        preprocessor.lex(&token);
+    } while (token.type != pp::Token::LAST);
+
+    return diagnostics.count() == 0;
+}
+
+std::string MacroHeavySource()
+{
+    const int kLineCount = 4000;
+
+    std::ostringstream source;
+    source << "#define SCALE 2.0\n"
+              "#define OFFSET vec4(0.5, 0.5, 0.5, 0.5)\n"
+              "#define MAD(a, b, c) ((a) * (b) + (c))\n"
+              "#define LERP(a, b, t) MAD((b) - (a), t, a)\n"
+              "#define SATURATE(x) clamp(x, 0.0, 1.0)\n"
+              "#define SAMPLE(s, uv) texture2D(s, (uv) * SCALE)\n"
+              "#define BLEND(s, uv, t) SATURATE(LERP(SAMPLE(s, uv), OFFSET, t))\n";
+    for (int i = 0; i < kLineCount; i++)
+    {
+        source << "color" << i << " = BLEND(sampler" << (i % 8) << ", texCoord"
+               << (i % 4) << ".xy, weight" << i << ") + MAD(color, SCALE, OFFSET);\n";
+    }
+    return source.str();
+}
+
+std::string CommentHeavySource()
+{
+    const int kBlockCount = 1000;
+
+    std::ostringstream source;
+    source << "/*\n";
+    for (int i = 0; i < 40; i++)
+    {
+        source << " * Copyright notice and license text, line " << i << ".\n";
+    }
+    source << " */\n";
+    for (int i = 0; i < kBlockCount; i++)
+    {
+        source << "/**\n"
+                  " * Returns the weighted sample " << i << " of the filter kernel.\n"
+                  " * The weights are normalized and the offsets are in texels.\n"
+                  " */\n"
+                  "const vec4 kernel" << i << "[2] = vec4[2](\n"
+                  "        vec4(0.25, 0.5, 0.75, 1.0),   // weights\n"
+                  "        vec4(-1.5, -0.5, 0.5, 1.5));  // offsets\n"
+                  "\n";
+    }
+    return source.str();
+}
+
+// Reports the throughput of preprocessing |source| as |trace|.
+bool RunPreprocessor(const std::string &trace, const std::string &source)
+{
+    if (!Preprocess(source))
+    {
+        std::cerr << "Failed to preprocess the " << trace << " input" << std::endl;
+        return false;
+    }
+
+    unsigned int iterations = 0;
+    std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed(0.0);
+    while (iterations < kMinIterations || elapsed.count() < kMinRunTimeSeconds)
+    {
+        Preprocess(source);
+        iterations++;
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+    }
+
+    double megabytes = static_cast<double>(source.size()) * iterations / (1024.0 * 1024.0);
+    perf_test::PrintResult("preprocessor", "", trace + "_throughput",
+                           megabytes / elapsed.count(), "MB/s", true);
+    return true;
+}
+
+// Returns the resident set size of the process in bytes, or 0 if unknown.
+size_t GetResidentMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+    {
+        return 0;
+    }
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int read = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+    return read == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+std::string ManyIdentifiersSource()
+{
+    const int kFunctionCount = 100;
+    const int kVariablesPerFunction = 40;
+
+    std::ostringstream source;
+    source << "precision mediump float;\n"
+              "uniform vec4 u;\n";
+    for (int f = 0; f < kFunctionCount; f++)
+    {
+        source << "vec4 function" << f << "(vec4 a) {\n";
+        for (int v = 0; v < kVariablesPerFunction; v++)
+        {
+            source << "    vec4 value" << f << "_" << v << " = ";
+            if (v == 0)
+            {
+                source << "a;\n";
+            }
+            else
+            {
+                source << "max(value" << f << "_" << (v - 1) << ", u) * dot(a, u);\n";
+            }
+        }
+        source << "    return clamp(value" << f << "_" << (kVariablesPerFunction - 1)
+               << ", 0.0, 1.0);\n"
+                  "}\n";
+    }
+    source << "void main() {\n"
+              "    vec4 c = u;\n";
+    for (int f = 0; f < kFunctionCount; f++)
+    {
+        source << "    c = function" << f << "(c);\n";
+    }
+    source << "    gl_FragColor = c;\n"
+              "}\n";
+    return source.str();
+}
+
+}
+
+int RunPreprocessorBenchmarks()
+{
+    int result = 0;
+    if (!RunPreprocessor("macro_heavy", MacroHeavySource()))
+    {
+        result = -1;
+    }
+    if (!RunPreprocessor("comment_heavy", CommentHeavySource()))
+    {
+        result = -1;
+    }
+    return result;
+}
+
+int RunSymbolLookupBenchmark()
+{
+    std::string source = ManyIdentifiersSource();
+    const char *sourceStrings[] = { source.c_str() };
+
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+    ShHandle compiler = ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES2_SPEC,
+                                            SH_GLSL_OUTPUT, &resources);
+    if (!compiler || !ShCompile(compiler, sourceStrings, 1, SH_VALIDATE))
+    {
+        std::cerr << "Failed to compile the symbol lookup shader" << std::endl;
+        ShDestruct(compiler);
+        return -1;
+    }
+
+    unsigned int iterations = 0;
+    std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed(0.0);
+    while (iterations < kMinIterations || elapsed.count() < kMinRunTimeSeconds)
+    {
+        ShCompile(compiler, sourceStrings, 1, SH_VALIDATE);
+        iterations++;
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+    }
+    ShDestruct(compiler);
+
+    perf_test::PrintResult("symbol_lookup", "", "many_identifiers_compile_latency",
+                           1000.0 * elapsed.count() / iterations, "ms", true);
+    return 0;
+}
+
+void RunCompilerConstructionBenchmark()
+{
+    // The compilers are kept until the end of each pass, so that the growth
+    // of the resident memory is the one they need.
+    const int kCompilerCount = 50;
+
+    ShBuiltInResources resources;
+    ShInitBuiltInResources(&resources);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        // The first pass drops the cached built-ins before each compiler, so
+        // that every compiler builds its own, as before the cache existed.
+        bool warm = (pass == 1);
+        std::vector<ShHandle> compilers;
+
+        size_t memoryBefore = GetResidentMemory();
+        std::chrono::high_resolution_clock::time_point start =
+            std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < kCompilerCount; i++)
+        {
+            if (!warm)
+            {
+                FreeBuiltInSymbolTableCache();
+            }
+            compilers.push_back(ShConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES3_SPEC,
+                                                    SH_ESSL_OUTPUT, &resources));
+        }
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        size_t memoryAfter = GetResidentMemory();
+
+        std::string trace = warm ? "warm" : "cold";
+        perf_test::PrintResult("compiler_construction", "", trace + "_time",
+                               1000.0 * elapsed.count() / kCompilerCount, "ms", true);
+        if (memoryBefore != 0 && memoryAfter >= memoryBefore)
+        {
+            perf_test::PrintResult("compiler_construction", "", trace + "_resident_memory",
+                                   (memoryAfter - memoryBefore) / kCompilerCount, "bytes", false);
+        }
+
+        for (size_t i = 0; i < compilers.size(); i++)
+        {
+            ShDestruct(compilers[i]);
+        }
+    }
+}
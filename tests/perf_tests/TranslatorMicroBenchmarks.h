@@ -0,0 +1,28 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// TranslatorMicroBenchmarks.h:
+//   Benchmarks of single stages of the translator on generated input, which
+//   translator_perftests runs after compiling the corpus.
+//
+
+#ifndef PERF_TESTS_TRANSLATOR_MICRO_BENCHMARKS_H
+#define PERF_TESTS_TRANSLATOR_MICRO_BENCHMARKS_H
+
+// Reports the preprocessor throughput on input that makes heavy use of
+// nested macros, and on input that is mostly comments and indentation.
+// Returns 0 if the input was preprocessed without errors.
+int RunPreprocessorBenchmarks();
+
+// Reports the time to parse and validate a shader that declares and refers
+// to thousands of identifiers and calls overloaded built-ins, which is
+// dominated by symbol table lookups. Returns 0 if the shader compiled.
+int RunSymbolLookupBenchmark();
+
+// Reports the time and resident memory taken to construct a compiler when
+// its built-in symbols are already cached, and when they are built anew.
+void RunCompilerConstructionBenchmark();
+
+#endif // PERF_TESTS_TRANSLATOR_MICRO_BENCHMARKS_H
@@ -0,0 +1,60 @@
+#version 300 es
+// Deferred shading resolve that reads a G-buffer and writes several outputs.
+precision mediump float;
+
+layout(std140) uniform LightBlock
+{
+    vec4 positionsAndRadii[16];
+    vec4 colors[16];
+    int lightCount;
+};
+
+uniform sampler2D u_albedo;
+uniform sampler2D u_normals;
+uniform sampler2D u_depth;
+uniform mat4 u_inverseProjection;
+
+in vec2 v_texCoord;
+
+layout(location = 0) out vec4 o_color;
+layout(location = 1) out vec4 o_luminance;
+
+vec3 reconstructPosition(vec2 texCoord, float depth)
+{
+    vec4 clip = vec4(texCoord * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 view = u_inverseProjection * clip;
+    return view.xyz / view.w;
+}
+
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 f = encoded * 2.0 - 1.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 albedo = texelFetch(u_albedo, pixel, 0);
+    vec3 normal = decodeNormal(texelFetch(u_normals, pixel, 0).xy);
+    vec3 position = reconstructPosition(v_texCoord, texelFetch(u_depth, pixel, 0).r);
+
+    vec3 color = vec3(0.0);
+    for (int i = 0; i < 16; ++i)
+    {
+        if (i >= lightCount)
+        {
+            break;
+        }
+        vec3 toLight = positionsAndRadii[i].xyz - position;
+        float distance = length(toLight);
+        float falloff = max(1.0 - distance / positionsAndRadii[i].w, 0.0);
+        color += albedo.rgb * colors[i].rgb * max(dot(normal, toLight / distance), 0.0) * falloff * falloff;
+    }
+
+    o_color = vec4(color, albedo.a);
+    o_luminance = vec4(dot(color, vec3(0.2126, 0.7152, 0.0722)));
+}
@@ -0,0 +1,28 @@
+// Separable 9-tap Gaussian blur written with helper macros.
+precision mediump float;
+
+uniform sampler2D u_source;
+uniform vec2 u_direction;
+uniform vec2 u_texelSize;
+
+varying vec2 v_texCoord;
+
+#define OFFSET(i) (u_direction * u_texelSize * float(i))
+#define TAP(i, weight) (texture2D(u_source, v_texCoord + OFFSET(i)) * (weight) + \
+                        texture2D(u_source, v_texCoord - OFFSET(i)) * (weight))
+
+const float kWeight0 = 0.2270270270;
+const float kWeight1 = 0.1945945946;
+const float kWeight2 = 0.1216216216;
+const float kWeight3 = 0.0540540541;
+const float kWeight4 = 0.0162162162;
+
+void main()
+{
+    vec4 sum = texture2D(u_source, v_texCoord) * kWeight0;
+    sum += TAP(1, kWeight1);
+    sum += TAP(2, kWeight2);
+    sum += TAP(3, kWeight3);
+    sum += TAP(4, kWeight4);
+    gl_FragColor = sum;
+}
@@ -0,0 +1,41 @@
+#version 300 es
+// Instanced camera-facing particles animated from a data texture.
+precision highp float;
+
+in vec2 a_corner;
+in vec4 a_instancePositionSize;
+in vec4 a_instanceColor;
+in float a_instanceIndex;
+
+uniform highp sampler2D u_animation;
+uniform mat4 u_viewProjection;
+uniform vec3 u_cameraRight;
+uniform vec3 u_cameraUp;
+uniform float u_time;
+uniform int u_frameCount;
+
+out vec2 v_texCoord;
+out vec4 v_color;
+flat out int v_frame;
+
+vec3 animatedOffset(int instance, float time)
+{
+    int row = instance / 64;
+    int column = instance - row * 64;
+    vec4 motion = texelFetch(u_animation, ivec2(column, row), 0);
+    return motion.xyz * sin(time * motion.w);
+}
+
+void main()
+{
+    int instance = int(a_instanceIndex);
+    vec3 center = a_instancePositionSize.xyz + animatedOffset(instance, u_time);
+    float size = a_instancePositionSize.w;
+    vec3 position = center + (u_cameraRight * a_corner.x + u_cameraUp * a_corner.y) * size;
+
+    v_texCoord = a_corner * 0.5 + 0.5;
+    v_color = a_instanceColor;
+    int frame = instance + int(u_time * 30.0);
+    v_frame = frame - (frame / u_frameCount) * u_frameCount;
+    gl_Position = u_viewProjection * vec4(position, 1.0);
+}
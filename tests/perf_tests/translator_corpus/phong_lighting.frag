@@ -0,0 +1,60 @@
+// Per-pixel Blinn-Phong lighting with several point lights and fog.
+precision mediump float;
+
+#define NUM_LIGHTS 4
+
+struct Light
+{
+    vec3 position;
+    vec3 color;
+    float radius;
+};
+
+uniform Light u_lights[NUM_LIGHTS];
+uniform vec3 u_eyePosition;
+uniform vec3 u_ambient;
+uniform float u_shininess;
+uniform sampler2D u_diffuseMap;
+uniform sampler2D u_specularMap;
+uniform vec3 u_fogColor;
+uniform float u_fogDensity;
+
+varying vec3 v_position;
+varying vec3 v_normal;
+varying vec2 v_texCoord;
+
+float attenuation(float distance, float radius)
+{
+    float ratio = clamp(distance / radius, 0.0, 1.0);
+    return (1.0 - ratio * ratio) / (1.0 + distance * distance);
+}
+
+vec3 shadeLight(Light light, vec3 normal, vec3 viewDir, vec3 albedo, float specularMask)
+{
+    vec3 toLight = light.position - v_position;
+    float distance = length(toLight);
+    vec3 lightDir = toLight / distance;
+    vec3 halfDir = normalize(lightDir + viewDir);
+
+    float diffuse = max(dot(normal, lightDir), 0.0);
+    float specular = pow(max(dot(normal, halfDir), 0.0), u_shininess) * specularMask;
+    return (albedo * diffuse + vec3(specular)) * light.color * attenuation(distance, light.radius);
+}
+
+void main()
+{
+    vec3 normal = normalize(v_normal);
+    vec3 viewDir = normalize(u_eyePosition - v_position);
+    vec4 albedo = texture2D(u_diffuseMap, v_texCoord);
+    float specularMask = texture2D(u_specularMap, v_texCoord).r;
+
+    vec3 color = u_ambient * albedo.rgb;
+    for (int i = 0; i < NUM_LIGHTS; ++i)
+    {
+        color += shadeLight(u_lights[i], normal, viewDir, albedo.rgb, specularMask);
+    }
+
+    float fogDistance = length(u_eyePosition - v_position);
+    float fog = exp(-u_fogDensity * fogDistance * fogDistance);
+    gl_FragColor = vec4(mix(u_fogColor, color, clamp(fog, 0.0, 1.0)), albedo.a);
+}
@@ -0,0 +1,61 @@
+// Fractal value noise built from many small helper functions.
+precision mediump float;
+
+uniform float u_time;
+uniform vec2 u_resolution;
+uniform vec3 u_lowColor;
+uniform vec3 u_highColor;
+
+varying vec2 v_texCoord;
+
+float hash(vec2 p)
+{
+    return fract(sin(dot(p, vec2(127.1, 311.7))) * 43758.5453123);
+}
+
+float smoothNoise(vec2 p)
+{
+    vec2 i = floor(p);
+    vec2 f = fract(p);
+    vec2 u = f * f * (3.0 - 2.0 * f);
+
+    float a = hash(i);
+    float b = hash(i + vec2(1.0, 0.0));
+    float c = hash(i + vec2(0.0, 1.0));
+    float d = hash(i + vec2(1.0, 1.0));
+    return mix(mix(a, b, u.x), mix(c, d, u.x), u.y);
+}
+
+mat2 rotation(float angle)
+{
+    float s = sin(angle);
+    float c = cos(angle);
+    return mat2(c, s, -s, c);
+}
+
+float fbm(vec2 p)
+{
+    float value = 0.0;
+    float amplitude = 0.5;
+    mat2 rotate = rotation(0.5);
+    for (int octave = 0; octave < 6; octave++)
+    {
+        value += amplitude * smoothNoise(p);
+        p = rotate * p * 2.0 + vec2(100.0);
+        amplitude *= 0.5;
+    }
+    return value;
+}
+
+void main()
+{
+    vec2 uv = v_texCoord * u_resolution / min(u_resolution.x, u_resolution.y);
+    vec2 q = vec2(fbm(uv), fbm(uv + vec2(1.0)));
+    vec2 r = vec2(fbm(uv + q + vec2(1.7, 9.2) + 0.15 * u_time),
+                  fbm(uv + q + vec2(8.3, 2.8) + 0.126 * u_time));
+    float f = fbm(uv + r);
+
+    vec3 color = mix(u_lowColor, u_highColor, clamp(f * f * 4.0, 0.0, 1.0));
+    color = mix(color, vec3(0.0, 0.0, 0.16), clamp(length(q), 0.0, 1.0));
+    gl_FragColor = vec4((f * f * f + 0.6 * f * f + 0.5 * f) * color, 1.0);
+}
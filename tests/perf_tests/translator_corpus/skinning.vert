@@ -0,0 +1,41 @@
+// Linear blend skinning with four influences per vertex.
+precision highp float;
+
+#define MAX_BONES 32
+
+attribute vec3 a_position;
+attribute vec3 a_normal;
+attribute vec2 a_texCoord;
+attribute vec4 a_boneIndices;
+attribute vec4 a_boneWeights;
+
+uniform mat4 u_bones[MAX_BONES];
+uniform mat4 u_modelView;
+uniform mat4 u_projection;
+uniform mat3 u_normalMatrix;
+
+varying vec3 v_position;
+varying vec3 v_normal;
+varying vec2 v_texCoord;
+
+mat4 boneMatrix(float index)
+{
+    return u_bones[int(index)];
+}
+
+void main()
+{
+    mat4 skin = boneMatrix(a_boneIndices.x) * a_boneWeights.x +
+                boneMatrix(a_boneIndices.y) * a_boneWeights.y +
+                boneMatrix(a_boneIndices.z) * a_boneWeights.z +
+                boneMatrix(a_boneIndices.w) * a_boneWeights.w;
+
+    vec4 skinnedPosition = skin * vec4(a_position, 1.0);
+    vec3 skinnedNormal = (skin * vec4(a_normal, 0.0)).xyz;
+
+    vec4 viewPosition = u_modelView * skinnedPosition;
+    v_position = viewPosition.xyz;
+    v_normal = normalize(u_normalMatrix * skinnedNormal);
+    v_texCoord = a_texCoord;
+    gl_Position = u_projection * viewPosition;
+}
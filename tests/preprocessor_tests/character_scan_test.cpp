@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "CharacterScan.h"
+
+namespace
+{
+
+typedef const char *(*ScanFunction)(const char *begin, const char *end);
+
+struct ScanParam
+{
+    ScanFunction function;
+    const char *set;
+    bool matching;
+};
+
+// Scans [begin, end) one character at a time.
+const char *ScanSlowly(const ScanParam &param, const char *begin, const char *end)
+{
+    for (const char *c = begin; c != end; ++c)
+    {
+        bool inSet = (*c != '\0') && (std::string(param.set).find(*c) != std::string::npos);
+        if (inSet == param.matching)
+            return c;
+    }
+    return end;
+}
+
+}  // anonymous namespace
+
+class CharacterScanTest : public testing::TestWithParam<ScanParam>
+{
+};
+
+TEST_P(CharacterScanTest, MatchesScalarScan)
+{
+    const ScanParam &param = GetParam();
+
+    // Runs of every length around the vector width, at every alignment,
+    // followed by each character that may stop the scan.
+    const char kCharacters[] = "/* \t\v\f\r\na1\\";
+    for (size_t i = 0; i + 1 < sizeof(kCharacters); ++i)
+    {
+        for (size_t runLength = 0; runLength < 40; ++runLength)
+        {
+            for (size_t offset = 0; offset < 16; ++offset)
+            {
+                std::string text(offset, 'x');
+                text += std::string(runLength, param.matching ? 'x' : ' ');
+                text += kCharacters[i];
+                text += "abc";
+
+                const char *begin = text.data() + offset;
+                const char *end = text.data() + text.size();
+                EXPECT_EQ(ScanSlowly(param, begin, end), param.function(begin, end));
+                // The scan does not look past |end|.
+                end = begin + runLength;
+                EXPECT_EQ(ScanSlowly(param, begin, end), param.function(begin, end));
+            }
+        }
+    }
+}
+
+const ScanParam kScanParams[] = {
+    {pp::FindLineBreak, "\r\n", true},
+    {pp::FindCommentBreak, "*\r\n", true},
+    {pp::FindCommentOrBlank, "/ \t\v\f", true},
+    {pp::SkipBlanks, " \t\v\f", false},
+};
+
+INSTANTIATE_TEST_CASE_P(All, CharacterScanTest, testing::ValuesIn(kScanParams));
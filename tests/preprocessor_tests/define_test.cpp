@@ -891,3 +891,30 @@ TEST_F(DefineTest, Predefined_FILE2)
     EXPECT_EQ(pp::Token::CONST_INT, token.type);
     EXPECT_EQ("21", token.text);
 }
+
+// Object-like macros share their replacement lists between expansions, so
+// expanding nested macros again must give the same tokens every time.
+TEST_F(DefineTest, RepeatedNestedExpansion)
+{
+    const char* input = "#define SCALE 2.0\n"
+                        "#define MAD(a, b, c) ((a) * (b) + (c))\n"
+                        "#define LERP(a, b, t) MAD((b) - (a), t, a)\n"
+                        "#define SATURATE(x) clamp(x, 0.0, 1.0)\n"
+                        "#define BLEND(x, y, t) SATURATE(LERP(x, y * SCALE, t))\n"
+                        "c0 = BLEND(s0, u0, w0) + MAD(c, SCALE, SCALE);\n"
+                        "c1 = BLEND(s1, u1, w1) + MAD(c, SCALE, SCALE);\n"
+                        "c2 = BLEND(s2, u2, w2) + MAD(c, SCALE, SCALE);\n";
+    const char* expected = "\n"
+                           "\n"
+                           "\n"
+                           "\n"
+                           "\n"
+                           "c0 = clamp((((u0 * 2.0) - (s0)) * (w0) + (s0)), 0.0, 1.0)"
+                           " + ((c) * (2.0) + (2.0));\n"
+                           "c1 = clamp((((u1 * 2.0) - (s1)) * (w1) + (s1)), 0.0, 1.0)"
+                           " + ((c) * (2.0) + (2.0));\n"
+                           "c2 = clamp((((u2 * 2.0) - (s2)) * (w2) + (s2)), 0.0, 1.0)"
+                           " + ((c) * (2.0) + (2.0));\n";
+
+    preprocess(input, expected);
+}
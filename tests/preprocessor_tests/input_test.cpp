@@ -8,6 +8,9 @@
 #include "Input.h"
 #include "Token.h"
 
+#include <string>
+#include <vector>
+
 class InitTest : public PreprocessorTest
 {
 };
@@ -154,3 +157,61 @@ TEST(InputTest, ReadStringsWithLength)
     EXPECT_STREQ("fobar", buf);
 }
 
+
+// Reads all of |input| with readCompact(), |maxSize| characters at a time.
+static std::string ReadCompact(pp::Input *input, size_t maxSize)
+{
+    std::string result;
+    std::vector<char> buf(maxSize);
+    for (size_t size = input->readCompact(&buf[0], maxSize); size > 0;
+         size = input->readCompact(&buf[0], maxSize))
+    {
+        result.append(&buf[0], size);
+    }
+    return result;
+}
+
+TEST(InputTest, ReadCompact)
+{
+    struct Case
+    {
+        const char *input;
+        const char *compacted;
+    };
+    const Case kCases[] = {
+        {"foo bar", "foo bar"},
+        {"foo  \t\v\f  bar", "foo bar"},
+        {"a/b /= c", "a/b /= c"},
+        {"foo // comment /* with */ text\nbar", "foo //\nbar"},
+        {"foo /* comment // with\n text */bar", "foo /*\n*/bar"},
+        {"/* ** * /* *\r\n*/", "/*\r\n*/"},
+        {"/*/ */", "/**/"},
+        // A lone '\r' must stay apart from a later '\n'.
+        {"/* a\r b\n\r\n */", "/*\r \n\r\n*/"},
+        {"/* a\r*\n */", "/*\r*\n*/"},
+        {"\\\n  \\\r\n", "\\\n \\\r\n"},
+        {"/* unterminated\n", "/*\n"},
+    };
+
+    for (size_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); ++i)
+    {
+        for (size_t maxSize = 1; maxSize <= 4; ++maxSize)
+        {
+            pp::Input input(1, &kCases[i].input, NULL);
+            EXPECT_EQ(kCases[i].compacted, ReadCompact(&input, maxSize))
+                << kCases[i].input << " " << maxSize;
+        }
+    }
+}
+
+TEST(InputTest, ReadCompactMultipleStrings)
+{
+    // Comments and whitespace runs continue across strings.
+    const char *str[] = {"a  /", "* x", "", "*", "/ ", " // y\n", "  b"};
+    pp::Input input(7, str, NULL);
+    EXPECT_EQ("a /**/ //\n b", ReadCompact(&input, 8));
+
+    const size_t compactLength[] = {3, 1, 0, 1, 2, 3, 2};
+    for (size_t i = 0; i < 7; ++i)
+        EXPECT_EQ(compactLength[i], input.compactLength(i)) << i;
+}
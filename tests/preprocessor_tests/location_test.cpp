@@ -72,6 +72,34 @@ TEST_F(LocationTest, NewlineInsideCommentCounted)
     expectLocation(1, &str, NULL, loc);
 }
 
+TEST_F(LocationTest, CarriageReturnsInsideCommentCounted)
+{
+    // A lone '\r' and "\r\n" are one line break each.
+    const char* str = "/* a\r b\r\n c\r*\n*/foo";
+    pp::SourceLocation loc(0, 5);
+
+    SCOPED_TRACE("CarriageReturnsInsideCommentCounted");
+    expectLocation(1, &str, NULL, loc);
+}
+
+TEST_F(LocationTest, CommentStraddlingStrings)
+{
+    const char* const str[] = {"/* long comment\n", "more of it\n", "end */  foo"};
+    pp::SourceLocation loc(2, 1);
+
+    SCOPED_TRACE("CommentStraddlingStrings");
+    expectLocation(3, str, NULL, loc);
+}
+
+TEST_F(LocationTest, WhitespaceStraddlingStrings)
+{
+    const char* const str[] = {"// comment\n    ", "      ", "\t\t\n foo"};
+    pp::SourceLocation loc(2, 2);
+
+    SCOPED_TRACE("WhitespaceStraddlingStrings");
+    expectLocation(3, str, NULL, loc);
+}
+
 TEST_F(LocationTest, ErrorLocationAfterComment)
 {
     const char* str = "/*\n\n*/@";
@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include <sstream>
+
+#include "PreprocessorTest.h"
+#include "Token.h"
+
+class MemoryBudgetTest : public PreprocessorTest
+{
+  protected:
+    // Returns the tokens of |input|, separated by spaces.
+    std::string lexAll(const char *input)
+    {
+        EXPECT_TRUE(mPreprocessor.init(1, &input, NULL));
+
+        std::stringstream stream;
+        pp::Token token;
+        for (mPreprocessor.lex(&token); token.type != pp::Token::LAST; mPreprocessor.lex(&token))
+        {
+            stream << token.text << " ";
+        }
+        return stream.str();
+    }
+};
+
+TEST_F(MemoryBudgetTest, ExponentialExpansion)
+{
+    // Each level doubles the tokens the argument expands to.
+    std::string input = "#define D(x) x x\n"
+                        "a\n";
+    std::string call = "b";
+    for (int i = 0; i < 24; ++i)
+        call = "D(" + call + ")";
+    input += call + "\nc\n";
+
+    EXPECT_CALL(mDiagnostics,
+                print(pp::Diagnostics::PP_MACRO_EXPANSION_TOO_LARGE,
+                      pp::SourceLocation(0, 3),
+                      "D"));
+
+    // The expansion stops, and so does the input.
+    mPreprocessor.setMemoryBudget(64 * 1024);
+    EXPECT_EQ("a ", lexAll(input.c_str()));
+    EXPECT_TRUE(mPreprocessor.memoryBudgetExceeded());
+}
+
+TEST_F(MemoryBudgetTest, BudgetIsReleased)
+{
+    // Expansions that fit the budget one at a time are not affected by
+    // how many of them there are.
+    std::string input = "#define D(x) x x\n"
+                        "#define E(x) D(D(D(D(x))))\n";
+    std::string expected;
+    for (int i = 0; i < 100; ++i)
+    {
+        input += "E(a)\n";
+        expected += "a a a a a a a a a a a a a a a a ";
+    }
+
+    EXPECT_CALL(mDiagnostics, print(testing::_, testing::_, testing::_)).Times(0);
+
+    mPreprocessor.setMemoryBudget(4 * 1024);
+    EXPECT_EQ(expected, lexAll(input.c_str()));
+    EXPECT_FALSE(mPreprocessor.memoryBudgetExceeded());
+}
@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2014 The ANGLE Project Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+
+#include <sstream>
+
+#include "PreprocessorTest.h"
+#include "Token.h"
+
+class SnapshotTest : public PreprocessorTest
+{
+  protected:
+    SnapshotTest()
+        : mSnapshotPreprocessor(&mDiagnostics, &mDirectiveHandler),
+          mSnapshot(NULL)
+    {
+    }
+
+    virtual ~SnapshotTest()
+    {
+        delete mSnapshot;
+    }
+
+    void takeSnapshot(const char *prologue)
+    {
+        ASSERT_TRUE(mSnapshotPreprocessor.init(1, &prologue, NULL));
+        mSnapshot = mSnapshotPreprocessor.takeSnapshot();
+    }
+
+    // Preprocesses the input string, starting from the snapshot, and
+    // verifies that it matches the expected output.
+    void preprocessFromSnapshot(pp::Preprocessor *preprocessor,
+                                const char *input, const char *expected)
+    {
+        ASSERT_TRUE(mSnapshot != NULL);
+        ASSERT_TRUE(preprocessor->init(*mSnapshot, 1, &input, NULL));
+
+        pp::Token token;
+        std::stringstream stream;
+        int line = 1;
+        do
+        {
+            preprocessor->lex(&token);
+            for (; line < token.location.line; ++line)
+            {
+                stream << "\n";
+            }
+            stream << token;
+        } while (token.type != pp::Token::LAST);
+
+        EXPECT_EQ(expected, stream.str());
+    }
+
+    pp::Preprocessor mSnapshotPreprocessor;
+    pp::Snapshot *mSnapshot;
+};
+
+TEST_F(SnapshotTest, MacrosAreKept)
+{
+    const char *prologue =
+        "#define FOO 1\n"
+        "#define BAR(x) (x + FOO)\n"
+        "#define BAZ 2\n"
+        "#undef BAZ\n";
+
+    using testing::_;
+    // No error or warning.
+    EXPECT_CALL(mDiagnostics, print(_, _, _)).Times(0);
+
+    takeSnapshot(prologue);
+    preprocessFromSnapshot(&mPreprocessor, "BAR(3) BAZ __VERSION__\n", "(3 + 1) BAZ 100\n");
+}
+
+TEST_F(SnapshotTest, DirectivesAreReplayed)
+{
+    const char *prologue =
+        "#extension foo : enable\n"
+        "#pragma optimize(off)\n";
+
+    using testing::_;
+    // Once while the snapshot is taken, and once for the compilation.
+    EXPECT_CALL(mDirectiveHandler,
+                handleExtension(pp::SourceLocation(0, 1), "foo", "enable")).Times(2);
+    EXPECT_CALL(mDirectiveHandler,
+                handlePragma(pp::SourceLocation(0, 2), "optimize", "off", false)).Times(2);
+    EXPECT_CALL(mDiagnostics, print(_, _, _)).Times(0);
+
+    takeSnapshot(prologue);
+    preprocessFromSnapshot(&mPreprocessor, "foo\n", "foo\n");
+}
+
+TEST_F(SnapshotTest, SharedByPreprocessors)
+{
+    using testing::_;
+    EXPECT_CALL(mDiagnostics, print(_, _, _)).Times(0);
+
+    takeSnapshot("#define FOO 1\n");
+    preprocessFromSnapshot(&mPreprocessor, "#undef FOO\nFOO\n", "\nFOO\n");
+
+    // Changes to the macros of one preprocessor do not affect the snapshot.
+    pp::Preprocessor other(&mDiagnostics, &mDirectiveHandler);
+    preprocessFromSnapshot(&other, "FOO\n", "1\n");
+}
+
+TEST_F(SnapshotTest, OnlyDirectivesAllowed)
+{
+    using testing::_;
+    EXPECT_CALL(mDiagnostics,
+                print(pp::Diagnostics::PP_PROLOGUE_UNEXPECTED_TOKEN,
+                      pp::SourceLocation(0, 2), "float"));
+
+    takeSnapshot("#define FOO 1\nfloat FOO;\n");
+    EXPECT_TRUE(mSnapshot == NULL);
+}
+
+// As with a shader that follows the prologue, #version may only come first
+// if the prologue has no directives.
+TEST_F(SnapshotTest, VersionAfterPrologue)
+{
+    using testing::_;
+    EXPECT_CALL(mDirectiveHandler, handleVersion(_, 300));
+    EXPECT_CALL(mDiagnostics, print(_, _, _)).Times(0);
+
+    takeSnapshot("// Comments only.\n");
+    preprocessFromSnapshot(&mPreprocessor, "#version 300 es\n", "\n");
+}
+
+TEST_F(SnapshotTest, VersionAfterDirectives)
+{
+    using testing::_;
+    EXPECT_CALL(mDirectiveHandler, handleVersion(_, _)).Times(0);
+    EXPECT_CALL(mDiagnostics,
+                print(pp::Diagnostics::PP_VERSION_NOT_FIRST_STATEMENT,
+                      pp::SourceLocation(0, 1), "version"));
+
+    takeSnapshot("#define FOO 1\n");
+    preprocessFromSnapshot(&mPreprocessor, "#version 300 es\n", "\n");
+}
@@ -128,6 +128,87 @@
                 },
             },
         },
+        {
+            'target_name': 'image_util_tests',
+            'type': 'executable',
+            'dependencies':
+            [
+                '../src/angle.gyp:image_util',
+                'gtest',
+            ],
+            'include_dirs':
+            [
+                '../include',
+                '../src',
+                'third_party/googletest/include',
+            ],
+            'includes':
+            [
+                '../build/common_defines.gypi',
+                'image_util_tests/image_util_tests.gypi',
+            ],
+            'sources':
+            [
+                'image_util_tests/image_util_test_main.cpp',
+            ],
+        },
+        {
+            # Headless, so that it runs wherever the translator builds.
+            'target_name': 'translator_perftests',
+            'type': 'executable',
+            'includes': [ '../build/common_defines.gypi', ],
+            'dependencies':
+            [
+                '../src/angle.gyp:translator_static',
+            ],
+            'include_dirs':
+            [
+                '../include',
+                '../src',
+                'perf_tests',
+            ],
+            'sources':
+            [
+                'perf_tests/TranslatorBenchmark.cpp',
+                'perf_tests/TranslatorBenchmark.h',
+                'perf_tests/TranslatorBenchmarks.cpp',
+                'perf_tests/TranslatorMicroBenchmarks.cpp',
+                'perf_tests/TranslatorMicroBenchmarks.h',
+                'perf_tests/third_party/perf/perf_test.cc',
+                'perf_tests/third_party/perf/perf_test.h',
+            ],
+            'copies':
+            [
+                {
+                    'destination': '<(PRODUCT_DIR)/translator_corpus',
+                    'files': [ '<!@(python <(angle_path)/enumerate_files.py perf_tests/translator_corpus -types *.frag *.vert)' ],
+                },
+            ],
+        },
+        {
+            # Headless, like translator_perftests.
+            'target_name': 'image_util_perftests',
+            'type': 'executable',
+            'includes': [ '../build/common_defines.gypi', ],
+            'dependencies':
+            [
+                '../src/angle.gyp:image_util',
+            ],
+            'include_dirs':
+            [
+                '../include',
+                '../src',
+                'perf_tests',
+            ],
+            'sources':
+            [
+                'perf_tests/ImageUtilBenchmark.cpp',
+                'perf_tests/ImageUtilBenchmark.h',
+                'perf_tests/ImageUtilBenchmarks.cpp',
+                'perf_tests/third_party/perf/perf_test.cc',
+                'perf_tests/third_party/perf/perf_test.h',
+            ],
+        },
     ],
 
     'conditions':